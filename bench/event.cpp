@@ -0,0 +1,152 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/event_thread.h>
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+struct EventTest {
+    static const uint THREADS = 4;
+    static const uint FANOUT  = 1000;
+    static const uint WORK    = 200;
+
+    // Baseline: all threads share a single EventQueue (previous EventThreadPool design)
+    struct SharedQueueState {
+        EventQueue<> queue;
+        Condition condmutex;
+        AtomicInt shutdown;
+        SharedQueueState() : queue(FANOUT * 2)
+            { shutdown.store(0); }
+    };
+
+    struct SharedQueuePool : ThreadGroup<Thread,SharedQueueState> {
+        SharedQueuePool() : ThreadGroup<Thread,SharedQueueState>(thread_run)
+            { }
+
+        void add(Event* event) {
+            shared_state.queue.add(event);
+            shared_state.queue.notify_multiwait(shared_state.condmutex);
+        }
+
+        void shutdown() {
+            shared_state.shutdown.store(1, EVO_ATOMIC_RELEASE);
+            shared_state.condmutex.lock_notify_all();
+        }
+
+        static void thread_run(void* arg) {
+            SharedQueueState& state = *(SharedQueueState*)arg;
+            while (state.shutdown.load(EVO_ATOMIC_ACQUIRE) == 0)
+                state.queue.process_multiwait(state.condmutex, state.shutdown, 1);
+            while (state.queue.process_multi(state.condmutex));
+        }
+    };
+
+    static AtomicULong& remaining() {
+        static AtomicULong value;
+        return value;
+    }
+
+    static void wait_done() {
+        while (remaining().load(EVO_ATOMIC_ACQUIRE) != 0)
+            SysThread::yield();
+    }
+
+    // Small unit of work, then signal completion
+    struct LeafEvent : Event {
+        ulong seed;
+        LeafEvent(ulong seed) : seed(seed)
+            { }
+        bool operator()() {
+            ulong val = seed;
+            for (uint i = 0; i < WORK; ++i)
+                val = val * 31 + i;
+            if (val == 0)
+                abort();
+            remaining().fetch_sub(1, EVO_ATOMIC_ACQ_REL);
+            return true;
+        }
+    };
+
+    // Fan-out from inside a pool thread
+    template<class P> struct RootEvent : Event {
+        P& pool;
+        RootEvent(P& pool) : pool(pool)
+            { }
+        bool operator()() {
+            for (uint i = 0; i < FANOUT; ++i)
+                pool.add(new LeafEvent(i + 1));
+            return true;
+        }
+    };
+
+    template<class P> struct BM {
+        static P& pool() {
+            static P* pool = NULL;
+            if (pool == NULL) {
+                pool = new P;
+                pool->start(THREADS);
+            }
+            return *pool;
+        }
+
+        // Fan-out from outside the pool, then join
+        static void external() {
+            P& p = pool();
+            remaining().store(FANOUT, EVO_ATOMIC_RELEASE);
+            for (uint i = 0; i < FANOUT; ++i)
+                p.add(new LeafEvent(i + 1));
+            wait_done();
+        }
+
+        // Fan-out from an event in the pool, then join
+        static void nested() {
+            P& p = pool();
+            remaining().store(FANOUT, EVO_ATOMIC_RELEASE);
+            p.add(new RootEvent<P>(p));
+            wait_done();
+        }
+    };
+};
+
+int main() {
+    Console& c = con();
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        << " - Threads               " << EventTest::THREADS << NL
+        << " - Fan-out               " << EventTest::FANOUT << NL
+        ;
+
+    c.out << NL;
+
+    typedef EventTest::BM<EventThreadPool> WorkStealing;
+    typedef EventTest::BM<EventTest::SharedQueuePool> SharedQueue;
+
+    c.out << "FanOutExternal:" << NL;
+    {
+        EVO_BENCH_SETUP(SharedQueue::external, 10);
+        EVO_BENCH_RUN(WorkStealing::external);
+        EVO_BENCH_RUN(SharedQueue::external);
+        bench.report(fmt_type);
+    }
+
+    c.out << "FanOutNested:" << NL;
+    {
+        EVO_BENCH_SETUP(SharedQueue::nested, 10);
+        EVO_BENCH_RUN(WorkStealing::nested);
+        EVO_BENCH_RUN(SharedQueue::nested);
+        bench.report(fmt_type);
+    }
+
+    WorkStealing::pool().shutdown().join();
+    SharedQueue::pool().shutdown();
+    SharedQueue::pool().join();
+    return 0;
+}
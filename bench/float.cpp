@@ -0,0 +1,162 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/string.h>
+#include <sstream>
+#include <iomanip>
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+#if _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable:4996)
+#endif
+
+struct FloatFmtTest {
+    static const int COUNT = 16;
+
+    struct InputMixed {
+        static const double* get_input() {
+            static const double VALUES[COUNT] = {
+                0.1, 1.5, -2.25, 3.14159265358979, 100.0, 0.30000000000000004, 1234.5678, 1e-5,
+                6.02214076e23, -9.81, 0.001, 42.0, 2.718281828459045, 1e100, -0.5, 98765.4321
+            };
+            return VALUES;
+        }
+    };
+    struct InputMetrics {
+        // Typical metric values: timings and rates with a few decimal places
+        static const double* get_input() {
+            static const double VALUES[COUNT] = {
+                0.253, 12.5, 1.75, 330.125, 0.0042, 17.0, 99.9, 1024.0,
+                5.5, 0.875, 250.25, 3.0, 61.44, 0.5, 7.125, 1.0
+            };
+            return VALUES;
+        }
+    };
+    struct InputRandom {
+        // Random bits -- mostly 17 significant digits
+        static const double* get_input() {
+            static double VALUES[COUNT];
+            static bool init = false;
+            if (!init) {
+                uint64 x = 88172645463325252ULL;
+                for (int i = 0; i < COUNT; ) {
+                    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                    double val = (double)(x >> 11) / (double)(1ULL << 53) * 1000.0;
+                    VALUES[i++] = val;
+                }
+                init = true;
+            }
+            return VALUES;
+        }
+    };
+
+    template<class T> struct BM {
+        static void evo_auto() {
+            const double* in = T::get_input();
+            String str;
+            for (int i = 0; i < COUNT; ++i)
+                str << in[i] << ',';
+            if (str.size() == 0)
+                abort();
+        }
+
+        static void evo_prec() {
+            const double* in = T::get_input();
+            String str;
+            for (int i = 0; i < COUNT; ++i)
+                str << FmtFloat(in[i], 3) << ',';
+            if (str.size() == 0)
+                abort();
+        }
+
+        static void evo_StringFlt() {
+            const double* in = T::get_input();
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i) {
+                StringFlt<double> str(in[i]);
+                total += str.size();
+            }
+            if (total == 0)
+                abort();
+        }
+
+        static void stl() {
+            const double* in = T::get_input();
+            std::ostringstream out;
+            out << std::setprecision(17);
+            for (int i = 0; i < COUNT; ++i)
+                out << in[i] << ',';
+            if (out.str().size() == 0)
+                abort();
+        }
+
+        static void c() {
+            const double* in = T::get_input();
+            const int BUF_SIZE = 32;
+            char buf[BUF_SIZE];
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += (ulong)snprintf(buf, BUF_SIZE, "%.17g", in[i]);
+            if (total == 0)
+                abort();
+        }
+
+        static void c_prec() {
+            const double* in = T::get_input();
+            const int BUF_SIZE = 512;
+            char buf[BUF_SIZE];
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += (ulong)snprintf(buf, BUF_SIZE, "%.3f", in[i]);
+            if (total == 0)
+                abort();
+        }
+    };
+};
+
+int main() {
+    Console& c = con();
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        ;
+
+    c.out << NL;
+
+    // Note: stl and c use %.17g (round-trip), evo uses shortest round-trip
+    #define RUN_FLOAT_TEST(T) { \
+        typedef FloatFmtTest::BM<T> BM; \
+        EVO_BENCH_SETUP(BM::c, 1000); \
+        EVO_BENCH_RUN(BM::evo_auto); \
+        EVO_BENCH_RUN(BM::evo_prec); \
+        EVO_BENCH_RUN(BM::evo_StringFlt); \
+        EVO_BENCH_RUN(BM::stl); \
+        EVO_BENCH_RUN(BM::c); \
+        EVO_BENCH_RUN(BM::c_prec); \
+        bench.report(fmt_type); \
+    }
+
+    c.out << "FloatFmtMixed:" << NL;
+    RUN_FLOAT_TEST(FloatFmtTest::InputMixed);
+
+    c.out << "FloatFmtMetrics:" << NL;
+    RUN_FLOAT_TEST(FloatFmtTest::InputMetrics);
+
+    c.out << "FloatFmtRandom:" << NL;
+    RUN_FLOAT_TEST(FloatFmtTest::InputRandom);
+
+    return 0;
+}
+
+#if _MSC_VER
+    #pragma warning(pop)
+#endif
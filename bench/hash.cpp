@@ -0,0 +1,134 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/maphash.h>
+#include <evo/string.h>
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+struct HashTest {
+    static const int COUNT = 64;
+
+    // Input keys of fixed length, offset by 1 byte so most are unaligned
+    template<int LEN> struct Input {
+        char buf[COUNT * LEN + 1];
+
+        Input() {
+            ulong seed = 12345;
+            for (int i = 0; i < COUNT * LEN + 1; ++i) {
+                seed = seed * 1103515245 + 12345;
+                buf[i] = (char)('a' + ((seed >> 16) % 26));
+            }
+        }
+
+        const char* key(int i) const
+            { return buf + 1 + (i * LEN); }
+
+        static const Input& get() {
+            static const Input input;
+            return input;
+        }
+    };
+
+    template<int LEN> struct BM {
+        template<class H> static void run() {
+            const Input<LEN>& in = Input<LEN>::get();
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += H::hash(in.key(i), LEN, 0);
+            if (total == 0)
+                abort();
+        }
+
+        static void SpookyHash()
+            { run< ::SpookyHash>(); }
+        static void WyHash()
+            { run<evo::WyHash>(); }
+        static void AesHash()
+            { run<evo::AesHash>(); }
+    };
+
+    // Map lookups with 1000 String keys (about 20 bytes each), looking up copies of the stored keys
+    template<class H> struct MapLookup {
+        typedef MapHash<String,int,CompareHash<String,H> > Map;
+
+        Map map;
+        String keys[COUNT];
+
+        MapLookup() {
+            String key;
+            for (int i = 0; i < 1000; ++i) {
+                key.set();
+                key << "session:" << (ulong)(i * 7919) << ":user";
+                map[key] = i;
+                if (i < COUNT)
+                    keys[i] = key;
+            }
+        }
+
+        static MapLookup& get() {
+            static MapLookup data;
+            return data;
+        }
+
+        static void run() {
+            MapLookup& data = get();
+            int total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += *data.map.find(data.keys[i]);
+            if (total == 0)
+                abort();
+        }
+    };
+};
+
+int main() {
+    Console& c = con();
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        << " - AES-NI                " << (AesHash::supported() ? "yes" : "no") << NL
+        << " - Hash cache            " << (EVO_LIST_OPT_HASHCACHE ? "yes" : "no") << NL
+        ;
+
+    c.out << NL;
+
+    #define RUN_HASH_TEST(LEN) { \
+        typedef HashTest::BM<LEN> BM; \
+        c.out << "Length" << LEN << ':' << NL; \
+        EVO_BENCH_SETUP(BM::SpookyHash, 1000); \
+        EVO_BENCH_RUN(BM::SpookyHash); \
+        EVO_BENCH_RUN(BM::WyHash); \
+        EVO_BENCH_RUN(BM::AesHash); \
+        bench.report(fmt_type); \
+    }
+
+    RUN_HASH_TEST(8);
+    RUN_HASH_TEST(16);
+    RUN_HASH_TEST(24);
+    RUN_HASH_TEST(32);
+    RUN_HASH_TEST(40);
+    RUN_HASH_TEST(64);
+    RUN_HASH_TEST(256);
+
+    c.out << "MapLookup:" << NL;
+    {
+        typedef HashTest::MapLookup< ::SpookyHash> SpookyHashMap;
+        typedef HashTest::MapLookup<WyHash> WyHashMap;
+        typedef HashTest::MapLookup<AesHash> AesHashMap;
+        EVO_BENCH_SETUP(SpookyHashMap::run, 1000);
+        EVO_BENCH_RUN(SpookyHashMap::run);
+        EVO_BENCH_RUN(WyHashMap::run);
+        EVO_BENCH_RUN(AesHashMap::run);
+        bench.report(fmt_type);
+    }
+
+    return 0;
+}
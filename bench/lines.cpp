@@ -0,0 +1,127 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/file.h>
+#include <evo/mappedfile.h>
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+struct LinesTest {
+    static const uint LINES   = 500000;     // lines in test file
+    static const uint THREADS = 4;          // chunks for MappedFile chunked test, read in turn here to show split overhead
+    static const char* PATH;
+
+    static ulongl expected_bytes;
+
+    static void create() {
+        File file(PATH, oWRITE_NEW);
+        expected_bytes = 0;
+        String line;
+        for (uint i = 0; i < LINES; ++i) {
+            line.set() << "2019-01-01 00:00:00 INFO request " << i << " path=/api/items/" << (i * 7919) % 100000 << " status=200";
+            file << line << NL;
+            expected_bytes += line.size();
+        }
+    }
+
+    static void check(ulongl bytes) {
+        if (bytes != expected_bytes)
+            abort();
+    }
+
+    // Read lines with File::readline(), copying each line into a String
+    static void file_readline() {
+        File file(PATH);
+        ulongl bytes = 0;
+        for (String line; file.readline(line); )
+            bytes += line.size();
+        check(bytes);
+    }
+
+    // Read lines with File::readlines() in batches, without copying
+    static void file_readlines() {
+        File file(PATH);
+        ulongl bytes = 0;
+        LineBatch batch;
+        while (file.readlines(batch)) {
+            for (SizeT i = 0; i < batch.lines.size(); ++i)
+                bytes += batch.lines[i].size();
+        }
+        check(bytes);
+    }
+
+    // Read lines with File::readlines() using a callback
+    struct AddBytes {
+        ulongl* bytes;
+        void operator()(const SubString& line) const
+            { *bytes += line.size(); }
+    };
+
+    static void file_readlines_func() {
+        File file(PATH);
+        ulongl bytes = 0;
+        AddBytes func = { &bytes };
+        file.readlines(func);
+        check(bytes);
+    }
+
+    // Read lines from MappedFile without copying
+    static void mapped_lines() {
+        MappedFile file(PATH);
+        ulongl bytes = 0;
+        MappedFile::Lines lines(file.lines());
+        while (lines.next())
+            bytes += lines.value().size();
+        check(bytes);
+    }
+
+    // Read lines from MappedFile split into chunks
+    static void mapped_chunks() {
+        MappedFile file(PATH);
+        ulongl bytes = 0;
+        for (uint i = 0; i < THREADS; ++i) {
+            MappedFile::Lines lines(file.lines(i, THREADS));
+            while (lines.next())
+                bytes += lines.value().size();
+        }
+        check(bytes);
+    }
+};
+
+const char* LinesTest::PATH = "bench_lines.tmp";
+ulongl LinesTest::expected_bytes = 0;
+
+int main() {
+    Console& c = con();
+
+    LinesTest::create();
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        << " - Lines                 " << LinesTest::LINES << NL
+        << " - Chunks                " << LinesTest::THREADS << NL
+        ;
+
+    c.out << NL;
+
+    c.out << "ReadLines:" << NL;
+    {
+        EVO_BENCH_SETUP(LinesTest::file_readline, 10);
+        EVO_BENCH_RUN(LinesTest::file_readline);
+        EVO_BENCH_RUN(LinesTest::file_readlines);
+        EVO_BENCH_RUN(LinesTest::file_readlines_func);
+        EVO_BENCH_RUN(LinesTest::mapped_lines);
+        EVO_BENCH_RUN(LinesTest::mapped_chunks);
+        bench.report(fmt_type);
+    }
+
+    ::remove(LinesTest::PATH);
+    return 0;
+}
@@ -0,0 +1,215 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/string.h>
+#include <string>
+#if defined(EVO_CPP17)
+    #include <charconv>
+#endif
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+#if _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable:4996)
+#endif
+
+struct NumberTest {
+    static const int COUNT = 16;
+
+    struct InputSmall {
+        // Typical protocol values: flags, sizes, counts
+        static const ulongl* get_input() {
+            static const ulongl VALUES[COUNT] = {
+                0, 1, 7, 42, 100, 512, 999, 1024, 4096, 12345, 65535, 100000, 3, 250, 86400, 99
+            };
+            return VALUES;
+        }
+    };
+    struct InputLarge {
+        // Timestamps, ids, and hashes
+        static const ulongl* get_input() {
+            static const ulongl VALUES[COUNT] = {
+                1571116800ULL, 1571116800123ULL, 4294967295ULL, 9007199254740993ULL, 18446744073709551615ULL, 123456789012ULL,
+                987654321ULL, 1000000000000000000ULL, 31415926535ULL, 2718281828459045ULL, 77777777ULL, 5000000000ULL,
+                12345678901234567ULL, 600000000000ULL, 42424242424242ULL, 10000000019ULL
+            };
+            return VALUES;
+        }
+    };
+
+    template<class T> struct Strings {
+        // Input formatted as terminated strings, for parsing tests
+        char   buf[COUNT][24];
+        size_t len[COUNT];
+
+        Strings() {
+            const ulongl* in = T::get_input();
+            for (int i = 0; i < COUNT; ++i)
+                len[i] = (size_t)snprintf(buf[i], sizeof(buf[i]), "%llu", in[i]);
+        }
+
+        static const Strings& get() {
+            static const Strings strings;
+            return strings;
+        }
+    };
+
+    template<class T> struct BM {
+        // Formatting
+
+        static void evo_fmt() {
+            const ulongl* in = T::get_input();
+            String str;
+            for (int i = 0; i < COUNT; ++i)
+                str << in[i] << ' ';
+            if (str.size() == 0)
+                abort();
+        }
+
+        static void evo_fmt_StringInt() {
+            const ulongl* in = T::get_input();
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i) {
+                StringInt<ulongl> str(in[i]);
+                total += str.size();
+            }
+            if (total == 0)
+                abort();
+        }
+
+    #if defined(EVO_CPP11)
+        static void stl_fmt() {
+            const ulongl* in = T::get_input();
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += (ulong)std::to_string(in[i]).size();
+            if (total == 0)
+                abort();
+        }
+    #endif
+
+    #if defined(EVO_CPP17)
+        static void stl_fmt_to_chars() {
+            const ulongl* in = T::get_input();
+            char buf[24];
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += (ulong)(std::to_chars(buf, buf + sizeof(buf), in[i]).ptr - buf);
+            if (total == 0)
+                abort();
+        }
+    #endif
+
+        static void c_fmt() {
+            const ulongl* in = T::get_input();
+            char buf[24];
+            ulong total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += (ulong)snprintf(buf, sizeof(buf), "%llu", in[i]);
+            if (total == 0)
+                abort();
+        }
+
+        // Parsing
+
+        static void evo_parse() {
+            const Strings<T>& in = Strings<T>::get();
+            ulongl total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += SubString(in.buf[i], (StrSizeT)in.len[i]).getnum<ulongl>(10);
+            if (total == 0)
+                abort();
+        }
+
+    #if defined(EVO_CPP17)
+        static void stl_parse_from_chars() {
+            const Strings<T>& in = Strings<T>::get();
+            ulongl total = 0, val;
+            for (int i = 0; i < COUNT; ++i) {
+                std::from_chars(in.buf[i], in.buf[i] + in.len[i], val);
+                total += val;
+            }
+            if (total == 0)
+                abort();
+        }
+    #endif
+
+        static void c_parse() {
+            const Strings<T>& in = Strings<T>::get();
+            ulongl total = 0;
+            for (int i = 0; i < COUNT; ++i)
+                total += strtoull(in.buf[i], NULL, 10);
+            if (total == 0)
+                abort();
+        }
+    };
+};
+
+int main() {
+    Console& c = con();
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        ;
+
+    c.out << NL;
+
+    #if defined(EVO_CPP11)
+        #define RUN_FMT_TEST_CPP11 EVO_BENCH_RUN(BM::stl_fmt);
+    #else
+        #define RUN_FMT_TEST_CPP11
+    #endif
+    #if defined(EVO_CPP17)
+        #define RUN_FMT_TEST_CPP17 EVO_BENCH_RUN(BM::stl_fmt_to_chars);
+        #define RUN_PARSE_TEST_CPP17 EVO_BENCH_RUN(BM::stl_parse_from_chars);
+    #else
+        #define RUN_FMT_TEST_CPP17
+        #define RUN_PARSE_TEST_CPP17
+    #endif
+
+    #define RUN_FMT_TEST(T) { \
+        typedef NumberTest::BM<T> BM; \
+        EVO_BENCH_SETUP(BM::c_fmt, 1000); \
+        EVO_BENCH_RUN(BM::evo_fmt); \
+        EVO_BENCH_RUN(BM::evo_fmt_StringInt); \
+        RUN_FMT_TEST_CPP11 \
+        RUN_FMT_TEST_CPP17 \
+        EVO_BENCH_RUN(BM::c_fmt); \
+        bench.report(fmt_type); \
+    }
+
+    #define RUN_PARSE_TEST(T) { \
+        typedef NumberTest::BM<T> BM; \
+        EVO_BENCH_SETUP(BM::c_parse, 1000); \
+        EVO_BENCH_RUN(BM::evo_parse); \
+        RUN_PARSE_TEST_CPP17 \
+        EVO_BENCH_RUN(BM::c_parse); \
+        bench.report(fmt_type); \
+    }
+
+    c.out << "FormatSmall:" << NL;
+    RUN_FMT_TEST(NumberTest::InputSmall);
+
+    c.out << "FormatLarge:" << NL;
+    RUN_FMT_TEST(NumberTest::InputLarge);
+
+    c.out << "ParseSmall:" << NL;
+    RUN_PARSE_TEST(NumberTest::InputSmall);
+
+    c.out << "ParseLarge:" << NL;
+    RUN_PARSE_TEST(NumberTest::InputLarge);
+
+    return 0;
+}
+
+#if _MSC_VER
+    #pragma warning(pop)
+#endif
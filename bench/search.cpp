@@ -0,0 +1,149 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/setlist.h>
+#include <evo/maplist.h>
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+struct SearchTest {
+    static const uint SMALL   = 1000;       // items in small set (fits in cache)
+    static const uint LARGE   = 4000000;    // items in large set (doesn't fit in cache)
+    static const uint LOOKUPS = 256;
+
+    static ulong random_key(uint i, uint size)
+        { return (((ulong)i * 2654435761UL) % size) * 2; }
+
+    // Check frozen search results on small sets, including freezing an empty set then changing it
+    static bool verify() {
+        {
+            SetList<String> set;
+            set.freeze();
+            set.add("a");
+            MapList<String,int> map;
+            map.freeze();
+            map["a"] = 1;
+            if (!set.contains("a") || map.find("a") == NULL)
+                return false;
+        }
+        const uint MAX_SIZE = 100;
+        ulong keys[MAX_SIZE * 2 + 2];
+        SetList<ulong>::Size indexes[MAX_SIZE * 2 + 2];
+        for (uint size = 0; size <= MAX_SIZE; ++size) {
+            SetList<ulong> set;
+            for (uint i = 0; i < size; ++i)
+                set.add((ulong)i * 2);
+            set.freeze();
+            const uint key_count = size * 2 + 2;
+            for (uint key = 0; key < key_count; ++key) {
+                keys[key] = key;
+                if (set.contains(key) != (key % 2 == 0 && key < size * 2))
+                    return false;
+            }
+            if (set.find_many(keys, key_count, indexes) != size)
+                return false;
+            for (uint key = 0; key < key_count; ++key)
+                if (indexes[key] != (key % 2 == 0 && key < size * 2 ? key / 2 : END))
+                    return false;
+        }
+        return true;
+    }
+
+    template<uint SIZE, bool FROZEN> struct BM {
+        typedef SetList<ulong> Set;
+
+        static const Set& data() {
+            static Set* data = NULL;
+            if (data == NULL) {
+                data = new Set;
+                data->capacity(SIZE);
+                for (uint i = 0; i < SIZE; ++i)
+                    data->add((ulong)i * 2);
+                if (FROZEN)
+                    data->freeze();
+            }
+            return *data;
+        }
+
+        // Get next batch of random keys, each batch is different so lookups aren't all cached
+        static void next_keys(ulong* keys) {
+            static uint round = 0;
+            ++round;
+            for (uint i = 0; i < LOOKUPS; ++i)
+                keys[i] = random_key(round * LOOKUPS + i, SIZE);
+        }
+
+        // Find random keys one at a time
+        static void contains() {
+            const Set& set = data();
+            ulong keys[LOOKUPS];
+            next_keys(keys);
+            uint found = 0;
+            for (uint i = 0; i < LOOKUPS; ++i)
+                found += (uint)set.contains(keys[i]);
+            if (found != LOOKUPS)
+                abort();
+        }
+
+        // Find random keys in a batch
+        static void find_many() {
+            ulong keys[LOOKUPS];
+            SizeT indexes[LOOKUPS];
+            next_keys(keys);
+            if (data().find_many(keys, LOOKUPS, indexes) != LOOKUPS)
+                abort();
+        }
+    };
+};
+
+int main() {
+    Console& c = con();
+
+    if (!SearchTest::verify()) {
+        c.err << "Frozen search check failed" << NL;
+        return 1;
+    }
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        << " - Small set size        " << SearchTest::SMALL << NL
+        << " - Large set size        " << SearchTest::LARGE << NL
+        << " - Lookups               " << SearchTest::LOOKUPS << NL
+        ;
+
+    c.out << NL;
+
+    typedef SearchTest::BM<SearchTest::SMALL, false> Small;
+    typedef SearchTest::BM<SearchTest::SMALL, true>  SmallFrozen;
+    typedef SearchTest::BM<SearchTest::LARGE, false> Large;
+    typedef SearchTest::BM<SearchTest::LARGE, true>  LargeFrozen;
+
+    c.out << "SmallSet:" << NL;
+    {
+        EVO_BENCH_SETUP(Small::contains, 100);
+        EVO_BENCH_RUN(Small::contains);
+        EVO_BENCH_RUN(SmallFrozen::contains);
+        EVO_BENCH_RUN(SmallFrozen::find_many);
+        bench.report(fmt_type);
+    }
+
+    c.out << "LargeSet:" << NL;
+    {
+        Large::data();
+        LargeFrozen::data();
+        EVO_BENCH_SETUP(Large::contains, 100);
+        EVO_BENCH_RUN(Large::contains);
+        EVO_BENCH_RUN(LargeFrozen::contains);
+        EVO_BENCH_RUN(LargeFrozen::find_many);
+        bench.report(fmt_type);
+    }
+
+    return 0;
+}
@@ -3,6 +3,7 @@
 
 #include <evo/benchmark.h>
 #include <evo/string.h>
+#include <evo/stringsso.h>
 #include <evo/strtok.h>
 #include <string>
 #include <sstream>
@@ -68,6 +69,15 @@ struct SplitTest {
             val.cstr(buf2);
         }
 
+        static void evo_StringSSO_Term() {
+            StringSSO<> in(get_input()), key, val;
+            if (!SubString(in).split('=', key, val))
+                abort();
+            // Make terminated
+            key.cstr();
+            val.cstr();
+        }
+
         static void evo_String() {
             String in(get_input()), key, val;
             if (!in.split('=', key, val))
@@ -326,6 +336,7 @@ int main() {
     c.out << "Sizes:" << NL
         << " - evo str:        " << StrSz::evo_sz << ": " << StrSz::evo_str_sz << " + " << StrSz::evo_hdr_sz << NL
         << " - evo substr:     " << sizeof(SubString) << NL
+        << " - evo str sso:    " << sizeof(StringSSO<>) << " (inline: " << StringSSO<>::INLINE_SIZE << ')' << NL
         << " - stl str:        " << StrSz::stl_sz << ": " << StrSz::stl_str_sz << " + " << StrSz::fmt_hdr_size() << NL
     #if defined(EVO_CPP17)
         << " - stl strview:    " << sizeof(std::string_view) << NL
@@ -341,6 +352,7 @@ int main() {
         EVO_BENCH_SETUP(BM::c, 1000); \
         EVO_BENCH_RUN(BM::evo_String_Term); \
         EVO_BENCH_RUN(BM::evo_SubString_Term); \
+        EVO_BENCH_RUN(BM::evo_StringSSO_Term); \
         EVO_BENCH_RUN(BM::evo_String); \
         EVO_BENCH_RUN(BM::evo_SubString); \
         EVO_BENCH_RUN(BM::stl); \
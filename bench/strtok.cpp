@@ -0,0 +1,146 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/strtok.h>
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+struct StrTokTest {
+    static const uint LINES = 100000;       // lines in test buffer
+    static const uint LONG_INTERVAL = 10;   // every Nth line has a long field, spanning more than one 64 byte block
+
+    static ulong expected_fields;
+    static ulong expected_bytes;
+
+    static const String& data() {
+        static String* data = NULL;
+        if (data == NULL) {
+            data = new String;
+            data->reserve(LINES * 64);
+            expected_fields = expected_bytes = 0;
+            String line;
+            String long_field;
+            long_field.add('x', 150);
+            for (uint i = 0; i < LINES; ++i) {
+                line.set() << i << ",item" << (i * 7919) % 100000 << ',' << (i % 100) << ".25,";
+                if (i % LONG_INTERVAL == 0)
+                    line << long_field;
+                else
+                    line << "ok";
+                line << ",1" << ((i & 1) ? "\r\n" : "\n");
+                *data << line;
+                expected_fields += 5;
+                expected_bytes  += line.size() - ((i & 1) ? 2 : 1) - 4;
+            }
+        }
+        return *data;
+    }
+
+    static void check(ulong fields, ulong bytes) {
+        if (fields != expected_fields || bytes != expected_bytes)
+            abort();
+    }
+
+    // Check StrTokBulk against StrTokLine and StrTok on values at and past block boundaries, return false on mismatch
+    static bool verify() {
+        const char* INPUTS[] = {
+            "a,b\nc",
+            ",\n,\r\n",
+            "  a  ,  b  \n\r c",
+            NULL
+        };
+        List<String> inputs;
+        for (const char** p = INPUTS; *p != NULL; ++p)
+            inputs.add(String(*p));
+        for (uint len = 60; len <= 200; ++len) {
+            String str;
+            str.add('x', len);
+            inputs.add(str);
+            inputs.add(String(str) << ",y");
+            inputs.add(String(str) << "\r\n" << String().add('y', len) << ',' << String().add('z', len));
+        }
+        for (SizeT i = 0; i < inputs.size(); ++i) {
+            List<SubString> expected;
+            StrTokLine lines(inputs[i]);
+            while (lines.next()) {
+                StrTok tok(lines.value());
+                while (tok.next(','))
+                    expected.add(tok.value());
+            }
+
+            SizeT count = 0;
+            StrTokBulk tok(inputs[i], ',');
+            while (tok.next()) {
+                if (count >= expected.size() || tok.value() != expected[count])
+                    return false;
+                ++count;
+            }
+            if (count != expected.size())
+                return false;
+        }
+        return true;
+    }
+
+    // Split lines with StrTokLine, then fields with StrTok
+    static void evo_strtokline() {
+        ulong fields = 0, bytes = 0;
+        StrTokLine lines(data());
+        while (lines.next()) {
+            StrTok tok(lines.value());
+            while (tok.next(',')) {
+                ++fields;
+                bytes += tok.value().size();
+            }
+        }
+        check(fields, bytes);
+    }
+
+    // Split fields and lines together with StrTokBulk
+    static void evo_strtokbulk() {
+        ulong fields = 0, bytes = 0;
+        StrTokBulk tok(data(), ',');
+        while (tok.next()) {
+            ++fields;
+            bytes += tok.value().size();
+        }
+        check(fields, bytes);
+    }
+};
+
+ulong StrTokTest::expected_fields = 0;
+ulong StrTokTest::expected_bytes  = 0;
+
+int main() {
+    Console& c = con();
+
+    if (!StrTokTest::verify()) {
+        c.err << "StrTokBulk check failed" << NL;
+        return 1;
+    }
+    StrTokTest::data();
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        << " - Lines                 " << StrTokTest::LINES << NL
+        << " - Buffer size           " << StrTokTest::data().size() << NL
+        ;
+
+    c.out << NL;
+
+    c.out << "SplitCsv:" << NL;
+    {
+        EVO_BENCH_SETUP(StrTokTest::evo_strtokline, 10);
+        EVO_BENCH_RUN(StrTokTest::evo_strtokline);
+        EVO_BENCH_RUN(StrTokTest::evo_strtokbulk);
+        bench.report(fmt_type);
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Evo C++ Library
+///////////////////////////////////////////////////////////////////////////////
+
+#include <evo/benchmark.h>
+#include <evo/maptree.h>
+#include <evo/maplist.h>
+#include <map>
+using namespace evo;
+
+// Output types: tTEXT or tMARKDOWN
+#if !defined(EVO_BENCH_OUTPUT_TYPE)
+    #define EVO_BENCH_OUTPUT_TYPE tMARKDOWN
+#endif
+
+static const FmtTable::Type fmt_type = FmtTable::EVO_BENCH_OUTPUT_TYPE;
+
+struct TreeTest {
+    static const uint COUNT  = 10000;     // items added per insert test
+    static const uint SIZE   = 100000;    // items in map for lookup and scan tests
+    static const uint WINDOW = 1000;      // items kept by expiry test
+    static const uint LOOKUPS = 64;
+
+    static ulong random_key(uint i)
+        { return ((ulong)i * 2654435761UL) % 1000003UL; }
+
+    // Wrappers so each test is written once for Evo maps and std::map -- expire() and scan() require iter_lower() so aren't used with MapList
+    template<class M> struct EvoMap {
+        M map;
+
+        void add(ulong key, ulong value)
+            { map[key] = value; }
+        ulong find(ulong key) const
+            { const ulong* value = map.find(key); return (value == NULL ? 0 : *value); }
+        void expire(ulong before) {
+            typename M::IterM start(map);
+            typename M::IterM end(map.iter_lowerM(before));
+            map.remove_range(start, end);
+        }
+        ulong scan(ulong key, uint count) const {
+            ulong total = 0;
+            for (typename M::Iter iter(map.iter_lower(key)); iter && count > 0; ++iter, --count)
+                total += iter->second;
+            return total;
+        }
+    };
+
+    struct StdMap {
+        std::map<ulong,ulong> map;
+
+        void add(ulong key, ulong value)
+            { map[key] = value; }
+        ulong find(ulong key) const
+            { std::map<ulong,ulong>::const_iterator iter = map.find(key); return (iter == map.end() ? 0 : iter->second); }
+        void expire(ulong before)
+            { map.erase(map.begin(), map.lower_bound(before)); }
+        ulong scan(ulong key, uint count) const {
+            ulong total = 0;
+            for (std::map<ulong,ulong>::const_iterator iter = map.lower_bound(key); iter != map.end() && count > 0; ++iter, --count)
+                total += iter->second;
+            return total;
+        }
+    };
+
+    template<class T> struct BM {
+        static const T& data() {
+            static T* data = NULL;
+            if (data == NULL) {
+                data = new T;
+                for (uint i = 0; i < SIZE; ++i)
+                    data->add((ulong)i * 10, i);
+            }
+            return *data;
+        }
+
+        // Insert keys in random order into new map
+        static void insert_random() {
+            T map;
+            for (uint i = 0; i < COUNT; ++i)
+                map.add(random_key(i), i);
+        }
+
+        // Insert time-ordered keys, expiring old keys to keep a window of recent keys (expiry index)
+        static void insert_expire() {
+            T map;
+            for (uint i = 0; i < COUNT; ++i) {
+                map.add(i, i);
+                if (i % 100 == 99 && i >= WINDOW)
+                    map.expire(i - WINDOW);
+            }
+        }
+
+        // Find random keys in large map
+        static void lookup() {
+            const T& map = data();
+            ulong total = 0;
+            for (uint i = 0; i < LOOKUPS; ++i)
+                total += map.find((random_key(i) % SIZE) * 10);
+            if (total == 0)
+                abort();
+        }
+
+        // Scan range of items in large map
+        static void scan() {
+            if (data().scan(SIZE * 5, 1000) == 0)
+                abort();
+        }
+    };
+};
+
+int main() {
+    Console& c = con();
+
+    c.out << "Config:" << NL
+        << " - Compiler              " << EVO_COMPILER << ' ' << EVO_COMPILER_VER << NL
+        << " - Insert count          " << TreeTest::COUNT << NL
+        << " - Map size              " << TreeTest::SIZE << NL
+        ;
+
+    c.out << NL;
+
+    typedef TreeTest::BM< TreeTest::EvoMap< MapTree<ulong,ulong> > > MapTree;
+    typedef TreeTest::BM< TreeTest::EvoMap< MapList<ulong,ulong> > > MapList;
+    typedef TreeTest::BM< TreeTest::StdMap > StdMap;
+
+    c.out << "InsertRandom:" << NL;
+    {
+        EVO_BENCH_SETUP(MapList::insert_random, 10);
+        EVO_BENCH_RUN(MapTree::insert_random);
+        EVO_BENCH_RUN(MapList::insert_random);
+        EVO_BENCH_RUN(StdMap::insert_random);
+        bench.report(fmt_type);
+    }
+
+    c.out << "InsertExpire:" << NL;
+    {
+        EVO_BENCH_SETUP(StdMap::insert_expire, 10);
+        EVO_BENCH_RUN(MapTree::insert_expire);
+        EVO_BENCH_RUN(StdMap::insert_expire);
+        bench.report(fmt_type);
+    }
+
+    c.out << "Lookup:" << NL;
+    {
+        EVO_BENCH_SETUP(MapList::lookup, 100);
+        EVO_BENCH_RUN(MapTree::lookup);
+        EVO_BENCH_RUN(MapList::lookup);
+        EVO_BENCH_RUN(StdMap::lookup);
+        bench.report(fmt_type);
+    }
+
+    c.out << "Scan:" << NL;
+    {
+        EVO_BENCH_SETUP(StdMap::scan, 100);
+        EVO_BENCH_RUN(MapTree::scan);
+        EVO_BENCH_RUN(StdMap::scan);
+        bench.report(fmt_type);
+    }
+
+    return 0;
+}
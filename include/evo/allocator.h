@@ -0,0 +1,386 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file allocator.h Evo container allocators. */
+#pragma once
+#ifndef INCL_evo_allocator_h
+#define INCL_evo_allocator_h
+
+#include "impl/container.h"
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Arena allocator that allocates from large blocks with a bump pointer, and frees everything at once.
+ - This is ideal for request-scoped containers: bind to containers used while handling a request, then call reset() when done
+ - Allocating is very fast: usually just a pointer bump in the current block
+ - Freeing individual allocations does nothing, except the most recent allocation is reclaimed (so a growing buffer can often be resized in place)
+ - Allocations larger than 1/4 the block size get a separate block, so they don't waste the rest of the current block
+ - All allocations are aligned to 16 bytes
+ - This is not thread safe, use a separate arena per thread
+ - Requires EVO_ALLOCATORS to be enabled to use with containers
+ - \b Caution: All containers using an arena must be freed (or no longer used) before calling reset() or destroying the arena
+ .
+
+\par Example
+
+\code
+#define EVO_ALLOCATORS 1
+#include <evo/allocator.h>
+#include <evo/string.h>
+using namespace evo;
+
+void handle_request(ArenaAllocator& arena) {
+    {
+        String str;
+        str.set_allocator(&arena);
+        str << "foo" << 123;
+    }
+    arena.reset();  // free everything from request at once
+}
+\endcode
+*/
+class ArenaAllocator : public Allocator {
+public:
+    static const ulong BLOCK_SIZE = 65536;      ///< Default block size in bytes
+
+    /** Constructor.
+     - No memory is allocated until first alloc()
+     .
+     \param  block_size  Block size to use in bytes, minimum of 1 KB used if lower
+    */
+    ArenaAllocator(ulong block_size=BLOCK_SIZE) : block_size_(block_size < MIN_BLOCK_SIZE ? (ulong)MIN_BLOCK_SIZE : block_size), blocks_(NULL), cur_(NULL), last_(NULL), used_(0) {
+    }
+
+    /** Destructor, frees all memory. */
+    ~ArenaAllocator()
+        { clear(); }
+
+    char* alloc(ulong bytes) {
+        const ulong size = align(bytes);
+        char* ptr;
+        if (size + PREFIX > block_size_ / 4) {
+            // Separate block for large allocation, keep using current block
+            Block* block = new_block(size + PREFIX);
+            if (cur_ != NULL) {
+                block->next = cur_->next;
+                cur_->next  = block;
+            } else {
+                block->next = blocks_;
+                blocks_     = block;
+            }
+            block->used = size + PREFIX;
+            ptr = block->data();
+        } else {
+            if (cur_ == NULL || cur_->used + size + PREFIX > cur_->size) {
+                Block* block = new_block(block_size_);
+                block->next = blocks_;
+                blocks_ = cur_ = block;
+            }
+            ptr = cur_->data() + cur_->used;
+            cur_->used += size + PREFIX;
+            last_ = ptr + PREFIX;
+        }
+        *(ulong*)ptr = size;
+        used_ += size;
+        return ptr + PREFIX;
+    }
+
+    char* realloc(void* ptr, ulong bytes) {
+        if (ptr == NULL)
+            return alloc(bytes);
+        ulong& cur_size = *(ulong*)((char*)ptr - PREFIX);
+        if (bytes <= cur_size)
+            return (char*)ptr;
+        const ulong size = align(bytes);
+        if (ptr == last_ && (cur_->used - cur_size) + size <= cur_->size) {
+            // Most recent allocation, grow in place
+            cur_->used += size - cur_size;
+            used_      += size - cur_size;
+            cur_size = size;
+            return (char*)ptr;
+        }
+        char* newptr = alloc(bytes);
+        memcpy(newptr, ptr, cur_size);
+        free(ptr);
+        return newptr;
+    }
+
+    void free(void* ptr) {
+        if (ptr != NULL && ptr == last_) {
+            // Reclaim most recent allocation
+            const ulong size = *(ulong*)((char*)ptr - PREFIX);
+            cur_->used -= size + PREFIX;
+            used_      -= size;
+            last_ = NULL;
+        }
+    }
+
+    /** Free all allocations at once, and keep one block for reuse.
+     - \b Caution: This invalidates all memory allocated from this arena
+    */
+    void reset() {
+        Block* keep = NULL;
+        for (Block* block = blocks_, *next; block != NULL; block = next) {
+            next = block->next;
+            if (keep == NULL && block->size == block_size_)
+                keep = block;
+            else
+                ::free(block);
+        }
+        if (keep != NULL) {
+            keep->next = NULL;
+            keep->used = 0;
+        }
+        blocks_ = cur_ = keep;
+        last_ = NULL;
+        used_ = 0;
+    }
+
+    /** Free all allocations at once, and free all blocks.
+     - \b Caution: This invalidates all memory allocated from this arena
+    */
+    void clear() {
+        for (Block* block = blocks_, *next; block != NULL; block = next) {
+            next = block->next;
+            ::free(block);
+        }
+        blocks_ = cur_ = NULL;
+        last_ = NULL;
+        used_ = 0;
+    }
+
+    /** Get number of bytes currently allocated from this arena.
+     - This includes alignment padding, but not per-allocation or per-block overhead
+     .
+     \return  Bytes used
+    */
+    ulong used() const
+        { return used_; }
+
+    /** Get block size used.
+     \return  Block size in bytes
+    */
+    ulong block_size() const
+        { return block_size_; }
+
+private:
+    // Disable copying
+    ArenaAllocator(const ArenaAllocator&) EVO_ONCPP11(= delete);
+    ArenaAllocator& operator=(const ArenaAllocator&) EVO_ONCPP11(= delete);
+
+    static const ulong ALIGN          = 16;     // allocation alignment
+    static const ulong PREFIX         = 16;     // allocation prefix, stores allocation size, keeps alignment
+    static const ulong MIN_BLOCK_SIZE = 1024;
+
+    struct Block {
+        Block* next;
+        ulong  size;        // data size in bytes
+        ulong  used;        // data used in bytes
+
+        char* data()
+            { return (char*)this + HEADER; }
+    };
+    static const ulong HEADER = (sizeof(Block) + ALIGN - 1) & ~(ALIGN - 1);
+
+    ulong  block_size_;
+    Block* blocks_;         // all blocks, most recent first (except large blocks)
+    Block* cur_;            // current block to allocate from
+    char*  last_;           // most recent allocation from current block, NULL if none or freed
+    ulong  used_;
+
+    static ulong align(ulong bytes)
+        { return (bytes + ALIGN - 1) & ~(ALIGN - 1); }
+
+    static Block* new_block(ulong size) {
+        Block* block = (Block*)::malloc(HEADER + size);
+        assert( block != NULL );
+        block->next = NULL;
+        block->size = size;
+        block->used = 0;
+        return block;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Pool allocator that caches freed memory in free lists with fixed size classes.
+ - Allocations are rounded up to a size class: 16, 32, 64, ... up to 4 KB -- larger allocations use malloc directly
+ - Freed memory is cached in a free list for its size class, and reused by the next allocation of that class
+   - Each free list caches up to a limit, then memory is returned with free()
+   - This avoids most malloc/free calls when small containers are created and destroyed repeatedly
+ - This is not thread safe, use a separate pool per thread and only call a pool from the thread that owns it -- local() gets a thread-local pool (C++11)
+   - Memory allocated on one thread may be freed on another thread only by returning it to the freeing thread's own pool, never to the pool that allocated it
+   - This is safe because each item is a separate malloc() block tagged with its size class, and isn't linked to the pool that allocated it -- so any pool can cache or free it, and malloc() memory may be freed from any thread
+   - Containers free memory to the allocator they were given, so a container using a pool must only be modified and freed on the thread that owns the pool
+ - All allocations are aligned to 16 bytes
+ - Requires EVO_ALLOCATORS to be enabled to use with containers
+ - \b Caution: All containers using a pool must be freed before destroying the pool
+ .
+
+\par Example
+
+\code
+#define EVO_ALLOCATORS 1
+#include <evo/allocator.h>
+#include <evo/string.h>
+using namespace evo;
+
+int main() {
+    PoolAllocator pool;
+    for (int i = 0; i < 1000; ++i) {
+        String str;
+        str.set_allocator(&pool);
+        str << "foo" << i;          // reuses memory freed by previous iteration
+    }
+    return 0;
+}
+\endcode
+*/
+class PoolAllocator : public Allocator {
+public:
+    static const uint  CLASS_COUNT = 9;         ///< Number of size classes
+    static const ulong CLASS_MIN   = 16;        ///< Smallest size class in bytes
+    static const ulong CLASS_MAX   = 4096;      ///< Largest size class in bytes, larger allocations aren't pooled
+    static const uint  MAX_CACHED  = 256;       ///< Default max free items cached per size class
+
+    /** Constructor.
+     \param  max_cached  Max free items to cache per size class
+    */
+    PoolAllocator(uint max_cached=MAX_CACHED) : max_cached_(max_cached) {
+        for (uint i = 0; i < CLASS_COUNT; ++i) {
+            free_[i]  = NULL;
+            count_[i] = 0;
+        }
+    }
+
+    /** Destructor, frees all cached memory. */
+    ~PoolAllocator()
+        { clear(); }
+
+    char* alloc(ulong bytes) {
+        char* ptr;
+        if (bytes > CLASS_MAX) {
+            ptr = (char*)::malloc(PREFIX + bytes);
+            assert( ptr != NULL );
+            *(uint*)ptr = LARGE;
+        } else {
+            const uint cls = get_class(bytes);
+            FreeItem* item = free_[cls];
+            if (item != NULL) {
+                free_[cls] = item->next;
+                --count_[cls];
+                ptr = (char*)item;
+            } else {
+                ptr = (char*)::malloc(PREFIX + (CLASS_MIN << cls));
+                assert( ptr != NULL );
+            }
+            *(uint*)ptr = cls;
+        }
+        return ptr + PREFIX;
+    }
+
+    char* realloc(void* ptr, ulong bytes) {
+        if (ptr == NULL)
+            return alloc(bytes);
+        char* const base = (char*)ptr - PREFIX;
+        const uint cls = *(uint*)base;
+        if (cls == LARGE) {
+            if (bytes > CLASS_MAX) {
+                char* newbase = (char*)::realloc(base, PREFIX + bytes);
+                assert( newbase != NULL );
+                return newbase + PREFIX;
+            }
+        } else {
+            const ulong cur_size = (CLASS_MIN << cls);
+            if (bytes <= cur_size)
+                return (char*)ptr;
+        }
+        char* newptr = alloc(bytes);
+        memcpy(newptr, ptr, (cls == LARGE ? bytes : (size_t)(CLASS_MIN << cls)));
+        free(ptr);
+        return newptr;
+    }
+
+    void free(void* ptr) {
+        if (ptr != NULL) {
+            char* const base = (char*)ptr - PREFIX;
+            const uint cls = *(uint*)base;
+            if (cls != LARGE && count_[cls] < max_cached_) {
+                FreeItem* item = (FreeItem*)base;
+                item->next = free_[cls];
+                free_[cls] = item;
+                ++count_[cls];
+            } else
+                ::free(base);
+        }
+    }
+
+    /** Free all cached memory. */
+    void clear() {
+        for (uint i = 0; i < CLASS_COUNT; ++i) {
+            for (FreeItem* item = free_[i], *next; item != NULL; item = next) {
+                next = item->next;
+                ::free(item);
+            }
+            free_[i]  = NULL;
+            count_[i] = 0;
+        }
+    }
+
+    /** Get number of free items currently cached.
+     \return  Cached item count
+    */
+    ulong cached() const {
+        ulong count = 0;
+        for (uint i = 0; i < CLASS_COUNT; ++i)
+            count += count_[i];
+        return count;
+    }
+
+#if defined(EVO_CPP11) || defined(DOXYGEN)
+    /** Get pool for current thread (C++11).
+     - Each thread gets its own pool, created on first use and destroyed when thread exits
+     - Containers using this must be freed before the thread exits
+     .
+     \return  Thread-local pool
+    */
+    static PoolAllocator& local() {
+        static thread_local PoolAllocator pool;
+        return pool;
+    }
+#endif
+
+private:
+    // Disable copying
+    PoolAllocator(const PoolAllocator&) EVO_ONCPP11(= delete);
+    PoolAllocator& operator=(const PoolAllocator&) EVO_ONCPP11(= delete);
+
+    static const ulong PREFIX = 16;             // allocation prefix, stores size class, keeps alignment
+    static const uint  LARGE  = CLASS_COUNT;    // size class for large allocations, not pooled
+
+    struct FreeItem {
+        FreeItem* next;
+    };
+
+    FreeItem* free_[CLASS_COUNT];
+    uint      count_[CLASS_COUNT];
+    uint      max_cached_;
+
+    static uint get_class(ulong bytes) {
+        uint cls = 0;
+        for (ulong size = CLASS_MIN; size < bytes; size <<= 1)
+            ++cls;
+        return cls;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
@@ -5,3 +5,5 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 ///////////////////////////////////////////////////////////////////////////////
 #include "memcached_server.h"
 #include "memcached_client.h"
+#include "memcached_store.h"
+#include "memcached_client_pool.h"
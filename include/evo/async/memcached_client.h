@@ -32,7 +32,8 @@ namespace impl_memc {
             tDELETE,
             tTOUCH,
             tGET,
-            tGET_CAS
+            tGET_CAS,
+            tMETA_GET
         };
 
         Type   type;
@@ -149,6 +150,7 @@ public:
     static const SizeT  DEFAULT_QUEUE_SIZE = 256;
     static const size_t DEFAULT_MAX_READ   = 524288;  // 512 KB
     static const size_t MIN_INITIAL_READ   = 0;
+    static const StrSizeT DEFAULT_MAX_LINE = 2048;    ///< Default max request line size for get_multi()
 
     typedef AsyncClient<MemcachedClient, impl_memc::ClientQueueItem> Base;
     using Base::OnConnect;
@@ -232,7 +234,19 @@ public:
      \param  max_read_size   Max read buffer size, 0 for unlimited -- this is used to limit the read buffer size
     */
     MemcachedClient(SizeT max_queue_size=DEFAULT_QUEUE_SIZE, SizeT max_read_size=DEFAULT_MAX_READ) :
-        AsyncClient<MemcachedClient, impl_memc::ClientQueueItem>(max_queue_size, max_read_size), cur_type_(QueueItem::tNONE) {
+        AsyncClient<MemcachedClient, impl_memc::ClientQueueItem>(max_queue_size, max_read_size), cur_type_(QueueItem::tNONE), max_line_size_(DEFAULT_MAX_LINE) {
+    }
+
+    /** %Set max request line size for get_multi() requests.
+     - Keys are split into multiple request lines as needed so each line fits in this size
+     - This should not be larger than the max line size supported by the server
+     .
+     \param  size  Max line size in bytes, including newline
+     \return       This
+    */
+    MemcachedClient& set_max_line(StrSizeT size=DEFAULT_MAX_LINE) {
+        max_line_size_ = size;
+        return *this;
     }
 
     /** Send a request to set a key and value.
@@ -810,6 +824,94 @@ public:
         return get_cas(key, on_get, on_error, track_notfound, &expire);
     }
 
+    /** Send a batched request to get values for a list of keys.
+     - Keys are combined into as few request lines as possible, each line fits in the max line size -- see set_max_line()
+       - All request lines are written together, so the whole batch goes out in one write and is pipelined
+     - OnGet::on_get() is called for each key found, then OnGet::on_get_end() is called once after all lines are done
+     - The server only sends back responses for keys that were found, so noting which keys weren't found (cache misses) requires some overhead:
+       - Use `track_notfound` to have the client build a list of keys not found, which is passed to OnGet::on_get_end()
+     .
+     \param  keys            Keys to get, each key must not have any spaces
+     \param  on_get          OnGet handler to receive response events
+     \param  on_error        OnError handler to use for unexpected errors (not used for normal fail response), NULL for none
+     \param  track_notfound  Whether to track keys not found (i.e. cache misses), true to enable logic that builds a list of keys not found (passed to OnGet::on_get_end()) -- this adds some overhead
+     \param  expire          Pointer to expiration time used to "touch" while getting the value by updating the expiration time, NULL to disable this
+                              - Expiration time is in seconds from now, 0 for no expiration, negative to expire now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
+                              - See calc_expire_time() helper
+     \return                 Whether successful, false if `keys` is empty or unable to send request due to internal error (usually means not connected and no connection in progress)
+    */
+    bool get_multi(const ListBase<SubString>& keys, OnGet& on_get, OnError* on_error=NULL, bool track_notfound=false, int64* expire=NULL) {
+        return get_multi_request(QueueItem::tGET, keys, on_get, on_error, track_notfound, expire);
+    }
+
+    /** Send a batched request to get values for a list of keys for Compare-And-Swap.
+     - Same as get_multi() except OnGet::on_get_cas() is called for each key found -- see get_cas()
+     .
+     \param  keys            Keys to get, each key must not have any spaces
+     \param  on_get          OnGet handler to receive response events
+     \param  on_error        OnError handler to use for unexpected errors (not used for normal fail response), NULL for none
+     \param  track_notfound  Whether to track keys not found (i.e. cache misses), true to enable logic that builds a list of keys not found (passed to OnGet::on_get_end()) -- this adds some overhead
+     \param  expire          Pointer to expiration time used to "touch" while getting the value by updating the expiration time, NULL to disable this
+                              - See calc_expire_time() helper
+     \return                 Whether successful, false if `keys` is empty or unable to send request due to internal error (usually means not connected and no connection in progress)
+    */
+    bool get_multi_cas(const ListBase<SubString>& keys, OnGet& on_get, OnError* on_error=NULL, bool track_notfound=false, int64* expire=NULL) {
+        return get_multi_request(QueueItem::tGET_CAS, keys, on_get, on_error, track_notfound, expire);
+    }
+
+    /** Send a request to get value for a single key using the meta protocol (`mg` command).
+     - This requires a server that supports meta commands
+     - Unlike get(), the server sends an explicit miss response, so a key not found is always passed to OnGet::on_get_end() without tracking overhead
+     - A hit calls OnGet::on_get(), or OnGet::on_get_cas() if `cas` is true, then OnGet::on_get_end() with an empty string
+     .
+     \param  key       Key to get, must be a single key
+     \param  on_get    OnGet handler to receive response events
+     \param  on_error  OnError handler to use for unexpected errors (not used for normal fail response), NULL for none
+     \param  cas       Whether to get a `cas_id` for Compare-And-Swap, true to call OnGet::on_get_cas() instead of OnGet::on_get()
+     \param  expire    Pointer to expiration time used to "touch" while getting the value by updating the expiration time, NULL to disable this
+                         - Expiration time is in seconds from now, 0 for no expiration, negative to expire now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
+     \return           Whether successful, false if unable to send request due to internal error (usually means not connected and no connection in progress)
+    */
+    bool get_meta(const SubString& key, OnGet& on_get, OnError* on_error=NULL, bool cas=false, int64* expire=NULL) {
+        if (get_state() == sNONE)
+            return false;
+
+        StringInt<int64> expire_str;
+        StrSizeT buf_size = 7 + key.size() + NEWLINE_LEN;
+        if (cas)
+            buf_size += 2;
+        if (expire != NULL) {
+            expire_str.set(*expire);
+            buf_size += 2 + expire_str.size();
+        }
+
+        RequestWriter writer(*this, buf_size);
+        if (writer.error())
+            return false;
+        SubString msg_str(writer.ptr(), buf_size - NEWLINE_LEN);
+        writer.add("mg ", 3);
+        writer.add(key.data(), key.size());
+        writer.add(" v f", 4);
+        if (cas)
+            writer.add(" c", 2);
+        if (expire != NULL) {
+            writer.add(" T", 2);
+            writer.add(expire_str.data(), expire_str.size());
+        }
+        writer.add("\r\n", NEWLINE_LEN);
+        if (logger.check(LOG_LEVEL_DEBUG))
+            logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(22 + msg_str.size()) << "MemcClient " << get_id() << ' ' << msg_str);
+
+        QueueItem& item = writer.pq.item;
+        item.type     = QueueItem::tMETA_GET;
+        item.on_reply = (void*)&on_get;
+        item.on_error = on_error;
+        item.data     = key;
+        item.data_num = (cas ? 1 : 0);
+        item.track_notfound = false;
+        return true;
+    }
+
     /** Calculate memcached expiration time for given number of seconds from now.
      - This returns an expiration value understood by memcached servers: number of seconds from now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
      .
@@ -839,21 +941,22 @@ private:
         typedef Pair<SubString,bool> KeyFlagPair;
         typedef List<KeyFlagPair> KeyFlags;
 
-        SubString key;
+        String   key;
         uint32   flags;
         ulong    size;
         uint64   cas_id;
         KeyFlags key_flags; // Flags for keys received -- used with track_notfound
+        SizeT    key_pos;   // Position in key_flags to search next -- keys are usually received in request order
 
-        ValueParams() : flags(0), size(0), cas_id(0) {
+        ValueParams() : flags(0), size(0), cas_id(0), key_pos(0) {
         }
 
+        // Clear value params, key_flags are kept until next request
         ValueParams& clear() {
             key.set();
             flags  = 0;
             size   = 0;
             cas_id = 0;
-            key_flags.set();
             return *this;
         }
 
@@ -871,6 +974,7 @@ private:
 
         void init_key_flags(const SubString& data) {
             key_flags.clear();
+            key_pos = 0;
             StrTok tok(data);
             while (tok.nextw(' '))
                 key_flags.add(KeyFlagPair(tok.value(), false));
@@ -878,13 +982,19 @@ private:
 
         void no_key_flags() {
             key_flags.set();
+            key_pos = 0;
         }
 
         void set_key_flag() {
-            for (KeyFlags::IterM iter(key_flags); iter; ++iter) {
-                KeyFlagPair& item(*iter);
-                if (item.first == key && !item.second) {
+            // Search from last position first, then wrap around
+            const SizeT count = key_flags.size();
+            for (SizeT i = 0, pos = key_pos; i < count; ++i, ++pos) {
+                if (pos >= count)
+                    pos = 0;
+                KeyFlagPair& item(key_flags(pos));
+                if (!item.second && item.first == key) {
                     item.second = true;
+                    key_pos = pos + 1;
                     break;
                 }
             }
@@ -894,10 +1004,82 @@ private:
     QueueItem::Type cur_type_;
     QueueItem cur_item_;
     ValueParams value_params_;
+    StrSizeT max_line_size_;
 
     friend class AsyncClient<MemcachedClient, QueueItem>;
     friend class evo::AsyncBuffers;
 
+    bool get_multi_request(QueueItem::Type type, const ListBase<SubString>& keys, OnGet& on_get, OnError* on_error, bool track_notfound, int64* expire) {
+        if (get_state() == sNONE || keys.size_ == 0)
+            return false;
+
+        SubString cmd;
+        if (expire != NULL)
+            cmd.set(type == QueueItem::tGET_CAS ? "gats" : "gat");
+        else
+            cmd.set(type == QueueItem::tGET_CAS ? "gets" : "get");
+        StringInt<int64> expire_str;
+        StrSizeT line_start_size = cmd.size() + NEWLINE_LEN;
+        if (expire != NULL) {
+            expire_str.set(*expire);
+            line_start_size += 1 + expire_str.size();
+        }
+
+        // Calculate request size and line count, splitting lines at max line size
+        SizeT    lines    = 1;
+        StrSizeT buf_size = line_start_size;
+        for (StrSizeT i = 0, line_size = line_start_size; i < keys.size_; ++i) {
+            const StrSizeT key_size = 1 + keys.data_[i].size();
+            if (line_size > line_start_size && line_size + key_size > max_line_size_) {
+                ++lines;
+                buf_size += line_start_size;
+                line_size = line_start_size;
+            }
+            line_size += key_size;
+            buf_size  += key_size;
+        }
+
+        RequestWriter writer(*this, buf_size);
+        if (writer.error())
+            return false;
+        String keys_str;
+        if (track_notfound)
+            keys_str.reserve(buf_size);
+        for (StrSizeT i = 0, line_size = 0; i < keys.size_; ++i) {
+            const SubString& key = keys.data_[i];
+            const StrSizeT key_size = 1 + key.size();
+            if (line_size > line_start_size && line_size + key_size > max_line_size_) {
+                writer.add("\r\n", NEWLINE_LEN);
+                line_size = 0;
+            }
+            if (line_size == 0) {
+                writer.add(cmd.data(), cmd.size());
+                if (expire != NULL) {
+                    writer.add(" ", 1);
+                    writer.add(expire_str.data(), expire_str.size());
+                }
+                line_size = line_start_size;
+            }
+            writer.add(" ", 1);
+            writer.add(key.data(), key.size());
+            line_size += key_size;
+            if (track_notfound)
+                keys_str.addsep(' ').add(key);
+        }
+        writer.add("\r\n", NEWLINE_LEN);
+        if (logger.check(LOG_LEVEL_DEBUG))
+            logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(64) << "MemcClient " << get_id() << ' ' << cmd << " (multi) " << keys.size_ << " keys in " << lines << " lines");
+
+        QueueItem& item = writer.pq.item;
+        item.type     = type;
+        item.on_reply = (void*)&on_get;
+        item.on_error = on_error;
+        item.data_num = lines;
+        item.track_notfound = track_notfound;
+        swap(item.data, keys_str);
+        return true;
+    }
+
     void on_connect() {
         cur_type_ = QueueItem::tNONE;
     }
@@ -912,6 +1094,11 @@ private:
     void on_close() {
     }
 
+    // Also active while reading a response already popped from the queue, like remaining lines from a multi-key get -- cur_type_ is left set on close so on_error() can notify
+    bool check_client_active() {
+        return ((cur_type_ != QueueItem::tNONE && get_state() != sNONE) || Base::check_client_active());
+    }
+
     bool on_read_fixed(SizeT& next_size, SubString& data, void* context) {
         EVO_PARAM_UNUSED(next_size);
         EVO_PARAM_UNUSED(context);
@@ -929,6 +1116,19 @@ private:
                     logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(34 + value_params_.key.size()) << "MemcClient " << get_id() << " on_get '" << value_params_.key << '\'');
                 ((OnGet*)cur_item_.on_reply)->on_get(value_params_.key, data, value_params_.flags);
                 break;
+            case QueueItem::tMETA_GET: {
+                // Meta get response is complete after value
+                cur_type_ = QueueItem::tNONE;
+                if (logger.check(LOG_LEVEL_DEBUG))
+                    logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(40 + value_params_.key.size()) << "MemcClient " << get_id() << " on_get (meta) '" << value_params_.key << '\'');
+                OnGet* on_get = (OnGet*)cur_item_.on_reply;
+                if (*cur_item_.data_num != 0)
+                    on_get->on_get_cas(value_params_.key, data, value_params_.flags, value_params_.cas_id);
+                else
+                    on_get->on_get(value_params_.key, data, value_params_.flags);
+                on_get->on_get_end(SubString());
+                break;
+            }
             default:
                 assert( false ); // shouldn't happen
                 break;
@@ -966,14 +1166,20 @@ private:
                 if (reply_str == STR_VALUE) {
                     value_params_.clear().parse(params_str);
                     value_params_.set_key_flag();
+                    value_params_.key.unshare(); // copy key, line is flushed from read buffer before value is read
                     buffers.read_flush();
                     if (!buffers.read_fixed_helper(*this, fixed_size, value_params_.size + NEWLINE_LEN, 0, context))
                         return false;
                     if (fixed_size > 0)
                         return true;
                 } else if (reply_str == STR_END) {
-                    cur_type_ = QueueItem::tNONE;
                     buffers.read_flush();
+                    if (*cur_item_.data_num > 1) {
+                        // More lines pending from get_multi()
+                        --*cur_item_.data_num;
+                        continue;
+                    }
+                    cur_type_ = QueueItem::tNONE;
                     if (cur_item_.track_notfound) {
                         String keys_notfound;
                         for (ValueParams::KeyFlags::Iter iter(value_params_.key_flags); iter; ++iter) {
@@ -1074,6 +1280,7 @@ private:
                             value_params_.no_key_flags();
                         value_params_.parse(params_str);
                         value_params_.set_key_flag();
+                        value_params_.key.unshare(); // copy key, line is flushed from read buffer before value is read
                         buffers.read_flush();
                         if (!buffers.read_fixed_helper(*this, fixed_size, value_params_.size + NEWLINE_LEN, 0, context))
                             return false;
@@ -1081,8 +1288,18 @@ private:
                             return true;
                         continue;   // next line
                     } else if (reply_str == STR_END) {
-                        // No keys found
                         assert( cur_type_ == QueueItem::tNONE );
+                        if (*cur_item_.data_num > 1) {
+                            // No keys found on first line, more lines pending from get_multi()
+                            cur_type_ = cur_item_.type;
+                            if (cur_item_.track_notfound)
+                                value_params_.init_key_flags(cur_item_.data);
+                            else
+                                value_params_.no_key_flags();
+                            --*cur_item_.data_num;
+                            break;
+                        }
+                        // No keys found
                         if (cur_item_.on_reply != NULL) {
                             if (cur_item_.track_notfound) {
                                 if (logger.check(LOG_LEVEL_DEBUG_LOW))
@@ -1098,6 +1315,39 @@ private:
                     break;
                 }
 
+                case QueueItem::tMETA_GET: {
+                    const SubString STR_META_VALUE("VA", 2);
+                    const SubString STR_META_MISS("EN", 2);
+                    if (reply_str == STR_META_VALUE) {
+                        // VA <size> f<flags> [c<cas>]
+                        cur_type_ = cur_item_.type;
+                        value_params_.clear();
+                        value_params_.key = cur_item_.data;
+                        StrTokWord tok(params_str);
+                        if (tok.nextw(DELIM))
+                            value_params_.size = tok.value().getnum<ulong>(fDEC);
+                        while (tok.nextw(DELIM)) {
+                            const SubString flag_value(tok.value().data() + 1, tok.value().size() - 1);
+                            switch (tok.value().data()[0]) {
+                                case 'f': value_params_.flags  = flag_value.getnum<uint32>(fDEC); break;
+                                case 'c': value_params_.cas_id = flag_value.getnum<uint64>(fDEC); break;
+                                default:  break;
+                            }
+                        }
+                        buffers.read_flush();
+                        if (!buffers.read_fixed_helper(*this, fixed_size, value_params_.size + NEWLINE_LEN, 0, context))
+                            return false;
+                        if (fixed_size > 0)
+                            return true;
+                        continue;   // next line
+                    } else if (reply_str == STR_META_MISS) {
+                        if (logger.check(LOG_LEVEL_DEBUG_LOW))
+                            logger.log_direct(LOG_LEVEL_DEBUG_LOW, logstr.set().reserve(48) << "MemcClient " << get_id() << " on_get_end (meta), not found");
+                        ((OnGet*)cur_item_.on_reply)->on_get_end(cur_item_.data);
+                    } else EVO_HELPER_RESPONSE_ERROR_CHECKS("META GET");
+                    break;
+                }
+
                 default:
                     if (logger.check(LOG_LEVEL_ERROR))
                         logger.log_direct(LOG_LEVEL_ERROR, logstr.set().reserve(52) << "MemcClient internal error: Bad queue item type: " << (int)cur_item_.type);
@@ -0,0 +1,677 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file memcached_client_pool.h Evo Async Memached API, client pool class. */
+#pragma once
+#ifndef INCL_evo_api_memcached_client_pool_h
+#define INCL_evo_api_memcached_client_pool_h
+
+#include "memcached_client.h"
+#include "../setlist.h"
+#include "../impl/hash.h"
+
+namespace evo {
+namespace async {
+/** \addtogroup EvoAsyncAPI */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** %Memcached client pool that spreads keys across multiple servers (nodes) with consistent hashing.
+ - Each node has its own MemcachedClient connection, and all clients share one event-loop
+   - By default the pool owns the event-loop, use runlocal() to run it -- or use attach_to() to use the event-loop from an AsyncServer or another client
+   - Requests to each client are pipelined: requests are written without waiting for previous responses
+ - Keys are mapped to nodes with a ketama style consistent hash ring: each node gets 160 points on the ring (per weight unit) and a key maps to the next node point on the ring
+   - Adding or removing a node only remaps the keys near that node's points, most keys stay on the same node
+ - A multi-key get() is split by node and sent to all nodes in parallel, and the response events are merged into a single OnGet handler
+   - Keys for each node are sent with MemcachedClient::get_multi(), which splits long requests into multiple lines
+   - OnGet::on_get_end() is called once, after all nodes are done
+ - A node with an error (connection error, timeout, protocol error) is marked as down, and keys for that node go to the next node on the ring while down
+   - Pending get requests for a failed node are finished right away: keys not received are reported as not found, so one slow or failed node doesn't stall the whole get
+   - Use set_timeout() to limit how long a slow node can take before it's considered failed
+   - A down node is reconnected after a backoff time, which doubles on each failed reconnect up to a max -- see set_backoff()
+   - Reconnects are checked when routing requests, and a node is used again once connected
+ - Single key requests are sent to the client for that key -- see get_client()
+ - This is not thread safe, all methods and events must be called from the event-loop thread
+ .
+
+\par Example
+
+\code
+#include <evo/async/memcached_client_pool.h>
+#include <evo/io.h>
+using namespace evo;
+
+struct OnGet : async::MemcachedClient::OnGet {
+    void on_get(const SubString& key, const SubString& value, uint32 flags) {
+        con().out << "on_get: " << key << " = " << value << NL;
+    }
+    void on_get_end(const SubString& keys_notfound) {
+        con().out << "on_get_end, notfound: " << keys_notfound << NL;
+    }
+};
+
+int main() {
+    Socket::sysinit();
+
+    async::MemcachedClientPool pool;
+    pool.add_node("127.0.0.1", 11211);
+    pool.add_node("127.0.0.1", 11212);
+    pool.set_timeout(1000, 1000);
+    pool.connect();
+
+    pool.set("key1", "value1");
+    pool.set("key2", "value2");
+
+    OnGet on_get;
+    pool.get("key1 key2 key3", on_get, NULL, true);
+    pool.runlocal();
+
+    return 0;
+}
+\endcode
+*/
+class MemcachedClientPool {
+public:
+    typedef MemcachedClient Client;             ///< Client type
+    typedef Client::OnError     OnError;        ///< Alias for Client::OnError
+    typedef Client::OnStore     OnStore;        ///< Alias for Client::OnStore
+    typedef Client::OnIncrement OnIncrement;    ///< Alias for Client::OnIncrement
+    typedef Client::OnRemove    OnRemove;       ///< Alias for Client::OnRemove
+    typedef Client::OnTouch     OnTouch;        ///< Alias for Client::OnTouch
+    typedef Client::OnGet       OnGet;          ///< Alias for Client::OnGet
+
+    static const uint  POINTS_PER_WEIGHT  = 160;    ///< Number of hash ring points per node weight unit
+    static const ulong DEFAULT_BACKOFF_MIN = 100;   ///< Default min reconnect backoff in milliseconds
+    static const ulong DEFAULT_BACKOFF_MAX = 30000; ///< Default max reconnect backoff in milliseconds
+
+    LoggerPtr<> logger; ///< Logger for pool events and errors -- see set_logger()
+
+    /** Constructor.
+     \param  max_queue_size  Max size for pending response queue, per client
+     \param  max_read_size   Max read buffer size per client, 0 for unlimited
+    */
+    MemcachedClientPool(SizeT max_queue_size=Client::DEFAULT_QUEUE_SIZE, SizeT max_read_size=Client::DEFAULT_MAX_READ) :
+        parent_(NULL), max_queue_size_(max_queue_size), max_read_size_(max_read_size), read_timeout_ms_(0), write_timeout_ms_(0),
+        backoff_min_ms_(DEFAULT_BACKOFF_MIN), backoff_max_ms_(DEFAULT_BACKOFF_MAX), down_count_(0) {
+    }
+
+    /** Destructor, closes all connections. */
+    ~MemcachedClientPool() {
+        close();
+        for (SizeT i = nodes_.size(); i > 0; )
+            delete nodes_[--i];
+    }
+
+    /** Attach to a parent AsyncClient or AsyncServer and use the same event-loop as the parent.
+     - This must be called _before_ add_node(), otherwise this is ignored
+     - When attached, the parent runs the event-loop and runlocal() can't be used here
+     .
+     \param  parent  Parent to attach to
+     \return         This
+    */
+    MemcachedClientPool& attach_to(AsyncBase& parent) {
+        if (nodes_.size() == 0)
+            parent_ = &parent;
+        return *this;
+    }
+
+    /** %Set logger to use for pool and all clients.
+     \param  newlogger  Pointer to logger to set, NULL for none (no logging)
+    */
+    void set_logger(LoggerBase* newlogger) {
+        logger.ptr = newlogger;
+        for (SizeT i = 0; i < nodes_.size(); ++i)
+            nodes_[i]->client.set_logger(newlogger);
+    }
+
+    /** %Set read/write timeouts to use for all clients.
+     - This must be called before connect() to take effect
+     - A timeout while waiting for a response marks the node as down
+     .
+     \param  read_timeout_ms   Socket read timeout in milliseconds, 0 for none (never timeout)
+     \param  write_timeout_ms  Socket write timeout in milliseconds, 0 for none (never timeout)
+    */
+    void set_timeout(ulong read_timeout_ms=0, ulong write_timeout_ms=0) {
+        read_timeout_ms_  = read_timeout_ms;
+        write_timeout_ms_ = write_timeout_ms;
+        for (SizeT i = 0; i < nodes_.size(); ++i)
+            nodes_[i]->client.set_timeout(read_timeout_ms, write_timeout_ms);
+    }
+
+    /** %Set reconnect backoff times for down nodes.
+     - After a node goes down, reconnect is tried after `min_ms`, and the wait doubles after each failed reconnect up to `max_ms`
+     .
+     \param  min_ms  Min (first) backoff time in milliseconds
+     \param  max_ms  Max backoff time in milliseconds
+    */
+    void set_backoff(ulong min_ms=DEFAULT_BACKOFF_MIN, ulong max_ms=DEFAULT_BACKOFF_MAX) {
+        backoff_min_ms_ = min_ms;
+        backoff_max_ms_ = (max_ms < min_ms ? min_ms : max_ms);
+    }
+
+    /** Add server node to pool.
+     - This adds points for the node to the hash ring, which remaps some keys to the new node
+     - Call connect() to connect all nodes
+     .
+     \param  host    Server host address
+     \param  port    Server port
+     \param  weight  Node weight, higher gets more keys relative to other nodes -- 0 is treated as 1
+     \return         New node index
+    */
+    SizeT add_node(const char* host, ushort port, uint weight=1) {
+        const SizeT index = nodes_.size();
+        Node* node = new Node(*this, host, port, (weight == 0 ? 1 : weight));
+        if (parent_ != NULL)
+            node->client.attach_to(*parent_);
+        else
+            node->client.attach_to(base_);
+        node->client.set_logger(logger.ptr);
+        node->client.set_timeout(read_timeout_ms_, write_timeout_ms_);
+        nodes_.add(node);
+        add_ring_points(index);
+        return index;
+    }
+
+    /** Get number of nodes in pool.
+     \return  Node count
+    */
+    SizeT get_node_count() const {
+        return nodes_.size();
+    }
+
+    /** Get whether node is up.
+     \param  index  Node index, from add_node()
+     \return        Whether node is up, false if down or index is invalid
+    */
+    bool is_node_up(SizeT index) const {
+        return (index < nodes_.size() && nodes_[index]->up);
+    }
+
+    /** Get client for node.
+     \param  index  Node index, from add_node() -- must be valid
+     \return        Client for node
+    */
+    Client& get_node_client(SizeT index) {
+        assert( index < nodes_.size() );
+        return nodes_[index]->client;
+    }
+
+    /** Start connecting all nodes.
+     - This is non-blocking and returns immediately while connecting, requests may be sent while connecting
+     - A node that fails to start connecting is marked as down
+     .
+     \return  Whether successful, false if no nodes are connecting
+    */
+    bool connect() {
+        bool result = false;
+        for (SizeT i = 0; i < nodes_.size(); ++i) {
+            Node& node = *nodes_[i];
+            if (node.client.get_state() != Client::sNONE || node.connect())
+                result = true;
+        }
+        return result;
+    }
+
+    /** Close all connections.
+     - Pending get() requests are finished with OnError::on_error() (aeCLOSED) and OnGet::on_get_end()
+     - Call connect() to connect again
+     - This must not be called from an event handler
+    */
+    void close() {
+        for (SizeT i = 0; i < nodes_.size(); ++i) {
+            Node& node = *nodes_[i];
+            node.client.close();
+            node.fail_parts(aeCLOSED);
+            if (!node.up) {
+                node.up = true;
+                --down_count_;
+            }
+            node.backoff_ms = 0;
+        }
+    }
+
+    /** Run the event-loop locally in current thread until all pending requests are handled.
+     - This blocks while client requests are pending
+     - This returns false immediately if attached to a parent, or if no nodes were added
+     .
+     \return  Whether successful, false if attached to a parent or on internal error
+    */
+    bool runlocal() {
+        if (parent_ != NULL || nodes_.size() == 0)
+            return false;
+        return base_.runlocal();
+    }
+
+    /** Get client to use for given key.
+     - This routes the key to a node with the hash ring, skipping nodes that are down
+     - Use this to send single key requests not covered by pool methods
+     .
+     \param  key  Key to get client for
+     \return      Client pointer, NULL if no nodes are available
+    */
+    Client* get_client(const SubString& key) {
+        Node* node = route(key);
+        return (node == NULL ? NULL : &node->client);
+    }
+
+    /** Send a request to set a key and value, routed to node for key.
+     - See Client::set()
+     .
+     \param  key       Key to store under -- must not have any spaces
+     \param  value     New value to store
+     \param  flags     User defined flags to store under key, 0 for none
+     \param  expire    Expiration time in seconds from now, 0 for no expiration -- see Client::set()
+     \param  cas_id    Pointer to Compare-And-Swap ID returned from get_cas() request, NULL if not doing Compare-And-Swap
+     \param  on_store  OnStore handler to receive response event, NULL for none
+     \param  on_error  OnError handler to use for unexpected errors, NULL for none -- ignored if `on_store=NULL`
+     \return           Whether successful, false if no nodes are available or unable to send request
+    */
+    bool set(const SubString& key, const SubString& value, uint32 flags=0, int64 expire=0, uint64* cas_id=NULL, OnStore* on_store=NULL, OnError* on_error=NULL) {
+        Client* client = get_client(key);
+        return (client != NULL && client->set(key, value, flags, expire, cas_id, on_store, on_error));
+    }
+
+    /** Send a request to add a new key and value, routed to node for key.
+     - See Client::set_add()
+     .
+     \param  key       Key to store under -- must not have any spaces
+     \param  value     New value to store
+     \param  flags     User defined flags to store under key, 0 for none
+     \param  expire    Expiration time in seconds from now, 0 for no expiration -- see Client::set()
+     \param  on_store  OnStore handler to receive response event, NULL for none
+     \param  on_error  OnError handler to use for unexpected errors, NULL for none -- ignored if `on_store=NULL`
+     \return           Whether successful, false if no nodes are available or unable to send request
+    */
+    bool set_add(const SubString& key, const SubString& value, uint32 flags=0, int64 expire=0, OnStore* on_store=NULL, OnError* on_error=NULL) {
+        Client* client = get_client(key);
+        return (client != NULL && client->set_add(key, value, flags, expire, on_store, on_error));
+    }
+
+    /** Send a request to replace an existing key and value, routed to node for key.
+     - See Client::set_replace()
+     .
+     \param  key       Key to store under -- must not have any spaces
+     \param  value     New value to store
+     \param  flags     User defined flags to store under key, 0 for none
+     \param  expire    Expiration time in seconds from now, 0 for no expiration -- see Client::set()
+     \param  on_store  OnStore handler to receive response event, NULL for none
+     \param  on_error  OnError handler to use for unexpected errors, NULL for none -- ignored if `on_store=NULL`
+     \return           Whether successful, false if no nodes are available or unable to send request
+    */
+    bool set_replace(const SubString& key, const SubString& value, uint32 flags=0, int64 expire=0, OnStore* on_store=NULL, OnError* on_error=NULL) {
+        Client* client = get_client(key);
+        return (client != NULL && client->set_replace(key, value, flags, expire, on_store, on_error));
+    }
+
+    /** Send a request to increment or decrement a key value, routed to node for key.
+     - See Client::increment()
+     .
+     \param  key           Key to increment/decrement
+     \param  count         Count to increment/decrement by
+     \param  decrement     Whether to decrement, false to increment
+     \param  on_increment  OnIncrement handler to receive response event, NULL for none
+     \param  on_error      OnError handler to use for unexpected errors, NULL for none -- ignored if `on_increment=NULL`
+     \return               Whether successful, false if no nodes are available or unable to send request
+    */
+    bool increment(const SubString& key, uint64 count=1, bool decrement=false, OnIncrement* on_increment=NULL, OnError* on_error=NULL) {
+        Client* client = get_client(key);
+        return (client != NULL && client->increment(key, count, decrement, on_increment, on_error));
+    }
+
+    /** Send a request to remove a key, routed to node for key.
+     - See Client::remove()
+     .
+     \param  key        Key to remove
+     \param  on_remove  OnRemove handler to receive response event, NULL for none
+     \param  on_error   OnError handler to use for unexpected errors, NULL for none -- ignored if `on_remove=NULL`
+     \return            Whether successful, false if no nodes are available or unable to send request
+    */
+    bool remove(const SubString& key, OnRemove* on_remove=NULL, OnError* on_error=NULL) {
+        Client* client = get_client(key);
+        return (client != NULL && client->remove(key, on_remove, on_error));
+    }
+
+    /** Send a request to update expiration time for a key, routed to node for key.
+     - See Client::touch()
+     .
+     \param  key       Key to touch
+     \param  expire    New expiration time in seconds from now, 0 for no expiration -- see Client::set()
+     \param  on_touch  OnTouch handler to receive response event, NULL for none
+     \param  on_error  OnError handler to use for unexpected errors, NULL for none
+     \return           Whether successful, false if no nodes are available or unable to send request
+    */
+    bool touch(const SubString& key, int64 expire, OnTouch* on_touch, OnError* on_error=NULL) {
+        Client* client = get_client(key);
+        return (client != NULL && client->touch(key, expire, on_touch, on_error));
+    }
+
+    /** Send requests to get values for one or more keys, split across nodes.
+     - Keys are grouped by node, and one get request is sent to each node in parallel
+     - OnGet::on_get() is called for each key found, from any node, then OnGet::on_get_end() is called once when all nodes are done
+     - If a node fails, OnError::on_error() is called for that node and the keys not received from it are treated as not found
+     - With `track_notfound`, the keys not found are passed to OnGet::on_get_end(), including keys for failed nodes or keys with no nodes available
+       - Keys not found aren't in any particular order
+     .
+     \param  keys            Key(s) to get, multiple keys are space-separated
+     \param  on_get          OnGet handler to receive response events
+     \param  on_error        OnError handler to use for node errors, NULL for none -- called once per failed node
+     \param  track_notfound  Whether to track keys not found (i.e. cache misses), true to pass keys not found to OnGet::on_get_end()
+     \return                 Whether successful, false if no requests were sent (no events are called)
+    */
+    bool get(const SubString& keys, OnGet& on_get, OnError* on_error=NULL, bool track_notfound=false) {
+        return get_split(keys, on_get, on_error, track_notfound, false);
+    }
+
+    /** Send requests to get values for one or more keys for Compare-And-Swap, split across nodes.
+     - Same as get() except OnGet::on_get_cas() is called for each key found
+     .
+     \param  keys            Key(s) to get, multiple keys are space-separated
+     \param  on_get          OnGet handler to receive response events
+     \param  on_error        OnError handler to use for node errors, NULL for none -- called once per failed node
+     \param  track_notfound  Whether to track keys not found (i.e. cache misses), true to pass keys not found to OnGet::on_get_end()
+     \return                 Whether successful, false if no requests were sent (no events are called)
+    */
+    bool get_cas(const SubString& keys, OnGet& on_get, OnError* on_error=NULL, bool track_notfound=false) {
+        return get_split(keys, on_get, on_error, track_notfound, true);
+    }
+
+private:
+    // Disable copying
+    MemcachedClientPool(const MemcachedClientPool&);
+    MemcachedClientPool& operator=(const MemcachedClientPool&);
+
+    struct Node;
+
+    // Merged state for a get request split across nodes
+    struct GetBatch {
+        OnGet*   on_get;
+        OnError* on_error;
+        SizeT    pending;       // number of parts pending
+        bool     track_notfound;
+        String   notfound;
+
+        GetBatch(OnGet& on_get, OnError* on_error, bool track_notfound) : on_get(&on_get), on_error(on_error), pending(0), track_notfound(track_notfound) {
+        }
+
+        void add_notfound(const SubString& keys) {
+            if (track_notfound) {
+                StrTok tok(keys);
+                while (tok.nextw(' ')) {
+                    if (notfound.size() > 0)
+                        notfound << ' ';
+                    notfound << tok.value();
+                }
+            }
+        }
+    };
+
+    // Part of a get request sent to one node, receives events from that node's client
+    struct GetPart : OnGet {
+        GetBatch* batch;
+        Node*     node;
+        GetPart*  prev;         // pending list for node
+        GetPart*  next;
+        String    keys;         // keys sent to node
+        List<SubString> key_list;   // keys sent to node, referencing `keys`
+        SubString keys_rest;    // keys not received yet, in request order
+
+        GetPart(GetBatch* batch, Node* node) : batch(batch), node(node), prev(NULL), next(NULL) {
+        }
+
+        void on_get(const SubString& key, const SubString& value, uint32 flags) {
+            batch->on_get->on_get(key, value, flags);
+            if (batch->track_notfound)
+                set_found(key);
+        }
+
+        void on_get_cas(const SubString& key, const SubString& value, uint32 flags, uint64 cas_id) {
+            batch->on_get->on_get_cas(key, value, flags, cas_id);
+            if (batch->track_notfound)
+                set_found(key);
+        }
+
+        void on_get_end(const SubString&) {
+            finish();
+        }
+
+        // Server responds in request order, so keys skipped over weren't found
+        void set_found(const SubString& key) {
+            StrTok tok(keys_rest);
+            while (tok.nextw(' ')) {
+                if (tok.value() == key) {
+                    const char* key_start = tok.value().data();
+                    const char* key_end   = key_start + key.size();
+                    batch->add_notfound(SubString(keys_rest.data(), (StrSizeT)(key_start - keys_rest.data())));
+                    keys_rest.set(key_end, (StrSizeT)(keys_rest.data() + keys_rest.size() - key_end));
+                    break;
+                }
+            }
+        }
+
+        // Finish part, and finish batch if this is the last part -- this deletes this part
+        void finish() {
+            node->unlink_part(this);
+            batch->add_notfound(keys_rest);
+            if (--batch->pending == 0) {
+                batch->on_get->on_get_end(batch->notfound);
+                delete batch;
+            }
+            delete this;
+        }
+    };
+
+    // Server node with its client and state
+    struct Node : Client::OnConnect, Client::OnError {
+        MemcachedClientPool& pool;
+        String   host;
+        ushort   port;
+        uint     weight;
+        Client   client;
+        bool     up;
+        ulong    backoff_ms;    // current reconnect backoff, 0 if not reconnecting
+        SysTimestamp down_time; // time node went down, or last reconnect failed
+        GetPart* parts;         // pending get parts
+        GetPart* batch_part;    // current part while splitting keys in get_split()
+
+        Node(MemcachedClientPool& pool, const char* host, ushort port, uint weight) :
+            pool(pool), host(host), port(port), weight(weight), client(pool.max_queue_size_, pool.max_read_size_), up(true), backoff_ms(0), parts(NULL), batch_part(NULL) {
+            client.set_on_connect(this);
+            client.set_on_error(this);
+        }
+
+        bool connect() {
+            if (client.connect_ip(host.cstr(), port))
+                return true;
+            set_down();
+            return false;
+        }
+
+        void set_down() {
+            if (up) {
+                up = false;
+                ++pool.down_count_;
+                backoff_ms = pool.backoff_min_ms_;
+            } else {
+                backoff_ms *= 2;
+                if (backoff_ms < pool.backoff_min_ms_)
+                    backoff_ms = pool.backoff_min_ms_;
+                else if (backoff_ms > pool.backoff_max_ms_)
+                    backoff_ms = pool.backoff_max_ms_;
+            }
+            down_time.set_wall_timer();
+            if (pool.logger.check(LOG_LEVEL_WARN))
+                pool.logger.log_direct(LOG_LEVEL_WARN, String().reserve(64 + host.size()) << "MemcClientPool node down: " << host << ':' << port << ", retry in " << backoff_ms << " ms");
+        }
+
+        void link_part(GetPart* part) {
+            part->prev = NULL;
+            part->next = parts;
+            if (parts != NULL)
+                parts->prev = part;
+            parts = part;
+        }
+
+        void unlink_part(GetPart* part) {
+            if (part->prev != NULL)
+                part->prev->next = part->next;
+            else
+                parts = part->next;
+            if (part->next != NULL)
+                part->next->prev = part->prev;
+            part->prev = part->next = NULL;
+        }
+
+        void fail_parts(AsyncError err) {
+            while (parts != NULL) {
+                GetPart* part = parts;
+                if (part->batch->on_error != NULL)
+                    part->batch->on_error->on_error(err);
+                part->finish();
+            }
+        }
+
+        void on_connect() {
+            if (!up) {
+                up = true;
+                --pool.down_count_;
+                if (pool.logger.check(LOG_LEVEL_INFO))
+                    pool.logger.log_direct(LOG_LEVEL_INFO, String().reserve(48 + host.size()) << "MemcClientPool node up: " << host << ':' << port);
+            }
+            backoff_ms = 0;
+        }
+
+        void on_error(AsyncError err) {
+            if (err == aeTIMEOUT && up && parts == NULL) {
+                // Idle connection timed out, not a node failure -- reconnects on next use
+                if (pool.logger.check(LOG_LEVEL_DEBUG))
+                    pool.logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(48 + host.size()) << "MemcClientPool node idle timeout: " << host << ':' << port);
+                return;
+            }
+            set_down();
+            fail_parts(err);
+        }
+    };
+
+    typedef List<Node*> Nodes;
+    typedef SetList<uint64> Ring;   // each point: (hash << 32) | node index
+
+    AsyncBase  base_;       // event-loop owner, unless attached to parent -- must be destroyed after nodes
+    AsyncBase* parent_;
+    Nodes nodes_;
+    Ring  ring_;
+    SizeT max_queue_size_;
+    SizeT max_read_size_;
+    ulong read_timeout_ms_;
+    ulong write_timeout_ms_;
+    ulong backoff_min_ms_;
+    ulong backoff_max_ms_;
+    SizeT down_count_;
+
+    void add_ring_points(SizeT index) {
+        const Node& node = *nodes_[index];
+        String point_str;
+        const uint count = node.weight * (POINTS_PER_WEIGHT / 2);
+        for (uint i = 0; i < count; ++i) {
+            // 2 points per hash
+            point_str.set() << node.host << ':' << node.port << '-' << i;
+            const uint64 hash = SpookyHash::Hash64(point_str.data(), point_str.size(), 0);
+            ring_.add((hash & 0xFFFFFFFF00000000ULL) | (uint64)index);
+            ring_.add((hash << 32) | (uint64)index);
+        }
+    }
+
+    // Try reconnecting down nodes with expired backoff
+    void check_reconnect() {
+        SysTimestamp now;
+        now.set_wall_timer();
+        for (SizeT i = 0; i < nodes_.size(); ++i) {
+            Node& node = *nodes_[i];
+            if (!node.up && node.client.get_state() == Client::sNONE && now.diff_msec(node.down_time) >= node.backoff_ms) {
+                if (logger.check(LOG_LEVEL_DEBUG))
+                    logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(48 + node.host.size()) << "MemcClientPool node reconnect: " << node.host << ':' << node.port);
+                node.connect();
+            }
+        }
+    }
+
+    Node* route(const SubString& key) {
+        const SizeT ring_size = ring_.size();
+        if (ring_size == 0)
+            return NULL;
+        if (down_count_ > 0)
+            check_reconnect();
+
+        const uint64 hash = (uint64)(uint32)SpookyHash::hash(key.data(), key.size(), 0) << 32;
+        Ring::Iter iter(ring_.iter_lower(hash));
+        for (SizeT i = 0; i < ring_size; ++i, ++iter) {
+            if (!iter)
+                iter = ring_.cbegin();
+            Node& node = *nodes_[(SizeT)(*iter & 0xFFFFFFFF)];
+            if (node.up) {
+                // Reconnect if closed since last used
+                if (node.client.get_state() != Client::sNONE || node.connect())
+                    return &node;
+            }
+        }
+        return NULL;
+    }
+
+    bool get_split(const SubString& keys, OnGet& on_get, OnError* on_error, bool track_notfound, bool cas) {
+        GetBatch* batch = new GetBatch(on_get, on_error, track_notfound);
+
+        // Group keys by node
+        GetPart* parts = NULL;  // temp list using prev links
+        StrTok tok(keys);
+        while (tok.nextw(' ')) {
+            const SubString& key = tok.value();
+            Node* node = route(key);
+            if (node == NULL) {
+                batch->add_notfound(key);
+                continue;
+            }
+            GetPart* part = node->batch_part;
+            if (part == NULL) {
+                part = node->batch_part = new GetPart(batch, node);
+                part->prev = parts;
+                parts = part;
+            } else
+                part->keys << ' ';
+            part->keys << key;
+        }
+
+        // Send a request to each node
+        for (GetPart* part = parts, *prev; part != NULL; part = prev) {
+            prev = part->prev;
+            Node* node = part->node;
+            node->batch_part = NULL;
+            part->keys_rest = part->keys;
+            StrTok tok_part(part->keys);
+            while (tok_part.nextw(' '))
+                part->key_list.add(tok_part.value());
+            if (cas ? node->client.get_multi_cas(part->key_list, *part) : node->client.get_multi(part->key_list, *part)) {
+                node->link_part(part);
+                ++batch->pending;
+            } else {
+                if (logger.check(LOG_LEVEL_ERROR))
+                    logger.log_direct(LOG_LEVEL_ERROR, String().reserve(56 + node->host.size()) << "MemcClientPool get request failed on node: " << node->host << ':' << node->port);
+                batch->add_notfound(part->keys);
+                delete part;
+            }
+        }
+
+        if (batch->pending == 0) {
+            delete batch;
+            return false;
+        }
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+}
+#endif
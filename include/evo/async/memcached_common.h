@@ -40,6 +40,65 @@ struct Memcached {
         srENUM_END      ///< Enum guard value (always last)
     };
 
+    /** Binary protocol packet magic byte, first byte of each packet header. */
+    enum BinaryMagic {
+        bmREQUEST  = 0x80,  ///< Request packet
+        bmRESPONSE = 0x81   ///< Response packet
+    };
+
+    /** Binary protocol command opcodes.
+     - Quiet variants (ending with `Q`) don't send a response on success, except quiet GET variants which only skip the response on a miss
+    */
+    enum BinaryOpcode {
+        boGET        = 0x00,    ///< Get value
+        boSET        = 0x01,    ///< %Set value
+        boADD        = 0x02,    ///< Add value if not found
+        boREPLACE    = 0x03,    ///< Replace value if found
+        boDELETE     = 0x04,    ///< Delete by key
+        boINCREMENT  = 0x05,    ///< Increment numeric value
+        boDECREMENT  = 0x06,    ///< Decrement numeric value
+        boQUIT       = 0x07,    ///< Close connection
+        boFLUSH      = 0x08,    ///< Flush (invalidate) all items
+        boGETQ       = 0x09,    ///< Get value, quiet
+        boNOOP       = 0x0A,    ///< No operation, used to end a pipeline of quiet commands
+        boVERSION    = 0x0B,    ///< Get server version
+        boGETK       = 0x0C,    ///< Get value and key
+        boGETKQ      = 0x0D,    ///< Get value and key, quiet
+        boAPPEND     = 0x0E,    ///< Append to existing value
+        boPREPEND    = 0x0F,    ///< Prepend to existing value
+        boSTAT       = 0x10,    ///< Get server stats
+        boSETQ       = 0x11,    ///< %Set value, quiet
+        boADDQ       = 0x12,    ///< Add value, quiet
+        boREPLACEQ   = 0x13,    ///< Replace value, quiet
+        boDELETEQ    = 0x14,    ///< Delete by key, quiet
+        boINCREMENTQ = 0x15,    ///< Increment numeric value, quiet
+        boDECREMENTQ = 0x16,    ///< Decrement numeric value, quiet
+        boQUITQ      = 0x17,    ///< Close connection, quiet
+        boFLUSHQ     = 0x18,    ///< Flush all items, quiet
+        boAPPENDQ    = 0x19,    ///< Append to existing value, quiet
+        boPREPENDQ   = 0x1A,    ///< Prepend to existing value, quiet
+        boTOUCH      = 0x1C,    ///< Update expiration time
+        boGAT        = 0x1D,    ///< Get value and update expiration time
+        boGATQ       = 0x1E,    ///< Get value and update expiration time, quiet
+        boGATK       = 0x23,    ///< Get value and key and update expiration time
+        boGATKQ      = 0x24     ///< Get value and key and update expiration time, quiet
+    };
+
+    /** Binary protocol response status. */
+    enum BinaryStatus {
+        bsNO_ERROR          = 0x00,     ///< Success
+        bsKEY_NOT_FOUND     = 0x01,     ///< Key not found
+        bsKEY_EXISTS        = 0x02,     ///< Key exists (CAS mismatch, or add for existing key)
+        bsVALUE_TOO_LARGE   = 0x03,     ///< Value too large
+        bsINVALID_ARGUMENTS = 0x04,     ///< Invalid arguments
+        bsNOT_STORED        = 0x05,     ///< Item not stored
+        bsNON_NUMERIC       = 0x06,     ///< Increment or decrement on non-numeric value
+        bsUNKNOWN_COMMAND   = 0x81,     ///< Unknown command
+        bsINTERNAL_ERROR    = 0x84      ///< Internal (server) error
+    };
+
+    static const uint BINARY_HEADER_SIZE = 24;  ///< Binary protocol packet header size in bytes
+
     /** ErrorResult enum conversion helper. */
     EVO_ENUM_MAP_PREFIXED(ErrorResult, er,
         "CLIENT_ERROR",
@@ -56,6 +115,32 @@ struct Memcached {
     );
 };
 
+/** \cond impl */
+namespace impl_memc {
+    // Binary protocol byte order helpers (network byte order)
+    inline void put_be16(char* ptr, uint16 val) {
+        ptr[0] = (char)(val >> 8);
+        ptr[1] = (char)val;
+    }
+    inline void put_be32(char* ptr, uint32 val) {
+        ptr[0] = (char)(val >> 24);
+        ptr[1] = (char)(val >> 16);
+        ptr[2] = (char)(val >> 8);
+        ptr[3] = (char)val;
+    }
+    inline void put_be64(char* ptr, uint64 val) {
+        put_be32(ptr, (uint32)(val >> 32));
+        put_be32(ptr + 4, (uint32)val);
+    }
+    inline uint16 get_be16(const char* ptr)
+        { return (uint16)(((uint16)(uchar)ptr[0] << 8) | (uchar)ptr[1]); }
+    inline uint32 get_be32(const char* ptr)
+        { return ((uint32)(uchar)ptr[0] << 24) | ((uint32)(uchar)ptr[1] << 16) | ((uint32)(uchar)ptr[2] << 8) | (uint32)(uchar)ptr[3]; }
+    inline uint64 get_be64(const char* ptr)
+        { return ((uint64)get_be32(ptr) << 32) | get_be32(ptr + 4); }
+}
+/** \endcond */
+
 ///////////////////////////////////////////////////////////////////////////////
 //@}
 }
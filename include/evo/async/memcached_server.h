@@ -22,7 +22,7 @@ namespace async {
 /** Base class for user defined %Memcached server handler.
  - See: MemcachedServer
  .
-Request event methods:
+Request event methods (all protocols use the same events -- see MemcachedServer):
  - on_error()
  - on_store()
  - on_increment()
@@ -46,11 +46,17 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         cCAS,               ///< %Compare and swap
         cDECREMENT,         ///< Decrement numeric value for key
         cDELETE,            ///< Delete by key
+        cFLUSH_ALL,         ///< Flush (invalidate) all items
         cGAT,               ///< Get value and update expiratiom time
         cGATS,              ///< Get value for compare and swap and update expiratiom time
         cGET,               ///< Get value
         cGETS,              ///< Get value for compare and swap
         cINCREMENT,         ///< Increment numeric value for key
+        cMETA_ARITHMETIC,   ///< Meta arithmetic: increment or decrement numeric value for key
+        cMETA_DELETE,       ///< Meta delete by key
+        cMETA_GET,          ///< Meta get value
+        cMETA_NOOP,         ///< Meta no-op, used to end a pipeline of quiet meta commands
+        cMETA_SET,          ///< Meta set value
         cPREPEND,           ///< Prepend to existing value
         cQUIT,              ///< Quit command to close connection
         cREPLACE,           ///< Replace value if found
@@ -68,11 +74,17 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         "cas",
         "decr",
         "delete",
+        "flush_all",
         "gat",
         "gats",
         "get",
         "gets",
         "incr",
+        "ma",
+        "md",
+        "mg",
+        "mn",
+        "ms",
         "prepend",
         "quit",
         "replace",
@@ -123,6 +135,76 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
     struct GetAdvParams {
         Int64 expire;   ///< Expiration time in seconds from now, null if not updating expiration, 0 for no expiration, negative to expire now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
         bool  cas;      ///< Whether CAS is enabled, if true the handler must include a `cas_id` when sending response values with `send_value()`
+
+        /** Constructor. */
+        GetAdvParams() : cas(false) { }
+    };
+
+    /** Additional parameters for INCR/DECR request variants that create a missing value.
+     - Binary protocol increment/decrement and meta arithmetic with the `N` flag use this, classic INCR/DECR don't
+     - If the key isn't found, the handler should store `initial` as the new value (with flags 0) and return it, instead of returning null
+    */
+    struct IncrementAdvParams {
+        uint64 initial;     ///< Initial value to store if key not found
+        int64  expire;      ///< Expiration time for new value in seconds from now, 0 for no expiration, negative to expire now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
+
+        /** Constructor. */
+        IncrementAdvParams() : initial(0), expire(0) { }
+    };
+
+    /** Protocol used by a request, which determines the response format. */
+    enum Protocol {
+        pTEXT = 0,      ///< Classic text protocol
+        pMETA,          ///< Text meta protocol: `mg`, `ms`, `md`, `ma`, `mn`
+        pBINARY         ///< Binary protocol
+    };
+
+    /** Response parameters for current request, used to format meta and binary protocol responses.
+     - This is set by the parent protocol class for each request, and copied by DeferredReply for a deferred response
+     - Handlers don't normally need this, helpers like send_value() use it to format the response
+    */
+    struct ResponseParams {
+        Protocol protocol;  ///< Request protocol
+        uint     opcode;    ///< Binary protocol opcode -- see Memcached::BinaryOpcode
+        uint32   opaque;    ///< Binary protocol opaque value, returned with response
+        String   token;     ///< Meta protocol opaque token (`O` flag), returned with response -- empty for none
+        String   key;       ///< Key returned with response (meta `k` flag, or binary GETK variants) -- empty for none
+        bool     ret_value; ///< Whether to return value with get response (meta `v` flag, always true for binary)
+        bool     ret_flags; ///< Whether to return flags with get response (meta `f` flag, always true for binary)
+        bool     ret_size;  ///< Whether to return value size with get response (meta `s` flag)
+        bool     quiet;     ///< Whether quiet mode is enabled: no response on success, or on miss for get requests
+        bool     found;     ///< Whether a get value was sent (set by send_value())
+        uint64   cas;       ///< CAS ID of stored value, returned with binary protocol store and increment/decrement success responses -- 0 for none
+
+        /** Constructor. */
+        ResponseParams() : protocol(pTEXT), opcode(0), opaque(0), ret_value(false), ret_flags(false), ret_size(false), quiet(false), found(false), cas(0) {
+        }
+
+        /** Reset for new request.
+         \param  new_protocol  Protocol for new request
+        */
+        void reset(Protocol new_protocol) {
+            protocol  = new_protocol;
+            opcode    = 0;
+            opaque    = 0;
+            token.set();
+            key.set();
+            ret_value = ret_flags = (new_protocol == pBINARY);
+            ret_size  = false;
+            quiet     = false;
+            found     = false;
+            cas       = 0;
+        }
+    };
+
+    /** Response status for meta and binary protocol responses. */
+    enum ResponseStatus {
+        rsOK = 0,       ///< Success -- meta: `HD`, binary: no error
+        rsNOT_FOUND,    ///< Key not found -- meta: `NF`, binary: key not found
+        rsEXISTS,       ///< CAS mismatch -- meta: `EX`, binary: key exists
+        rsNOT_STORED,   ///< Not stored -- meta: `NS`, binary: not stored
+        rsMISS,         ///< Get miss -- meta: `EN`, binary: key not found
+        rsNOOP          ///< No-op response -- meta: `MN`, binary: no error
     };
 
     /** Deferred context helper -- used by AsyncServer. */
@@ -134,7 +216,7 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
          \param  context  Context to use
          \param  id       Request ID to use
         */
-        DeferredReply(DeferredContext& context, ulong id) : DeferredContext::ReplyBase(context, id) {
+        DeferredReply(DeferredContext& context, ulong id) : DeferredContext::ReplyBase(context, id), response(context.handler->response) {
         }
 
         /** Destructor. */
@@ -151,10 +233,14 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         void deferred_reply_error(const SubString& msg) {
             if (context.handler != NULL) {
                 String buf;
-                buf.reserve(15 + msg.size());
-                buf.set("SERVER_ERROR ", 13);
-                buf << msg;
-                buf.add("\r\n", 2);
+                if (response.protocol == pBINARY) {
+                    format_binary_error(buf, response, Memcached::bsINTERNAL_ERROR, msg);
+                } else {
+                    buf.reserve(15 + msg.size());
+                    buf.set("SERVER_ERROR ", 13);
+                    buf << msg;
+                    buf.add("\r\n", 2);
+                }
                 DeferredContext::Handler& handler = *context.handler;
                 handler.reply.deferred_send(id, buf, true);
                 if (handler.logger.check(LOG_LEVEL_DEBUG_LOW))
@@ -167,16 +253,28 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
 
         /** Finish set/store request and report result.
          \param  result  Command result -- see Memcached::StoreResult
+         \param  cas_id  CAS ID of stored value, returned with binary protocol response -- 0 for none
         */
-        void deferred_reply_store(Memcached::StoreResult result) {
+        void deferred_reply_store(Memcached::StoreResult result, uint64 cas_id=0) {
             if (context.handler != NULL) {
                 String buf;
-                switch (result) {
-                    case Memcached::srSTORED:     buf.set("STORED\r\n", 8);      break;
-                    case Memcached::srNOT_STORED: buf.set("NOT_STORED\r\n", 12); break;
-                    case Memcached::srEXISTS:     buf.set("EXISTS\r\n", 8);      break;
-                    case Memcached::srNOT_FOUND:  buf.set("NOT_FOUND\r\n", 11);  break;
-                    default: buf.set("SERVER_ERROR Backend error\r\n", 28); break;
+                if (response.protocol != pTEXT) {
+                    response.cas = cas_id;
+                    switch (result) {
+                        case Memcached::srSTORED:     format_status(buf, response, rsOK);         break;
+                        case Memcached::srNOT_STORED: format_status(buf, response, rsNOT_STORED); break;
+                        case Memcached::srEXISTS:     format_status(buf, response, rsEXISTS);     break;
+                        case Memcached::srNOT_FOUND:  format_status(buf, response, rsNOT_FOUND);  break;
+                        default: format_error(buf, response, "Backend error"); break;
+                    }
+                } else {
+                    switch (result) {
+                        case Memcached::srSTORED:     buf.set("STORED\r\n", 8);      break;
+                        case Memcached::srNOT_STORED: buf.set("NOT_STORED\r\n", 12); break;
+                        case Memcached::srEXISTS:     buf.set("EXISTS\r\n", 8);      break;
+                        case Memcached::srNOT_FOUND:  buf.set("NOT_FOUND\r\n", 11);  break;
+                        default: buf.set("SERVER_ERROR Backend error\r\n", 28); break;
+                    }
                 }
                 DeferredContext::Handler& handler = *context.handler;
                 if (handler.logger.check(LOG_LEVEL_DEBUG_LOW))
@@ -189,12 +287,19 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         }
 
         /** Finish increment/decrement request and report result.
-         \param  value  Result value after increment/decrement, null if key not found
+         \param  value   Result value after increment/decrement, null if key not found
+         \param  cas_id  CAS ID of updated value, returned with binary protocol response -- 0 for none
         */
-        void deferred_reply_increment(UInt64 value) {
+        void deferred_reply_increment(UInt64 value, uint64 cas_id=0) {
             if (context.handler != NULL) {
                 String buf;
-                if (value.null()) {
+                if (response.protocol != pTEXT) {
+                    response.cas = cas_id;
+                    if (value.null())
+                        format_status(buf, response, rsNOT_FOUND);
+                    else
+                        format_number(buf, response, *value);
+                } else if (value.null()) {
                     buf.set("NOT_FOUND\r\n", 11);
                 } else {
                     buf.reserve(UInt64::MAXSTRLEN + 2);
@@ -216,7 +321,9 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         void deferred_reply_delete(bool success) {
             if (context.handler != NULL) {
                 String buf;
-                if (success)
+                if (response.protocol != pTEXT)
+                    format_status(buf, response, (success ? rsOK : rsNOT_FOUND));
+                else if (success)
                     buf.set("DELETED\r\n", 9);
                 else
                     buf.set("NOT_FOUND\r\n", 11);
@@ -236,7 +343,9 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         void deferred_reply_touch(bool success) {
             if (context.handler != NULL) {
                 String buf;
-                if (success)
+                if (response.protocol != pTEXT)
+                    format_status(buf, response, (success ? rsOK : rsNOT_FOUND));
+                else if (success)
                     buf.set("TOUCHED\r\n", 9);
                 else
                     buf.set("NOT_FOUND\r\n", 11);
@@ -263,7 +372,24 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         void deferred_reply_get(const SubString& key, const SubString& value, uint32 flags, uint64* cas_id=NULL) {
             if (context.handler != NULL) {
                 DeferredContext::Handler& handler = *context.handler;
-                handler.send_value_internal(id, key, value, flags, cas_id, AsyncServerReply::wfDEFERRED);
+                handler.send_value_internal(id, response, key, value, flags, cas_id, AsyncServerReply::wfDEFERRED);
+                if (handler.logger.check(LOG_LEVEL_DEBUG_LOW))
+                    handler.logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(68 + key.size()) << "MemcServer on_get sent deferred value " << id << ": '" << key << "' (size: " << value.size() << ')');
+            }
+        }
+
+        /** Send get request value for key, with value sent by reference (no copy) when possible.
+         - Same as deferred_reply_get(), but large values with an allocated buffer are written to the socket by reference instead of copied -- see send_value_ref()
+         .
+         \param  key     Key for value to send
+         \param  value   Value to send for key
+         \param  flags   User flags stored with value
+         \param  cas_id  Compare-And-Swap ID to send, NULL for none -- this must only be non-null for CAS GET request variants, see GetAdvParams
+        */
+        void deferred_reply_get_ref(const SubString& key, const String& value, uint32 flags, uint64* cas_id=NULL) {
+            if (context.handler != NULL) {
+                DeferredContext::Handler& handler = *context.handler;
+                handler.send_value_ref_internal(id, response, key, value, flags, cas_id, AsyncServerReply::wfDEFERRED);
                 if (handler.logger.check(LOG_LEVEL_DEBUG_LOW))
                     handler.logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(68 + key.size()) << "MemcServer on_get sent deferred value " << id << ": '" << key << "' (size: " << value.size() << ')');
             }
@@ -272,7 +398,11 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         /** Finish response for get request. */
         void deferred_reply_get_end() {
             if (context.handler != NULL) {
-                String buf("END\r\n", 5);
+                String buf;
+                if (response.protocol == pTEXT)
+                    buf.set("END\r\n", 5);
+                else if (!response.found)
+                    format_status(buf, response, rsMISS);   // nothing added in quiet mode
                 DeferredContext::Handler& handler = *context.handler;
                 handler.reply.deferred_send(id, buf, true);
                 if (handler.logger.check(LOG_LEVEL_DEBUG_LOW))
@@ -282,12 +412,15 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
             }
             finished = true;
         }
+
+        ResponseParams response;    ///< Response parameters copied from request, used to format deferred response
     };
 
     LoggerPtr<> logger;     ///< Logger to use (set by AsyncServer)
     bool noreply;           ///< Whether no-reply mode is enabled (set by parent protocol class)
     bool enable_gat;        ///< Derived constructor must set to true to enable "get and touch" (gat/gats command)
     bool enable_cas;        ///< Derived constructor must set to true to enable "compare and swap" (gets/gats command)
+    ResponseParams response;///< Response parameters for current request (set by parent protocol class)
 
     /** Constructor. */
     MemcachedServerHandlerBase() : noreply(false), enable_gat(false), enable_cas(false) {
@@ -312,6 +445,7 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
        - cCAS:      Store with atomic swap operation, fails if item was modified since it was last retrieved -- not enabled unless `enable_cas=true`
        .
      - On error call send_error() then return `rtHANDLED` or `rtCLOSE`
+     - For binary protocol responses, set `response.cas` to the CAS ID of the stored value (if supported)
      - If the store `command` is not supported do this:
        \code
         send_error("Not implemented");
@@ -355,6 +489,8 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
      - Decrementing below 0 should result in 0
      - On error call send_error() then return `rtHANDLED` or `rtCLOSE`
      - If value for key is not numeric then this should be considered an error
+     - For binary protocol responses, set `response.cas` to the CAS ID of the updated value (if supported)
+     - This is called by the default on_increment() overload with `IncrementAdvParams`, so a handler that doesn't create missing values only needs to implement this
      .
      \param  context    Context for creating DeferredReply for deferred response
      \param  key        Key to increment or decrement
@@ -380,6 +516,25 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
         return rtHANDLED;
     }
 
+    /** Called on INCR or DECR request, with parameters for creating a missing value.
+     - This is an addition to on_increment(DeferredContext&,const SubString&,uint64,bool) and is called first for all INCR and DECR requests
+     - `adv_params` is only non-null for requests that may create a missing value: binary protocol, or meta arithmetic with `N` flag
+     - The default implementation ignores `adv_params` and calls the overload without it, so a missing key is reported as not found
+     - Override this to create missing values -- see IncrementAdvParams
+     .
+     \param  context     Context for creating DeferredReply for deferred response
+     \param  key         Key to increment or decrement
+     \param  count       Count to increment or decrement
+     \param  decrement   Whether to decrement instead of increment, false to increment, true to decrement
+     \param  adv_params  Parameters for creating value if key not found, NULL to not create
+     \return             Result, same as on_increment(DeferredContext&,const SubString&,uint64,bool) except:
+                          - UInt64 initial value if key not found and value was created
+    */
+    virtual IncrementResult on_increment(DeferredContext& context, const SubString& key, uint64 count, bool decrement, IncrementAdvParams* adv_params) {
+        EVO_PARAM_UNUSED(adv_params);
+        return on_increment(context, key, count, decrement);
+    }
+
     /** Called on DELETE request to delete key and value.
      - On error call send_error() then return `rtHANDLED` or `rtCLOSE`
      .
@@ -470,6 +625,7 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
        - GETS (get for Compare-And-Swap) to get and return a cas_id for atomic %Compare And Swap -- these requests are rejected unless `enable_cas=true`
        - GATS (get for Compare-And-Swap and update) combines both above variants -- these requests are rejected unless `enable_gat=true` and `enable_cas=true`
      - Call send_value() to send a value for key -- skip if key not found
+       - Use send_value_ref() instead to send a large stored value without copying it
      - This is called multiple times if a GET request has multiple keys
      - This is only called if `on_get_start()` returned `grCONTINUE` for this request
      - If any part of this response is deferred then this or `on_get_start()` or `on_get_end()` must return `rtDEFERRED` to indiciate this, otherwise results are undefined
@@ -566,10 +722,12 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
     // Helpers
 
     /** Helper to send a reply message.
+     - This does nothing with binary protocol, which doesn't use text replies
+     .
      \param  msg  Reply message to send
     */
     void send_reply(const SubString& msg) {
-        if (!noreply) {
+        if (!noreply && response.protocol != pBINARY) {
             AsyncServerReply::Writer writer(reply, id, msg.size() + 2);
             writer.add(msg.data(), msg.size());
             writer.add("\r\n", 2);
@@ -579,41 +737,65 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
     }
 
     /** Helper to send a client error response.
+     - With binary protocol this sends an "invalid arguments" error status with message
+     .
      \param  msg  Error message to send
     */
     void send_client_error(const SubString& msg) {
-        if (!noreply) {
+        if (response.protocol == pBINARY) {
+            String buf;
+            format_binary_error(buf, response, Memcached::bsINVALID_ARGUMENTS, msg);
+            reply.send(id, buf);
+        } else if (!noreply) {
             AsyncServerReply::Writer writer(reply, id, 15 + msg.size());
             writer.add("CLIENT_ERROR ", 13);
             writer.add(msg.data(), msg.size());
             writer.add("\r\n", 2);
-            if (logger.check(LOG_LEVEL_DEBUG_LOW))
-                logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(40 + msg.size()) << "MemcServer -- send_error: CLIENT_ERROR " << msg);
-        }
+        } else
+            return;
+        if (logger.check(LOG_LEVEL_DEBUG_LOW))
+            logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(40 + msg.size()) << "MemcServer -- send_error: CLIENT_ERROR " << msg);
     }
 
     /** Helper to send a server error response.
+     - With binary protocol this sends an "internal error" status with message
+     .
      \param  msg  Error message to send
     */
     void send_error(const SubString& msg) {
-        if (!noreply) {
+        if (response.protocol == pBINARY) {
+            String buf;
+            format_binary_error(buf, response, Memcached::bsINTERNAL_ERROR, msg);
+            reply.send(id, buf);
+        } else if (!noreply) {
             AsyncServerReply::Writer writer(reply, id, 15 + msg.size());
             writer.add("SERVER_ERROR ", 13);
             writer.add(msg.data(), msg.size());
             writer.add("\r\n", 2);
-            if (logger.check(LOG_LEVEL_DEBUG_LOW))
-                logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(40 + msg.size()) << "MemcServer -- send_error: SERVER_ERROR " << msg);
-        }
+        } else
+            return;
+        if (logger.check(LOG_LEVEL_DEBUG_LOW))
+            logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(40 + msg.size()) << "MemcServer -- send_error: SERVER_ERROR " << msg);
     }
 
     /** Helper for sending statistics.
      - Call from on_stats()
      - Call repeatedly for each statistic
+     - With binary protocol this sends a STAT response packet with name as key
      .
      \param  name   Stats name
      \param  value  Stats value
     */
     void send_stat(const SubString& name, const SubString& value) {
+        if (response.protocol == pBINARY) {
+            AsyncServerReply::Writer writer(reply, id, Memcached::BINARY_HEADER_SIZE + name.size() + value.size());
+            String buf;
+            format_binary_header(buf, response, Memcached::bsNO_ERROR, name.size(), 0, name.size() + value.size(), 0);
+            writer.add(buf.data(), buf.size());
+            writer.add(name.data(), name.size());
+            writer.add(value.data(), value.size());
+            return;
+        }
         AsyncServerReply::Writer writer(reply, id, 8 + name.size() + value.size());
         writer.add("STAT ", 5);
         writer.add(name.data(), name.size());
@@ -624,6 +806,7 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
 
     /** Helper to send value for get response.
      - Call from on_get_start() or on_get() if key and value found
+     - The response is formatted according to the request protocol -- see ResponseParams
      .
      \param  key     Key for value
      \param  value   Value to send
@@ -631,23 +814,272 @@ struct MemcachedServerHandlerBase : public AsyncServerHandler {
      \param  cas_id  Compare-And-Swap ID to send, NULL for none -- this must only be non-null for CAS GET request variants, see GetAdvParams
     */
     void send_value(const SubString& key, const SubString& value, uint32 flags=0, uint64* cas_id=NULL) {
-        send_value_internal(id, key, value, flags, cas_id, AsyncServerReply::wfNONE);
+        send_value_internal(id, response, key, value, flags, cas_id, AsyncServerReply::wfNONE);
         if (logger.check(LOG_LEVEL_DEBUG_LOW))
             logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(42 + key.size()) << "MemcServer -- send_value '" << key << "' (size: " << value.size() << ')');
     }
 
+    /** Helper to send value for get response, with value sent by reference (no copy) when possible.
+     - Call from on_get_start() or on_get() if key and value found
+     - This is the same as send_value(), but large values with an allocated buffer (i.e. stored values, not literals or substrings) are written to the socket by reference instead of copied
+       - The `VALUE` header line is still copied, then the value buffer is referenced until written to the socket -- see AsyncBuffers::write_ref()
+       - Smaller values are copied the same as with send_value()
+     - This avoids copying large cached values, which can dominate CPU usage
+     - \b Caution: The value buffer must not be shared with other threads, make a full (unshared) copy first if needed
+     .
+     \param  key     Key for value
+     \param  value   Value to send, stored value with a buffer to send without copying
+     \param  flags   User defined flags stored with value
+     \param  cas_id  Compare-And-Swap ID to send, NULL for none -- this must only be non-null for CAS GET request variants, see GetAdvParams
+    */
+    void send_value_ref(const SubString& key, const String& value, uint32 flags=0, uint64* cas_id=NULL) {
+        send_value_ref_internal(id, response, key, value, flags, cas_id, AsyncServerReply::wfNONE);
+        if (logger.check(LOG_LEVEL_DEBUG_LOW))
+            logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(42 + key.size()) << "MemcServer -- send_value_ref '" << key << "' (size: " << value.size() << ')');
+    }
+
+    /** Helper to send shared value for get response, with value sent by reference (no copy) when possible.
+     - This is the same as send_value_ref(const SubString&,const String&,uint32,uint64*) but references a SharedString, which has an atomic reference count
+     - Use this to send a value shared with other threads without copying, like a value from MemcachedStore
+     .
+     \param  key     Key for value
+     \param  value   Value to send
+     \param  flags   User defined flags stored with value
+     \param  cas_id  Compare-And-Swap ID to send, NULL for none -- this must only be non-null for CAS GET request variants, see GetAdvParams
+    */
+    void send_value_ref(const SubString& key, const SharedString& value, uint32 flags=0, uint64* cas_id=NULL) {
+        send_value_ref_internal(id, response, key, value, flags, cas_id, AsyncServerReply::wfNONE);
+        if (logger.check(LOG_LEVEL_DEBUG_LOW))
+            logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(42 + key.size()) << "MemcServer -- send_value_ref '" << key << "' (size: " << value.size() << ')');
+    }
+
+    /** Format meta or binary protocol status response.
+     - Meta protocol: status code (`HD`, `NF`, `EX`, `NS`, `EN`, `MN`) with returned key and opaque token flags
+     - Binary protocol: response header with status, and returned key (if any) as body
+       - An `rsOK` response includes `params.cas` as the CAS ID
+     - Nothing is appended in quiet mode for `rsOK` and `rsMISS` status
+     .
+     \param  out     Output string to append to
+     \param  params  Response parameters for request
+     \param  status  Response status to format
+    */
+    static void format_status(String& out, const ResponseParams& params, ResponseStatus status) {
+        if (params.quiet && (status == rsOK || status == rsMISS))
+            return;
+        if (params.protocol == pBINARY) {
+            Memcached::BinaryStatus bin_status;
+            switch (status) {
+                case rsNOT_FOUND:   // fallthrough
+                case rsMISS:        bin_status = Memcached::bsKEY_NOT_FOUND; break;
+                case rsEXISTS:      bin_status = Memcached::bsKEY_EXISTS;    break;
+                case rsNOT_STORED:  bin_status = Memcached::bsNOT_STORED;    break;
+                default:            bin_status = Memcached::bsNO_ERROR;      break;
+            }
+            format_binary_header(out, params, bin_status, params.key.size(), 0, params.key.size(), (status == rsOK ? params.cas : 0));
+            out.add(params.key);
+        } else {
+            static const char* CODES[] = { "HD", "NF", "EX", "NS", "EN", "MN" };
+            out.reserve(8 + params.key.size() + params.token.size());
+            out.add(CODES[status], 2);
+            format_meta_flags(out, params);
+            out.add("\r\n", 2);
+        }
+    }
+
+    /** Format server error response.
+     \param  out     Output string to append to
+     \param  params  Response parameters for request
+     \param  msg     Error message
+    */
+    static void format_error(String& out, const ResponseParams& params, const SubString& msg) {
+        if (params.protocol == pBINARY) {
+            format_binary_error(out, params, Memcached::bsINTERNAL_ERROR, msg);
+        } else {
+            out.reserve(15 + msg.size());
+            out.add("SERVER_ERROR ", 13);
+            out << msg;
+            out.add("\r\n", 2);
+        }
+    }
+
+    /** Format meta or binary protocol numeric response for increment or decrement.
+     - Binary protocol response includes `params.cas` as the CAS ID
+     - Nothing is appended in quiet mode
+     .
+     \param  out     Output string to append to
+     \param  params  Response parameters for request
+     \param  value   New numeric value
+    */
+    static void format_number(String& out, const ResponseParams& params, uint64 value) {
+        if (params.quiet)
+            return;
+        if (params.protocol == pBINARY) {
+            format_binary_header(out, params, Memcached::bsNO_ERROR, 0, 0, 8, params.cas);
+            impl_memc::put_be64(out.advWrite(8), value);
+            out.advWriteDone(8);
+        } else if (params.ret_value) {
+            StringInt<uint64> value_str(value);
+            StringInt<StrSizeT> value_size_str(value_str.size());
+            out.reserve(10 + value_size_str.size() + value_str.size() + params.key.size() + params.token.size());
+            out.add("VA ", 3).add(value_size_str.data(), value_size_str.size());
+            format_meta_flags(out, params);
+            out.add("\r\n", 2).add(value_str.data(), value_str.size()).add("\r\n", 2);
+        } else
+            format_status(out, params, rsOK);
+    }
+
+    /** Format binary protocol response header.
+     \param  out         Output string to append to
+     \param  params      Response parameters for request, used for opcode and opaque value
+     \param  status      Response status
+     \param  key_len     Key length in body
+     \param  extras_len  Extras length in body
+     \param  body_len    Total body length, including extras, key, and value
+     \param  cas         CAS value for response, 0 for none
+    */
+    static void format_binary_header(String& out, const ResponseParams& params, Memcached::BinaryStatus status, StrSizeT key_len, uint extras_len, StrSizeT body_len, uint64 cas) {
+        char* p = out.advWrite(Memcached::BINARY_HEADER_SIZE);
+        p[0] = (char)Memcached::bmRESPONSE;
+        p[1] = (char)params.opcode;
+        impl_memc::put_be16(p + 2, (uint16)key_len);
+        p[4] = (char)extras_len;
+        p[5] = 0;   // data type
+        impl_memc::put_be16(p + 6, (uint16)status);
+        impl_memc::put_be32(p + 8, (uint32)body_len);
+        impl_memc::put_be32(p + 12, params.opaque);
+        impl_memc::put_be64(p + 16, cas);
+        out.advWriteDone(Memcached::BINARY_HEADER_SIZE);
+    }
+
+    /** Format binary protocol error response with message body.
+     \param  out     Output string to append to
+     \param  params  Response parameters for request
+     \param  status  Response error status
+     \param  msg     Error message
+    */
+    static void format_binary_error(String& out, const ResponseParams& params, Memcached::BinaryStatus status, const SubString& msg) {
+        format_binary_header(out, params, status, 0, 0, msg.size(), 0);
+        out.add(msg.data(), msg.size());
+    }
+
 private:
+    // Append meta response flags for returned key and opaque token
+    static void format_meta_flags(String& out, const ResponseParams& params) {
+        if (params.key.size() > 0)
+            out.add(" k", 2).add(params.key);
+        if (params.token.size() > 0)
+            out.add(" O", 2).add(params.token);
+    }
+
+    // Format meta or binary value response header, returns trailer size (2 for meta with value, otherwise 0)
+    static SizeT format_value_header(String& out, const ResponseParams& params, const SubString& key, StrSizeT value_size, uint32 flags, uint64* cas_id) {
+        if (params.protocol == pBINARY) {
+            const bool with_key = (params.opcode == Memcached::boGETK || params.opcode == Memcached::boGETKQ || params.opcode == Memcached::boGATK || params.opcode == Memcached::boGATKQ);
+            const StrSizeT key_len = (with_key ? key.size() : 0);
+            format_binary_header(out, params, Memcached::bsNO_ERROR, key_len, 4, 4 + key_len + value_size, (cas_id != NULL ? *cas_id : 0));
+            impl_memc::put_be32(out.advWrite(4), flags);
+            out.advWriteDone(4);
+            if (with_key)
+                out.add(key.data(), key.size());
+            return 0;
+        }
+
+        out.reserve(48 + params.key.size() + params.token.size());
+        if (params.ret_value)
+            out.add("VA ", 3) << value_size;
+        else
+            out.add("HD", 2);
+        if (params.ret_flags)
+            out.add(" f", 2) << flags;
+        if (cas_id != NULL)
+            out.add(" c", 2) << *cas_id;
+        if (params.ret_size)
+            out.add(" s", 2) << value_size;
+        format_meta_flags(out, params);
+        out.add("\r\n", 2);
+        return (params.ret_value ? 2 : 0);
+    }
+
+    /** Helper to send value for get response, with value sent by reference when possible (used internally).
+     - This is used by send_value_ref() and deferred_reply_get_ref() -- not used directly
+     .
+     \param  req_id        Request ID for response
+     \param  params        Response parameters for request
+     \param  key           Key for value
+     \param  value         Value to send
+     \param  flags         User defined flags stored with value
+     \param  cas_id        Compare-And-Swap ID to send, NULL for none -- this must only be non-null for CAS GET request variants, see GetAdvParams
+     \param  writer_flags  Flags passed to response writer
+     \tparam  TValue       Value string type, String or SharedString
+    */
+    template<class TValue>
+    void send_value_ref_internal(ulong req_id, ResponseParams& params, const SubString& key, const TValue& value, uint32 flags, uint64* cas_id, AsyncServerReply::WriterFlags writer_flags) {
+        if (value.size() < AsyncServerReply::OutBuffer::WRITE_REF_MIN || (params.protocol == pMETA && !params.ret_value)) {
+            send_value_internal(req_id, params, key, SubString(value.data(), value.size()), flags, cas_id, writer_flags);
+            return;
+        }
+
+        SizeT trailer_size = 2;
+        if (params.protocol != pTEXT) {
+            params.found = true;
+            String header;
+            trailer_size = format_value_header(header, params, key, value.size(), flags, cas_id);
+            AsyncServerReply::Writer writer(reply, req_id, header.size(), writer_flags);
+            writer.add(header.data(), header.size());
+        } else {
+            StringInt<uint32> flags_str(flags);
+            StringInt<StrSizeT> value_size_str(value.size());
+            StringInt<uint64> cas_id_str;
+
+            SizeT write_size = 10 + key.size() + flags_str.size() + value_size_str.size();
+            if (cas_id != NULL) {
+                cas_id_str.set(*cas_id);
+                write_size += 1 + cas_id_str.size();
+            }
+
+            AsyncServerReply::Writer writer(reply, req_id, write_size, writer_flags);
+            writer.add("VALUE ", 6);
+            writer.add(key.data(), key.size());
+            writer.add(' ').add(flags_str.data(), flags_str.size());
+            writer.add(' ').add(value_size_str.data(), value_size_str.size());
+            if (cas_id != NULL)
+                writer.add(' ').add(cas_id_str.data(), cas_id_str.size());
+            writer.add("\r\n", 2);
+        }
+        reply.send_ref(req_id, value, writer_flags);
+        if (trailer_size > 0) {
+            AsyncServerReply::Writer writer(reply, req_id, 2, writer_flags);
+            writer.add("\r\n", 2);
+        }
+    }
+
     /** Helper to send value for get response (used internally).
      - This is used by send_value() and deferred_reply_get() -- not used directly
      .
      \param  req_id        Request ID for response
+     \param  params        Response parameters for request
      \param  key           Key for value
      \param  value         Value to send
      \param  flags         User defined flags stored with value
      \param  cas_id        Compare-And-Swap ID to send, NULL for none -- this must only be non-null for CAS GET request variants, see GetAdvParams
      \param  writer_flags  Flags passed to response writer
     */
-    void send_value_internal(ulong req_id, const SubString& key, const SubString& value, uint32 flags, uint64* cas_id, AsyncServerReply::WriterFlags writer_flags) {
+    void send_value_internal(ulong req_id, ResponseParams& params, const SubString& key, const SubString& value, uint32 flags, uint64* cas_id, AsyncServerReply::WriterFlags writer_flags) {
+        if (params.protocol != pTEXT) {
+            params.found = true;
+            String header;
+            const SizeT trailer_size = format_value_header(header, params, key, value.size(), flags, cas_id);
+            const bool with_value = (params.protocol == pBINARY || params.ret_value);
+            AsyncServerReply::Writer writer(reply, req_id, header.size() + (with_value ? value.size() + trailer_size : 0), writer_flags);
+            writer.add(header.data(), header.size());
+            if (with_value) {
+                writer.add(value.data(), value.size());
+                if (trailer_size > 0)
+                    writer.add("\r\n", 2);
+            }
+            return;
+        }
+
         StringInt<uint32> flags_str(flags);
         StringInt<StrSizeT> value_size_str(value.size());
         StringInt<uint64> cas_id_str;
@@ -675,6 +1107,11 @@ private:
 
 /** Implements %Memcached protocol for an async server.
  - See \ref Async for general overview
+ - Supported protocols, detected per connection from the first request byte:
+   - Text protocol: classic commands like `get`, `set`, `delete`, etc
+   - Meta commands (text): `mg`, `ms`, `md`, `ma`, `mn` -- `mg` flags `b` (base64 keys), `N` (auto-create), and `t` (return TTL) aren't supported and return a client error, `ma` supports auto-create with `N` and `J` flags
+   - Binary protocol: all common opcodes including quiet variants, handled with the same handler events
+ - Handler helpers like MemcachedServerHandlerBase::send_value() format responses for the request protocol, so handlers don't need protocol-specific code
  .
 Usage:
  - Implement a `HANDLER` class with the event (callback) methods
@@ -774,7 +1211,7 @@ struct MemcachedServer {
      \param  shared  Shared data for requests
      \param  logger  Logger to use, NULL for none
     */
-    MemcachedServer(Global& global, Shared& shared, LoggerBase* logger) : logger(logger), handler(global, shared), command(HandlerBase::cUNKNOWN) {
+    MemcachedServer(Global& global, Shared& shared, LoggerBase* logger) : logger(logger), handler(global, shared), command(HandlerBase::cUNKNOWN), mode(mUNKNOWN), binary_body(false) {
         handler.logger.set(logger);
     }
 
@@ -811,50 +1248,59 @@ struct MemcachedServer {
         }
 
     bool on_read_fixed(SizeT& next_size, SubString& data, void* context) {
-        // Read storage value
-        EVO_PARAM_UNUSED(next_size);
         assert( context != NULL );
-        String logstr;
-        if (logger.check(LOG_LEVEL_DEBUG)) {
-            logstr.set().reserve(96 + storage_params.key.size())
-                << "MemcServer on_store " << HandlerBase::CommandEnum::get_string(command)
-                << " '" << storage_params.key << "' fl:" << storage_params.flags << " exp:" << storage_params.expire;
-            if (command == HandlerBase::cCAS)
-                logstr << " id:" << storage_params.cas_id;
-            logstr << " (size: " << storage_params.size << ')';
-            logger.log_direct(LOG_LEVEL_DEBUG, logstr);
-        }
-        data.stripr("\r\n", NEWLINE_LEN, 1);
-
         DeferredContext& context_ref = *(DeferredContext*)context;
-        ulong expected_deferred_count = context_ref.count();
-        
-        HandlerBase::StoreResult result = handler.on_store(context_ref, storage_params, data, command, storage_params.cas_id);
-        switch (result.type) {
-            case HandlerBase::rtNORMAL:
-                switch (result.result) {
-                    case Memcached::srSTORED:     reply("STORED\r\n", 8);      break;
-                    case Memcached::srNOT_STORED: reply("NOT_STORED\r\n", 12); break;
-                    case Memcached::srEXISTS:     reply("EXISTS\r\n", 8);      break;
-                    case Memcached::srNOT_FOUND:  reply("NOT_FOUND\r\n", 11);  break;
-                    default:
-                        if (logger.check(LOG_LEVEL_ERROR))
-                            logger.log_direct(LOG_LEVEL_ERROR, logstr.set().reserve(56) << "MemcServer on_store error: Invalid handler result: " << (int)result.result);
-                        return false; // invalid result, close connection
+        if (mode == mBINARY) {
+            // Read binary request header or body
+            if (!binary_body) {
+                if ((uchar)data.data()[0] != Memcached::bmREQUEST) {
+                    logger.log(LOG_LEVEL_ERROR, "MemcServer binary error: Invalid request magic byte");
+                    return false; // close connection
                 }
-                break;
-            EVO_HELPER_HANDLER_CASES("on_store");
+                memcpy(binary_header, data.data(), Memcached::BINARY_HEADER_SIZE);
+                const uint32 body_len = impl_memc::get_be32(binary_header + 8);
+                if (body_len > 0) {
+                    binary_body = true;
+                    next_size   = body_len;
+                    return true;
+                }
+                data.set();
+            } else
+                binary_body = false;
+            if (!on_binary_request(context_ref, data))
+                return false;
+            next_size = Memcached::BINARY_HEADER_SIZE;
+            return true;
         }
-        EVO_HELPER_HANDLER_END_DEFCHECK("on_store");
-        return true;
+
+        // Read storage value
+        EVO_PARAM_UNUSED(next_size);
+        data.stripr("\r\n", NEWLINE_LEN, 1);
+        return on_store_request(context_ref, data);
     }
 
     bool on_read(SizeT& fixed_size, AsyncBuffers& buffers, void* context) {
         // New command
         assert( context != NULL );
 
+        if (mode != mTEXT) {
+            if (mode == mUNKNOWN) {
+                // Detect protocol from first byte
+                char ch;
+                if (!buffers.read_peek(ch))
+                    return true;
+                mode = ((uchar)ch == Memcached::bmREQUEST ? mBINARY : mTEXT);
+                if (logger.check(LOG_LEVEL_DEBUG_LOW))
+                    logger.log_direct(LOG_LEVEL_DEBUG_LOW, (mode == mBINARY ? "MemcServer -- binary protocol" : "MemcServer -- text protocol"));
+            }
+            if (mode == mBINARY) {
+                // Binary requests are read as fixed size header then body
+                binary_body = false;
+                return buffers.read_fixed_helper(*this, fixed_size, Memcached::BINARY_HEADER_SIZE, 0, context);
+            }
+        }
+
         DeferredContext& context_ref = *(DeferredContext*)context;
-        ulong expected_deferred_count = context_ref.count();
 
         const char DELIM = ' ';
         String logstr;
@@ -864,6 +1310,7 @@ struct MemcachedServer {
             line.split(' ', command_str, params_str);
             handler.set_id();
             handler.noreply = false;
+            handler.response.reset(HandlerBase::pTEXT);
 
             command = Handler::CommandEnum::get_enum(command_str);
             switch (command) {
@@ -899,6 +1346,7 @@ struct MemcachedServer {
                         handler.send_client_error("Missing parameter, expected key");
                         break;
                     }
+                    storage_params.key.unshare(); // copy key, line is flushed from read buffer before value is read
                     buffers.read_flush();
                     if (handler.noreply)
                         handler.reply.nosend(handler.id);
@@ -926,23 +1374,10 @@ struct MemcachedServer {
                         handler.send_client_error("Missing parameter, expected key");
                         break;
                     }
-                    if (logger.check(LOG_LEVEL_DEBUG))
-                        logger.log_direct(LOG_LEVEL_DEBUG, logstr.set().reserve(42 + key.size()) << "MemcServer on_increment '" << key << "' " << (command == HandlerBase::cDECREMENT ? '-' : '+') << count);
                     if (handler.noreply)
                         handler.reply.nosend(handler.id);
-                    HandlerBase::IncrementResult result = handler.on_increment(context_ref, key, count, (command == HandlerBase::cDECREMENT));
-                    switch (result.type) {
-                        case HandlerBase::rtNORMAL:
-                            if (!result.result.null()) {
-                                StringInt<uint64,NEWLINE_LEN> result_str(*result.result, fDEC, false, NEWLINE_LEN);
-                                result_str.add("\r\n", NEWLINE_LEN);
-                                reply(result_str.data(), result_str.size());
-                            } else
-                                reply("NOT_FOUND\r\n", 11);
-                            break;
-                        EVO_HELPER_HANDLER_CASES("on_increment");
-                    }
-                    EVO_HELPER_HANDLER_END_DEFCHECK("on_increment");
+                    if (!on_increment_request(context_ref, key, count, (command == HandlerBase::cDECREMENT)))
+                        return false;
                     break;
                 }
 
@@ -959,21 +1394,10 @@ struct MemcachedServer {
                         handler.send_client_error("Missing parameter, expected key(s)");
                         break;
                     }
-                    if (logger.check(LOG_LEVEL_DEBUG))
-                        logger.log_direct(LOG_LEVEL_DEBUG, logstr.set().reserve(24 + key.size()) << "MemcServer on_delete '" << key << '\'');
                     if (handler.noreply)
                         handler.reply.nosend(handler.id);
-                    HandlerBase::DeleteResult result = handler.on_delete(context_ref, key);
-                    switch (result.type) {
-                        case HandlerBase::rtNORMAL:
-                            if (result.result == HandlerBase::grOK)
-                                reply("DELETED\r\n", 9);
-                            else
-                                reply("NOT_FOUND\r\n", 11);
-                            break;
-                        EVO_HELPER_HANDLER_CASES("on_delete");
-                    }
-                    EVO_HELPER_HANDLER_END_DEFCHECK("on_delete");
+                    if (!on_delete_request(context_ref, key))
+                        return false;
                     break;
                 }
 
@@ -992,21 +1416,10 @@ struct MemcachedServer {
                         handler.send_client_error("Missing parameter, expected key(s)");
                         break;
                     }
-                    if (logger.check(LOG_LEVEL_DEBUG))
-                        logger.log_direct(LOG_LEVEL_DEBUG, logstr.set().reserve(24 + key.size()) << "MemcServer on_touch '" << key << '\'');
                     if (handler.noreply)
                         handler.reply.nosend(handler.id);
-                    HandlerBase::TouchResult result = handler.on_touch(context_ref, key, expire);
-                    switch (result.type) {
-                        case HandlerBase::rtNORMAL:
-                            if (result.result == HandlerBase::grOK)
-                                reply("TOUCHED\r\n", 9);
-                            else
-                                reply("NOT_FOUND\r\n", 11);
-                            break;
-                        EVO_HELPER_HANDLER_CASES("on_touch");
-                    }
-                    EVO_HELPER_HANDLER_END_DEFCHECK("on_touch");
+                    if (!on_touch_request(context_ref, key, expire))
+                        return false;
                     break;
                 }
 
@@ -1071,59 +1484,204 @@ struct MemcachedServer {
                             logstr << " exp:" << *adv_params.expire;
                         logger.log_direct(LOG_LEVEL_DEBUG_LOW, logstr);
                     }
+                    if (!on_get_request(context_ref, params_str, adv_params_ptr))
+                        return false;
+                    break;
+                }
 
-                    uint deferred = 0;
-                    HandlerBase::GetStartResult result = handler.on_get_start(context_ref, params_str, adv_params_ptr);
-                    switch (result.type) {
-                        case HandlerBase::rtNORMAL:
-                            switch (result.result) {
-                                case HandlerBase::gsrCONTINUE: {
-                                    // Call on_get() for each key
-                                    StrTokWord tok(params_str);
-                                    while (tok.nextw(DELIM)) {
-                                        if (logger.check(LOG_LEVEL_DEBUG))
-                                            logger.log_direct(LOG_LEVEL_DEBUG, logstr.set().reserve(24 + tok.value().size()) << "MemcServer on_get '" << tok.value() << '\'');
-                                        switch (handler.on_get(context_ref, tok.value(), adv_params_ptr)) {
-                                            case HandlerBase::rtNORMAL:   break;
-                                            case HandlerBase::rtHANDLED:  handled = true; break;
-                                            case HandlerBase::rtDEFERRED: ++deferred; EVO_HELPER_HANDLER_DEFCHECK("on_get", " from on_get()"); break;
-                                            default: return false; // rtCLOSE
-                                        }
-                                        EVO_HELPER_HANDLER_END_DEFCHECK("on_get");
-                                        if (handled)
-                                            break;
-                                    }
+                // Meta get
+                case HandlerBase::cMETA_GET: {
+                    handler.response.reset(HandlerBase::pMETA);
+                    StrTokWord tok(params_str);
+                    if (!tok.nextw(DELIM)) {
+                        handler.send_client_error("Missing parameter, expected key");
+                        break;
+                    }
+                    const SubString key(tok.value());
+                    HandlerBase::GetAdvParams adv_params;
+                    bool adv = false;
+                    char unsupported = 0;
+                    while (tok.nextw(DELIM)) {
+                        const SubString& flag = tok.value();
+                        switch (flag.data()[0]) {
+                            case 'v': handler.response.ret_value = true; break;
+                            case 'f': handler.response.ret_flags = true; break;
+                            case 's': handler.response.ret_size  = true; break;
+                            case 'c': adv_params.cas = adv = true; break;
+                            case 'T': adv_params.expire = SubString(flag.data() + 1, flag.size() - 1).getnum<int64>(fDEC); adv = true; break;
+                            case 'b': // fallthrough
+                            case 'N': // fallthrough
+                            case 't': unsupported = flag.data()[0]; break;
+                            default:  meta_common_flag(flag, key); break;
+                        }
+                    }
+                    if (unsupported != 0) {
+                        handler.send_client_error(String().reserve(24) << "Flag not supported: " << unsupported);
+                        break;
+                    }
+                    if ((adv_params.cas && !handler.enable_cas) || (!adv_params.expire.null() && !handler.enable_gat)) {
+                        handler.send_error("Not implemented");
+                        break;
+                    }
+                    if (!on_get_request(context_ref, key, (adv ? &adv_params : NULL)))
+                        return false;
+                    break;
+                }
+
+                // Meta set
+                case HandlerBase::cMETA_SET: {
+                    handler.response.reset(HandlerBase::pMETA);
+                    storage_params.key.set();
+                    storage_params.flags  = 0;
+                    storage_params.expire = 0;
+                    storage_params.size   = 0;
+                    storage_params.cas_id = 0;
+                    command = HandlerBase::cSET;
+
+                    StrTokWord tok(params_str);
+                    bool valid = false, cas = false;
+                    if (tok.nextw(DELIM)) {
+                        storage_params.key = tok.value();
+                        if (tok.nextw(DELIM)) {
+                            storage_params.size = tok.value().getnum<ulong>(fDEC);
+                            valid = true;
+                        }
+                    }
+                    while (tok.nextw(DELIM)) {
+                        const SubString& flag = tok.value();
+                        const SubString flag_value(flag.data() + 1, flag.size() - 1);
+                        switch (flag.data()[0]) {
+                            case 'F': storage_params.flags  = flag_value.getnum<uint32>(fDEC); break;
+                            case 'T': storage_params.expire = flag_value.getnum<int64>(fDEC);  break;
+                            case 'C': storage_params.cas_id = flag_value.getnum<uint64>(fDEC); cas = true; break;
+                            case 'M':
+                                switch (flag_value.size() > 0 ? flag_value.data()[0] : 'S') {
+                                    case 'E': case 'e': command = HandlerBase::cADD;     break;
+                                    case 'A': case 'a': command = HandlerBase::cAPPEND;  break;
+                                    case 'P': case 'p': command = HandlerBase::cPREPEND; break;
+                                    case 'R': case 'r': command = HandlerBase::cREPLACE; break;
+                                    case 'S': case 's': command = HandlerBase::cSET;     break;
+                                    default: valid = false; break;
                                 }
-                                case HandlerBase::gsrSKIP:
-                                    break;
-                            }
-                            break;
-                        case HandlerBase::rtDEFERRED: ++deferred; EVO_HELPER_HANDLER_DEFCHECK("on_get", " from on_get_start()"); break;
-                        case HandlerBase::rtHANDLED:  handled = true; break;
-                        default: return false; // rtCLOSE
+                                break;
+                            case 'b': valid = false; break;
+                            default:  meta_common_flag(flag, storage_params.key); break;
+                        }
+                    }
+                    if (!valid) {
+                        handler.send_client_error("bad command line format");
+                        break;
                     }
-                    EVO_HELPER_HANDLER_END_DEFCHECK("on_get_start");
-
-                    if (!handled) {
-                        switch (handler.on_get_end(context_ref)) {
-                            case HandlerBase::rtNORMAL:   break;
-                            case HandlerBase::rtHANDLED:  handled = true; break;
-                            case HandlerBase::rtDEFERRED: ++deferred; EVO_HELPER_HANDLER_DEFCHECK("on_get", " from on_get_end()"); break;
-                            default: return false; // rtCLOSE
+                    if (cas && command == HandlerBase::cSET) {
+                        if (!handler.enable_cas) {
+                            handler.send_error("Not implemented");
+                            break;
                         }
-                        EVO_HELPER_HANDLER_END_DEFCHECK("on_get_end");
+                        command = HandlerBase::cCAS;
+                    }
+                    storage_params.key.unshare(); // copy key, line is flushed from read buffer before value is read
+                    buffers.read_flush();
 
-                        if (!handled && deferred == 0) {
-                            String buf("END\r\n", 5);
-                            handler.reply.send(handler.id, buf);
-                            handler.reply.send_end();
+                    if (!buffers.read_fixed_helper(*this, fixed_size, storage_params.size + NEWLINE_LEN, 0, context))
+                        return false;
+                    if (fixed_size > 0)
+                        return true;
+                    continue; // next command (while loop at top)
+                }
+
+                // Meta delete
+                case HandlerBase::cMETA_DELETE: {
+                    handler.response.reset(HandlerBase::pMETA);
+                    StrTokWord tok(params_str);
+                    if (!tok.nextw(DELIM)) {
+                        handler.send_client_error("Missing parameter, expected key");
+                        break;
+                    }
+                    const SubString key(tok.value());
+                    while (tok.nextw(DELIM))
+                        meta_common_flag(tok.value(), key);
+                    if (!on_delete_request(context_ref, key))
+                        return false;
+                    break;
+                }
+
+                // Meta arithmetic
+                case HandlerBase::cMETA_ARITHMETIC: {
+                    handler.response.reset(HandlerBase::pMETA);
+                    StrTokWord tok(params_str);
+                    if (!tok.nextw(DELIM)) {
+                        handler.send_client_error("Missing parameter, expected key");
+                        break;
+                    }
+                    const SubString key(tok.value());
+                    HandlerBase::IncrementAdvParams adv_params;
+                    HandlerBase::IncrementAdvParams* adv_params_ptr = NULL;
+                    uint64 count = 1;
+                    bool decrement = false, valid = true;
+                    while (tok.nextw(DELIM)) {
+                        const SubString& flag = tok.value();
+                        const SubString flag_value(flag.data() + 1, flag.size() - 1);
+                        switch (flag.data()[0]) {
+                            case 'v': handler.response.ret_value = true; break;
+                            case 'D': count = flag_value.getnum<uint64>(fDEC); break;
+                            case 'J': adv_params.initial = flag_value.getnum<uint64>(fDEC); break;
+                            case 'N':
+                                adv_params.expire = flag_value.getnum<int64>(fDEC);
+                                adv_params_ptr = &adv_params;
+                                break;
+                            case 'M':
+                                switch (flag_value.size() > 0 ? flag_value.data()[0] : 'I') {
+                                    case 'I': case 'i': case '+': decrement = false; break;
+                                    case 'D': case 'd': case '-': decrement = true;  break;
+                                    default: valid = false; break;
+                                }
+                                break;
+                            case 'b': valid = false; break;
+                            default:  meta_common_flag(flag, key); break;
                         }
                     }
+                    if (!valid) {
+                        handler.send_client_error("bad command line format");
+                        break;
+                    }
+                    if (!on_increment_request(context_ref, key, count, decrement, adv_params_ptr))
+                        return false;
+                    break;
+                }
+
+                // Meta no-op
+                case HandlerBase::cMETA_NOOP:
+                    handler.response.reset(HandlerBase::pMETA);
+                    reply_status(HandlerBase::rsNOOP);
+                    break;
+
+                // Flush
+                case HandlerBase::cFLUSH_ALL: {
+                    ulong delay_sec = 0;
+                    StrTokWord tok(params_str);
+                    while (tok.nextw(DELIM)) {
+                        if (tok.value() == "noreply")
+                            handler.noreply = true;
+                        else
+                            delay_sec = tok.value().getnum<ulong>(fDEC);
+                    }
+                    if (logger.check(LOG_LEVEL_DEBUG))
+                        logger.log_direct(LOG_LEVEL_DEBUG, logstr.set().reserve(40) << "MemcServer on_flush_all " << delay_sec);
+                    if (handler.noreply)
+                        handler.reply.nosend(handler.id);
+                    handler.on_flush_all(delay_sec);
+                    reply("OK\r\n", 4);
                     break;
                 }
 
                 // Misc
                 case HandlerBase::cSTATS: handler.on_stats(params_str); break;
+                case HandlerBase::cVERSION: {
+                    String version;
+                    handler.on_version(version);
+                    handler.send_reply(String().reserve(8 + version.size()) << "VERSION " << version);
+                    break;
+                }
                 case HandlerBase::cQUIT:  return false;
 
                 // Unknown
@@ -1145,13 +1703,373 @@ struct MemcachedServer {
         handler.on_error(err);
     }
 
-    #undef EVO_HELPER_HANDLER_END_DEFCHECK
-    #undef EVO_HELPER_HANDLER_CASES
-    #undef EVO_HELPER_HANDLER_DEFCHECK
-
 private:
+    // Connection protocol mode, detected from first request
+    enum Mode {
+        mUNKNOWN = 0,
+        mTEXT,
+        mBINARY
+    };
+
     HandlerBase::Command     command;
     HandlerBase::StoreParams storage_params;
+    Mode mode;
+    bool binary_body;                                   // whether next binary fixed read is request body, otherwise header
+    char binary_header[Memcached::BINARY_HEADER_SIZE];  // current binary request header
+
+    // Store request: on_read_fixed() with value, command and storage_params
+    bool on_store_request(DeferredContext& context_ref, SubString& data) {
+        ulong expected_deferred_count = context_ref.count();
+        String logstr;
+        if (logger.check(LOG_LEVEL_DEBUG)) {
+            logstr.set().reserve(96 + storage_params.key.size())
+                << "MemcServer on_store " << HandlerBase::CommandEnum::get_string(command)
+                << " '" << storage_params.key << "' fl:" << storage_params.flags << " exp:" << storage_params.expire;
+            if (command == HandlerBase::cCAS)
+                logstr << " id:" << storage_params.cas_id;
+            logstr << " (size: " << storage_params.size << ')';
+            logger.log_direct(LOG_LEVEL_DEBUG, logstr);
+        }
+
+        HandlerBase::StoreResult result = handler.on_store(context_ref, storage_params, data, command, storage_params.cas_id);
+        switch (result.type) {
+            case HandlerBase::rtNORMAL:
+                switch (result.result) {
+                    case Memcached::srSTORED:     reply_result(HandlerBase::rsOK,         "STORED\r\n", 8);      break;
+                    case Memcached::srNOT_STORED: reply_result(HandlerBase::rsNOT_STORED, "NOT_STORED\r\n", 12); break;
+                    case Memcached::srEXISTS:     reply_result(HandlerBase::rsEXISTS,     "EXISTS\r\n", 8);      break;
+                    case Memcached::srNOT_FOUND:  reply_result(HandlerBase::rsNOT_FOUND,  "NOT_FOUND\r\n", 11);  break;
+                    default:
+                        if (logger.check(LOG_LEVEL_ERROR))
+                            logger.log_direct(LOG_LEVEL_ERROR, logstr.set().reserve(56) << "MemcServer on_store error: Invalid handler result: " << (int)result.result);
+                        return false; // invalid result, close connection
+                }
+                break;
+            EVO_HELPER_HANDLER_CASES("on_store");
+        }
+        EVO_HELPER_HANDLER_END_DEFCHECK("on_store");
+        return true;
+    }
+
+    // Increment/decrement request
+    bool on_increment_request(DeferredContext& context_ref, const SubString& key, uint64 count, bool decrement, HandlerBase::IncrementAdvParams* adv_params_ptr=NULL) {
+        ulong expected_deferred_count = context_ref.count();
+        if (logger.check(LOG_LEVEL_DEBUG))
+            logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(42 + key.size()) << "MemcServer on_increment '" << key << "' " << (decrement ? '-' : '+') << count);
+        HandlerBase::IncrementResult result = static_cast<HandlerBase&>(handler).on_increment(context_ref, key, count, decrement, adv_params_ptr);
+        switch (result.type) {
+            case HandlerBase::rtNORMAL:
+                if (handler.response.protocol != HandlerBase::pTEXT) {
+                    if (result.result.null()) {
+                        reply_status(HandlerBase::rsNOT_FOUND);
+                    } else {
+                        String buf;
+                        HandlerBase::format_number(buf, handler.response, *result.result);
+                        reply_buf(buf);
+                    }
+                } else if (!result.result.null()) {
+                    StringInt<uint64,NEWLINE_LEN> result_str(*result.result, fDEC, false, NEWLINE_LEN);
+                    result_str.add("\r\n", NEWLINE_LEN);
+                    reply(result_str.data(), result_str.size());
+                } else
+                    reply("NOT_FOUND\r\n", 11);
+                break;
+            EVO_HELPER_HANDLER_CASES("on_increment");
+        }
+        EVO_HELPER_HANDLER_END_DEFCHECK("on_increment");
+        return true;
+    }
+
+    // Delete request
+    bool on_delete_request(DeferredContext& context_ref, const SubString& key) {
+        ulong expected_deferred_count = context_ref.count();
+        if (logger.check(LOG_LEVEL_DEBUG))
+            logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(24 + key.size()) << "MemcServer on_delete '" << key << '\'');
+        HandlerBase::DeleteResult result = handler.on_delete(context_ref, key);
+        switch (result.type) {
+            case HandlerBase::rtNORMAL:
+                if (result.result == HandlerBase::grOK)
+                    reply_result(HandlerBase::rsOK, "DELETED\r\n", 9);
+                else
+                    reply_result(HandlerBase::rsNOT_FOUND, "NOT_FOUND\r\n", 11);
+                break;
+            EVO_HELPER_HANDLER_CASES("on_delete");
+        }
+        EVO_HELPER_HANDLER_END_DEFCHECK("on_delete");
+        return true;
+    }
+
+    // Touch request
+    bool on_touch_request(DeferredContext& context_ref, const SubString& key, int64 expire) {
+        ulong expected_deferred_count = context_ref.count();
+        if (logger.check(LOG_LEVEL_DEBUG))
+            logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(24 + key.size()) << "MemcServer on_touch '" << key << '\'');
+        HandlerBase::TouchResult result = handler.on_touch(context_ref, key, expire);
+        switch (result.type) {
+            case HandlerBase::rtNORMAL:
+                if (result.result == HandlerBase::grOK)
+                    reply_result(HandlerBase::rsOK, "TOUCHED\r\n", 9);
+                else
+                    reply_result(HandlerBase::rsNOT_FOUND, "NOT_FOUND\r\n", 11);
+                break;
+            EVO_HELPER_HANDLER_CASES("on_touch");
+        }
+        EVO_HELPER_HANDLER_END_DEFCHECK("on_touch");
+        return true;
+    }
+
+    // Get request for one or more keys (text protocol), or one key (meta and binary protocols)
+    bool on_get_request(DeferredContext& context_ref, const SubString& keys, HandlerBase::GetAdvParams* adv_params_ptr) {
+        const char DELIM = ' ';
+        ulong expected_deferred_count = context_ref.count();
+        bool handled  = false;
+        uint deferred = 0;
+        HandlerBase::GetStartResult result = handler.on_get_start(context_ref, keys, adv_params_ptr);
+        switch (result.type) {
+            case HandlerBase::rtNORMAL:
+                switch (result.result) {
+                    case HandlerBase::gsrCONTINUE: {
+                        // Call on_get() for each key
+                        StrTokWord tok(keys);
+                        while (tok.nextw(DELIM)) {
+                            if (logger.check(LOG_LEVEL_DEBUG))
+                                logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(24 + tok.value().size()) << "MemcServer on_get '" << tok.value() << '\'');
+                            switch (handler.on_get(context_ref, tok.value(), adv_params_ptr)) {
+                                case HandlerBase::rtNORMAL:   break;
+                                case HandlerBase::rtHANDLED:  handled = true; break;
+                                case HandlerBase::rtDEFERRED: ++deferred; EVO_HELPER_HANDLER_DEFCHECK("on_get", " from on_get()"); break;
+                                default: return false; // rtCLOSE
+                            }
+                            EVO_HELPER_HANDLER_END_DEFCHECK("on_get");
+                            if (handled)
+                                break;
+                        }
+                    }
+                    case HandlerBase::gsrSKIP:
+                        break;
+                }
+                break;
+            case HandlerBase::rtDEFERRED: ++deferred; EVO_HELPER_HANDLER_DEFCHECK("on_get", " from on_get_start()"); break;
+            case HandlerBase::rtHANDLED:  handled = true; break;
+            default: return false; // rtCLOSE
+        }
+        EVO_HELPER_HANDLER_END_DEFCHECK("on_get_start");
+
+        if (!handled) {
+            switch (handler.on_get_end(context_ref)) {
+                case HandlerBase::rtNORMAL:   break;
+                case HandlerBase::rtHANDLED:  handled = true; break;
+                case HandlerBase::rtDEFERRED: ++deferred; EVO_HELPER_HANDLER_DEFCHECK("on_get", " from on_get_end()"); break;
+                default: return false; // rtCLOSE
+            }
+            EVO_HELPER_HANDLER_END_DEFCHECK("on_get_end");
+
+            if (!handled && deferred == 0) {
+                if (handler.response.protocol == HandlerBase::pTEXT) {
+                    String buf("END\r\n", 5);
+                    handler.reply.send(handler.id, buf);
+                    handler.reply.send_end();
+                } else if (handler.response.found)
+                    handler.reply.send_end();
+                else
+                    reply_status(HandlerBase::rsMISS);
+            }
+        }
+        return true;
+    }
+
+    // Binary protocol request, header in binary_header
+    bool on_binary_request(DeferredContext& context_ref, const SubString& body) {
+        const uint   opcode     = (uchar)binary_header[1];
+        const uint   key_len    = impl_memc::get_be16(binary_header + 2);
+        const uint   extras_len = (uchar)binary_header[4];
+        const uint64 cas        = impl_memc::get_be64(binary_header + 16);
+        if (key_len + extras_len > body.size()) {
+            logger.log(LOG_LEVEL_ERROR, "MemcServer binary error: Invalid request lengths");
+            return false; // close connection
+        }
+        const char* extras = body.data();
+        SubString key(body.data() + extras_len, key_len);
+        SubString value(key.data() + key_len, body.size() - extras_len - key_len);
+
+        handler.set_id();
+        handler.noreply = false;
+        handler.response.reset(HandlerBase::pBINARY);
+        handler.response.opcode = opcode;
+        handler.response.opaque = impl_memc::get_be32(binary_header + 12);
+        if (logger.check(LOG_LEVEL_DEBUG_LOW))
+            logger.log_direct(LOG_LEVEL_DEBUG_LOW, String().reserve(48 + key.size()) << "MemcServer binary opcode:" << opcode << " key:'" << key << '\'');
+
+        switch (opcode) {
+            // Get
+            case Memcached::boGETQ:   case Memcached::boGETKQ: case Memcached::boGATQ: case Memcached::boGATKQ:
+                handler.response.quiet = true;  // fallthrough
+            case Memcached::boGET:    case Memcached::boGETK:  case Memcached::boGAT:  case Memcached::boGATK: {
+                HandlerBase::GetAdvParams adv_params;
+                HandlerBase::GetAdvParams* adv_params_ptr = NULL;
+                if (key.empty()) {
+                    handler.send_client_error("Missing key");
+                    break;
+                }
+                if (opcode >= Memcached::boGAT) {
+                    if (!handler.enable_gat) {
+                        handler.send_error("Not implemented");
+                        break;
+                    }
+                    if (extras_len != 4) {
+                        handler.send_client_error("Invalid extras");
+                        break;
+                    }
+                    adv_params.expire = (int64)impl_memc::get_be32(extras);
+                    adv_params_ptr = &adv_params;
+                }
+                if (handler.enable_cas) {
+                    adv_params.cas = true;
+                    adv_params_ptr = &adv_params;
+                }
+                if (opcode == Memcached::boGETK || opcode == Memcached::boGETKQ || opcode == Memcached::boGATK || opcode == Memcached::boGATKQ)
+                    handler.response.key.copy(key.data(), key.size());
+                if (!on_get_request(context_ref, key, adv_params_ptr))
+                    return false;
+                break;
+            }
+
+            // Storage
+            case Memcached::boSETQ:     case Memcached::boADDQ:   case Memcached::boREPLACEQ:
+            case Memcached::boAPPENDQ:  case Memcached::boPREPENDQ:
+                handler.response.quiet = true;  // fallthrough
+            case Memcached::boSET:      case Memcached::boADD:    case Memcached::boREPLACE:
+            case Memcached::boAPPEND:   case Memcached::boPREPEND: {
+                storage_params.key    = key;
+                storage_params.flags  = 0;
+                storage_params.expire = 0;
+                storage_params.size   = value.size();
+                storage_params.cas_id = cas;
+                switch (opcode) {
+                    case Memcached::boSET:     case Memcached::boSETQ:     command = (cas != 0 ? HandlerBase::cCAS : HandlerBase::cSET); break;
+                    case Memcached::boADD:     case Memcached::boADDQ:     command = HandlerBase::cADD;     break;
+                    case Memcached::boREPLACE: case Memcached::boREPLACEQ: command = HandlerBase::cREPLACE; break;
+                    case Memcached::boAPPEND:  case Memcached::boAPPENDQ:  command = HandlerBase::cAPPEND;  break;
+                    default:                                               command = HandlerBase::cPREPEND; break;
+                }
+                if (key.empty() || extras_len != (command == HandlerBase::cAPPEND || command == HandlerBase::cPREPEND ? 0U : 8U)) {
+                    handler.send_client_error("Invalid arguments");
+                    break;
+                }
+                if (command == HandlerBase::cCAS && !handler.enable_cas) {
+                    handler.send_error("Not implemented");
+                    break;
+                }
+                if (extras_len == 8) {
+                    storage_params.flags  = impl_memc::get_be32(extras);
+                    storage_params.expire = (int64)impl_memc::get_be32(extras + 4);
+                }
+                if (!on_store_request(context_ref, value))
+                    return false;
+                break;
+            }
+
+            // Increment
+            case Memcached::boINCREMENTQ: case Memcached::boDECREMENTQ:
+                handler.response.quiet = true;  // fallthrough
+            case Memcached::boINCREMENT:  case Memcached::boDECREMENT:
+                if (key.empty() || extras_len != 20) {
+                    handler.send_client_error("Invalid arguments");
+                    break;
+                } else {
+                    // Extras: delta, initial value, expiration -- expiration 0xFFFFFFFF means don't create if not found
+                    const uint32 expire = impl_memc::get_be32(extras + 16);
+                    HandlerBase::IncrementAdvParams adv_params;
+                    HandlerBase::IncrementAdvParams* adv_params_ptr = NULL;
+                    if (expire != 0xFFFFFFFF) {
+                        adv_params.initial = impl_memc::get_be64(extras + 8);
+                        adv_params.expire  = (int64)expire;
+                        adv_params_ptr = &adv_params;
+                    }
+                    if (!on_increment_request(context_ref, key, impl_memc::get_be64(extras), (opcode == Memcached::boDECREMENT || opcode == Memcached::boDECREMENTQ), adv_params_ptr))
+                        return false;
+                }
+                break;
+
+            // Delete
+            case Memcached::boDELETEQ:
+                handler.response.quiet = true;  // fallthrough
+            case Memcached::boDELETE:
+                if (key.empty()) {
+                    handler.send_client_error("Missing key");
+                    break;
+                }
+                if (!on_delete_request(context_ref, key))
+                    return false;
+                break;
+
+            // Touch
+            case Memcached::boTOUCH:
+                if (key.empty() || extras_len != 4) {
+                    handler.send_client_error("Invalid arguments");
+                    break;
+                }
+                if (!on_touch_request(context_ref, key, (int64)impl_memc::get_be32(extras)))
+                    return false;
+                break;
+
+            // Flush
+            case Memcached::boFLUSHQ:
+                handler.response.quiet = true;  // fallthrough
+            case Memcached::boFLUSH: {
+                const ulong delay_sec = (extras_len == 4 ? impl_memc::get_be32(extras) : 0);
+                if (logger.check(LOG_LEVEL_DEBUG))
+                    logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(40) << "MemcServer on_flush_all " << delay_sec);
+                handler.on_flush_all(delay_sec);
+                reply_status(HandlerBase::rsOK);
+                break;
+            }
+
+            // Misc
+            case Memcached::boNOOP:
+                reply_status(HandlerBase::rsNOOP);
+                break;
+            case Memcached::boVERSION: {
+                String version, buf;
+                handler.on_version(version);
+                HandlerBase::format_binary_header(buf, handler.response, Memcached::bsNO_ERROR, 0, 0, version.size(), 0);
+                buf << version;
+                reply_buf(buf);
+                break;
+            }
+            case Memcached::boSTAT: {
+                // Stats are sent with send_stat(), then terminated with an empty stat
+                SubString params(key);
+                handler.on_stats(params);
+                String buf;
+                HandlerBase::format_binary_header(buf, handler.response, Memcached::bsNO_ERROR, 0, 0, 0, 0);
+                reply_buf(buf);
+                break;
+            }
+            case Memcached::boQUIT:
+            case Memcached::boQUITQ:
+                return false;
+
+            // Unknown
+            default: {
+                String buf;
+                HandlerBase::format_binary_error(buf, handler.response, Memcached::bsUNKNOWN_COMMAND, "Unknown command");
+                reply_buf(buf);
+                break;
+            }
+        }
+        return true;
+    }
+
+    // Handle meta flag common to all meta commands: quiet, opaque token, return key
+    void meta_common_flag(const SubString& flag, const SubString& key) {
+        switch (flag.data()[0]) {
+            case 'q': handler.response.quiet = true; break;
+            case 'O': handler.response.token.copy(flag.data() + 1, flag.size() - 1); break;
+            case 'k': handler.response.key.copy(key.data(), key.size()); break;
+            default: break; // ignore unsupported flags
+        }
+    }
 
     // String literals only
     void reply(const char* data, StrSizeT size) {
@@ -1161,6 +2079,35 @@ private:
             handler.reply.send_end();
         }
     }
+
+    // Reply with text literal, or status for meta and binary protocols
+    void reply_result(HandlerBase::ResponseStatus status, const char* data, StrSizeT size) {
+        if (handler.response.protocol == HandlerBase::pTEXT)
+            reply(data, size);
+        else
+            reply_status(status);
+    }
+
+    // Reply with status for meta and binary protocols
+    void reply_status(HandlerBase::ResponseStatus status) {
+        String buf;
+        HandlerBase::format_status(buf, handler.response, status);
+        reply_buf(buf);
+    }
+
+    // Reply with formatted response for meta and binary protocols, empty for no response (quiet mode)
+    void reply_buf(String& buf) {
+        if (buf.empty()) {
+            handler.reply.nosend(handler.id);
+        } else {
+            handler.reply.send(handler.id, buf);
+            handler.reply.send_end();
+        }
+    }
+
+    #undef EVO_HELPER_HANDLER_END_DEFCHECK
+    #undef EVO_HELPER_HANDLER_CASES
+    #undef EVO_HELPER_HANDLER_DEFCHECK
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,921 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file memcached_store.h Evo Async Memached API, server storage engine. */
+#pragma once
+#ifndef INCL_evo_api_memcached_store_h
+#define INCL_evo_api_memcached_store_h
+
+#include "memcached_server.h"
+#include "../maphashflat.h"
+#include "../sharedstring.h"
+#include "../thread.h"
+#include "../impl/systime.h"
+
+namespace evo {
+namespace async {
+/** \addtogroup EvoAsyncAPI */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Concurrent in-memory storage engine for a %Memcached server.
+ - This implements all %Memcached storage commands, and is used by MemcachedStoreHandler, or a custom handler can delegate to this
+   - Storage commands: store() (set, add, replace, append, prepend, cas), increment(), remove(), touch(), flush_all()
+   - Retrieval: get() and get_touch() either copy the value out to a String, or reference it without copying with a SharedString
+     - Stored values are immutable SharedString buffers with an atomic reference count, a change replaces the buffer, so a referenced value stays valid and unchanged after the store is modified by another thread
+ - Keys are spread across shards by hash, each shard has its own lock (lock striping) so threads rarely contend
+   - This is thread safe and can be shared by all server threads -- see AsyncServer::run_threads()
+ - Memory is limited by `max_memory`, split evenly across shards -- storing a value evicts older values as needed
+   - Eviction uses the CLOCK (second chance) algorithm: reading a value marks it as referenced, and referenced values get a second chance before being evicted
+   - Memory use is estimated from key and value sizes plus a fixed per-item overhead
+   - Values larger than a shard memory limit can't be stored
+ - Expiration times follow the %Memcached protocol (seconds from now, or a Unix timestamp if over 30 days)
+   - Expired values are removed lazily when accessed, and in the background by purge_expired() -- see start_purge_thread()
+ - Each stored value gets a unique CAS ID for %Compare And Swap
+ .
+
+\par Example
+
+\code
+#include <evo/async/memcached_store.h>
+using namespace evo;
+
+int main() {
+    async::MemcachedStore store(4, 16777216); // 4 shards, 16 MB
+
+    async::MemcachedServerHandlerBase::StoreParams params;
+    params.key = "foo";
+    params.expire = 60;
+    store.store(params, "bar", async::MemcachedServerHandlerBase::cSET);
+
+    String value;
+    uint32 flags;
+    uint64 cas_id;
+    if (store.get("foo", value, flags, cas_id))
+        con().out << value << NL;
+    return 0;
+}
+\endcode
+*/
+class MemcachedStore {
+public:
+    typedef MemcachedServerHandlerBase::Command     Command;        ///< Alias for MemcachedServerHandlerBase::Command
+    typedef MemcachedServerHandlerBase::StoreParams StoreParams;    ///< Alias for MemcachedServerHandlerBase::StoreParams
+    typedef MemcachedServerHandlerBase::IncrementAdvParams IncrementAdvParams;  ///< Alias for MemcachedServerHandlerBase::IncrementAdvParams
+
+    static const uint   DEFAULT_SHARDS            = 16;         ///< Default number of shards
+    static const ulongl DEFAULT_MAX_MEMORY        = 67108864;   ///< Default max memory in bytes (64 MB)
+    static const ulong  DEFAULT_PURGE_INTERVAL_MS = 1000;       ///< Default interval between background purges in milliseconds
+    static const int64  MAX_RELATIVE_EXPIRE       = 2592000;    ///< Max relative expiration time in seconds (30 days), larger values are a Unix timestamp
+
+    /** Storage statistics, summed from all shards. */
+    struct Stats {
+        ulongl items;           ///< Current item count
+        ulongl bytes;           ///< Current memory use estimate in bytes
+        ulongl max_memory;      ///< Max memory in bytes
+        ulongl total_items;     ///< Total items stored
+        ulongl get_hits;        ///< Number of get requests where key was found
+        ulongl get_misses;      ///< Number of get requests where key wasn't found
+        ulongl evictions;       ///< Number of valid items evicted to free memory
+        ulongl expired;         ///< Number of expired items removed (lazily or by purge)
+
+        /** Constructor. */
+        Stats() : items(0), bytes(0), max_memory(0), total_items(0), get_hits(0), get_misses(0), evictions(0), expired(0) {
+        }
+    };
+
+    /** Constructor.
+     \param  shards      Number of shards to use, rounded up to a power of 2
+     \param  max_memory  Max memory to use in bytes, split evenly across shards
+    */
+    MemcachedStore(uint shards=DEFAULT_SHARDS, ulongl max_memory=DEFAULT_MAX_MEMORY) : shards_(NULL), shard_count_(0), max_memory_(max_memory), purge_thread_(purge_thread, this), purge_interval_ms_(DEFAULT_PURGE_INTERVAL_MS), purge_stop_(false) {
+        init(shards);
+    }
+
+    /** Destructor, stops purge thread (if started) and frees all items. */
+    ~MemcachedStore() {
+        stop_purge_thread();
+        delete [] shards_;
+    }
+
+    /** %Set number of shards to use.
+     - This removes all items, and should be called before the store is used by other threads
+     .
+     \param  shards  Number of shards to use, rounded up to a power of 2
+     \return         This
+    */
+    MemcachedStore& set_shards(uint shards) {
+        init(shards);
+        return *this;
+    }
+
+    /** Get number of shards used.
+     \return  Shard count
+    */
+    uint get_shards() const {
+        return shard_count_;
+    }
+
+    /** %Set max memory to use.
+     - This is split evenly across shards
+     - If lowered, items are evicted as needed on next store in each shard
+     - This should be called before the store is used by other threads
+     .
+     \param  max_memory  Max memory to use in bytes
+     \return             This
+    */
+    MemcachedStore& set_max_memory(ulongl max_memory) {
+        max_memory_ = max_memory;
+        const ulongl shard_limit = max_memory / shard_count_;
+        for (uint i = 0; i < shard_count_; ++i) {
+            Mutex::Lock lock(shards_[i].mutex);
+            shards_[i].limit = shard_limit;
+        }
+        return *this;
+    }
+
+    /** Get max memory limit.
+     \return  Max memory in bytes
+    */
+    ulongl get_max_memory() const {
+        return max_memory_;
+    }
+
+    /** Store value using given command.
+     - How to store depends on the command:
+       - cSET:      Store new value, replace if already exists
+       - cAPPEND:   Append to existing value, ignores `params.flags` and `params.expire`
+       - cPREPEND:  Prepend to existing value, ignores `params.flags` and `params.expire`
+       - cADD:      Store new value, only if key doesn't already exist
+       - cREPLACE:  Store new value, only if key already exists
+       - cCAS:      Store new value, only if CAS ID still matches
+       .
+     - A negative expiration time expires the value immediately, so any existing value is removed
+     .
+     \param  params   Store parameters to use
+     \param  value    Value to store
+     \param  command  Store command to use
+     \param  cas_id      %Compare And Swap ID from previous get (cCAS only)
+     \param  new_cas_id  Stores new CAS ID of stored value, if stored and not expired immediately -- NULL to ignore  [out]
+     \return          Store result:
+                       - `Memcached::srSTORED` if stored
+                       - `Memcached::srNOT_STORED` if not stored due to unmet condition (cADD, cREPLACE, cAPPEND, cPREPEND)
+                       - `Memcached::srEXISTS` if CAS ID doesn't match (cCAS only)
+                       - `Memcached::srNOT_FOUND` if key not found (cCAS only)
+                       - `Memcached::srUNKNOWN` if value is too large to store, or command isn't a store command
+    */
+    Memcached::StoreResult store(const StoreParams& params, const SubString& value, Command command, uint64 cas_id=0, uint64* new_cas_id=NULL) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(params.key);
+        Mutex::Lock lock(shard.mutex);
+
+        Item* item = find(shard, params.key, now);
+        switch (command) {
+            case MemcachedServerHandlerBase::cSET:
+                break;
+            case MemcachedServerHandlerBase::cADD:
+                if (item != NULL)
+                    return Memcached::srNOT_STORED;
+                break;
+            case MemcachedServerHandlerBase::cREPLACE:
+                if (item == NULL)
+                    return Memcached::srNOT_STORED;
+                break;
+            case MemcachedServerHandlerBase::cCAS:
+                if (item == NULL)
+                    return Memcached::srNOT_FOUND;
+                if (item->cas_id != cas_id)
+                    return Memcached::srEXISTS;
+                break;
+            case MemcachedServerHandlerBase::cAPPEND:
+            case MemcachedServerHandlerBase::cPREPEND: {
+                if (item == NULL)
+                    return Memcached::srNOT_STORED;
+                const ulongl new_size = item_size(item->key.size(), item->value.size() + value.size());
+                if (new_size > shard.limit)
+                    return Memcached::srUNKNOWN;
+                String new_value;
+                new_value.reserve(item->value.size() + value.size());
+                if (command == MemcachedServerHandlerBase::cAPPEND)
+                    new_value.add(item->value.data(), item->value.size()).add(value.data(), value.size());
+                else
+                    new_value.add(value.data(), value.size()).add(item->value.data(), item->value.size());
+                update_value(shard, item, new_value, now);
+                item->cas_id = shard.next_cas();
+                if (new_cas_id != NULL)
+                    *new_cas_id = item->cas_id;
+                evict(shard, now, item);
+                ++shard.total_items;
+                return Memcached::srSTORED;
+            }
+            default:
+                return Memcached::srUNKNOWN;
+        }
+
+        const int64 expire = get_expire_time(params.expire, now);
+        if (expire < 0) {
+            // Expire immediately
+            if (item != NULL)
+                remove_item(shard, item);
+            return Memcached::srSTORED;
+        }
+
+        const ulongl size = item_size(params.key.size(), value.size());
+        if (size > shard.limit)
+            return Memcached::srUNKNOWN;
+
+        if (item == NULL) {
+            item = add_item(shard, params.key, value, size);
+        } else {
+            String new_value;
+            new_value.copy(value.data(), value.size());
+            update_value(shard, item, new_value, now);
+            item->ref = false;
+        }
+        item->flags  = params.flags;
+        item->expire = expire;
+        item->time   = now;
+        item->cas_id = shard.next_cas();
+        if (new_cas_id != NULL)
+            *new_cas_id = item->cas_id;
+        evict(shard, now, item);
+        ++shard.total_items;
+        return Memcached::srSTORED;
+    }
+
+    /** Get value for key.
+     - This copies the stored value, so the result is safe to use after the store is modified by another thread
+     .
+     \param  key     Key to get
+     \param  value   Stores copied value, unchanged if not found  [out]
+     \param  flags   Stores user flags stored with value  [out]
+     \param  cas_id  Stores CAS ID for value  [out]
+     \return         Whether found, false if not found or expired
+    */
+    bool get(const SubString& key, String& value, uint32& flags, uint64& cas_id) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(key);
+        Mutex::Lock lock(shard.mutex);
+        return get_item(shard, key, value, flags, cas_id, now, NULL);
+    }
+
+    /** Get value for key without copying.
+     - This references the stored value buffer, which is immutable, so the result is safe to use (and pass to other threads) after the store is modified by another thread
+     - Use this to send large values without copying -- see MemcachedServerHandlerBase::send_value_ref()
+     .
+     \param  key     Key to get
+     \param  value   Stores reference to value, unchanged if not found  [out]
+     \param  flags   Stores user flags stored with value  [out]
+     \param  cas_id  Stores CAS ID for value  [out]
+     \return         Whether found, false if not found or expired
+    */
+    bool get(const SubString& key, SharedString& value, uint32& flags, uint64& cas_id) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(key);
+        Mutex::Lock lock(shard.mutex);
+        return get_item(shard, key, value, flags, cas_id, now, NULL);
+    }
+
+    /** Get value for key and update expiration time.
+     - This is used with "get and touch" (GAT) requests
+     - This copies the stored value, so the result is safe to use after the store is modified by another thread
+     .
+     \param  key     Key to get
+     \param  value   Stores copied value, unchanged if not found  [out]
+     \param  flags   Stores user flags stored with value  [out]
+     \param  cas_id  Stores CAS ID for value  [out]
+     \param  expire  New expiration time in seconds from now, 0 for no expiration, negative to expire now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
+     \return         Whether found, false if not found or expired
+    */
+    bool get_touch(const SubString& key, String& value, uint32& flags, uint64& cas_id, int64 expire) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(key);
+        Mutex::Lock lock(shard.mutex);
+        return get_item(shard, key, value, flags, cas_id, now, &expire);
+    }
+
+    /** Get value for key without copying, and update expiration time.
+     - This is the same as get_touch(const SubString&,String&,uint32&,uint64&,int64) except the value is referenced instead of copied -- see get(const SubString&,SharedString&,uint32&,uint64&)
+     .
+     \param  key     Key to get
+     \param  value   Stores reference to value, unchanged if not found  [out]
+     \param  flags   Stores user flags stored with value  [out]
+     \param  cas_id  Stores CAS ID for value  [out]
+     \param  expire  New expiration time in seconds from now, 0 for no expiration, negative to expire now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
+     \return         Whether found, false if not found or expired
+    */
+    bool get_touch(const SubString& key, SharedString& value, uint32& flags, uint64& cas_id, int64 expire) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(key);
+        Mutex::Lock lock(shard.mutex);
+        return get_item(shard, key, value, flags, cas_id, now, &expire);
+    }
+
+    /** Increment or decrement numeric value for key.
+     - Incrementing wraps around on 64-bit overflow, decrementing below 0 results in 0
+     - With `adv_params`, a missing value is created with the initial value (and flags 0), which is the result -- no increment/decrement is done on the new value
+       - If the expiration time has already passed, nothing is stored, but the initial value is still the result
+     .
+     \param  result      Stores new value after increment/decrement, set to null if key not found (and not created)  [out]
+     \param  key         Key to increment or decrement
+     \param  count       Count to increment or decrement
+     \param  decrement   Whether to decrement instead of increment
+     \param  adv_params  Parameters for creating value if key not found, NULL to not create
+     \param  new_cas_id  Stores new CAS ID of updated or created value, unchanged if none -- NULL to ignore  [out]
+     \return             Whether successful, false if existing value isn't a 64-bit unsigned decimal number, or new value is too large to store
+    */
+    bool increment(UInt64& result, const SubString& key, uint64 count, bool decrement, const IncrementAdvParams* adv_params=NULL, uint64* new_cas_id=NULL) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(key);
+        Mutex::Lock lock(shard.mutex);
+
+        Item* item = find(shard, key, now);
+        if (item == NULL) {
+            if (adv_params == NULL) {
+                result.set();
+                return true;
+            }
+            const int64 expire = get_expire_time(adv_params->expire, now);
+            if (expire >= 0) {
+                StringInt<uint64> value_str(adv_params->initial);
+                const ulongl size = item_size(key.size(), value_str.size());
+                if (size > shard.limit)
+                    return false;
+                item = add_item(shard, key, SubString(value_str.data(), value_str.size()), size);
+                item->expire = expire;
+                item->time   = now;
+                item->cas_id = shard.next_cas();
+                if (new_cas_id != NULL)
+                    *new_cas_id = item->cas_id;
+                evict(shard, now, item);
+                ++shard.total_items;
+            }
+            result = adv_params->initial;
+            return true;
+        }
+
+        uint64 num;
+        if (!parse_uint64(num, item->value.get()))
+            return false;
+        if (decrement)
+            num = (count > num ? 0 : num - count);
+        else
+            num += count;
+
+        String new_value;
+        new_value.setn(num);
+        if (item_size(item->key.size(), new_value.size()) > shard.limit)
+            return false;
+        update_value(shard, item, new_value, now);
+        item->cas_id = shard.next_cas();
+        if (new_cas_id != NULL)
+            *new_cas_id = item->cas_id;
+        evict(shard, now, item);
+        result = num;
+        return true;
+    }
+
+    /** Remove key and value.
+     \param  key  Key to remove
+     \return      Whether removed, false if not found
+    */
+    bool remove(const SubString& key) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(key);
+        Mutex::Lock lock(shard.mutex);
+        Item* item = find(shard, key, now);
+        if (item == NULL)
+            return false;
+        remove_item(shard, item);
+        return true;
+    }
+
+    /** Update expiration time for key.
+     \param  key     Key to touch
+     \param  expire  New expiration time in seconds from now, 0 for no expiration, negative to expire now, or a value greater than 2592000 (30 days) means a Unix timestamp to expire on
+     \return         Whether successful, false if not found
+    */
+    bool touch(const SubString& key, int64 expire) {
+        const int64 now = get_time();
+        Shard& shard = get_shard(key);
+        Mutex::Lock lock(shard.mutex);
+        Item* item = find(shard, key, now);
+        if (item == NULL)
+            return false;
+        touch_item(shard, item, get_expire_time(expire, now));
+        return true;
+    }
+
+    /** Invalidate all items.
+     - With a delay, all items stored before the delay expires are invalidated when it expires
+     .
+     \param  delay_sec  Number of seconds to delay the flush, 0 for immediate
+    */
+    void flush_all(ulong delay_sec=0) {
+        const int64 flush_time = get_time() + (int64)delay_sec;
+        for (uint i = 0; i < shard_count_; ++i) {
+            Shard& shard = shards_[i];
+            Mutex::Lock lock(shard.mutex);
+            if (delay_sec == 0)
+                shard.clear();
+            else
+                shard.flush_time = flush_time;
+        }
+    }
+
+    /** Remove all expired items.
+     - This scans all items, locking one shard at a time
+     - This is called periodically by the purge thread, if started -- see start_purge_thread()
+     .
+     \return  Number of expired items removed
+    */
+    ulongl purge_expired() {
+        ulongl count = 0;
+        for (uint i = 0; i < shard_count_; ++i) {
+            const int64 now = get_time();
+            Shard& shard = shards_[i];
+            Mutex::Lock lock(shard.mutex);
+            for (Item* item = shard.head, *next; item != NULL; item = next) {
+                next = item->next;
+                if (shard.expired(item, now)) {
+                    remove_item(shard, item);
+                    ++shard.expired_count;
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
+
+    /** Start background thread to periodically remove expired items.
+     - This does nothing if the thread is already running
+     - The thread is stopped by stop_purge_thread(), or the destructor
+     .
+     \param  interval_ms  Interval between purges in milliseconds
+     \return              Whether successful, false if thread could not be started
+    */
+    bool start_purge_thread(ulong interval_ms=DEFAULT_PURGE_INTERVAL_MS) {
+        Condition::Lock lock(purge_cond_);
+        if (purge_thread_.thread_active())
+            return true;
+        purge_interval_ms_ = interval_ms;
+        purge_stop_ = false;
+        return purge_thread_.thread_start();
+    }
+
+    /** Stop background purge thread.
+     - This does nothing if the thread isn't running
+    */
+    void stop_purge_thread() {
+        {
+            Condition::Lock lock(purge_cond_);
+            if (!purge_thread_.thread_active())
+                return;
+            purge_stop_ = true;
+            purge_cond_.notify();
+        }
+        purge_thread_.thread_join();
+    }
+
+    /** Get storage statistics.
+     \param  stats  Stores stats summed from all shards  [out]
+    */
+    void get_stats(Stats& stats) {
+        stats = Stats();
+        stats.max_memory = max_memory_;
+        for (uint i = 0; i < shard_count_; ++i) {
+            Shard& shard = shards_[i];
+            Mutex::Lock lock(shard.mutex);
+            stats.items       += shard.map.size();
+            stats.bytes       += shard.used;
+            stats.total_items += shard.total_items;
+            stats.get_hits    += shard.hits;
+            stats.get_misses  += shard.misses;
+            stats.evictions   += shard.evictions;
+            stats.expired     += shard.expired_count;
+        }
+    }
+
+private:
+    // Disable copying
+    MemcachedStore(const MemcachedStore&) EVO_ONCPP11(= delete);
+    MemcachedStore& operator=(const MemcachedStore&) EVO_ONCPP11(= delete);
+
+    static const ulong SHARD_SEED = 0x9E3779B9;
+
+    struct Item {
+        Item*        prev;      // previous (newer) item in shard list
+        Item*        next;      // next (older) item in shard list
+        String       key;
+        SharedString value;     // immutable, replaced on change so get() references stay valid
+        int64        expire;    // Unix time to expire, 0 for none
+        int64        time;      // Unix time last stored, used with delayed flush
+        uint64       cas_id;
+        uint32       flags;
+        bool         ref;       // CLOCK reference bit, set when read
+
+        Item() : prev(NULL), next(NULL), expire(0), time(0), cas_id(0), flags(0), ref(false) {
+        }
+    };
+
+    typedef MapHashFlat<String,Item*> Map;
+
+    struct Shard {
+        Mutex  mutex;
+        Map    map;
+        Item*  head;            // newest item
+        Item*  tail;            // oldest item, next to check for eviction
+        ulongl used;            // memory use estimate
+        ulongl limit;           // memory limit
+        uint64 cas_counter;
+        uint64 cas_shift;       // CAS IDs are interleaved across shards so they're unique
+        uint64 cas_index;
+        int64  flush_time;      // time to invalidate older items, 0 for none
+        ulongl total_items;
+        ulongl hits;
+        ulongl misses;
+        ulongl evictions;
+        ulongl expired_count;
+
+        Shard() : head(NULL), tail(NULL), used(0), limit(0), cas_counter(0), cas_shift(0), cas_index(0), flush_time(0), total_items(0), hits(0), misses(0), evictions(0), expired_count(0) {
+        }
+
+        ~Shard() {
+            clear();
+        }
+
+        uint64 next_cas() {
+            return ((++cas_counter) << cas_shift) | cas_index;
+        }
+
+        bool expired(const Item* item, int64 now) const {
+            return ((item->expire != 0 && item->expire <= now) || (flush_time != 0 && flush_time <= now && item->time <= flush_time));
+        }
+
+        void list_add(Item* item) {
+            item->prev = NULL;
+            item->next = head;
+            if (head != NULL)
+                head->prev = item;
+            else
+                tail = item;
+            head = item;
+        }
+
+        void list_remove(Item* item) {
+            if (item->prev != NULL)
+                item->prev->next = item->next;
+            else
+                head = item->next;
+            if (item->next != NULL)
+                item->next->prev = item->prev;
+            else
+                tail = item->prev;
+        }
+
+        void clear() {
+            for (Item* item = head, *next; item != NULL; item = next) {
+                next = item->next;
+                delete item;
+            }
+            map.clear();
+            head = tail = NULL;
+            used = 0;
+            flush_time = 0;
+        }
+    };
+
+    Shard* shards_;
+    uint   shard_count_;
+    ulongl max_memory_;
+
+    Thread    purge_thread_;
+    Condition purge_cond_;
+    ulong     purge_interval_ms_;
+    bool      purge_stop_;
+
+    void init(uint shards) {
+        uint count = 1, bits = 0;
+        while (count < shards) {
+            count <<= 1;
+            ++bits;
+        }
+        delete [] shards_;
+        shards_      = new Shard[count];
+        shard_count_ = count;
+        const ulongl shard_limit = max_memory_ / count;
+        for (uint i = 0; i < count; ++i) {
+            shards_[i].limit     = shard_limit;
+            shards_[i].cas_shift = bits;
+            shards_[i].cas_index = i;
+        }
+    }
+
+    static int64 get_time() {
+        SysNativeTimeStamp ts;
+        ts.set_utc();
+        return ts.get_unix_timestamp();
+    }
+
+    // Get absolute expiration time from protocol expiration time: 0 for none, -1 if already expired
+    static int64 get_expire_time(int64 expire, int64 now) {
+        if (expire == 0)
+            return 0;
+        if (expire < 0)
+            return -1;
+        if (expire > MAX_RELATIVE_EXPIRE)
+            return (expire <= now ? -1 : expire);
+        return now + expire;
+    }
+
+    // Estimate memory used by item, including item, map slot, and allocation overhead
+    static ulongl item_size(StrSizeT key_size, StrSizeT value_size) {
+        const ulongl OVERHEAD = sizeof(Item) + sizeof(typename Map::Item) + 1 + 32;
+        return OVERHEAD + key_size + value_size;
+    }
+
+    static bool parse_uint64(uint64& num, const SubString& value) {
+        const StrSizeT MAX_DIGITS = 20;
+        const StrSizeT size = value.size();
+        if (size == 0 || size > MAX_DIGITS)
+            return false;
+        const char* data = value.data();
+        uint64 result = 0;
+        for (StrSizeT i = 0; i < size; ++i) {
+            const uint digit = (uint)(data[i] - '0');
+            if (digit > 9)
+                return false;
+            const uint64 next = (result * 10) + digit;
+            if (next / 10 != result)
+                return false;   // overflow
+            result = next;
+        }
+        num = result;
+        return true;
+    }
+
+    Shard& get_shard(const SubString& key) {
+        return shards_[SpookyHash::hash(key.data(), key.size(), SHARD_SEED) & (shard_count_ - 1)];
+    }
+
+    // Find valid item, removes item if expired -- shard must be locked
+    Item* find(Shard& shard, const SubString& key, int64 now) {
+        Item** item = shard.map.findM(String(key.data(), key.size()));
+        if (item == NULL)
+            return NULL;
+        if (shard.expired(*item, now)) {
+            remove_item(shard, *item);
+            ++shard.expired_count;
+            return NULL;
+        }
+        return *item;
+    }
+
+    static void get_value(String& out, const SharedString& value)
+        { out.copy(value.data(), value.size()); }
+
+    static void get_value(SharedString& out, const SharedString& value)
+        { out = value; }
+
+    template<class TValue>
+    bool get_item(Shard& shard, const SubString& key, TValue& value, uint32& flags, uint64& cas_id, int64 now, const int64* expire) {
+        Item* item = find(shard, key, now);
+        if (item == NULL) {
+            ++shard.misses;
+            return false;
+        }
+        ++shard.hits;
+        get_value(value, item->value);
+        flags  = item->flags;
+        cas_id = item->cas_id;
+        if (expire != NULL)
+            touch_item(shard, item, get_expire_time(*expire, now));
+        else
+            item->ref = true;
+        return true;
+    }
+
+    void touch_item(Shard& shard, Item* item, int64 expire) {
+        if (expire < 0) {
+            remove_item(shard, item);
+        } else {
+            item->expire = expire;
+            item->ref    = true;
+        }
+    }
+
+    // Add new item with given value and memory use estimate, caller sets remaining fields -- shard must be locked
+    Item* add_item(Shard& shard, const SubString& key, const SubString& value, ulongl size) {
+        Item* item = new Item;
+        item->key.copy(key.data(), key.size());
+        item->value.set(value.data(), value.size());
+        shard.map[item->key] = item;
+        shard.list_add(item);
+        shard.used += size;
+        return item;
+    }
+
+    // Replace item value with new value (taken without copying) and update memory use -- shard must be locked
+    void update_value(Shard& shard, Item* item, String& new_value, int64 now) {
+        shard.used -= item_size(item->key.size(), item->value.size());
+        shard.used += item_size(item->key.size(), new_value.size());
+        item->value.set(new_value);
+        item->time = now;
+    }
+
+    void remove_item(Shard& shard, Item* item) {
+        shard.used -= item_size(item->key.size(), item->value.size());
+        shard.list_remove(item);
+        shard.map.remove(item->key);
+        delete item;
+    }
+
+    // Evict items until memory use is within limit, using CLOCK (second chance) -- `keep` is the item just stored, which isn't evicted
+    void evict(Shard& shard, int64 now, Item* keep) {
+        while (shard.used > shard.limit && shard.tail != NULL) {
+            Item* item = shard.tail;
+            if (item == keep) {
+                if (item == shard.head)
+                    break;
+                shard.list_remove(item);
+                shard.list_add(item);
+            } else if (shard.expired(item, now)) {
+                remove_item(shard, item);
+                ++shard.expired_count;
+            } else if (item->ref) {
+                // Second chance
+                item->ref = false;
+                shard.list_remove(item);
+                shard.list_add(item);
+            } else {
+                remove_item(shard, item);
+                ++shard.evictions;
+            }
+        }
+    }
+
+    static void purge_thread(void* arg) {
+        MemcachedStore& store = *(MemcachedStore*)arg;
+        Condition::Lock lock(store.purge_cond_);
+        while (!store.purge_stop_) {
+            store.purge_cond_.wait(store.purge_interval_ms_);
+            if (store.purge_stop_)
+                break;
+            lock.unlock();
+            store.purge_expired();
+            lock.lock();
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** %Memcached server handler using MemcachedStore for storage.
+ - This implements all %Memcached storage and retrieval commands with a MemcachedStore, so a memcached server works without any custom handler code
+   - "get and touch" (GAT) and "compare and swap" (CAS) are enabled
+   - Large values are sent by reference (no copy) from a per-connection buffer -- see send_value_ref()
+ - The store is in `Global` data, so is shared by all server threads -- see AsyncServer::run_threads()
+   - Use AsyncServer::get_global() to configure the store before running the server
+   - The background purge thread is started on server init, if not already started -- see MemcachedStore::start_purge_thread()
+ - Inherit this to customize, the derived class constructor must pass both arguments to this constructor
+ .
+
+\par Example
+
+This runs multiple server threads, so defines `EVO_ASYNC_MULTI_THREAD` and must also link with `-levent_pthreads` -- see \ref Async.
+To run a single thread instead, call `server.run(listener)` and skip both.
+
+\code
+#define EVO_ASYNC_MULTI_THREAD 1
+#include <evo/async/memcached_store.h>
+using namespace evo;
+
+typedef async::MemcachedServer<async::MemcachedStoreHandler>::Server Server;
+
+int main() {
+    Socket::sysinit();
+
+    const ushort PORT = 11211;
+    const uint THREADS = 4;
+
+    Socket listener;
+    try {
+        listener.listen_ip(PORT);
+    } EVO_CATCH(return 1)
+
+    Server server;
+    server.get_global().store.set_max_memory(268435456); // 256 MB
+    server.run_threads(listener, THREADS);
+
+    return 0;
+}
+\endcode
+*/
+struct MemcachedStoreHandler : MemcachedServerHandlerBase {
+    /** Global data shared by all server threads. */
+    struct Global {
+        MemcachedStore store;   ///< Storage engine
+    };
+
+    /** Shared data for each server thread. */
+    struct Shared : SimpleSharedBase<Global> {
+        /** Called when server thread is initialized, starts store purge thread.
+         \param  server  Server AsyncBase instance
+         \param  global  Reference to global data
+         \return         Whether successful
+        */
+        bool on_init(AsyncBase& server, Global& global) {
+            EVO_PARAM_UNUSED(server);
+            return global.store.start_purge_thread();
+        }
+    };
+
+    MemcachedStore& store;      ///< Storage engine used
+
+    /** Constructor.
+     \param  global  Global data to use
+     \param  shared  Shared data to use
+    */
+    MemcachedStoreHandler(Global& global, Shared& shared) : store(global.store) {
+        EVO_PARAM_UNUSED(shared);
+        enable_gat = true;
+        enable_cas = true;
+    }
+
+    StoreResult on_store(DeferredContext& context, StoreParams& params, SubString& value, Command command, uint64 cas_id) {
+        EVO_PARAM_UNUSED(context);
+        const Memcached::StoreResult result = store.store(params, value, command, cas_id, &response.cas);
+        if (result == Memcached::srUNKNOWN) {
+            send_error("object too large for cache");
+            return rtHANDLED;
+        }
+        return result;
+    }
+
+    IncrementResult on_increment(DeferredContext& context, const SubString& key, uint64 count, bool decrement, IncrementAdvParams* adv_params) {
+        EVO_PARAM_UNUSED(context);
+        UInt64 result;
+        if (!store.increment(result, key, count, decrement, adv_params, &response.cas)) {
+            send_client_error("cannot increment or decrement non-numeric value");
+            return rtHANDLED;
+        }
+        return result;
+    }
+
+    DeleteResult on_delete(DeferredContext& context, const SubString& key) {
+        EVO_PARAM_UNUSED(context);
+        return (store.remove(key) ? grOK : grNOT_FOUND);
+    }
+
+    TouchResult on_touch(DeferredContext& context, const SubString& key, int64 expire) {
+        EVO_PARAM_UNUSED(context);
+        return (store.touch(key, expire) ? grOK : grNOT_FOUND);
+    }
+
+    ResponseType on_get(DeferredContext& context, const SubString& key, GetAdvParams* adv_params) {
+        EVO_PARAM_UNUSED(context);
+        SharedString value;
+        uint32 flags;
+        uint64 cas_id;
+        bool found;
+        if (adv_params != NULL && !adv_params->expire.null())
+            found = store.get_touch(key, value, flags, cas_id, *adv_params->expire);
+        else
+            found = store.get(key, value, flags, cas_id);
+        if (found)
+            send_value_ref(key, value, flags, (adv_params != NULL && adv_params->cas ? &cas_id : NULL));
+        return rtNORMAL;
+    }
+
+    void on_flush_all(ulong delay_sec) {
+        store.flush_all(delay_sec);
+    }
+
+    void on_stats(SubString& params) {
+        EVO_PARAM_UNUSED(params);
+        MemcachedStore::Stats stats;
+        store.get_stats(stats);
+        send_stat("curr_items",     String().setn(stats.items));
+        send_stat("total_items",    String().setn(stats.total_items));
+        send_stat("bytes",          String().setn(stats.bytes));
+        send_stat("limit_maxbytes", String().setn(stats.max_memory));
+        send_stat("get_hits",       String().setn(stats.get_hits));
+        send_stat("get_misses",     String().setn(stats.get_misses));
+        send_stat("evictions",      String().setn(stats.evictions));
+        send_stat("expired",        String().setn(stats.expired));
+        send_reply("END");
+    }
+
+    void on_version(String& version) {
+        version = "evo-memcached-store";
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+}
+#endif
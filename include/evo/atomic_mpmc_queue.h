@@ -0,0 +1,476 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file atomic_mpmc_queue.h Evo AtomicMpmcQueue. */
+#pragma once
+#ifndef INCL_evo_atomic_mpmc_queue_h
+#define INCL_evo_atomic_mpmc_queue_h
+
+#include "thread.h"
+#include "impl/systime.h"
+#if defined(__linux__) && !defined(EVO_NO_FUTEX)
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+    #include <climits>
+    #if defined(SYS_futex)
+        #define EVO_IMPL_FUTEX 1
+    #endif
+#endif
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** \cond impl */
+namespace impl {
+    // Parks and wakes threads waiting on a condition that changes without a lock (event count)
+    // - Waiter: key = prepare(), re-check condition, then cancel() if satisfied or wait(key) otherwise
+    // - Notifier: change state, then notify() -- this is just a fence and atomic load when nothing is waiting
+    // - Linux uses a futex on the sequence number, other systems use a Condition
+    class AtomicWaiter {
+    public:
+        AtomicWaiter() {
+            seq_.store(0, EVO_ATOMIC_RELAXED);
+            waiters_.store(0, EVO_ATOMIC_RELAXED);
+        }
+
+        uint32 prepare() {
+            waiters_.fetch_add(1, EVO_ATOMIC_ACQ_REL);
+            EVO_ATOMIC_FENCE(EVO_ATOMIC_SYNC);
+            return seq_.load(EVO_ATOMIC_ACQUIRE);
+        }
+
+        void cancel()
+            { waiters_.fetch_sub(1, EVO_ATOMIC_RELEASE); }
+
+        void wait(uint32 key, ulong timeout_ms) {
+        #if defined(EVO_IMPL_FUTEX)
+            if (seq_.load(EVO_ATOMIC_ACQUIRE) == key) {
+                struct timespec ts;
+                struct timespec* pts = NULL;
+                if (timeout_ms < Condition::INF) {
+                    ts.tv_sec  = (time_t)(timeout_ms / 1000);
+                    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+                    pts = &ts;
+                }
+                ::syscall(SYS_futex, (int*)(void*)&seq_, FUTEX_WAIT_PRIVATE, (int)key, pts, NULL, 0);
+            }
+        #else
+            {
+                Condition::Lock lock(cond_);
+                if (seq_.load(EVO_ATOMIC_ACQUIRE) == key)
+                    cond_.wait(timeout_ms);
+            }
+        #endif
+            waiters_.fetch_sub(1, EVO_ATOMIC_RELEASE);
+        }
+
+        void notify(bool all) {
+            EVO_ATOMIC_FENCE(EVO_ATOMIC_SYNC);
+            if (waiters_.load(EVO_ATOMIC_RELAXED) > 0) {
+            #if defined(EVO_IMPL_FUTEX)
+                seq_.fetch_add(1, EVO_ATOMIC_RELEASE);
+                ::syscall(SYS_futex, (int*)(void*)&seq_, FUTEX_WAKE_PRIVATE, (all ? INT_MAX : 1), NULL, NULL, 0);
+            #else
+                Condition::Lock lock(cond_);
+                seq_.fetch_add(1, EVO_ATOMIC_RELEASE);
+                if (all)
+                    cond_.notify_all();
+                else
+                    cond_.notify();
+            #endif
+            }
+        }
+
+    private:
+        AtomicUInt32 seq_;      // Incremented to wake waiters, futex word on Linux
+        AtomicUInt32 waiters_;  // Number of threads between prepare() and wait()/cancel()
+    #if !defined(EVO_IMPL_FUTEX)
+        Condition cond_;
+    #endif
+
+        // Disable copying
+        AtomicWaiter(const AtomicWaiter&);
+        AtomicWaiter& operator=(const AtomicWaiter&);
+    };
+}
+/** \endcond */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Fast bounded multi-producer multi-consumer queue, implemented with a ring-buffer.
+ \tparam  T      Item type to use, copied with assignment operator
+ \tparam  TSize  Size type to use for queue size (must be unsigned integer) -- default: SizeT
+
+\par Features
+
+ - This is lock free and thread safe, any number of threads may add and pop items at the same time
+ - Each buffer slot has a sequence number, so producers and consumers only contend on claiming a position -- a slow producer or consumer doesn't block others from using other slots
+   - This is based on the bounded MPMC queue by Dmitry Vyukov
+ - This allocates a fixed size buffer and is not resizable, size is always a power of 2
+ - Adding items does not allocate memory (though this calls the item assignment operator, which could)
+ - Waiting methods (add(), pop_wait(), pop_batch_wait()) park the thread until notified, instead of spinning or sleeping
+   - On Linux this uses a futex, otherwise a Condition
+   - When nothing is waiting, notifying is just a memory fence and an atomic load
+ - pop_batch() claims multiple items at once, which reduces contention between consumers
+ - Popped items are left as-is in buffer, to be overwritten as new items are added
+ .
+
+Note that this is not a full EvoContainer and doesn't have iterators.
+
+See also: AtomicBufferQueue
+
+\par Example
+
+\code
+#include <evo/atomic_mpmc_queue.h>
+using namespace evo;
+
+int main() {
+    AtomicMpmcQueue<int> queue(20); // rounds to 32 (power of 2)
+
+    queue.try_add(1);   // doesn't block, false if full
+    queue.add(2);       // waits while full
+    queue.add(3);
+
+    int a = 0;
+    queue.pop(a);       // set to 1, doesn't block
+
+    int items[8];
+    SizeT count = queue.pop_batch(items, 8);    // set count to 2, items to 2, 3
+
+    queue.pop_wait(a, 100); // waits up to 100 ms, returns false on timeout
+
+    return 0;
+}
+\endcode
+*/
+template<class T, class TSize=SizeT>
+class AtomicMpmcQueue {
+public:
+    typedef AtomicMpmcQueue<T,TSize> This;      ///< %This type
+    typedef TSize Size;                         ///< Queue size integer type (always unsigned)
+    typedef T     Item;                         ///< Item type
+
+    static const Size DEFAULT_SIZE = 128;       ///< Default size to use
+
+    /** Constructor, sets buffer size.
+     \param  size  Buffer size to use as item count, rounded to next power of 2 if needed
+    */
+    AtomicMpmcQueue(Size size=DEFAULT_SIZE) {
+        size = size_pow2(size < 2 ? 2 : size);
+        buf_       = new Cell[size];
+        size_      = size;
+        size_mask_ = size - 1;
+        for (Size i = 0; i < size; ++i)
+            buf_[i].seq.store(i, EVO_ATOMIC_RELAXED);
+        write_pos_.store(0, EVO_ATOMIC_RELAXED);
+        read_pos_.store(0, EVO_ATOMIC_RELEASE);
+    }
+
+    /** Destructor. */
+    ~AtomicMpmcQueue() {
+        delete [] buf_;
+    }
+
+    /** Get buffer size.
+     - Thread safe
+     .
+     \return  Buffer size as item count, always a power of 2
+    */
+    Size size() const {
+        return size_;
+    }
+
+    /** Get used item count.
+     - Thread safe, though this is approximate while other threads are adding or popping
+     .
+     \return  Item count used, 0 if queue is empty
+    */
+    Size used() const {
+        const uint64 read  = read_pos_.load(EVO_ATOMIC_ACQUIRE);
+        const uint64 write = write_pos_.load(EVO_ATOMIC_ACQUIRE);
+        return (Size)(write <= read ? 0 : (write - read > size_ ? size_ : write - read));
+    }
+
+    /** Get whether queue is empty.
+     - Thread safe, though this is approximate while other threads are adding or popping
+     - This checks whether the oldest item is ready to pop, so an item still being added doesn't count
+     .
+     \return  Whether empty
+    */
+    bool empty() const {
+        const uint64 read = read_pos_.load(EVO_ATOMIC_ACQUIRE);
+        return (buf_[read & size_mask_].seq.load(EVO_ATOMIC_ACQUIRE) != read + 1);
+    }
+
+    /** Get whether queue is full.
+     - Thread safe, though this is approximate while other threads are adding or popping
+     .
+     \return  Whether full, same as used() == size()
+    */
+    bool full() const {
+        return (used() >= size_);
+    }
+
+    /** Try to add item to queue, without waiting.
+     - Thread safe
+     - This uses Item::operator=() to copy the item to queue memory
+       - For best performance, copying should not allocate any memory or involve any expensive processing
+       - Not exception safe -- item assignment operator must not throw
+     - This wakes a consumer waiting in pop_wait() or pop_batch_wait()
+     .
+     \param  item  Item to add, copied with assignment operator
+     \return       Whether successful, false if queue is full
+    */
+    bool try_add(typename DataCopy<Item>::PassType item) {
+        uint64 pos = write_pos_.load(EVO_ATOMIC_RELAXED);
+        Cell* cell;
+        for (;;) {
+            cell = &buf_[pos & size_mask_];
+            const uint64 seq = cell->seq.load(EVO_ATOMIC_ACQUIRE);
+            if (seq == pos) {
+                if (write_pos_.compare_set(pos, pos + 1, EVO_ATOMIC_RELAXED, EVO_ATOMIC_RELAXED))
+                    break;
+                pos = write_pos_.load(EVO_ATOMIC_RELAXED);
+            } else if (seq < pos) {
+                return false;   // full, slot not popped yet from previous lap
+            } else
+                pos = write_pos_.load(EVO_ATOMIC_RELAXED);
+        }
+
+        EVO_EXCEPTION_GUARD_START
+        cell->item = item;
+        EVO_EXCEPTION_GUARD_END
+        cell->seq.store(pos + 1, EVO_ATOMIC_RELEASE);
+        not_empty_.notify(false);
+        return true;
+    }
+
+    /** Add item to queue, waiting while queue is full.
+     - Thread safe
+     - This uses Item::operator=() to copy the item to queue memory -- see try_add()
+     - This parks the thread while full, until an item is popped or timeout expires
+     .
+     \param  item        Item to add, copied with assignment operator
+     \param  timeout_ms  Maximum wait timeout in milliseconds, 0 for no wait, Condition::INF to wait indefinitely
+     \return             Whether successful, false on timeout
+    */
+    bool add(typename DataCopy<Item>::PassType item, ulong timeout_ms=Condition::INF) {
+        if (try_add(item))
+            return true;
+        Deadline deadline(timeout_ms);
+        for (;;) {
+            ulong wait_ms;
+            if (!deadline.remaining(wait_ms))
+                return false;
+            const uint32 key = not_full_.prepare();
+            if (try_add(item)) {
+                not_full_.cancel();
+                return true;
+            }
+            not_full_.wait(key, wait_ms);
+            if (try_add(item))
+                return true;
+        }
+    }
+
+    /** Pop oldest item from queue, without waiting.
+     - Thread safe
+     - This doesn't really remove the item, but copies it and leaves it as-is in buffer to be overwritten later
+     - This uses Item::operator=() to copy the item from queue memory -- copying should be fast and must not throw
+     - This wakes a producer waiting in add()
+     .
+     \param  item  Stores popped item, copied with assignment operator  [out]
+     \return       Whether item popped, false if queue is empty
+    */
+    bool pop(Item& item) {
+        uint64 pos = read_pos_.load(EVO_ATOMIC_RELAXED);
+        Cell* cell;
+        for (;;) {
+            cell = &buf_[pos & size_mask_];
+            const uint64 seq = cell->seq.load(EVO_ATOMIC_ACQUIRE);
+            if (seq == pos + 1) {
+                if (read_pos_.compare_set(pos, pos + 1, EVO_ATOMIC_RELAXED, EVO_ATOMIC_RELAXED))
+                    break;
+                pos = read_pos_.load(EVO_ATOMIC_RELAXED);
+            } else if (seq < pos + 1) {
+                return false;   // empty, slot not added yet
+            } else
+                pos = read_pos_.load(EVO_ATOMIC_RELAXED);
+        }
+
+        EVO_EXCEPTION_GUARD_START
+        item = cell->item;
+        EVO_EXCEPTION_GUARD_END
+        cell->seq.store(pos + size_, EVO_ATOMIC_RELEASE);
+        not_full_.notify(false);
+        return true;
+    }
+
+    /** Pop oldest item from queue, waiting while queue is empty.
+     - Thread safe
+     - Same as pop() except this parks the thread while empty, until an item is added or timeout expires
+     .
+     \param  item        Stores popped item, copied with assignment operator  [out]
+     \param  timeout_ms  Maximum wait timeout in milliseconds, 0 for no wait, Condition::INF to wait indefinitely
+     \return             Whether item popped, false on timeout
+    */
+    bool pop_wait(Item& item, ulong timeout_ms=Condition::INF) {
+        if (pop(item))
+            return true;
+        Deadline deadline(timeout_ms);
+        for (;;) {
+            ulong wait_ms;
+            if (!deadline.remaining(wait_ms))
+                return false;
+            const uint32 key = not_empty_.prepare();
+            if (pop(item)) {
+                not_empty_.cancel();
+                return true;
+            }
+            not_empty_.wait(key, wait_ms);
+            if (pop(item))
+                return true;
+        }
+    }
+
+    /** Pop up to max oldest items from queue, without waiting.
+     - Thread safe
+     - This claims all available items (up to max) at once, which is faster than calling pop() for each item
+     - Items are copied in order with Item::operator=() -- copying should be fast and must not throw
+     - This wakes producers waiting in add()
+     .
+     \param  items  Array to store popped items, must have room for at least max items  [out]
+     \param  max    Maximum number of items to pop
+     \return        Number of items popped, 0 if queue is empty
+    */
+    Size pop_batch(Item* items, Size max) {
+        if (max == 0)
+            return 0;
+        uint64 pos = read_pos_.load(EVO_ATOMIC_RELAXED);
+        Size count;
+        for (;;) {
+            // Count ready items from pos
+            count = 0;
+            uint64 seq = 0;
+            while (count < max) {
+                seq = buf_[(pos + count) & size_mask_].seq.load(EVO_ATOMIC_ACQUIRE);
+                if (seq != pos + count + 1)
+                    break;
+                ++count;
+            }
+            if (count == 0) {
+                if (seq < pos + 1)
+                    return 0;   // empty
+            } else if (read_pos_.compare_set(pos, pos + count, EVO_ATOMIC_RELAXED, EVO_ATOMIC_RELAXED))
+                break;
+            pos = read_pos_.load(EVO_ATOMIC_RELAXED);
+        }
+
+        EVO_EXCEPTION_GUARD_START
+        for (Size i = 0; i < count; ++i, ++pos) {
+            Cell& cell = buf_[pos & size_mask_];
+            items[i] = cell.item;
+            cell.seq.store(pos + size_, EVO_ATOMIC_RELEASE);
+        }
+        EVO_EXCEPTION_GUARD_END
+        not_full_.notify(count > 1);
+        return count;
+    }
+
+    /** Pop up to max oldest items from queue, waiting while queue is empty.
+     - Thread safe
+     - Same as pop_batch() except this parks the thread while empty, until an item is added or timeout expires
+     .
+     \param  items       Array to store popped items, must have room for at least max items  [out]
+     \param  max         Maximum number of items to pop
+     \param  timeout_ms  Maximum wait timeout in milliseconds, 0 for no wait, Condition::INF to wait indefinitely
+     \return             Number of items popped, 0 on timeout
+    */
+    Size pop_batch_wait(Item* items, Size max, ulong timeout_ms=Condition::INF) {
+        Size count = pop_batch(items, max);
+        if (count > 0 || max == 0)
+            return count;
+        Deadline deadline(timeout_ms);
+        for (;;) {
+            ulong wait_ms;
+            if (!deadline.remaining(wait_ms))
+                return 0;
+            const uint32 key = not_empty_.prepare();
+            if ((count = pop_batch(items, max)) > 0) {
+                not_empty_.cancel();
+                return count;
+            }
+            not_empty_.wait(key, wait_ms);
+            if ((count = pop_batch(items, max)) > 0)
+                return count;
+        }
+    }
+
+private:
+    // Disable copying
+    AtomicMpmcQueue(const This&);
+    This& operator=(const This&);
+
+    // Slot sequence is pos when ready to add, pos + 1 when added and ready to pop, then pos + size when popped (ready to add on next lap)
+    struct Cell {
+        AtomicUInt64 seq;
+        T            item;
+    };
+
+    // Tracks remaining time for a wait timeout
+    struct Deadline {
+        ulong        timeout_ms;
+        SysTimestamp end;
+
+        Deadline(ulong timeout_ms) : timeout_ms(timeout_ms) {
+            if (timeout_ms > 0 && timeout_ms < Condition::INF) {
+                end.set_wall_timer();
+                end.add_msec(timeout_ms);
+            }
+        }
+
+        bool remaining(ulong& wait_ms) const {
+            if (timeout_ms == 0)
+                return false;
+            if (timeout_ms >= Condition::INF) {
+                wait_ms = timeout_ms;
+                return true;
+            }
+            SysTimestamp now;
+            now.set_wall_timer();
+            if (now.compare(end) >= 0)
+                return false;
+            const ulongl diff_ms = end.diff_msec(now);
+            wait_ms = (diff_ms == 0 ? 1 : (ulong)diff_ms);
+            return true;
+        }
+    };
+
+    static const uint CACHE_LINE_SIZE = 64;
+
+    Cell* buf_;
+    Size  size_;                // Must be a power of 2 for mask to work
+    Size  size_mask_;           // Mask for faster modulus
+
+    // Positions increase to infinity (index = pos % size_), would take hundreds of years to max out 64 bits
+    char pad1_[CACHE_LINE_SIZE];
+    AtomicUInt64 write_pos_;    // Next write position, claimed by producers
+    char pad2_[CACHE_LINE_SIZE];
+    AtomicUInt64 read_pos_;     // Next read position, claimed by consumers
+    char pad3_[CACHE_LINE_SIZE];
+
+    impl::AtomicWaiter not_empty_;  // Consumers wait here while empty
+    impl::AtomicWaiter not_full_;   // Producers wait here while full
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
@@ -9,7 +9,7 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 #define INCL_evo_event_thread_h
 
 #include "event.h"
-#include "thread.h"
+#include "atomic_mpmc_queue.h"
 
 namespace evo {
 /** \addtogroup EvoEvent */
@@ -17,19 +17,187 @@ namespace evo {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/** \cond impl */
+namespace impl {
+    // Chase-Lev work-stealing deque of event pointers (Le et al. 2013 memory ordering)
+    // - Only the owner thread may call push() and take(), which work on the bottom (LIFO)
+    // - Any thread may call steal(), which works on the top (FIFO)
+    // - Arrays replaced by growth are kept until destruction since a thief may still be reading one
+    class EventDeque {
+    public:
+        static const int64 DEFAULT_SIZE = 64;
+
+        EventDeque() : retired_(NULL) {
+            top_.store(0, EVO_ATOMIC_RELAXED);
+            bottom_.store(0, EVO_ATOMIC_RELAXED);
+            array_.store(new Array(DEFAULT_SIZE), EVO_ATOMIC_RELAXED);
+        }
+
+        ~EventDeque() {
+            delete array_.load(EVO_ATOMIC_RELAXED);
+            while (retired_ != NULL) {
+                Array* prev = retired_->prev;
+                delete retired_;
+                retired_ = prev;
+            }
+        }
+
+        bool empty() const
+            { return (bottom_.load(EVO_ATOMIC_ACQUIRE) <= top_.load(EVO_ATOMIC_ACQUIRE)); }
+
+        void push(Event* event) {
+            const int64 b = bottom_.load(EVO_ATOMIC_RELAXED);
+            const int64 t = top_.load(EVO_ATOMIC_ACQUIRE);
+            Array* array = array_.load(EVO_ATOMIC_RELAXED);
+            if (b - t > array->mask)
+                array = grow(array, t, b);
+            array->put(b, event);
+            bottom_.store(b + 1, EVO_ATOMIC_RELEASE);
+        }
+
+        Event* take() {
+            const int64 b = bottom_.load(EVO_ATOMIC_RELAXED) - 1;
+            Array* array = array_.load(EVO_ATOMIC_RELAXED);
+            bottom_.store(b, EVO_ATOMIC_RELAXED);
+            EVO_ATOMIC_FENCE(EVO_ATOMIC_SYNC);
+            int64 t = top_.load(EVO_ATOMIC_RELAXED);
+            Event* event = NULL;
+            if (t <= b) {
+                event = array->get(b);
+                if (t == b) {
+                    // Last item, race with thieves
+                    if (!top_.compare_set(t, t + 1, EVO_ATOMIC_SYNC, EVO_ATOMIC_RELAXED))
+                        event = NULL;
+                    bottom_.store(b + 1, EVO_ATOMIC_RELAXED);
+                }
+            } else
+                bottom_.store(b + 1, EVO_ATOMIC_RELAXED);
+            return event;
+        }
+
+        // Returns 1 if stolen, 0 if empty, -1 if lost a race (try again)
+        int steal(Event*& event) {
+            int64 t = top_.load(EVO_ATOMIC_ACQUIRE);
+            EVO_ATOMIC_FENCE(EVO_ATOMIC_SYNC);
+            const int64 b = bottom_.load(EVO_ATOMIC_ACQUIRE);
+            if (t < b) {
+                Array* array = array_.load(EVO_ATOMIC_ACQUIRE);
+                event = array->get(t);
+                if (!top_.compare_set(t, t + 1, EVO_ATOMIC_SYNC, EVO_ATOMIC_RELAXED))
+                    return -1;
+                return 1;
+            }
+            return 0;
+        }
+
+    private:
+        struct Array {
+            int64 mask;
+            Atomic<Event*>* items;
+            Array* prev;
+
+            Array(int64 size) : mask(size - 1), items(new Atomic<Event*>[(size_t)size]), prev(NULL)
+                { }
+            ~Array()
+                { delete [] items; }
+
+            Event* get(int64 i) const
+                { return items[i & mask].load(EVO_ATOMIC_RELAXED); }
+            void put(int64 i, Event* event)
+                { items[i & mask].store(event, EVO_ATOMIC_RELAXED); }
+        };
+
+        Atomic<int64>  top_;
+        Atomic<int64>  bottom_;
+        Atomic<Array*> array_;
+        Array*         retired_;    // Only accessed by owner
+
+        Array* grow(Array* array, int64 t, int64 b) {
+            Array* new_array = new Array((array->mask + 1) * 2);
+            for (int64 i = t; i < b; ++i)
+                new_array->put(i, array->get(i));
+            array->prev = retired_;
+            retired_ = array;
+            array_.store(new_array, EVO_ATOMIC_RELEASE);
+            return new_array;
+        }
+
+        // Disable copying
+        EventDeque(const EventDeque&);
+        EventDeque& operator=(const EventDeque&);
+    };
+
+    struct EventWorker {
+        EventDeque deque;
+        AtomicWaiter parker;    // Used to park this thread while idle
+        const void* owner;      // Shared state of pool that owns this worker
+        bool searching;         // Whether counted as searching, only accessed by owner thread
+        bool idle;              // Whether in idle list, guarded by idle mutex
+
+        EventWorker(const void* owner) : owner(owner), searching(false), idle(false)
+            { }
+
+        static EventWorker*& current() {
+            static EVO_THREAD_LOCAL EventWorker* worker = NULL;
+            return worker;
+        }
+    };
+}
+/** \endcond */
+
+///////////////////////////////////////////////////////////////////////////////
+
 /** Internal state used by EventThreadPool. */
 struct EventThreadState {
-    EventQueue<> queue;     ///< EventQueue used by pool
-    Condition condmutex;    ///< Condition for multithreading
-    AtomicInt shutdown;     ///< Thread shutdown flag
-    ulong waitms;           ///< Thread wait timeout in milliseconds
+    static const uint MAX_WORKERS = 256;    ///< Maximum threads with a local deque, additional threads only use the injector queue
+
+    AtomicMpmcQueue<Event*> queue;          ///< Injector queue for events added from outside the pool
+    Atomic<impl::EventWorker*> workers[MAX_WORKERS];    ///< Registered workers, each with a local deque
+    AtomicUInt worker_count;                ///< Number of registered worker slots
+    AtomicUInt searching;                   ///< Number of threads looking for events to steal, used to limit wakeups
+    Mutex idle_mutex;                       ///< Guards idle list
+    impl::EventWorker* idle[MAX_WORKERS];   ///< Idle list: Parked workers, guarded by idle_mutex
+    uint idle_size;                         ///< Idle list size, guarded by idle_mutex
+    AtomicUInt idle_count;                  ///< Idle list size, readable without locking
+    AtomicInt shutdown;                     ///< Thread shutdown flag
+    ulong waitms;                           ///< Thread wait timeout in milliseconds
+
+    /** Constructor. */
+    EventThreadState() : queue(EventQueue<>::DEFAULT_SIZE), idle_size(0), waitms(1) {
+        for (uint i = 0; i < MAX_WORKERS; ++i)
+            workers[i].store(NULL, EVO_ATOMIC_RELAXED);
+        worker_count.store(0, EVO_ATOMIC_RELAXED);
+        searching.store(0, EVO_ATOMIC_RELAXED);
+        idle_count.store(0, EVO_ATOMIC_RELAXED);
+        shutdown.store(0, EVO_ATOMIC_RELAXED);
+    }
+
+    /** Destructor. */
+    ~EventThreadState()
+        { reset_workers(); }
+
+    /** Free all workers, used after all threads have stopped. */
+    void reset_workers() {
+        const uint count = worker_count.load(EVO_ATOMIC_ACQUIRE);
+        for (uint i = 0; i < count && i < MAX_WORKERS; ++i) {
+            delete workers[i].load(EVO_ATOMIC_RELAXED);
+            workers[i].store(NULL, EVO_ATOMIC_RELAXED);
+        }
+        worker_count.store(0, EVO_ATOMIC_RELEASE);
+        searching.store(0, EVO_ATOMIC_RELAXED);
+        idle_size = 0;
+        idle_count.store(0, EVO_ATOMIC_RELEASE);
+    }
 };
 
-/** %Event processing thread pool.
- - This runs a group of threads as EventQueue consumers that process events added to the queue
- - %Events are popped from the queue and invoked by a thread in the pool, then are destroyed (if event returns true)
+/** %Event processing thread pool using work-stealing.
+ - This runs a group of threads that process events, each thread has its own local deque
+   - %Events added from outside the pool go to a shared injector queue
+   - %Events added from a thread in the pool (i.e. by an event) go to that thread's local deque, and are processed by that thread in LIFO order
+   - Idle threads steal the oldest events from other threads' deques, so nested fan-out is spread across the pool without contending on a single queue
+ - %Events are invoked by a thread in the pool, then are destroyed (if event returns true)
  - Use start() to start threads, and shutdown() and join() to shutdown
- - Use add() to add events to queue
+ - Use add() to add events
  .
 
 \par Example
@@ -64,52 +232,210 @@ public:
     typedef EventThreadPool This;   ///< This type
 
     /** Constructor.
-     \param  wait_timeout_ms  Maximum thread wait while idle -- see `waitms` in EventQueue::process_multiwait()
+     \param  wait_timeout_ms  Maximum thread wait while idle, in milliseconds -- idle threads are also woken when an event is added
     */
     EventThreadPool(ulong wait_timeout_ms=1) : ThreadGroup<Thread,EventThreadState>(thread_run) {
         shared_state.waitms = wait_timeout_ms;
     }
 
-    /** Add an event to queue to be processed.
+    /** Add an event to be processed.
      - This takes ownership of the event pointer, and will free it once the event is completed (via C++ delete operator)
        - The event is only freed if it returns true, otherwise it's assumed that ownership was transferred elsewhere
-     - This blocks while queue is full (spin-wait with 1 nanosecond sleep) -- a full queue should be avoided
-     - \b Caution: Do not call from the same queue that invoked (called) the event, this will deadlock if the queue is full
+     - When called from a thread in this pool (i.e. from an event) the event is pushed to that thread's local deque, which grows as needed and never blocks
+     - Otherwise the event is added to the injector queue, which blocks while full (parked until a thread pops an event) -- a full queue should be avoided
      .
      \param  event        %Event pointer to add and take ownership of
-     \param  spinwait_ns  Spin-wait sleep time in nanoseconds (usually default is preferred) -- used to sleep each loop while spin waiting
+     \param  spinwait_ns  Not used, kept for compatibility (adding to a full injector queue parks instead of spin-waiting)
      \return              This
     */
     This& add(Event* event, ulongl spinwait_ns=1) {
-        shared_state.queue.add(event, spinwait_ns);
-        shared_state.queue.notify_multiwait(shared_state.condmutex);
+        (void)spinwait_ns;
+        impl::EventWorker* worker = impl::EventWorker::current();
+        if (worker != NULL && worker->owner == &shared_state)
+            worker->deque.push(event);
+        else
+            shared_state.queue.add(event);
+
+        wake(shared_state);
         return *this;
     }
 
     /** Stop processing events and shutdown threads.
      - This starts the shutdown process, call join() to wait for all threads to fully stop
-     - Stop adding events to the queue before calling this, otherwise behavior is undefned (likely shutdown delay or memory leak)
+     - Threads finish all pending events before stopping, including events added by those events
+     - Stop adding events from outside the pool before calling this, otherwise behavior is undefned (likely shutdown delay or memory leak)
      .
      \return  This
     */
     This& shutdown() {
         shared_state.shutdown.store(1, EVO_ATOMIC_RELEASE);
-        shared_state.condmutex.lock_notify_all();
+        Mutex::Lock lock(shared_state.idle_mutex);
+        for (uint i = 0; i < shared_state.idle_size; ++i)
+            shared_state.idle[i]->parker.notify(true);
         return *this;
     }
 
+    /** Join all threads by waiting for them to stop.
+     - Call shutdown() first to stop processing events
+     .
+     \return  Always true
+    */
+    bool join() {
+        const bool result = Base::join();
+        shared_state.reset_workers();
+        return result;
+    }
+
 private:
     typedef ThreadGroup<Thread,EventThreadState> Base;
 
     Base& cancel() EVO_ONCPP11(= delete);
     bool cancelled() const EVO_ONCPP11(= delete);
 
+    // Wake an idle worker, only if no worker is already searching (a searcher that finds work calls this to wake the next one)
+    // - The woken worker is counted as searching before it wakes up, so events added meanwhile don't wake more workers
+    static void wake(EventThreadState& state) {
+        EVO_ATOMIC_FENCE(EVO_ATOMIC_SYNC);
+        if (state.searching.load(EVO_ATOMIC_RELAXED) != 0 || state.idle_count.load(EVO_ATOMIC_RELAXED) == 0)
+            return;
+        impl::EventWorker* worker = NULL;
+        {
+            Mutex::Lock lock(state.idle_mutex);
+            if (state.idle_size > 0 && state.searching.load(EVO_ATOMIC_ACQUIRE) == 0) {
+                worker = state.idle[--state.idle_size];
+                worker->idle = false;
+                state.idle_count.store(state.idle_size, EVO_ATOMIC_RELEASE);
+                state.searching.fetch_add(1, EVO_ATOMIC_ACQ_REL);
+            }
+        }
+        if (worker != NULL)
+            worker->parker.notify(false);
+    }
+
+    // Park worker until woken by wake() or shutdown(), or until timeout
+    static void park(EventThreadState& state, impl::EventWorker* worker, ulong waitms) {
+        const uint32 key = worker->parker.prepare();
+        {
+            Mutex::Lock lock(state.idle_mutex);
+            worker->idle = true;
+            state.idle[state.idle_size++] = worker;
+            state.idle_count.store(state.idle_size, EVO_ATOMIC_RELEASE);
+        }
+        if (worker->searching) {
+            worker->searching = false;
+            state.searching.fetch_sub(1, EVO_ATOMIC_ACQ_REL);
+        }
+
+        // Re-check after becoming idle to avoid a missed wakeup
+        EVO_ATOMIC_FENCE(EVO_ATOMIC_SYNC);
+        if (state.shutdown.load(EVO_ATOMIC_ACQUIRE) != 0 || has_work(state))
+            worker->parker.cancel();
+        else
+            worker->parker.wait(key, waitms);
+
+        // Still in idle list if not woken by wake(), otherwise wake() already counted this worker as searching
+        Mutex::Lock lock(state.idle_mutex);
+        if (worker->idle) {
+            worker->idle = false;
+            for (uint i = 0; i < state.idle_size; ++i) {
+                if (state.idle[i] == worker) {
+                    state.idle[i] = state.idle[--state.idle_size];
+                    break;
+                }
+            }
+            state.idle_count.store(state.idle_size, EVO_ATOMIC_RELEASE);
+        } else
+            worker->searching = true;
+    }
+
+    static bool has_work(EventThreadState& state) {
+        if (!state.queue.empty())
+            return true;
+        const uint count = state.worker_count.load(EVO_ATOMIC_ACQUIRE);
+        for (uint i = 0; i < count && i < EventThreadState::MAX_WORKERS; ++i) {
+            const impl::EventWorker* worker = state.workers[i].load(EVO_ATOMIC_ACQUIRE);
+            if (worker != NULL && !worker->deque.empty())
+                return true;
+        }
+        return false;
+    }
+
+    static Event* search(EventThreadState& state, impl::EventWorker* worker, uint& victim) {
+        Event* event;
+        if (state.queue.pop(event))
+            return event;
+
+        // Steal, start from a different victim each time to spread contention
+        for (;;) {
+            const uint count = state.worker_count.load(EVO_ATOMIC_ACQUIRE);
+            const uint slots = (count < EventThreadState::MAX_WORKERS ? count : EventThreadState::MAX_WORKERS);
+            bool retry = false;
+            for (uint i = 0; i < slots; ++i) {
+                if (++victim >= slots)
+                    victim = 0;
+                impl::EventWorker* other = state.workers[victim].load(EVO_ATOMIC_ACQUIRE);
+                if (other != NULL && other != worker) {
+                    const int result = other->deque.steal(event);
+                    if (result > 0)
+                        return event;
+                    if (result < 0)
+                        retry = true;
+                }
+            }
+            if (!retry)
+                break;
+        }
+        return NULL;
+    }
+
     static void thread_run(void* arg) {
         EventThreadState& state = *(EventThreadState*)arg;
         const ulong waitms = state.waitms;
-        while (state.shutdown.load(EVO_ATOMIC_ACQUIRE) == 0)
-            state.queue.process_multiwait(state.condmutex, state.shutdown, waitms);
-        while (state.queue.process_multi(state.condmutex));
+
+        // Register worker with a local deque, owned by this pool's shared state
+        impl::EventWorker* worker = NULL;
+        const uint index = state.worker_count.fetch_add(1, EVO_ATOMIC_ACQ_REL);
+        if (index < EventThreadState::MAX_WORKERS) {
+            worker = new impl::EventWorker(&state);
+            state.workers[index].store(worker, EVO_ATOMIC_RELEASE);
+        }
+        impl::EventWorker::current() = worker;
+
+        uint victim = index;
+        for (;;) {
+            Event* event;
+            if (worker == NULL) {
+                // No local deque, poll while idle
+                if ((event = search(state, worker, victim)) == NULL) {
+                    if (state.shutdown.load(EVO_ATOMIC_ACQUIRE) != 0)
+                        break;
+                    sleepms(waitms);
+                    continue;
+                }
+            } else if ((event = worker->deque.take()) == NULL) {
+                if (!worker->searching) {
+                    worker->searching = true;
+                    state.searching.fetch_add(1, EVO_ATOMIC_ACQ_REL);
+                }
+                if ((event = search(state, worker, victim)) == NULL) {
+                    if (state.shutdown.load(EVO_ATOMIC_ACQUIRE) != 0)
+                        break;
+                    park(state, worker, waitms);
+                    continue;
+                }
+                // Last searcher found work, wake another worker to look for more
+                worker->searching = false;
+                if (state.searching.fetch_sub(1, EVO_ATOMIC_ACQ_REL) == 1)
+                    wake(state);
+            }
+            if ((*event)())
+                delete event;
+        }
+        if (worker != NULL && worker->searching) {
+            worker->searching = false;
+            state.searching.fetch_sub(1, EVO_ATOMIC_ACQ_REL);
+        }
+        impl::EventWorker::current() = NULL;
     }
 };
 
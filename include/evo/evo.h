@@ -128,12 +128,19 @@ object oriented C++ server code. Evo aims to make C++ easier and more powerful w
  - String, SubString, \link evo::StringBase StringBase\endlink
    - UnicodeString
    - SubStringMapList
+   - StringSSO
+   - SharedString, SharedList
+   - StringPool, InternedString
  - Set
    - SetList, \link StrSetList\endlink
+   - SetTree, \link StrSetTree\endlink
    - SetHash, \link StrSetHash\endlink
+   - SetHashFlat, \link StrSetHashFlat\endlink
  - Map
    - MapList, \link StrMapList\endlink
+   - MapTree, \link StrMapTree\endlink
    - MapHash, \link StrHash\endlink
+   - MapHashFlat, \link StrHashFlat\endlink
    - lookupsub(), map_contains()
    - EVO_MAP_FIELDS(), EVO_MAP_FIELDS_KEY()
    .
@@ -142,7 +149,8 @@ object oriented C++ server code. Evo aims to make C++ easier and more powerful w
  .
 
  - Compare, CompareR, CompareI, CompareIR
- - CompareHash
+ - CompareHash, WyHash, AesHash
+ - Allocator, ArenaAllocator, PoolAllocator -- see EVO_ALLOCATORS
  - fixed_array_size(), EVO_FIXED_ARRAY_SIZE()
  - is_null()
  .
@@ -168,6 +176,7 @@ object oriented C++ server code. Evo aims to make C++ easier and more powerful w
  - StrTokS, StrTokRS
    - \link StrTokWordS\endlink, \link StrTokWordRS\endlink
  - StrTokLine
+ - StrTokBulk
  .
  - EVO_TOK_NEXT_OR_BREAK()
  - EVO_TOK_OR_BREAK()
@@ -179,6 +188,7 @@ object oriented C++ server code. Evo aims to make C++ easier and more powerful w
  - Console, ConsoleMT
  - File
    - \link FileMT\endlink
+ - MappedFile
  - Pipe, PipeIn, PipeOut
    - \link PipeInMT\endlink, \link PipeOutMT\endlink
  - Socket, SocketCast
@@ -206,6 +216,8 @@ object oriented C++ server code. Evo aims to make C++ easier and more powerful w
 _Alpha: Work In Progress_
 
  - \link async::MemcachedClient MemcachedClient\endlink, \link async::MemcachedServerHandlerBase MemcachedServerHandlerBase\endlink
+ - \link async::MemcachedClientPool MemcachedClientPool\endlink
+ - \link async::MemcachedStore MemcachedStore\endlink, \link async::MemcachedStoreHandler MemcachedStoreHandler\endlink
  - AsyncClient, AsyncServer
  .
 </td></tr><tr><td valign="top">
@@ -224,6 +236,7 @@ _Alpha: Work In Progress_
    - AtomicFlag
    - AtomicPtr
    - AtomicBufferQueue
+   - AtomicMpmcQueue
  .
  </td><td valign="top">
 
@@ -718,6 +731,8 @@ Containers like List and String use sharing:
 
 Containers that support Sharing: List, String, PtrList, MapList, MapHash
 
+With EVO_ALLOCATORS enabled, these containers only share buffers with containers using the same Allocator, otherwise a copy is made.
+
 \par Example
 
 \code
@@ -962,10 +977,14 @@ Types:
    - UnicodeString
  - Set
    - SetList, \link StrSetList\endlink
+   - SetTree, \link StrSetTree\endlink
    - SetHash, \link StrSetHash\endlink
+   - SetHashFlat, \link StrSetHashFlat\endlink
  - Map
    - MapList, \link StrMapList\endlink
+   - MapTree, \link StrMapTree\endlink
    - MapHash, \link StrHash\endlink
+   - MapHashFlat, \link StrHashFlat\endlink
    .
  - Var
  .
@@ -1044,6 +1063,11 @@ otherwise collisions won't be handled correctly. Hashing types:
 Standard hashing types:
 
  - CompareHash
+
+Hash functions for the `H` param of CompareHash (default: SpookyHash):
+
+ - WyHash -- fast on short keys
+ - AesHash -- uses AES-NI when supported by the CPU, otherwise WyHash
  .
 */
 
@@ -1478,6 +1502,8 @@ Near the beginning of a program using sockets, call Socket::sysinit() for best p
 Evo async I/O is designed to support clients and servers using different protocol implementations.
 
  - %Memcached: \link async::MemcachedClient MemcachedClient\endlink, \link async::MemcachedServer MemcachedServer\endlink
+   - Built-in server storage: \link async::MemcachedStore MemcachedStore\endlink, \link async::MemcachedStoreHandler MemcachedStoreHandler\endlink
+   - Multiple servers with consistent hashing: \link async::MemcachedClientPool MemcachedClientPool\endlink
  - Comming soon: %Redis, %HTTP
  .
 
@@ -1592,6 +1618,7 @@ An async server class is created using a template class implementing a `PROTOCOL
    - Call \link AsyncServer::set_timeout() server.set_timeout()\endlink to set connection timeouts (optional but recommended)
    - Call \link AsyncServer::set_logger() server.set_logger()\endlink to enable logging
    - Call \link AsyncServer::run() server.run()\endlink to run the server event-loop and handle connections -- this won't return until the server is shut down
+     - Or call \link AsyncServer::run_threads() server.run_threads()\endlink to run multiple server threads, each with a separate event-loop and `Shared` instance -- requires `EVO_ASYNC_MULTI_THREAD`
    - A handler or another thread may call \link AsyncServer::shutdown() server.shutdown()\endlink to stop the server, causing the `server.run*()` event-loop method used to return
  - Note that `Shared::on_init()` is the place to start back-end connections
  .
@@ -2260,8 +2287,11 @@ Evo STL compatibility info.
  - Evo String is similar to `std::string` (dynamic string)
    - Evo \link evo::StringBase StringBase\endlink is used as a common base type for referencing all string types (pass by const reference)
  - Evo SubString is similar to C++17 `std::string_view` (substring reference)
+ - Evo SetTree is similar to `std::set` (B+tree as set), and MapTree is similar to `std::map` (B+tree as map)
  - Evo SetHash is similar to C++11 `std::unordered_set` (hash table as set)
+   - Evo SetHashFlat is also similar, but uses open addressing (no per-item allocation) and has no sharing
  - Evo MapHash is similar to C++11 `std::unordered_map` (hash table as map)
+   - Evo MapHashFlat is also similar, but uses open addressing (no per-item allocation) and has no sharing
  - Evo Nullable is similar to C++17 `std::optional` (but is only for primitive types)
  - Most Evo containers implement iterator methods for STL compatibility: `begin(), end(), cbegin(), cend()`
 
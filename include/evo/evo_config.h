@@ -95,7 +95,10 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 
 // Allocators
 #if !defined(EVO_ALLOCATORS)
-    /** Enable container allocators -- NOT YET SUPPORTED.
+    /** Enable container allocators.
+     - When enabled, List, String, PtrList, MapList, and MapHash support binding an Allocator with `set_allocator()`
+     - This adds an allocator pointer to each container and buffer header
+     - See ArenaAllocator, PoolAllocator
      - Default: 0
     */
     #define EVO_ALLOCATORS 0
@@ -140,6 +143,18 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
     */
     #define EVO_LIST_OPT_REFTERM 0
 #endif
+#if !defined(EVO_LIST_OPT_HASHCACHE)
+    /** List: Enable caching hash values in shared buffer header.
+     - When enabled, List::hash() (and String) caches the hash value in the buffer header, but only while the buffer is shared (copies of the same list)
+     - This only helps when the same shared buffer is hashed repeatedly, such as lookups in a hash map using copies of the map keys
+     - Unshared lists are not cached and are rehashed every time -- this includes map keys that don't share a buffer, so a MapHash resize still rehashes most keys
+     - Each buffer uses a little more memory (4 fields in header)
+     - \b Caution: When enabled, List::hash() writes to the shared buffer header even though it's const, so it's not safe to call at the same time from multiple threads on lists sharing a buffer
+       - This includes concurrent const lookups in a hash container with String keys, such as MapHash, from different threads
+     - Default: 0
+    */
+    #define EVO_LIST_OPT_HASHCACHE 0
+#endif
 
 // List Option Dependencies
 #if !EVO_LIST_OPT_EXTREF
@@ -33,7 +33,7 @@ namespace evo {
    - seek()
    - pos()
  - Data:
-   - readline(), readtext(), readbin()
+   - readline(), readlines(), readtext(), readbin()
      - bufread()
    - writeline(), writetext(), writebin()
      - operator<<()
@@ -0,0 +1,822 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file btree.h Evo implementation detail: B+tree used by MapTree and SetTree. */
+#pragma once
+#ifndef INCL_evo_impl_btree_h
+#define INCL_evo_impl_btree_h
+
+#include "../type.h"
+
+namespace evo {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** \cond impl */
+namespace impl {
+    /* Get key from B+tree item -- map items are a Pair with the key as first. */
+    template<class TKey, class TItem>
+    struct BTreeKey {
+        static const TKey& get(const TItem& item)
+            { return item.first; }
+        static void init(TItem* item, const TKey& key) {
+            DataInit<TItem>::init_safe(item, 1);
+            item->first = key;
+        }
+    };
+
+    /* Get key from B+tree item -- set items are the key. */
+    template<class TKey>
+    struct BTreeKey<TKey,TKey> {
+        static const TKey& get(const TKey& item)
+            { return item; }
+        static void init(TKey* item, const TKey& key)
+            { DataInit<TKey>::init(item, &key, 1); }
+    };
+
+    /* Reads items from an array, for BTree::load(). */
+    template<class TItem>
+    struct BTreeArrayReader {
+        const TItem* ptr;
+        const TItem* end;
+
+        BTreeArrayReader(const TItem* ptr, ulong count) : ptr(ptr), end(ptr + count)
+            { }
+
+        const TItem* next()
+            { return (ptr < end ? ptr++ : NULL); }
+    };
+
+    /* Reads items from a container iterator, for BTree::load() -- iterator item must have the same layout as TItem. */
+    template<class TItem, class TIter>
+    struct BTreeIterReader {
+        TIter iter;
+        bool  started;
+
+        template<class T> BTreeIterReader(const T& src) : iter(src), started(false)
+            { }
+
+        const TItem* next() {
+            if (started)
+                ++iter;
+            else
+                started = true;
+            return (iter ? (const TItem*)&(*iter) : NULL);
+        }
+    };
+
+    /* B+tree with items in linked leaf nodes, used by MapTree and SetTree.
+     - Leaves hold items in a sorted array, branches hold separator keys and child node pointers
+     - Node sizes are set from item and key sizes to fill a fixed number of cache lines, so each search step touches few lines
+     - Leaves are doubly linked in order for iteration, and each leaf has an id so iterators can refer to it by number (Map/Set IterKey)
+     - Items and keys are relocated by copying bytes, like other Evo containers
+     - This inherits TCompare to reduce size bloat with an empty Compare
+    */
+    template<class TKey, class TItem, class TCompare, class TSize>
+    struct BTree : public TCompare {
+        typedef TSize Size;
+        typedef TKey  Key;
+        typedef TItem Item;
+        typedef BTreeKey<TKey,TItem> KeyOf;
+
+        static const size_t LEAF_BYTES   = 512;    // bytes for items per leaf (8 cache lines)
+        static const size_t BRANCH_BYTES = 256;    // bytes for keys per branch (4 cache lines)
+
+        static const Size LEAF_SIZE   = (Size)(LEAF_BYTES / sizeof(Item) < 4 ? 4 : LEAF_BYTES / sizeof(Item));      // max items per leaf
+        static const Size BRANCH_SIZE = (Size)(BRANCH_BYTES / sizeof(Key) < 4 ? 4 : BRANCH_BYTES / sizeof(Key));    // max keys per branch
+        static const Size LEAF_MIN    = LEAF_SIZE / 2;      // leaves with fewer items are merged or refilled on remove
+        static const Size BRANCH_MIN  = BRANCH_SIZE / 2;    // branches with fewer keys are merged or refilled on remove
+        static const uint MAX_HEIGHT  = 48;                 // max branch levels, far more than needed for any Size
+
+        struct Leaf;
+        struct Branch;
+
+        // Offset to items in leaf, and keys in branch, aligned for any type
+        static size_t leaf_offset()
+            { return (sizeof(Leaf) + 15) & ~(size_t)15; }
+        static size_t branch_offset()
+            { return (sizeof(Branch) + 15) & ~(size_t)15; }
+
+        struct Leaf {
+            Size  count;    // number of items
+            Size  id;       // index in leaves table
+            Leaf* prev;
+            Leaf* next;
+
+            Item* items()
+                { return (Item*)((char*)this + leaf_offset()); }
+            const Item* items() const
+                { return (const Item*)((const char*)this + leaf_offset()); }
+        };
+
+        struct Branch {
+            Size  count;                        // number of keys, number of children is count + 1
+            void* children[BRANCH_SIZE + 1];    // child for each key range, keys in children[i] are less than keys[i]
+
+            Key* keys()
+                { return (Key*)((char*)this + branch_offset()); }
+            const Key* keys() const
+                { return (const Key*)((const char*)this + branch_offset()); }
+        };
+
+        // Path from root to a leaf, used to split or merge nodes
+        struct Path {
+            Branch* nodes[MAX_HEIGHT];
+            Size    index[MAX_HEIGHT];  // child index in each node
+        };
+
+        // Raw aligned storage for a key being moved between branches
+        union KeyBuf {
+            char    buf[sizeof(Key)];
+            ulongl  align1;
+            ldouble align2;
+            void*   align3;
+
+            Key* ptr()
+                { return (Key*)buf; }
+        };
+
+        void*  root;            // root node, Leaf if height is 0, NULL if no nodes
+        Leaf*  first;           // first leaf, NULL if no nodes
+        Leaf*  last;            // last leaf, NULL if no nodes
+        Size   height;          // number of branch levels above leaves
+        Leaf** leaves;          // leaf for each id, NULL for free ids, followed by free id stack
+        Size   leaves_size;     // number of ids used
+        Size   leaves_cap;      // max ids before growing table
+        Size   free_count;      // number of free ids on stack
+
+        BTree() : root(NULL), first(NULL), last(NULL), height(0), leaves(NULL), leaves_size(0), leaves_cap(0), free_count(0)
+            { }
+        BTree(const BTree& src) : TCompare(src), root(NULL), first(NULL), last(NULL), height(0), leaves(NULL), leaves_size(0), leaves_cap(0), free_count(0)
+            { }
+        ~BTree()
+            { reset(); }
+
+        BTree& operator=(const BTree& src) {
+            TCompare::operator=(src);
+            return *this;
+        }
+
+    #if defined(EVO_CPP11)
+        BTree(BTree&& src) : TCompare(std::move((TCompare&&)src)), root(NULL), first(NULL), last(NULL), height(0), leaves(NULL), leaves_size(0), leaves_cap(0), free_count(0)
+            { swap(src); }
+        BTree& operator=(BTree&& src) {
+            reset();
+            TCompare::operator=(std::move((TCompare&&)src));
+            swap(src);
+            return *this;
+        }
+    #endif
+
+        void swap(BTree& src) {
+            evo::swap(root, src.root);
+            evo::swap(first, src.first);
+            evo::swap(last, src.last);
+            evo::swap(height, src.height);
+            evo::swap(leaves, src.leaves);
+            evo::swap(leaves_size, src.leaves_size);
+            evo::swap(leaves_cap, src.leaves_cap);
+            evo::swap(free_count, src.free_count);
+        }
+
+        // Free all items and nodes
+        void reset() {
+            if (root != NULL) {
+                free_node(root, height);
+                root  = NULL;
+                first = last = NULL;
+                height = 0;
+            }
+            if (leaves != NULL) {
+                ::free(leaves);
+                leaves = NULL;
+                leaves_size = leaves_cap = free_count = 0;
+            }
+        }
+
+        Size leaf_count() const
+            { return leaves_size - free_count; }
+
+        // FIND
+
+        // Find item with key, NULL if not found
+        const Item* find(const Key& key) const {
+            if (root != NULL) {
+                const Leaf* leaf = find_leaf(key);
+                bool found;
+                const Size pos = leaf_lower(leaf, key, found);
+                if (found)
+                    return leaf->items() + pos;
+            }
+            return NULL;
+        }
+
+        // Find item with key and set its position, NULL if not found
+        const Item* find(Size& leaf_id, Size& pos, const Key& key) const {
+            bool found;
+            const Item* item = lower(leaf_id, pos, key, found);
+            if (found)
+                return item;
+            leaf_id = END;
+            return NULL;
+        }
+
+        // Find first item with key greater or equal to given key and set its position, NULL if none
+        const Item* lower(Size& leaf_id, Size& pos, const Key& key, bool& found) const {
+            found = false;
+            if (root != NULL) {
+                const Leaf* leaf = find_leaf(key);
+                pos = leaf_lower(leaf, key, found);
+                if (pos >= leaf->count) {
+                    // Next leaf starts with a greater key
+                    leaf = leaf->next;
+                    pos  = 0;
+                }
+                if (leaf != NULL) {
+                    leaf_id = leaf->id;
+                    return leaf->items() + pos;
+                }
+            }
+            leaf_id = END;
+            return NULL;
+        }
+
+        // Find first item with key greater than given key and set its position, NULL if none
+        const Item* upper(Size& leaf_id, Size& pos, const Key& key) const {
+            bool found;
+            const Item* item = lower(leaf_id, pos, key, found);
+            if (found)
+                item = next_item(leaf_id, pos);
+            return item;
+        }
+
+        // ITERATE
+
+        const Item* first_item(Size& leaf_id, Size& pos) const {
+            pos = 0;
+            if (first != NULL && first->count > 0) {
+                leaf_id = first->id;
+                return first->items();
+            }
+            leaf_id = END;
+            return NULL;
+        }
+
+        const Item* next_item(Size& leaf_id, Size& pos) const {
+            if (leaf_id != END) {
+                const Leaf* leaf = leaves[leaf_id];
+                if (++pos < leaf->count)
+                    return leaf->items() + pos;
+                if ((leaf = leaf->next) != NULL) {
+                    leaf_id = leaf->id;
+                    pos = 0;
+                    return leaf->items();
+                }
+                leaf_id = END;
+            }
+            return NULL;
+        }
+
+        const Item* last_item(Size& leaf_id, Size& pos) const {
+            if (last != NULL && last->count > 0) {
+                leaf_id = last->id;
+                pos = last->count - 1;
+                return last->items() + pos;
+            }
+            leaf_id = END;
+            pos = 0;
+            return NULL;
+        }
+
+        const Item* prev_item(Size& leaf_id, Size& pos) const {
+            if (leaf_id != END) {
+                const Leaf* leaf = leaves[leaf_id];
+                if (pos > 0)
+                    return leaf->items() + --pos;
+                if ((leaf = leaf->prev) != NULL) {
+                    leaf_id = leaf->id;
+                    pos = leaf->count - 1;
+                    return leaf->items() + pos;
+                }
+                leaf_id = END;
+            }
+            return NULL;
+        }
+
+        // Get item at position, NULL if leaf_id is END
+        const Item* item_at(Size leaf_id, Size pos) const
+            { return (leaf_id == END ? NULL : leaves[leaf_id]->items() + pos); }
+
+        // Count items from first position up to (not including) end position, END if end doesn't follow first
+        Size count_range(Size leaf_id, Size pos, Size end_leaf_id, Size end_pos) const {
+            Size count = 0;
+            for (const Leaf* leaf = leaves[leaf_id]; leaf != NULL; leaf = leaf->next) {
+                if (leaf->id == end_leaf_id)
+                    return (end_pos >= pos ? count + (end_pos - pos) : END);
+                count += leaf->count - pos;
+                pos = 0;
+            }
+            return END;
+        }
+
+        // INSERT
+
+        // Find or insert item with key, new items are initialized with key and default value
+        Item* insert(const Key& key, bool& created) {
+            if (root == NULL)
+                root = first = last = leaf_new();
+
+            Path path;
+            Leaf* leaf = find_path(path, key);
+            bool found;
+            const Size pos = leaf_lower(leaf, key, found);
+            created = !found;
+            if (found)
+                return leaf->items() + pos;
+            if (leaf->count < LEAF_SIZE)
+                return leaf_insert(leaf, pos, key);
+
+            // Split full leaf -- when appending to last leaf, keep it full and start a new leaf so sequential inserts fill leaves
+            Leaf* right = leaf_new();
+            leaf_link(leaf, right);
+            const Size split = (pos == LEAF_SIZE && right->next == NULL ? LEAF_SIZE : (LEAF_SIZE + 1) / 2);
+            right->count = LEAF_SIZE - split;
+            if (right->count > 0)
+                memcpy((void*)right->items(), (const void*)(leaf->items() + split), right->count * sizeof(Item));
+            leaf->count = split;
+            Item* item = (pos < split ? leaf_insert(leaf, pos, key) : leaf_insert(right, pos - split, key));
+
+            KeyBuf sep;
+            new(sep.ptr()) Key(KeyOf::get(right->items()[0]));
+            branch_insert(path, sep, right);
+            return item;
+        }
+
+        // Load items into empty tree -- sorted items are appended to full leaves and branches are built bottom-up, once an item
+        // isn't in order it and all remaining items are inserted normally, where items with duplicate keys replace previous items
+        template<class TReader>
+        Size load(TReader& reader) {
+            assert( root == NULL );
+            Size count = 0;
+            const Item* src;
+            const Key* prev_key = NULL;
+            Leaf* leaf = NULL;
+            while ((src = reader.next()) != NULL) {
+                if (prev_key != NULL && TCompare::operator()(*prev_key, KeyOf::get(*src)) >= 0)
+                    break;
+                if (leaf == NULL) {
+                    leaf = first = last = leaf_new();
+                } else if (leaf->count >= LEAF_SIZE) {
+                    Leaf* next = leaf_new();
+                    leaf_link(leaf, next);
+                    leaf = next;
+                }
+                Item* item = leaf->items() + leaf->count;
+                DataInit<Item>::init(item, src, 1);
+                prev_key = &KeyOf::get(*item);
+                ++leaf->count;
+                ++count;
+            }
+
+            if (leaf != NULL) {
+                // Balance last 2 leaves
+                Leaf* left = leaf->prev;
+                if (left != NULL && leaf->count < LEAF_MIN) {
+                    const Size n = (left->count - leaf->count) / 2;
+                    memmove((void*)(leaf->items() + n), (const void*)leaf->items(), leaf->count * sizeof(Item));
+                    memcpy((void*)leaf->items(), (const void*)(left->items() + left->count - n), n * sizeof(Item));
+                    left->count -= n;
+                    leaf->count += n;
+                }
+                build_branches();
+            }
+
+            // Insert remaining items normally
+            for (; src != NULL; src = reader.next()) {
+                bool created;
+                Item* item = insert(KeyOf::get(*src), created);
+                if (created)
+                    ++count;
+                *item = *src;
+            }
+            return count;
+        }
+
+        // REMOVE
+
+        // Remove item with key, returns whether found and removed
+        bool remove(const Key& key) {
+            if (root != NULL) {
+                Path path;
+                Leaf* leaf = find_path(path, key);
+                bool found;
+                Size pos = leaf_lower(leaf, key, found);
+                if (found) {
+                    remove_items(path, leaf, pos, 1);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Remove items starting at position, leaf_id and pos are updated to next item position (leaf_id is END if no more)
+        Size remove_range(Size& leaf_id, Size& pos, Size count) {
+            Size removed = 0;
+            while (count > 0 && leaf_id != END) {
+                Leaf* leaf = leaves[leaf_id];
+                Size n = leaf->count - pos;
+                if (n > count)
+                    n = count;
+                Path path;
+                find_path(path, KeyOf::get(leaf->items()[pos]));
+                remove_items(path, leaf, pos, n);
+                removed += n;
+                count   -= n;
+                leaf_id = (leaf == NULL ? (Size)END : leaf->id);
+            }
+            return removed;
+        }
+
+        // Get position of item before given position, where leaf_id END is the end position, leaf_id set to END if no previous item
+        void prev_pos(Size& leaf_id, Size& pos) const {
+            if (leaf_id == END)
+                last_item(leaf_id, pos);
+            else
+                prev_item(leaf_id, pos);
+        }
+
+    private:
+        // Find leaf for key
+        const Leaf* find_leaf(const Key& key) const {
+            const void* node = root;
+            for (Size h = 0; h < height; ++h) {
+                const Branch* br = (const Branch*)node;
+                node = br->children[branch_child(br, key)];
+            }
+            return (const Leaf*)node;
+        }
+
+        // Find leaf for key and store path to it
+        Leaf* find_path(Path& path, const Key& key) const {
+            void* node = root;
+            for (Size h = 0; h < height; ++h) {
+                Branch* br = (Branch*)node;
+                const Size i = branch_child(br, key);
+                path.nodes[h] = br;
+                path.index[h] = i;
+                node = br->children[i];
+            }
+            return (Leaf*)node;
+        }
+
+        // Get child index for key -- index of first separator greater than key
+        Size branch_child(const Branch* br, const Key& key) const {
+            const Key* keys = br->keys();
+            Size left = 0, right = br->count, mid;
+            while (left < right) {
+                mid = left + ((right - left) / 2);
+                if (TCompare::operator()(key, keys[mid]) < 0)
+                    right = mid;
+                else
+                    left = mid + 1;
+            }
+            return left;
+        }
+
+        // Get index of first item with key greater or equal to key
+        Size leaf_lower(const Leaf* leaf, const Key& key, bool& found) const {
+            const Item* items = leaf->items();
+            Size left = 0, right = leaf->count, mid;
+            while (left < right) {
+                mid = left + ((right - left) / 2);
+                const int cmp = TCompare::operator()(key, KeyOf::get(items[mid]));
+                if (cmp < 0) {
+                    right = mid;
+                } else if (cmp == 0) {
+                    found = true;
+                    return mid;
+                } else
+                    left = mid + 1;
+            }
+            found = false;
+            return left;
+        }
+
+        // Insert new item in leaf with room
+        Item* leaf_insert(Leaf* leaf, Size pos, const Key& key) {
+            assert( leaf->count < LEAF_SIZE );
+            Item* item = leaf->items() + pos;
+            if (pos < leaf->count)
+                memmove((void*)(item + 1), (const void*)item, (leaf->count - pos) * sizeof(Item));
+            ++leaf->count;
+            KeyOf::init(item, key);
+            return item;
+        }
+
+        // Insert separator key and child to the right of it up the path, splitting full branches as needed -- sep is moved
+        void branch_insert(Path& path, KeyBuf& sep, void* child) {
+            for (Size h = height; h > 0; ) {
+                Branch* br = path.nodes[--h];
+                const Size i = path.index[h];
+                Key* keys = br->keys();
+                if (br->count < BRANCH_SIZE) {
+                    const Size move = br->count - i;
+                    memmove((void*)(keys + i + 1), (const void*)(keys + i), move * sizeof(Key));
+                    memmove(br->children + i + 2, br->children + i + 1, move * sizeof(void*));
+                    memcpy((void*)(keys + i), sep.buf, sizeof(Key));
+                    br->children[i + 1] = child;
+                    ++br->count;
+                    return;
+                }
+
+                // Split full branch: combine with new key and child, then move upper half to new branch and middle key up
+                char  tmp_keys[(BRANCH_SIZE + 1) * sizeof(Key)];
+                void* tmp_children[BRANCH_SIZE + 2];
+                memcpy(tmp_keys, (const void*)keys, i * sizeof(Key));
+                memcpy(tmp_keys + (i * sizeof(Key)), sep.buf, sizeof(Key));
+                memcpy(tmp_keys + ((i + 1) * sizeof(Key)), (const void*)(keys + i), (BRANCH_SIZE - i) * sizeof(Key));
+                memcpy(tmp_children, br->children, (i + 1) * sizeof(void*));
+                tmp_children[i + 1] = child;
+                memcpy(tmp_children + i + 2, br->children + i + 1, (BRANCH_SIZE - i) * sizeof(void*));
+
+                const Size mid = BRANCH_SIZE / 2;
+                Branch* right = branch_new();
+                right->count = BRANCH_SIZE - mid;
+                memcpy((void*)right->keys(), tmp_keys + ((mid + 1) * sizeof(Key)), right->count * sizeof(Key));
+                memcpy(right->children, tmp_children + mid + 1, (right->count + 1) * sizeof(void*));
+                br->count = mid;
+                memcpy((void*)keys, tmp_keys, mid * sizeof(Key));
+                memcpy(br->children, tmp_children, (mid + 1) * sizeof(void*));
+                memcpy(sep.buf, tmp_keys + (mid * sizeof(Key)), sizeof(Key));
+                child = right;
+            }
+
+            // New root
+            assert( height + 1 < MAX_HEIGHT );
+            Branch* br = branch_new();
+            memcpy((void*)br->keys(), sep.buf, sizeof(Key));
+            br->children[0] = root;
+            br->children[1] = child;
+            br->count = 1;
+            root = br;
+            ++height;
+        }
+
+        // Remove items from leaf, then merge or refill leaf if too small -- leaf and pos are updated to next item position (leaf is NULL if no more)
+        void remove_items(Path& path, Leaf*& leaf, Size& pos, Size count) {
+            assert( pos + count <= leaf->count );
+            Item* items = leaf->items();
+            DataInit<Item>::uninit(items + pos, count);
+            leaf->count -= count;
+            if (pos < leaf->count)
+                memmove((void*)(items + pos), (const void*)(items + pos + count), (leaf->count - pos) * sizeof(Item));
+            if (leaf->count < LEAF_MIN && height > 0)
+                leaf_rebalance(path, leaf, pos);
+            if (pos >= leaf->count) {
+                leaf = leaf->next;
+                pos  = 0;
+            }
+        }
+
+        // Merge leaf with a sibling, or move items from a sibling, leaf and pos are updated if items move
+        void leaf_rebalance(Path& path, Leaf*& leaf, Size& pos) {
+            Branch* parent = path.nodes[height - 1];
+            const Size i = path.index[height - 1];
+            Leaf* left  = (i > 0 ? (Leaf*)parent->children[i - 1] : NULL);
+            Leaf* right = (i < parent->count ? (Leaf*)parent->children[i + 1] : NULL);
+            if (left != NULL && left->count + leaf->count <= LEAF_SIZE) {
+                // Merge into left
+                memcpy((void*)(left->items() + left->count), (const void*)leaf->items(), leaf->count * sizeof(Item));
+                pos += left->count;
+                left->count += leaf->count;
+                leaf_unlink(leaf);
+                leaf_free(leaf);
+                leaf = left;
+                branch_remove(path, height - 1, i - 1, true);
+            } else if (right != NULL && leaf->count + right->count <= LEAF_SIZE) {
+                // Merge right into this
+                memcpy((void*)(leaf->items() + leaf->count), (const void*)right->items(), right->count * sizeof(Item));
+                leaf->count += right->count;
+                leaf_unlink(right);
+                leaf_free(right);
+                branch_remove(path, height - 1, i, true);
+            } else if (left != NULL) {
+                // Move items from end of left
+                const Size n = (left->count - leaf->count) / 2;
+                memmove((void*)(leaf->items() + n), (const void*)leaf->items(), leaf->count * sizeof(Item));
+                memcpy((void*)leaf->items(), (const void*)(left->items() + left->count - n), n * sizeof(Item));
+                left->count -= n;
+                leaf->count += n;
+                pos += n;
+                parent->keys()[i - 1] = KeyOf::get(leaf->items()[0]);
+            } else {
+                // Move items from start of right
+                assert( right != NULL );
+                const Size n = (right->count - leaf->count) / 2;
+                memcpy((void*)(leaf->items() + leaf->count), (const void*)right->items(), n * sizeof(Item));
+                memmove((void*)right->items(), (const void*)(right->items() + n), (right->count - n) * sizeof(Item));
+                leaf->count  += n;
+                right->count -= n;
+                parent->keys()[i] = KeyOf::get(right->items()[0]);
+            }
+        }
+
+        // Remove key and child to the right of it from branch at path level h, then merge or refill branch if too small
+        void branch_remove(Path& path, Size h, Size k, bool destroy_key) {
+            Branch* br = path.nodes[h];
+            Key* keys = br->keys();
+            if (destroy_key)
+                keys[k].~Key();
+            const Size move = br->count - k - 1;
+            memmove((void*)(keys + k), (const void*)(keys + k + 1), move * sizeof(Key));
+            memmove(br->children + k + 1, br->children + k + 2, move * sizeof(void*));
+            --br->count;
+
+            if (h == 0) {
+                if (br->count == 0) {
+                    // Remove root with single child
+                    root = br->children[0];
+                    ::free(br);
+                    --height;
+                }
+            } else if (br->count < BRANCH_MIN)
+                branch_rebalance(path, h);
+        }
+
+        // Merge branch at path level h with a sibling, or rotate a key from a sibling through the parent
+        void branch_rebalance(Path& path, Size h) {
+            Branch* br     = path.nodes[h];
+            Branch* parent = path.nodes[h - 1];
+            const Size i = path.index[h - 1];
+            Branch* left  = (i > 0 ? (Branch*)parent->children[i - 1] : NULL);
+            Branch* right = (i < parent->count ? (Branch*)parent->children[i + 1] : NULL);
+            Key* pkeys = parent->keys();
+            Key* keys  = br->keys();
+            if (left != NULL && left->count + br->count < BRANCH_SIZE) {
+                // Merge into left, moving separator down
+                Key* lkeys = left->keys();
+                memcpy((void*)(lkeys + left->count), (const void*)(pkeys + i - 1), sizeof(Key));
+                memcpy((void*)(lkeys + left->count + 1), (const void*)keys, br->count * sizeof(Key));
+                memcpy(left->children + left->count + 1, br->children, (br->count + 1) * sizeof(void*));
+                left->count += br->count + 1;
+                ::free(br);
+                branch_remove(path, h - 1, i - 1, false);
+            } else if (right != NULL && br->count + right->count < BRANCH_SIZE) {
+                // Merge right into this, moving separator down
+                memcpy((void*)(keys + br->count), (const void*)(pkeys + i), sizeof(Key));
+                memcpy((void*)(keys + br->count + 1), (const void*)right->keys(), right->count * sizeof(Key));
+                memcpy(br->children + br->count + 1, right->children, (right->count + 1) * sizeof(void*));
+                br->count += right->count + 1;
+                ::free(right);
+                branch_remove(path, h - 1, i, false);
+            } else if (left != NULL) {
+                // Rotate last key and child from left
+                memmove((void*)(keys + 1), (const void*)keys, br->count * sizeof(Key));
+                memmove(br->children + 1, br->children, (br->count + 1) * sizeof(void*));
+                memcpy((void*)keys, (const void*)(pkeys + i - 1), sizeof(Key));
+                br->children[0] = left->children[left->count];
+                memcpy((void*)(pkeys + i - 1), (const void*)(left->keys() + left->count - 1), sizeof(Key));
+                --left->count;
+                ++br->count;
+            } else {
+                // Rotate first key and child from right
+                assert( right != NULL );
+                Key* rkeys = right->keys();
+                memcpy((void*)(keys + br->count), (const void*)(pkeys + i), sizeof(Key));
+                br->children[br->count + 1] = right->children[0];
+                memcpy((void*)(pkeys + i), (const void*)rkeys, sizeof(Key));
+                memmove((void*)rkeys, (const void*)(rkeys + 1), (right->count - 1) * sizeof(Key));
+                memmove(right->children, right->children + 1, right->count * sizeof(void*));
+                --right->count;
+                ++br->count;
+            }
+        }
+
+        // Build branch levels over loaded leaves -- branches are filled, with the last 2 on each level balanced
+        void build_branches() {
+            Size count = leaf_count();
+            if (count == 1) {
+                root = first;
+                return;
+            }
+            void** nodes = (void**)::malloc((size_t)count * (sizeof(void*) + sizeof(const Key*)));
+            const Key** mins = (const Key**)(nodes + count);
+            Size i = 0;
+            for (Leaf* leaf = first; leaf != NULL; leaf = leaf->next, ++i) {
+                nodes[i] = leaf;
+                mins[i]  = &KeyOf::get(leaf->items()[0]);
+            }
+
+            const Size FANOUT = BRANCH_SIZE + 1;
+            while (count > 1) {
+                Size out = 0;
+                for (Size start = 0; start < count; ++out) {
+                    Size n = count - start;
+                    if (n > FANOUT)
+                        n = (n - FANOUT <= BRANCH_MIN ? n / 2 : FANOUT);
+                    Branch* br = branch_new();
+                    br->count = n - 1;
+                    Key* keys = br->keys();
+                    for (Size j = 0; j < n; ++j)
+                        br->children[j] = nodes[start + j];
+                    for (Size j = 1; j < n; ++j)
+                        new(keys + j - 1) Key(*mins[start + j]);
+                    nodes[out] = br;
+                    mins[out]  = mins[start];
+                    start += n;
+                }
+                count = out;
+                ++height;
+                assert( height < MAX_HEIGHT );
+            }
+            root = nodes[0];
+            ::free(nodes);
+        }
+
+        Leaf* leaf_new() {
+            Leaf* leaf = (Leaf*)::malloc(leaf_offset() + (size_t)LEAF_SIZE * sizeof(Item));
+            leaf->count = 0;
+            leaf->prev  = NULL;
+            leaf->next  = NULL;
+
+            // Get free id, or add id and grow table as needed
+            if (free_count > 0) {
+                leaf->id = ((Size*)(leaves + leaves_cap))[--free_count];
+            } else {
+                if (leaves_size >= leaves_cap) {
+                    const Size newcap = (leaves_cap > 0 ? leaves_cap * 2 : 8);
+                    Leaf** newleaves = (Leaf**)::malloc((size_t)newcap * (sizeof(Leaf*) + sizeof(Size)));
+                    if (leaves != NULL) {
+                        memcpy(newleaves, leaves, leaves_size * sizeof(Leaf*));
+                        ::free(leaves);
+                    }
+                    leaves     = newleaves;
+                    leaves_cap = newcap;
+                }
+                leaf->id = leaves_size++;
+            }
+            leaves[leaf->id] = leaf;
+            return leaf;
+        }
+
+        // Free leaf, items must already be freed or moved
+        void leaf_free(Leaf* leaf) {
+            leaves[leaf->id] = NULL;
+            ((Size*)(leaves + leaves_cap))[free_count++] = leaf->id;
+            ::free(leaf);
+        }
+
+        // Link new leaf after leaf
+        void leaf_link(Leaf* leaf, Leaf* next) {
+            next->prev = leaf;
+            next->next = leaf->next;
+            if (leaf->next != NULL)
+                leaf->next->prev = next;
+            else
+                last = next;
+            leaf->next = next;
+        }
+
+        void leaf_unlink(Leaf* leaf) {
+            if (leaf->prev != NULL)
+                leaf->prev->next = leaf->next;
+            else
+                first = leaf->next;
+            if (leaf->next != NULL)
+                leaf->next->prev = leaf->prev;
+            else
+                last = leaf->prev;
+        }
+
+        Branch* branch_new() {
+            Branch* br = (Branch*)::malloc(branch_offset() + (size_t)BRANCH_SIZE * sizeof(Key));
+            br->count = 0;
+            return br;
+        }
+
+        // Free node and all child nodes with items and keys, height is 0 for leaf
+        void free_node(void* node, Size h) {
+            if (h == 0) {
+                Leaf* leaf = (Leaf*)node;
+                if (leaf->count > 0)
+                    DataInit<Item>::uninit(leaf->items(), leaf->count);
+                ::free(leaf);
+            } else {
+                Branch* br = (Branch*)node;
+                for (Size i = 0; i <= br->count; ++i)
+                    free_node(br->children[i], h - 1);
+                if (br->count > 0)
+                    DataInit<Key>::uninit(br->keys(), br->count);
+                ::free(br);
+            }
+        }
+    };
+}
+/** \endcond */
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
+#endif
@@ -60,8 +60,14 @@ Evo containers
 
 ///////////////////////////////////////////////////////////////////////////////
 
-/** \cond impl */
-/** %Allocator base class. */
+/** %Allocator base class.
+ - Containers that support allocators use this to allocate and free their buffers, when EVO_ALLOCATORS is enabled
+   - Bind an allocator to a container with `set_allocator()` -- see List, String, PtrList, MapList, MapHash
+   - A NULL allocator uses the default (malloc/realloc/free)
+   - Each buffer remembers the allocator used, so it's always freed with the same allocator
+ - Implementations: ArenaAllocator, PoolAllocator (see allocator.h)
+ - \b Caution: An allocator must not be destroyed (or reset) while any container is still using memory from it
+*/
 struct Allocator {
     static const bool SHARED = true;    ///< This allocator can be shared among multiple containers
 
@@ -86,6 +92,20 @@ struct Allocator {
     */
     virtual void free(void* ptr) = 0;
 };
+
+// Internal allocation/deallocation macros using an allocator (NULL for default) -- used by containers when EVO_ALLOCATORS is enabled
+/** \cond impl */
+#define EVO_IMPL_CONTAINER_MEM_ALLOC_A(ALLOCATOR, TYPE, BYTES) \
+    (TYPE*)((ALLOCATOR) == NULL ? ::malloc(BYTES) : (ALLOCATOR)->alloc(BYTES))
+#define EVO_IMPL_CONTAINER_MEM_REALLOC_A(ALLOCATOR, TYPE, PTR, BYTES) \
+    (TYPE*)((ALLOCATOR) == NULL ? ::realloc(PTR, BYTES) : (ALLOCATOR)->realloc(PTR, BYTES))
+#define EVO_IMPL_CONTAINER_MEM_FREE_A(ALLOCATOR, PTR) { \
+    assert( PTR != NULL ); \
+    if ((ALLOCATOR) == NULL) \
+        ::free(PTR); \
+    else \
+        (ALLOCATOR)->free(PTR); \
+}
 /** \endcond */
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -928,6 +948,36 @@ template<class T, class H> struct DataHash<T,H,true> : public DataType<T> {
 };
 /** \endcond */
 
+/** \cond impl */
+namespace impl {
+    // DataHash helper for list types with contiguous items, hashes items directly with H
+    template<class TList, class TItem, class H>
+    struct DataHashList : public DataType<TList> {
+        typedef H HashType;
+        static ulong hash(const TList* data, ulong size, ulong seed=0) {
+            for (ulong i = 0; i < size; ++i)
+                seed = hash(data[i], seed);
+            return seed;
+        }
+        static ulong hash(const TList& data, ulong seed=0)
+            { return DataHash<TItem,H>::hash(data.data(), data.size(), seed); }
+    };
+
+    // Default hashing class uses TList::hash(), which may use a cached hash value for shared buffers -- see EVO_LIST_OPT_HASHCACHE
+    template<class TList, class TItem>
+    struct DataHashList<TList,TItem,SpookyHash> : public DataType<TList> {
+        typedef SpookyHash HashType;
+        static ulong hash(const TList* data, ulong size, ulong seed=0) {
+            for (ulong i = 0; i < size; ++i)
+                seed = data[i].hash(seed);
+            return seed;
+        }
+        static ulong hash(const TList& data, ulong seed=0)
+            { return data.hash(seed); }
+    };
+}
+/** \endcond */
+
 ///////////////////////////////////////////////////////////////////////////////
 
 /** Base type for comparison types.
@@ -1048,16 +1098,19 @@ struct CompareIR : public CompareBase<T> {
 
 /** %Hash object used with containers that hash items.
  - This inherits an associated comparison type used with hash collisons
- - Hashing is done with the SpookyHash V2 library (included with Evo):
+ - Hashing is done with the SpookyHash V2 library (included with Evo) by default:
    - SpookyHash reference: http://burtleburtle.net/bob/hash/spooky.html
+   - Use `H` to select a different hash function, like WyHash or AesHash, which are much faster on short keys
  - Non-POD types are compared by calling method the `T::hash()`, which should use DataHash to hash the actual data
    - Evo types like String implement this hash() method
+   - String and List keys are hashed with `H` directly via DataHash specializations
    - See IsNormalType, TypeId
    .
  .
  \tparam  T  Type to hash
+ \tparam  H  Hashing class to use -- default: SpookyHash, see also: WyHash, AesHash
 */
-template<class T>
+template<class T, class H=SpookyHash>
 struct CompareHash : public Compare<T> {
 #if defined(EVO_OLDCC)
     typedef typename DataType<T>::Item Item;
@@ -1076,7 +1129,7 @@ struct CompareHash : public Compare<T> {
      \return       Hash function result
     */
     ulong hash(PassItem key, ulong seed=0) const
-        { return DataHash<T>::hash(key, seed); }
+        { return DataHash<T,H>::hash(key, seed); }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,193 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file eytzinger.h Evo implementation detail: Eytzinger (BFS) layout search index used by SetList and MapList freeze(). */
+#pragma once
+#ifndef INCL_evo_impl_eytzinger_h
+#define INCL_evo_impl_eytzinger_h
+
+#include "../type.h"
+#include "../pair.h"
+
+#if defined(__GNUC__)
+    #define EVO_IMPL_PREFETCH(ptr) __builtin_prefetch(ptr)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <xmmintrin.h>
+    #define EVO_IMPL_PREFETCH(ptr) _mm_prefetch((const char*)(ptr), _MM_HINT_T0)
+#else
+    #define EVO_IMPL_PREFETCH(ptr)
+#endif
+
+namespace evo {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** \cond impl */
+namespace impl {
+    /* Read-optimized search index over a sorted array of keys or key/value pairs.
+     - Holds a copy of the keys in Eytzinger (BFS) order: node k has children at 2k and 2k+1, and keys are 1-based in a cache-line aligned buffer
+     - Search is branchless: each level does `k = 2*k + (key[k] < x)`, then the lower bound is decoded by dropping the trailing right turns from k
+     - Each search prefetches the cache line holding the descendants of node k a few levels down, so memory latency overlaps with the comparisons
+     - Each BFS position also stores the sorted index for that key, so results map back to the source array
+     - The index is a snapshot: the owner must clear() it when the source array changes
+    */
+    template<class TKey, class TSize>
+    class EytzingerIndex {
+    public:
+        typedef TKey  Key;
+        typedef TSize Size;
+
+        static const uint FIND_BATCH = 16;      // searches interleaved by find_many()
+
+        EytzingerIndex() : data_(NULL)
+            { }
+
+        ~EytzingerIndex()
+            { clear(); }
+
+        bool active() const
+            { return (data_ != NULL); }
+
+        void clear() {
+            if (data_ != NULL) {
+                if (data_->size > 0)
+                    DataInit<Key>::uninit(data_->keys + 1, data_->size);
+                ::free(data_);
+                data_ = NULL;
+            }
+        }
+
+        void swap(EytzingerIndex& other)
+            { evo::swap(data_, other.data_); }
+
+        // Build index from sorted items, items must be unique and sorted according to the comparison used to search
+        template<class TItem>
+        void build(const TItem* items, Size size) {
+            clear();
+            const size_t keys_bytes = ((size_t)size + 1) * sizeof(Key);
+            const size_t keys_align = (keys_bytes + sizeof(uint64) - 1) & ~(size_t)(sizeof(uint64) - 1);
+            char* buf = (char*)::malloc(sizeof(Data) + LINE + keys_align + ((size_t)size + 1) * sizeof(Size));
+            char* keys = buf + sizeof(Data);
+            keys += (LINE - ((size_t)keys & (LINE - 1))) & (LINE - 1);
+
+            data_ = (Data*)buf;
+            data_->keys    = (Key*)keys;
+            data_->indexes = (Size*)(keys + keys_align);
+            data_->size    = size;
+            data_->levels  = 0;
+            while ((((uint64)2 << data_->levels) - 1) <= (uint64)size)
+                ++data_->levels;
+            data_->indexes[0] = size;
+
+            Size i = 0;
+            build_node(items, i, 1);
+            assert( i == size );
+        }
+
+        // Find key, set index to found sorted index or to the lower bound (insert position) if not found
+        template<class TCompare>
+        bool find(Size& index, const Key& key, const TCompare& compare) const {
+            const Key* keys = data_->keys;
+            const Size size = data_->size;
+            Size k = 1;
+            for (uint level = data_->levels; level > 0; --level) {
+                EVO_IMPL_PREFETCH(keys + (size_t)k * PREFETCH_STRIDE);
+                k = 2 * k + (Size)(compare(keys[k], key) < 0);
+            }
+            if (k <= size)
+                k = 2 * k + (Size)(compare(keys[k], key) < 0);
+            k = decode(k);
+            index = data_->indexes[k];
+            return (k > 0 && compare(keys[k], key) == 0);
+        }
+
+        // Find multiple keys and store sorted index for each (END if not found), interleaving up to FIND_BATCH searches level by level so their cache misses overlap
+        template<class TCompare>
+        Size find_many(const Key* keys, Size count, Size* indexes, const TCompare& compare) const {
+            const Key* index_keys = data_->keys;
+            const Size size = data_->size;
+            Size pos[FIND_BATCH];
+            Size found = 0;
+            for (Size start = 0; start < count; start += FIND_BATCH) {
+                const uint batch = (count - start < FIND_BATCH ? (uint)(count - start) : FIND_BATCH);
+                const Key* batch_keys = keys + start;
+                for (uint j = 0; j < batch; ++j)
+                    pos[j] = 1;
+                for (uint level = data_->levels; level > 0; --level) {
+                    for (uint j = 0; j < batch; ++j) {
+                        const Size k = 2 * pos[j] + (Size)(compare(index_keys[pos[j]], batch_keys[j]) < 0);
+                        EVO_IMPL_PREFETCH(index_keys + (size_t)k * PREFETCH_STRIDE);
+                        pos[j] = k;
+                    }
+                }
+                for (uint j = 0; j < batch; ++j) {
+                    Size k = pos[j];
+                    if (k <= size)
+                        k = 2 * k + (Size)(compare(index_keys[k], batch_keys[j]) < 0);
+                    k = decode(k);
+                    if (k > 0 && compare(index_keys[k], batch_keys[j]) == 0) {
+                        indexes[start + j] = data_->indexes[k];
+                        ++found;
+                    } else
+                        indexes[start + j] = END;
+                }
+            }
+            return found;
+        }
+
+    private:
+        // Copying not supported, the owner drops the index on copy
+        EytzingerIndex(const EytzingerIndex&);
+        EytzingerIndex& operator=(const EytzingerIndex&);
+
+        static const size_t LINE = 64;
+        static const size_t LINE_KEYS = (sizeof(Key) >= LINE / 2 ? 2 : LINE / sizeof(Key));
+        static const size_t PREFETCH_STRIDE = (LINE_KEYS >= 16 ? 16 : (LINE_KEYS >= 8 ? 8 : (LINE_KEYS >= 4 ? 4 : 2)));     // descendants this many times k share a cache line
+
+        struct Data {
+            Key*  keys;         // keys in BFS order, 1-based
+            Size* indexes;      // sorted index for each BFS position, 1-based -- indexes[0] is size (not found lower bound)
+            Size  size;
+            uint  levels;       // number of complete tree levels, each search does at least this many steps
+        };
+
+        Data* data_;
+
+        // In-order walk of the implicit tree visits BFS positions in sorted order
+        template<class TItem>
+        void build_node(const TItem* items, Size& i, Size k) {
+            if (k <= data_->size) {
+                build_node(items, i, 2 * k);
+                DataInit<Key>::init(data_->keys + k, &item_key(items[i]), 1);
+                data_->indexes[k] = i++;
+                build_node(items, i, 2 * k + 1);
+            }
+        }
+
+        static const Key& item_key(const Key& item)
+            { return item; }
+
+        template<class T>
+        static const Key& item_key(const Pair<Key,T>& item)
+            { return item.first; }
+
+        // Drop trailing right turns and the last left turn to get the lower bound node, 0 if none
+        static Size decode(Size k) {
+        #if defined(__GNUC__)
+            return (Size)((uint64)k >> (__builtin_ctzll(~(uint64)k) + 1));
+        #else
+            while (k & 1)
+                k >>= 1;
+            return k >> 1;
+        #endif
+        }
+    };
+}
+/** \endcond */
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
+#endif
@@ -10,6 +10,26 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 
 #include "sys.h"
 
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>     // _umul128(), __cpuid()
+#endif
+
+// AES-NI hashing with runtime CPU check, x86-64 only
+#if !defined(EVO_NO_CPU) && !defined(EVO_NO_AES) && defined(EVO_64)
+    #if defined(_MSC_VER) && defined(_M_X64)
+        #include <wmmintrin.h>
+        #define EVO_IMPL_AES
+    #elif defined(__x86_64__) && (defined(EVO_CLANG_VER) || EVO_GCC_VER >= 409)
+        #include <cpuid.h>
+        #include <wmmintrin.h>
+        #define EVO_IMPL_AES
+        #define EVO_IMPL_AES_TARGET __attribute__((target("aes,sse2")))
+    #endif
+    #if defined(EVO_IMPL_AES) && !defined(EVO_IMPL_AES_TARGET)
+        #define EVO_IMPL_AES_TARGET
+    #endif
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // The following was mostly copied from SpookyHash V2 by Bob Jenkins (public domain) -- Aug 5 2012
 // http://burtleburtle.net/bob/hash/spooky.html
@@ -534,4 +554,233 @@ private:
 
 /** \endcond */
 ///////////////////////////////////////////////////////////////////////////////
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Fast hash for short keys, based on wyhash (final 4) by Wang Yi (public domain).
+ - This has a much lower fixed cost than SpookyHash (the default) on short keys, like most string keys (8-40 bytes)
+ - Use as the `H` param with DataHash and CompareHash, for example: `MapHash<String,int,CompareHash<String,WyHash> >`
+ - Hash values differ from SpookyHash, so don't mix them for the same data
+ - On 32-bit systems the 64-bit result is folded to 32 bits
+ .
+*/
+struct WyHash {
+    /** Compute hash value from data.
+     \param  data  Data pointer to hash
+     \param  size  Data size in bytes
+     \param  seed  Seed value for chaining from a previous hash, 0 if none
+     \return       Hash value
+    */
+    static ulong hash(const void* data, ulong size, ulong seed) {
+        const uint64 result = hash64((const uint8*)data, size, seed);
+    #if defined(EVO_32)
+        return (ulong)(result ^ (result >> 32));
+    #else
+        return (ulong)result;
+    #endif
+    }
+
+    /** Compute hash value from POD value.
+     \tparam  T  Value type, inferred from param
+     \param  value  Value to hash
+     \param  seed   Seed value for chaining from a previous hash, 0 if none
+     \return        Hash value
+    */
+    template<class T>
+    static ulong hash_pod(T value, ulong seed)
+        { return hash(&value, sizeof(T), seed); }
+
+    /** \cond impl */
+    static const uint64 P0 = 0x2d358dccaa6c78a5ULL;
+    static const uint64 P1 = 0x8bb84b93962eacc9ULL;
+    static const uint64 P2 = 0x4b33a62ed433d4a3ULL;
+    static const uint64 P3 = 0x4d5a2da51de1aa47ULL;
+
+    // 64x64 to 128-bit multiply, returns low bits in a and high bits in b
+    static void mum(uint64& a, uint64& b) {
+    #if defined(__SIZEOF_INT128__)
+        const unsigned __int128 r = (unsigned __int128)a * b;
+        a = (uint64)r;
+        b = (uint64)(r >> 64);
+    #elif defined(_MSC_VER) && defined(_M_X64)
+        a = _umul128(a, b, &b);
+    #else
+        const uint64 ha = a >> 32, hb = b >> 32, la = (uint32)a, lb = (uint32)b;
+        const uint64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+        uint64 c = (t < rl);
+        const uint64 lo = t + (rm1 << 32);
+        c += (lo < t);
+        b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+        a = lo;
+    #endif
+    }
+
+    static uint64 mix(uint64 a, uint64 b)
+        { mum(a, b); return a ^ b; }
+
+    static uint64 read8(const uint8* p)
+        { uint64 v; memcpy(&v, p, 8); return v; }
+    static uint64 read4(const uint8* p)
+        { uint32 v; memcpy(&v, p, 4); return v; }
+    static uint64 read3(const uint8* p, ulong k)
+        { return ((uint64)p[0] << 16) | ((uint64)p[k >> 1] << 8) | p[k - 1]; }
+
+    static uint64 hash64(const uint8* p, ulong size, uint64 seed) {
+        seed ^= mix(seed ^ P0, P1);
+        uint64 a, b;
+        if (size <= 16) {
+            if (size >= 4) {
+                const ulong mid = (size >> 3) << 2;
+                a = (read4(p) << 32) | read4(p + mid);
+                b = (read4(p + size - 4) << 32) | read4(p + size - 4 - mid);
+            } else if (size > 0) {
+                a = read3(p, size);
+                b = 0;
+            } else
+                a = b = 0;
+        } else {
+            ulong i = size;
+            if (i > 48) {
+                uint64 seed1 = seed, seed2 = seed;
+                do {
+                    seed  = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+                    seed1 = mix(read8(p + 16) ^ P2, read8(p + 24) ^ seed1);
+                    seed2 = mix(read8(p + 32) ^ P3, read8(p + 40) ^ seed2);
+                    p += 48;
+                    i -= 48;
+                } while (i > 48);
+                seed ^= seed1 ^ seed2;
+            }
+            while (i > 16) {
+                seed = mix(read8(p) ^ P1, read8(p + 8) ^ seed);
+                i -= 16;
+                p += 16;
+            }
+            a = read8(p + i - 16);
+            b = read8(p + i - 8);
+        }
+        a ^= P1;
+        b ^= seed;
+        mum(a, b);
+        return mix(a ^ P0 ^ size, b ^ P1);
+    }
+    /** \endcond */
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Fast hash for short keys using AES-NI instructions, with fallback to WyHash.
+ - This uses one AES round per 16 bytes of input, and 3 rounds to finish, so is very fast on short and medium keys
+ - AES-NI support is checked at runtime (once), and when not supported this uses WyHash instead
+   - AES-NI is only used with 64-bit x86 (with GCC 4.9+, clang, or MSVC), other targets always use WyHash
+   - Define `EVO_NO_AES` to disable AES-NI
+ - Use as the `H` param with DataHash and CompareHash, for example: `MapHash<String,int,CompareHash<String,AesHash> >`
+ - Hash values depend on CPU support so must not be persisted or shared between machines
+ .
+*/
+struct AesHash {
+    /** Get whether AES-NI instructions are used.
+     \return  Whether AES-NI used, false if using WyHash fallback
+    */
+    static bool supported() {
+    #if defined(EVO_IMPL_AES)
+        static const bool result = cpu_check();
+        return result;
+    #else
+        return false;
+    #endif
+    }
+
+    /** Compute hash value from data.
+     \param  data  Data pointer to hash
+     \param  size  Data size in bytes
+     \param  seed  Seed value for chaining from a previous hash, 0 if none
+     \return       Hash value
+    */
+    static ulong hash(const void* data, ulong size, ulong seed) {
+    #if defined(EVO_IMPL_AES)
+        if (supported())
+            return (ulong)hash_aes((const uint8*)data, size, seed);
+    #endif
+        return WyHash::hash(data, size, seed);
+    }
+
+    /** Compute hash value from POD value.
+     \tparam  T  Value type, inferred from param
+     \param  value  Value to hash
+     \param  seed   Seed value for chaining from a previous hash, 0 if none
+     \return        Hash value
+    */
+    template<class T>
+    static ulong hash_pod(T value, ulong seed)
+        { return hash(&value, sizeof(T), seed); }
+
+    /** \cond impl */
+#if defined(EVO_IMPL_AES)
+    static bool cpu_check() {
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        return ((info[2] >> 25) & 1) != 0;
+    #else
+        uint eax, ebx, ecx, edx;
+        return (__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & bit_AES) != 0);
+    #endif
+    }
+
+    EVO_IMPL_AES_TARGET static __m128i load16(const uint8* p)
+        { return _mm_loadu_si128((const __m128i*)p); }
+
+    EVO_IMPL_AES_TARGET static uint64 hash_aes(const uint8* p, ulong size, uint64 seed) {
+        const __m128i K0 = _mm_set_epi64x((int64)WyHash::P0, (int64)WyHash::P1);
+        const __m128i K1 = _mm_set_epi64x((int64)WyHash::P2, (int64)WyHash::P3);
+        __m128i a = _mm_xor_si128(_mm_set_epi64x((int64)seed, (int64)size), K0);
+        __m128i b = _mm_xor_si128(_mm_set_epi64x((int64)size, (int64)seed), K1);
+        if (size <= 16) {
+            uint64 lo, hi;
+            if (size >= 8) {
+                lo = WyHash::read8(p);
+                hi = WyHash::read8(p + size - 8);
+            } else if (size >= 4) {
+                lo = WyHash::read4(p);
+                hi = WyHash::read4(p + size - 4);
+            } else if (size > 0) {
+                lo = WyHash::read3(p, size);
+                hi = 0;
+            } else
+                lo = hi = 0;
+            a = _mm_aesenc_si128(_mm_xor_si128(a, _mm_set_epi64x((int64)hi, (int64)lo)), K1);
+        } else {
+            // Two lanes of 16 bytes each, last blocks may overlap previous ones
+            const uint8* end = p + size;
+            if (size > 32) {
+                const uint8* last = end - 32;
+                do {
+                    a = _mm_aesenc_si128(_mm_xor_si128(a, load16(p)), K1);
+                    b = _mm_aesenc_si128(_mm_xor_si128(b, load16(p + 16)), K0);
+                    p += 32;
+                } while (p < last);
+                a = _mm_aesenc_si128(_mm_xor_si128(a, load16(last)), K1);
+                b = _mm_aesenc_si128(_mm_xor_si128(b, load16(last + 16)), K0);
+            } else {
+                a = _mm_aesenc_si128(_mm_xor_si128(a, load16(p)), K1);
+                b = _mm_aesenc_si128(_mm_xor_si128(b, load16(end - 16)), K0);
+            }
+        }
+        __m128i h = _mm_aesenc_si128(a, b);
+        h = _mm_aesenc_si128(h, K0);
+        h = _mm_aesenc_si128(h, K1);
+        return (uint64)_mm_cvtsi128_si64(h) ^ (uint64)_mm_cvtsi128_si64(_mm_unpackhi_epi64(h, h));
+    }
+#endif
+    /** \endcond */
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
 #endif
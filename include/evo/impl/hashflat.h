@@ -0,0 +1,129 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file hashflat.h Evo implementation detail: Flat hash table group probing. */
+#pragma once
+#ifndef INCL_evo_impl_hashflat_h
+#define INCL_evo_impl_hashflat_h
+
+#include "sys.h"
+#include <string.h>
+
+#if defined(EVO_CPU)
+    #if defined(_WIN32)
+        #include <intrin.h>
+        #pragma intrinsic(_BitScanForward)
+    #elif defined(EVO_IMPL_SSE42) || defined(EVO_IMPL_SSE2)
+        #include <emmintrin.h>
+    #endif
+#endif
+
+namespace evo {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** \cond impl */
+namespace impl {
+    /* Group of control bytes in a flat hash table, matched together.
+     - Each slot has a control byte: full slots store the low 7 bits of the item hash (high bit clear), empty and deleted slots have high bit set
+     - Each match returns a bitmask with 1 bit per matching slot in group (bit 0 for first slot), use next() to iterate matches
+     - This uses SSE 2 when available, otherwise matches 8 bytes at a time with 64-bit integer ops
+     - The control byte array must be readable for SIZE bytes at any slot position, so the first SIZE bytes are mirrored at the end
+    */
+    struct HashFlatGroup {
+        static const uint SIZE = 16;                    // number of control bytes in a group
+        static const char EMPTY   = (char)0x80;         // control byte for empty slot
+        static const char DELETED = (char)0xFE;         // control byte for deleted slot
+        static const ulong HASH_MASK = 0x7F;            // mask for hash bits stored in control byte
+
+        // Get control byte for given hash
+        static char ctrl(ulong hash)
+            { return (char)(hash & HASH_MASK); }
+
+        // Get whether control byte is for a full slot
+        static bool full(char ctrl)
+            { return ((uchar)ctrl & 0x80) == 0; }
+
+        // Get index of lowest match in mask and remove it from mask, mask must not be 0
+        static uint next(uint& mask) {
+            assert( mask != 0 );
+        #if defined(_MSC_VER)
+            unsigned long i;
+            _BitScanForward(&i, mask);
+            const uint index = (uint)i;
+        #elif defined(__GNUC__)
+            const uint index = (uint)__builtin_ctz(mask);
+        #else
+            uint index = 0;
+            while (!(mask & (1U << index)))
+                ++index;
+        #endif
+            mask &= (mask - 1);
+            return index;
+        }
+
+    #if defined(EVO_IMPL_SSE42) || defined(EVO_IMPL_SSE2)
+        __m128i data;
+
+        explicit HashFlatGroup(const char* ctrl) : data(_mm_loadu_si128((const __m128i*)ctrl))
+            { }
+
+        // Get slots matching given hash control byte
+        uint match(char h2) const
+            { return (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(data, _mm_set1_epi8(h2))); }
+
+        // Get empty slots
+        uint match_empty() const
+            { return match(EMPTY); }
+
+        // Get empty or deleted slots (high bit set)
+        uint match_avail() const
+            { return (uint)_mm_movemask_epi8(data); }
+    #else
+        uint64 data[2];
+
+        explicit HashFlatGroup(const char* ctrl)
+            { memcpy(data, ctrl, SIZE); }
+
+        uint match(char h2) const {
+            const uint64 pattern = LSB * (uchar)h2;
+            return bytemask(zero_bytes(data[0] ^ pattern)) | (bytemask(zero_bytes(data[1] ^ pattern)) << 8);
+        }
+
+        uint match_empty() const
+            { return match(EMPTY); }
+
+        uint match_avail() const
+            { return bytemask(data[0] & MSB) | (bytemask(data[1] & MSB) << 8); }
+
+    private:
+        static const uint64 LSB = 0x0101010101010101ULL;
+        static const uint64 MSB = 0x8080808080808080ULL;
+
+        // Set high bit of each zero byte, clear all other bits (no false positives)
+        static uint64 zero_bytes(uint64 val)
+            { return ~(((val & ~MSB) + ~MSB) | val | ~MSB); }
+
+        // Pack high bit of each byte into 8-bit mask, lowest address byte first (bytes are in memory order)
+        static uint bytemask(uint64 val) {
+        #if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+            return (uint)(((val >> 7) * 0x0102040810204080ULL) >> 56);
+        #else
+            uint mask = 0;
+            for (uint i = 0; i < 8; ++i)
+                if (val & (0x80ULL << ((7 - i) * 8)))
+                    mask |= (1U << i);
+            return mask;
+        #endif
+        }
+    #endif
+    };
+}
+/** \endcond */
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
+#endif
@@ -9,6 +9,8 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 #define INCL_evo_impl_str_h
 
 #include "sys.h"
+#include "strfloat.h"
+#include "strsimd.h"
 #include "../meta.h"
 
 // Disable certain MSVC warnings for this file
@@ -42,6 +44,10 @@ namespace impl {
     static const int CHARMAP_LOWER_LAST  = 122;
     inline const char* CHARMAP_LOWER()
         { return "abcdefghijklmnopqrstuvwxyz"; }
+
+    // Decimal digit pairs "00" to "99", used to format 2 digits at a time
+    inline const char* DIGIT_PAIRS()
+        { return "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899"; }
 };
 /** \endcond */
 
@@ -1162,7 +1168,7 @@ inline const char* string_memrchr(const char* str, char ch, size_t size) {
 
 /** %String search algorithm selection. */
 enum StringSearchAlg {
-    ssaDEFAULT=0,   ///< Default, uses system memmem() if possible (define EVO_NO_MEMMEM to prevent this), otherwise same as ssaKMP
+    ssaDEFAULT=0,   ///< Default, uses SSE optimized search when enabled (see \ref CppCompilers), otherwise system memmem() if possible (define EVO_NO_MEMMEM to prevent this), otherwise same as ssaKMP
     ssaKMP,         ///< Knuth-Morris-Pratt using partial match table
     ssaBASIC        ///< Basic search using memchr() and memcmp()
 };
@@ -1260,7 +1266,12 @@ namespace impl {
                 if (memcmp(data, pattern, data_size) == 0)
                     return offset;
             } else {
-            #if !defined(EVO_NO_MEMMEM) && defined(EVO_GLIBC_MEMMEM)
+            #if defined(EVO_CPU)
+                // SSE first and last char filter
+                const char* ptr = str_search_cpu(data, data_size, pattern, pattern_size);
+                if (ptr != NULL)
+                    return offset + (ulong)(ptr - data);
+            #elif !defined(EVO_NO_MEMMEM) && defined(EVO_GLIBC_MEMMEM)
                 // memmem()
                 const char* ptr = (char*)memmem(data, data_size, pattern, pattern_size);
                 if (ptr != NULL)
@@ -1359,8 +1370,8 @@ namespace impl {
 
     // Reverse search
 
-    // Find pattern in string with reverse search, offset is added to result if found -- default uses KMP
-    inline ulong string_search_reverse(const char* pattern, uint pattern_size, const char* data, ulong data_size, ulong offset) {
+    // Find pattern in string with reverse search, offset is added to result if found -- uses KMP
+    inline ulong string_search_reverse_kmp(const char* pattern, uint pattern_size, const char* data, ulong data_size, ulong offset) {
         if (pattern_size > 0 && pattern_size <= data_size) {
             if (pattern_size == 1) {
                 // Special case for single char
@@ -1396,6 +1407,17 @@ namespace impl {
         return NONE;
     }
 
+    // Find pattern in string with reverse search, offset is added to result if found -- uses SSE optimized search when enabled, otherwise KMP
+    inline ulong string_search_reverse(const char* pattern, uint pattern_size, const char* data, ulong data_size, ulong offset) {
+    #if defined(EVO_CPU)
+        if (pattern_size > 1 && pattern_size < data_size) {
+            const char* ptr = str_search_cpu_r(data, data_size, pattern, pattern_size);
+            return (ptr == NULL ? NONE : offset + (ulong)(ptr - data));
+        }
+    #endif
+        return string_search_reverse_kmp(pattern, pattern_size, data, data_size, offset);
+    }
+
     // string_search_reverse() variant
     inline ulong string_search_reverse_basic(const char* pattern, uint pattern_size, const char* data, ulong data_size, ulong offset) {
         if (pattern_size > 0 && pattern_size <= data_size) {
@@ -1443,9 +1465,10 @@ namespace impl {
     // Select a string_search_reverse() variant dynamically
     inline ulong string_search_reverse(StringSearchAlg alg, const char* pattern, uint pattern_size, const char* data, ulong data_size, ulong offset) {
         switch (alg) {
+            case ssaKMP:
+                return string_search_reverse_kmp(pattern, pattern_size, data, data_size, offset);
             case ssaBASIC:
                 return string_search_reverse_basic(pattern, pattern_size, data, data_size, offset);
-            case ssaKMP:
             default:
                 return string_search_reverse(pattern, pattern_size, data, data_size, offset);
         }
@@ -1458,6 +1481,33 @@ namespace impl {
 // Implementation
 /** \cond impl */
 namespace impl {
+    // Load 8 chars as uint64 with first char in lowest byte
+    inline uint64 tonum_load8(const char* str) {
+        uint64 val;
+    #if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+        memcpy(&val, str, sizeof(val));
+    #else
+        val = 0;
+        for (int i = 7; i >= 0; --i)
+            val = (val << 8) | (uchar)str[i];
+    #endif
+        return val;
+    }
+
+    // Get whether all 8 chars loaded with tonum_load8() are decimal digits (SWAR)
+    inline bool tonum_is8digits(uint64 val)
+        { return (((val + 0x4646464646464646ULL) | (val - 0x3030303030303030ULL)) & 0x8080808080808080ULL) == 0; }
+
+    // Convert 8 decimal digits loaded with tonum_load8() to number (SWAR), combining digit pairs then 4-digit groups with multiplies
+    inline uint32 tonum_parse8digits(uint64 val) {
+        const uint64 MASK = 0x000000FF000000FFULL;
+        const uint64 MUL1 = 100 + (1000000ULL << 32);
+        const uint64 MUL2 = 1 + (10000ULL << 32);
+        val -= 0x3030303030303030ULL;
+        val = (val * 10) + (val >> 8);
+        return (uint32)((((val & MASK) * MUL1) + (((val >> 16) & MASK) * MUL2)) >> 32);
+    }
+
     // Convert string to integer value
     template<class T>
     T tonum(const char* str, ulong size, Error& error, int base) {
@@ -1569,9 +1619,10 @@ namespace impl {
                 break;
         }
 
-        // Limits
-        const typename ToUnsigned<T>::Type limitnum = (neg ? (IntegerT<T>::SIGN ? -(typename ToSigned<T>::Type)IntegerT<T>::MIN : IntegerT<T>::MAX) : IntegerT<T>::MAX);
-        const typename ToUnsigned<T>::Type limitbase = limitnum / (typename ToUnsigned<T>::Type)base;
+        // Limits -- negative limit is computed unsigned since negating MIN overflows signed
+        typedef typename ToUnsigned<T>::Type UT;
+        const UT limitnum = (neg ? (IntegerT<T>::SIGN ? (UT)0 - (UT)IntegerT<T>::MIN : (UT)IntegerT<T>::MAX) : (UT)IntegerT<T>::MAX);
+        const UT limitbase = limitnum / (UT)base;
 
     #if defined(EVO_OLDCC)
         const T MIN = IntegerT<T>::MIN;
@@ -1580,6 +1631,24 @@ namespace impl {
 
         // Number
         error = ENone;
+        if (base == 10 && IntegerT<T>::BYTES >= 4) {
+            // Decimal: Consume 8 digits at a time, then finish in loop below
+            const ulong DIGITS8 = 100000000UL;
+            uint64 val;
+            while (end - str >= 8 && tonum_is8digits(val = tonum_load8(str))) {
+                const uint32 digits8 = tonum_parse8digits(val);
+                if ((ulongl)digits8 > (ulongl)limitnum || (ulongl)num > ((ulongl)limitnum - digits8) / DIGITS8) {
+                    error = EOutOfBounds;
+                #if defined(EVO_OLDCC) // fixes undefined reference on older compilers
+                    return (neg ? MIN : MAX);
+                #else
+                    return (neg ? IntegerT<T>::MIN : IntegerT<T>::MAX);
+                #endif
+                }
+                num = (UT)((ulongl)num * DIGITS8 + digits8);
+                str += 8;
+            }
+        }
         for (; str < end; ++str) {
             ch = *str;
             if (ch >= '0' && ch <= '9')
@@ -1617,13 +1686,50 @@ namespace impl {
             num *= (typename ToUnsigned<T>::Type)base;
             num += ch;
         }
-        return (neg ? -(typename ToSigned<T>::Type)num : num);
+        return (T)(neg ? (typename ToUnsigned<T>::Type)0 - num : num);
     }
 
+    // Floating point conversion used by tonumf()
+    // - num is the first 19 significant digits, exp10 is the decimal exponent for num
+    // - truncated is whether more non-zero digits were dropped from num, str/end is the source digits for this case
+    // - Generic version scales in floating point, float and double are always correctly rounded
+    template<class T> struct FloatParse {
+        static T get(Error& error, ulongl num, int exp10, bool, const char*, const char*) {
+            if (num == 0)
+                return 0.0;
+            if (exp10 > FloatT<T>::maxexp()) {
+                error = EOutOfBounds;
+                return FloatT<T>::inf();
+            }
+            if (exp10 < FloatT<T>::minexp() - 20) {
+                error = EOutOfBounds;
+                return 0.0;
+            }
+            return FloatT<T>::exp10((T)num, exp10);
+        }
+    };
+    template<> struct FloatParse<float> {
+        static float get(Error& error, ulongl num, int exp10, bool truncated, const char* str, const char* end) {
+            const float result = tonumf_float(num, exp10, truncated, str, end);
+            if (FloatT<float>::inf(result) || (result == 0.0f && num != 0))
+                error = EOutOfBounds;
+            return result;
+        }
+    };
+    template<> struct FloatParse<double> {
+        static double get(Error& error, ulongl num, int exp10, bool truncated, const char* str, const char* end) {
+            const double result = tonumf_double(num, exp10, truncated, str, end);
+            if (FloatT<double>::inf(result) || (result == 0.0 && num != 0))
+                error = EOutOfBounds;
+            return result;
+        }
+    };
+
     // Convert string to floating-point value
     template<class T>
     T tonumf(const char* str, ulong size, Error& error) {
-        const int MAXDIGITS = FloatT<T>::MAXDIGITS + 2;
+        const int MAXDIGITS = 18;       // max significant digits to use (after the first) that fit in ulongl
+        const int MAXEXP    = 100000;   // stop parsing exponent digits past this to prevent overflow
         const int BASE = 10;
         const char* end = str + size;
         bool neg = false;
@@ -1666,7 +1772,10 @@ namespace impl {
         }
 
         // Working data
+        const char* digits_start = str;
+        const char* digits_end   = NULL;
         bool   found_point = false;
+        bool   truncated   = false;
         ulongl num         = 0;
         int    exp         = 0;
         int    exp_digits  = 0;
@@ -1676,10 +1785,29 @@ namespace impl {
         // Significant digits
         while (str < end) {
             ch = *str;
-            if (ch >= '0' && ch <= '9')
-                // Decimal digit
-                ch -= '0';
-            else if (ch == '.') {
+            if (ch >= '0' && ch <= '9') {
+                // Run of decimal digits, don't start counting digits until first significant digit
+                const char* run_start = str;
+                if (sig_digits == 0)
+                    while (str < end && *str == '0')
+                        ++str;
+                for (; str < end && (ch=(uchar)(*str - '0')) <= 9; ++str) {
+                    if (sig_digits > MAXDIGITS) {
+                        ++exp;
+                        if (ch != 0)
+                            truncated = true;
+                    } else {
+                        num *= BASE;
+                        num += ch;
+                    }
+                    ++sig_digits;
+                }
+                const int count = (int)(str - run_start);
+                if (found_point)
+                    exp_digits += count;
+                digits += count;
+                continue;
+            } else if (ch == '.') {
                 // Decimal point
                 if (found_point)
                     { error = EInval; return 0.0; }
@@ -1688,6 +1816,7 @@ namespace impl {
                 continue;
             } else if (ch == 'e' || ch == 'E') {
                 // Exponent
+                digits_end = str;
                 if (digits == 0)
                     { error = EInval; break; }
                 if (++str < end) {
@@ -1696,16 +1825,18 @@ namespace impl {
                         case '+': ++str; break;
                         case '-': exp_neg = true; ++str; break;
                     }
+                    int exp_val = 0;
                     for (; str < end; ++str) {
                         if ((ch=*str) >= '0' && ch <= '9')
                             ch -= '0';
                         else
                             break;
-                        exp *= BASE;
-                        exp += ch;
+                        if (exp_val < MAXEXP) {
+                            exp_val *= BASE;
+                            exp_val += ch;
+                        }
                     }
-                    if (exp_neg)
-                        exp = -exp;
+                    exp += (exp_neg ? -exp_val : exp_val);
                 }
                 break;
             } else if (ch == '#') {
@@ -1722,33 +1853,14 @@ namespace impl {
                 error = EInval;
                 break;
             }
-
-            // Don't start counting digits until first significant digit
-            if (found_point)
-                ++exp_digits;
-            if (sig_digits != 0 || ch != 0) {
-                // Apply next digit
-                if (sig_digits > MAXDIGITS) {
-                    ++exp;
-                } else {
-                    num *= BASE;
-                    num += ch;
-                }
-                ++sig_digits;
-            }
-            ++digits; ++str;
         }
         if (digits == 0 || str != end)
             error = EInval;
+        if (digits_end == NULL)
+            digits_end = str;
 
         // Result
-        T result;
-        if (exp > FloatT<T>::maxexp())
-            { result = FloatT<T>::inf(); error = EOutOfBounds; }
-        else if (exp < FloatT<T>::minexp())
-            { result = -FloatT<T>::inf(); error = EOutOfBounds; }
-        else
-            result = FloatT<T>::exp10((T)num, -exp_digits+exp);
+        T result = FloatParse<T>::get(error, num, exp - exp_digits, truncated, digits_start, digits_end);
         if (neg)
             result = -result;
         return result;
@@ -1846,6 +1958,29 @@ namespace impl {
         #undef EVO_TMP_TRUE_IF_CHAR
     }
 
+    // Format unsigned integer in decimal as string 2 digits at a time, writing backwards from endptr, returns pointer to first digit
+    template<class T>
+    inline char* fnum10(char* endptr, T num) {
+        const char* const PAIRS = DIGIT_PAIRS();
+        char* ptr = endptr;
+        while (num >= 100) {
+            const T quot = (T)(num / 100);
+            const char* pair = PAIRS + ((uint)(num - quot * 100) << 1);
+            ptr -= 2;
+            ptr[0] = pair[0];
+            ptr[1] = pair[1];
+            num = quot;
+        }
+        if (num >= 10) {
+            const char* pair = PAIRS + ((uint)num << 1);
+            ptr -= 2;
+            ptr[0] = pair[0];
+            ptr[1] = pair[1];
+        } else
+            *--ptr = (char)('0' + num);
+        return ptr;
+    }
+
     // Format signed integer as string
     template<class T>
     static ulong fnum(char* endptr, T num, int base) {
@@ -1863,7 +1998,14 @@ namespace impl {
         }
 
         char* ptr = endptr;
-        if (num == 0)
+        if (base == 10) {
+            // Decimal: 2 digits at a time
+            if (num < 0) {
+                ptr = fnum10(ptr, (typename ToUnsigned<T>::Type)((typename ToUnsigned<T>::Type)0 - (typename ToUnsigned<T>::Type)num));
+                *--ptr = '-';
+            } else
+                ptr = fnum10(ptr, (typename ToUnsigned<T>::Type)num);
+        } else if (num == 0)
             *--ptr = '0';
         else if (num > 0) {
             while (num != 0) {
@@ -1898,7 +2040,9 @@ namespace impl {
         }
 
         char* ptr = endptr;
-        if (num == 0)
+        if (base == 10)
+            ptr = fnum10(ptr, (typename ToUnsigned<T>::Type)num);    // Decimal: 2 digits at a time
+        else if (num == 0)
             *--ptr = '0';
         else
             while (num != 0) {
@@ -2191,6 +2335,36 @@ namespace impl {
         return (ulong)(ptr - startptr);
     }
 
+    // Floating point formatting used by String, StringFlt, FmtSetFloat, and IoWriter
+    // - Usage: Call prepare() to get max formatted length (including sign), then format() with a buffer at least that size
+    // - Generic version normalizes the number and formats with fnumfe() or fnumf()
+    template<class T> struct FloatFmt {
+        static int prepare(T& num, int& exp, int precision) {
+            if (precision < 0) {
+                num = FloatT<T>::fexp10(exp, num);
+                return FloatT<T>::MAXDIGITS_AUTO;
+            }
+            num = FloatT<T>::fexp10(exp, fnumf_weight(num, precision));
+            return FloatT<T>::maxdigits_prec(exp, precision);
+        }
+        static ulong format(char* ptr, T num, int exp, int precision)
+            { return (precision < 0 ? fnumfe(ptr, num, exp, false) : fnumf(ptr, num, exp, precision)); }
+    };
+
+    // Shortest round-trip formatting with float and double, num is formatted as-is so exp isn't used
+    template<> struct FloatFmt<float> {
+        static int prepare(float& num, int&, int precision)
+            { return (precision < 0 ? FNUMF_AUTO_MAXLEN_FLOAT : fnumf_prec_maxlen(num, precision)); }
+        static ulong format(char* ptr, float num, int, int precision)
+            { return (precision < 0 ? fnumf_auto(ptr, num) : fnumf_prec(ptr, num, precision)); }
+    };
+    template<> struct FloatFmt<double> {
+        static int prepare(double& num, int&, int precision)
+            { return (precision < 0 ? FNUMF_AUTO_MAXLEN_DOUBLE : fnumf_prec_maxlen(num, precision)); }
+        static ulong format(char* ptr, double num, int, int precision)
+            { return (precision < 0 ? fnumf_auto(ptr, num) : fnumf_prec(ptr, num, precision)); }
+    };
+
 #if defined(EVO_FNUMF_SPRINTF)
     static const uint FNUMF_SPRINTF_BUF_SIZE = UInt::MAXSTRLEN + 6;
 
@@ -2818,13 +2992,7 @@ struct FmtSetFloat {
     /** \cond impl */
     template<class T>
     void impl_info(T& num, int& exp, int& maxlen, int align_width) const {
-        if (precision < 0) {
-            num    = FloatT<T>::fexp10(exp, num);
-            maxlen = FloatT<T>::MAXDIGITS_AUTO + 1;                     // add 1 for sign
-        } else {
-            num    = FloatT<T>::fexp10(exp, impl::fnumf_weight(num, precision));
-            maxlen = FloatT<T>::maxdigits_prec(exp, precision) + 1;     // add 1 for sign
-        }
+        maxlen = impl::FloatFmt<T>::prepare(num, exp, precision);
         if (pad_width > maxlen)
             maxlen = pad_width;
         if (align_width > maxlen)
@@ -2833,11 +3001,7 @@ struct FmtSetFloat {
     template<class T>
     ulong impl_write(char* buf, T num, int exp, int align_width, const FmtSetField* field) const {
         char* p = buf;
-        long len;
-        if (precision < 0)
-            len = (long)impl::fnumfe(p, num, exp, false);
-        else
-            len = (long)impl::fnumf(p, num, exp, precision);
+        const long len = (long)impl::FloatFmt<T>::format(p, num, exp, precision);
 
         const int width         = (pad_width > len ? pad_width : len);
         const int align_padding = (align_width > width ? align_width - width : 0);
@@ -2845,29 +3009,35 @@ struct FmtSetFloat {
         int align_padleft, align_padright;
         FmtSetField::setup_align(align_padleft, align_padright, align_padding, field);
 
+        // Unsigned length computed once, each move is guarded so the compiler can see the length is in bounds
+        const size_t ulen = (len > 0 ? (size_t)len : 0);
         char* p1 = p + align_padleft;
         if (len < pad_width) {
-            const int padlen = pad_width - len;
+            const int padlen = pad_width - (int)ulen;
             if (FloatT<T>::nan(num) || FloatT<T>::inf(num)) {
-                memmove(p1 + padlen, p, len);
+                if (ulen > 0)
+                    memmove(p1 + padlen, p, ulen);
                 memset(p1, (int)(uchar)pad_ch_sp, padlen);
             } else if (num < 0.0) {
-                memmove(p1 + 1 + padlen, p+1, len-1);
+                if (ulen > 1)
+                    memmove(p1 + 1 + padlen, p + 1, ulen - 1);
                 memset(p1 + 1, (int)(uchar)pad_ch, padlen);
                 *p1 = '-';
             } else {
-                memmove(p1 + padlen, p, len);
+                if (ulen > 0)
+                    memmove(p1 + padlen, p, ulen);
                 memset(p1, (int)(uchar)pad_ch, padlen);
             }
             if (align_padleft > 0)
                 memset(p, (int)(uchar)field->fill, align_padleft);
-            p = p1 + len + padlen;
+            p = p1 + ulen + padlen;
         } else if (align_padleft > 0) {
-            memmove(p1, p, len);
+            if (ulen > 0)
+                memmove(p1, p, ulen);
             memset(p, (int)(uchar)field->fill, align_padleft);
-            p = p1 + len;
+            p = p1 + ulen;
         } else
-            p += len;
+            p += ulen;
 
         if (align_padright > 0) {
             memset(p, (int)(uchar)field->fill, align_padright);
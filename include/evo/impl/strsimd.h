@@ -0,0 +1,326 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file strsimd.h Evo implementation detail: SSE optimized substring search and character set scanning. */
+#pragma once
+#ifndef INCL_evo_impl_strsimd_h
+#define INCL_evo_impl_strsimd_h
+
+#include "sys.h"
+#include <string.h>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+    #pragma intrinsic(_BitScanForward)
+    #pragma intrinsic(_BitScanReverse)
+    #if defined(_M_X64)
+        #pragma intrinsic(_BitScanForward64)
+    #endif
+#elif defined(EVO_IMPL_SSE42)
+    #include <nmmintrin.h>
+#elif defined(EVO_IMPL_SSE2)
+    #include <emmintrin.h>
+#endif
+
+namespace evo {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** \cond impl */
+namespace impl {
+#if defined(EVO_CPU)
+    // Get index of lowest set bit, mask must not be 0
+    inline uint str_simd_bitscan(uint mask) {
+    #if defined(_MSC_VER)
+        ulong i;
+        _BitScanForward(&i, mask);
+        return (uint)i;
+    #else
+        return (uint)__builtin_ctz(mask);
+    #endif
+    }
+
+    // Get index of highest set bit, mask must not be 0
+    inline uint str_simd_bitscan_r(uint mask) {
+    #if defined(_MSC_VER)
+        ulong i;
+        _BitScanReverse(&i, mask);
+        return (uint)i;
+    #else
+        return (uint)(31 - __builtin_clz(mask));
+    #endif
+    }
+
+    /* Find pattern in data with SSE 2, filtering 16 candidate positions at a time by matching first and last pattern chars.
+     - Only candidates where both first and last chars match are compared with memcmp()
+     - Requires: 1 < pattern_size < data_size
+    */
+    inline const char* str_search_cpu(const char* data, ulong data_size, const char* pattern, uint pattern_size) {
+        const ulong BATCH_SIZE = 16;
+        const ulong last = pattern_size - 1;
+        const ulong count = data_size - last;  // candidate positions
+        const __m128i first_in = _mm_set1_epi8(pattern[0]);
+        const __m128i last_in  = _mm_set1_epi8(pattern[last]);
+
+        ulong i = 0;
+        for (; i + BATCH_SIZE <= count; i += BATCH_SIZE) {
+            // pcmpeqb, pand, pmovmskb
+            uint mask = (uint)_mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(first_in, _mm_loadu_si128((const __m128i*)(data + i))),
+                _mm_cmpeq_epi8(last_in, _mm_loadu_si128((const __m128i*)(data + i + last)))
+            ));
+            while (mask != 0) {
+                const char* p = data + i + str_simd_bitscan(mask);
+                if (memcmp(p + 1, pattern + 1, last - 1) == 0)
+                    return p;
+                mask &= mask - 1;
+            }
+        }
+
+        // Check remaining positions
+        for (; i < count; ++i)
+            if (data[i] == pattern[0] && data[i + last] == pattern[last] && memcmp(data + i + 1, pattern + 1, last - 1) == 0)
+                return data + i;
+        return NULL;
+    }
+
+    // Find last pattern in data with SSE 2, same as str_search_cpu() but searches backwards from end
+    inline const char* str_search_cpu_r(const char* data, ulong data_size, const char* pattern, uint pattern_size) {
+        const ulong BATCH_SIZE = 16;
+        const ulong last = pattern_size - 1;
+        ulong count = data_size - last;  // candidate positions
+        const __m128i first_in = _mm_set1_epi8(pattern[0]);
+        const __m128i last_in  = _mm_set1_epi8(pattern[last]);
+
+        for (; count >= BATCH_SIZE; count -= BATCH_SIZE) {
+            const ulong i = count - BATCH_SIZE;
+            uint mask = (uint)_mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(first_in, _mm_loadu_si128((const __m128i*)(data + i))),
+                _mm_cmpeq_epi8(last_in, _mm_loadu_si128((const __m128i*)(data + i + last)))
+            ));
+            while (mask != 0) {
+                const uint bit = str_simd_bitscan_r(mask);
+                const char* p = data + i + bit;
+                if (memcmp(p + 1, pattern + 1, last - 1) == 0)
+                    return p;
+                mask &= ~(1U << bit);
+            }
+        }
+
+        // Check remaining positions
+        while (count > 0) {
+            --count;
+            if (data[count] == pattern[0] && data[count + last] == pattern[last] && memcmp(data + count + 1, pattern + 1, last - 1) == 0)
+                return data + count;
+        }
+        return NULL;
+    }
+#endif
+
+    /* Character set used to scan for any chars in set, or any chars not in set.
+     - This has a 256-bit lookup table for checking chars one at a time
+     - With SSE 4.2 this also has nibble lookup tables used to check 16 chars at a time with pshufb (SSSE 3):
+       - Each char is split into low and high nibbles, the low nibble selects a mask of high nibble values present in set for that low nibble
+       - Chars from 0x80 and up use a separate low nibble table (lo_hi), since a byte only has bits for 8 high nibble values
+     .
+    */
+    struct StrCharSet {
+        uint32 bits[8];
+    #if defined(EVO_IMPL_SSE42)
+        __m128i lo;         // low nibble table for chars 0x00 - 0x7F
+        __m128i lo_hi;      // low nibble table for chars 0x80 - 0xFF
+        bool    has_hi;     // whether set has any chars 0x80 - 0xFF
+    #endif
+
+        StrCharSet(const char* chars, ulong count) {
+            memset(bits, 0, sizeof(bits));
+        #if defined(EVO_IMPL_SSE42)
+            uchar lo_buf[32];
+            memset(lo_buf, 0, sizeof(lo_buf));
+        #endif
+            for (ulong i = 0; i < count; ++i) {
+                const uchar ch = (uchar)chars[i];
+                bits[ch >> 5] |= (1U << (ch & 31));
+            #if defined(EVO_IMPL_SSE42)
+                lo_buf[(ch & 0x0F) + ((ch & 0x80) >> 3)] |= (uchar)(1U << ((ch >> 4) & 7));
+            #endif
+            }
+        #if defined(EVO_IMPL_SSE42)
+            lo     = _mm_loadu_si128((const __m128i*)lo_buf);
+            lo_hi  = _mm_loadu_si128((const __m128i*)(lo_buf + 16));
+            has_hi = (bits[4] | bits[5] | bits[6] | bits[7]) != 0;
+        #endif
+        }
+
+        bool contains(char ch) const
+            { return ((bits[(uchar)ch >> 5] >> ((uchar)ch & 31)) & 1) != 0; }
+
+    #if defined(EVO_IMPL_SSE42)
+        // Get bitmask with bit set for each char in set from 16 chars -- HI is whether to check chars 0x80 and up (has_hi)
+        template<bool HI>
+        uint match(__m128i n) const {
+            // pshufb returns 0 where index high bit is set, so chars 0x80 and up only match in lo_hi (with high bit flipped)
+            const __m128i HI_BITS = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128);
+            const __m128i hi_bits = _mm_shuffle_epi8(HI_BITS, _mm_and_si128(_mm_srli_epi16(n, 4), _mm_set1_epi8(0x0F)));
+            __m128i lo_bits = _mm_shuffle_epi8(lo, n);
+            if (HI)
+                lo_bits = _mm_or_si128(lo_bits, _mm_shuffle_epi8(lo_hi, _mm_xor_si128(n, _mm_set1_epi8((char)0x80))));
+            return (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo_bits, hi_bits), _mm_setzero_si128())) ^ 0xFFFF;
+        }
+    #endif
+    };
+
+#if defined(EVO_IMPL_SSE42)
+    // Scan 16 chars at a time with SSE for str_scan_charset(), stops at last partial batch
+    template<bool ANY, bool HI>
+    inline const char* str_scan_charset_cpu(const char* str, const char* end, const StrCharSet& set) {
+        const ulong BATCH_SIZE = 16;
+        const uint  MASK = (ANY ? 0 : 0xFFFF);
+        for (; end - str >= (long)BATCH_SIZE; str += BATCH_SIZE) {
+            const uint r = set.match<HI>(_mm_loadu_si128((const __m128i*)str)) ^ MASK;
+            if (r != 0)
+                return str + str_simd_bitscan(r);
+        }
+        return str;
+    }
+
+    // Scan 16 chars at a time in reverse with SSE for str_scan_charset_r(), stops at last partial batch and returns new end, or NULL if found
+    template<bool ANY, bool HI>
+    inline const char* str_scan_charset_cpu_r(const char* str, const char* end, const StrCharSet& set, const char*& found) {
+        const ulong BATCH_SIZE = 16;
+        const uint  MASK = (ANY ? 0 : 0xFFFF);
+        while (end - str >= (long)BATCH_SIZE) {
+            end -= BATCH_SIZE;
+            const uint r = set.match<HI>(_mm_loadu_si128((const __m128i*)end)) ^ MASK;
+            if (r != 0) {
+                found = end + str_simd_bitscan_r(r) + 1;
+                return NULL;
+            }
+        }
+        return end;
+    }
+#endif
+
+    // Scan to next char in set, or next char not in set if ANY is false
+    template<bool ANY>
+    inline const char* str_scan_charset(const char* str, const char* end, const StrCharSet& set) {
+    #if defined(EVO_IMPL_SSE42)
+        str = (set.has_hi ? str_scan_charset_cpu<ANY,true>(str, end, set) : str_scan_charset_cpu<ANY,false>(str, end, set));
+    #endif
+        for (; str < end; ++str)
+            if (set.contains(*str) == ANY)
+                break;
+        return str;
+    }
+
+    // Scan to next char in set in reverse, or next char not in set if ANY is false -- returns new end after found char, or str if not found
+    template<bool ANY>
+    inline const char* str_scan_charset_r(const char* str, const char* end, const StrCharSet& set) {
+    #if defined(EVO_IMPL_SSE42)
+        const char* found = NULL;
+        end = (set.has_hi ? str_scan_charset_cpu_r<ANY,true>(str, end, set, found) : str_scan_charset_cpu_r<ANY,false>(str, end, set, found));
+        if (end == NULL)
+            return found;
+    #endif
+        while (str < end) {
+            if (set.contains(*--end) == ANY)
+                return end + 1;
+        }
+        return end;
+    }
+
+    // Get index of lowest set bit in 64-bit mask, mask must not be 0
+    inline uint str_bitscan64(uint64 mask) {
+    #if defined(_MSC_VER)
+        ulong i;
+        #if defined(_M_X64)
+            _BitScanForward64(&i, mask);
+        #else
+            if ((uint32)mask != 0)
+                _BitScanForward(&i, (uint32)mask);
+            else {
+                _BitScanForward(&i, (uint32)(mask >> 32));
+                i += 32;
+            }
+        #endif
+        return (uint)i;
+    #else
+        return (uint)__builtin_ctzll(mask);
+    #endif
+    }
+
+    /* Gets bitmasks of delimiter positions in blocks of 64 chars, used for bulk tokenizing -- see StrTokBulk.
+     - This matches a delimiter and both newline chars (CR, LF) -- bit 0 is set if first char is a delimiter or newline, and so on
+     - With SSE this checks 16 chars at a time, a full block is 4 batches
+    */
+    struct StrDelimMask {
+        static const uint BLOCK_SIZE = 64;
+
+        char delim;
+    #if defined(EVO_CPU)
+        __m128i delim_in;
+        __m128i cr_in;
+        __m128i lf_in;
+    #endif
+
+        StrDelimMask(char delim) : delim(delim) {
+        #if defined(EVO_CPU)
+            delim_in = _mm_set1_epi8(delim);
+            cr_in    = _mm_set1_epi8('\r');
+            lf_in    = _mm_set1_epi8('\n');
+        #endif
+        }
+
+        // Get mask for full block of BLOCK_SIZE chars
+        uint64 get(const char* str) const {
+        #if defined(EVO_CPU)
+            return (uint64)get16(str) | ((uint64)get16(str + 16) << 16) | ((uint64)get16(str + 32) << 32) | ((uint64)get16(str + 48) << 48);
+        #else
+            return get(str, BLOCK_SIZE);
+        #endif
+        }
+
+        // Get mask for partial block, count must not be more than BLOCK_SIZE
+        uint64 get(const char* str, uint count) const {
+            uint64 mask = 0;
+            for (uint i = 0; i < count; ++i) {
+                const char ch = str[i];
+                if (ch == delim || ch == '\n' || ch == '\r')
+                    mask |= (1ULL << i);
+            }
+            return mask;
+        }
+
+    private:
+    #if defined(EVO_CPU)
+        uint get16(const char* str) const {
+            // pcmpeqb, por, pmovmskb
+            const __m128i n = _mm_loadu_si128((const __m128i*)str);
+            return (uint)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(n, delim_in), _mm_or_si128(_mm_cmpeq_epi8(n, cr_in), _mm_cmpeq_epi8(n, lf_in))));
+        }
+    #endif
+    };
+
+    // Scan to next char matching any in chars
+    inline const char* str_scan_any(const char* str, const char* end, const char* chars, ulong count)
+        { return str_scan_charset<true>(str, end, StrCharSet(chars, count)); }
+
+    // Scan to next char matching any in chars in reverse, return new end
+    inline const char* str_scan_any_r(const char* str, const char* end, const char* chars, ulong count)
+        { return str_scan_charset_r<true>(str, end, StrCharSet(chars, count)); }
+
+    // Scan to next char not matching any in chars
+    inline const char* str_scan_anybut(const char* str, const char* end, const char* chars, ulong count)
+        { return str_scan_charset<false>(str, end, StrCharSet(chars, count)); }
+
+    // Scan to next char not matching any in chars in reverse, return new end
+    inline const char* str_scan_anybut_r(const char* str, const char* end, const char* chars, ulong count)
+        { return str_scan_charset_r<false>(str, end, StrCharSet(chars, count)); }
+}
+/** \endcond */
+
+///////////////////////////////////////////////////////////////////////////////
+}
+#endif
@@ -649,6 +649,25 @@ struct IoFile : public IoDevice {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/** Batch of lines read from a stream.
+ - See Stream::readlines(), StreamIn::readlines()
+ - Lines reference the stream read buffer, so no line data is copied
+   - \b Caution: Lines are only valid until the next read from the same stream, or until the stream is closed
+ - Members are public for quick access and simple low-level interface
+*/
+struct LineBatch {
+    static const ulong DEFSIZE = 1048576;   ///< Default block size (1 MB)
+
+    List<SubString> lines;      ///< Lines read by last batch, newlines not included
+    ulong           blocksize;  ///< Stream read buffer size to use, the buffer is grown to this if smaller -- 0 to use current buffer size
+
+    /** Constructor.
+     \param  size  Block size to use for stream read buffer, 0 to use current buffer size
+    */
+    LineBatch(ulong size=DEFSIZE) : blocksize(size)
+        { }
+};
+
 /** Buffered reader for IoDevice (used internally).
  - This is an internal low-level interface, see: File, Pipe, Console, Socket
  - Filtering is enabled by setting 'filters' -- note that the pointer should be owned (freed) by the IoDevice
@@ -1010,6 +1029,97 @@ struct IoReader {
         }
         return EOutOfBounds;
     }
+
+    /** Read next batch of lines from file using buffer.
+     - This adds all complete lines currently in buffer to batch, filling buffer first if no complete line is available
+       - Lines are found with a bulk newline scan across the buffer and reference the buffer, no line data is copied
+       - Each fill does a single read from file, so lines from pipes and sockets are returned as they arrive
+     - Lines in batch are invalid after the next read
+     - The buffer is grown to `batch.blocksize` if smaller, and is grown more as needed to fit a line longer than the buffer
+     - This recognizes '\\n', '\\r', or either combination of the two as a newline, same as readline() -- mixing calls with readline() is fine
+     - Line longer than `maxlen` is skipped with error EOutOfBounds, if it doesn't fit in the buffer then the rest of it is returned as a line on the next call
+     .
+     \tparam  T  IoDevice to read from
+
+     \param  batch   Stores lines read, cleared first [in/out]
+     \param  in      File to read from
+     \param  maxlen  Maximum line length, 0 for no limit
+     \return         ENone on success (at least 1 line in batch), EEnd if no more lines (end-of-file), EOutOfBounds if line too long, ELoss if readtext() left a partial newline (see readline()), or other error code
+    */
+    template<class T>
+    Error readlines(LineBatch& batch, T& in, ulong maxlen=0) {
+        assert( curbuf->used <= curbuf->size );
+        assert( curbuf_offset <= curbuf->used );
+        batch.lines.clear();
+        if (rd_partnl != 0)
+            return ELoss;
+        if (batch.blocksize > readbuf.size)
+            readbuf.resize(batch.blocksize);
+
+        Error err;
+        ulong len;
+        bool  eof = false;
+        for (;;) {
+            if (rl_partnl != 0 && curbuf_offset < curbuf->used) {
+                // Previous line ended with potential partial newline, skip rest of newline
+                if (curbuf->data[curbuf_offset] == rl_partnl)
+                    ++curbuf_offset;
+                rl_partnl = 0;
+            }
+
+            // Add all complete lines in buffer
+            const char* data = curbuf->data;
+            const char* end  = data + curbuf->used;
+            const char* start = data + curbuf_offset;
+            for (const char* p; (p = str_scan_delim(start, end, '\r', '\n')) < end; ) {
+                len = (ulong)(p - start);
+                if (maxlen > 0 && len > maxlen && batch.lines.size() > 0)
+                    break; // return lines so far, line too long is skipped on next call
+
+                const char checknext = (*p == '\n' ? '\r' : '\n');
+                if (++p < end) {
+                    if (*p == checknext)
+                        ++p; // skip rest of newline
+                } else
+                    rl_partnl = checknext; // save partial to check later
+                if (maxlen > 0 && len > maxlen) {
+                    curbuf_offset = (ulong)(p - data);
+                    return EOutOfBounds;
+                }
+                batch.lines.add(SubString(start, (StrSizeT)len));
+                start = p;
+            }
+            curbuf_offset = (ulong)(start - data);
+            if (batch.lines.size() > 0)
+                return ENone;
+
+            // No complete line, check partial line
+            len = curbuf->used - curbuf_offset;
+            if (maxlen > 0 && len > maxlen) {
+                curbuf_offset = curbuf->used;
+                return EOutOfBounds;
+            }
+            if (eof) {
+                if (len == 0)
+                    return EEnd;
+                batch.lines.add(SubString(start, (StrSizeT)len)); // last line without newline
+                curbuf_offset = curbuf->used;
+                return ENone;
+            }
+
+            // Read more, grow buffer if partial line fills it
+            readbuf.flush(curbuf_offset);
+            if (readbuf.used == readbuf.size)
+                readbuf.resize(readbuf.size > 0 ? readbuf.size * 2 : DEFSIZE);
+            const ulong readsize = in.read(err, readbuf.data + readbuf.used, readbuf.size - readbuf.used);
+            if (err != ENone)
+                return err;
+            if (readsize == 0)
+                eof = true;
+            else
+                readbuf.used += readsize;
+        }
+    }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1592,24 +1702,13 @@ struct IoWriter : public RawBuffer {
     template<class TOut,class TNum>
     Error writenumf(TOut& out, TNum num, int precision=fPREC_AUTO) {
         assert( used <= size );
-        int exp = 0;  uint maxlen;  Error err;
-        if (precision < 0) {
-            num    = FloatT<TNum>::fexp10(exp, num);
-            maxlen = (uint)FloatT<TNum>::MAXDIGITS_AUTO;
-            if (size < maxlen)
-                return EBufSize;
-            if (size-used < maxlen && (err=flush(out)) != ENone)
-                return err;
-            used += impl::fnumfe(data+used, num, exp, false);
-        } else {
-            num    = FloatT<TNum>::fexp10(exp, impl::fnumf_weight(num, precision));
-            maxlen = (uint)FloatT<TNum>::maxdigits_prec(exp, precision);
-            if (size < maxlen)
-                return EBufSize;
-            if (size-used < maxlen && (err=flush(out)) != ENone)
-                return err;
-            used += impl::fnumf(data+used, num, exp, precision);
-        }
+        int exp = 0;  Error err;
+        const uint maxlen = (uint)impl::FloatFmt<TNum>::prepare(num, exp, precision);
+        if (size < maxlen)
+            return EBufSize;
+        if (size-used < maxlen && (err=flush(out)) != ENone)
+            return err;
+        used += impl::FloatFmt<TNum>::format(data+used, num, exp, precision);
         return ENone;
     }
 
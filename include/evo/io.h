@@ -100,7 +100,7 @@ Evo input/output streams
  - This is similar to Stream but only supports reading input
  - This implements binary and text input with buffering
    - Binary intput (no newline conversion): readbin()
-   - Text intput (automatic newline conversion): readtext(), readline()
+   - Text intput (automatic newline conversion): readtext(), readline(), readlines()
    .
  - Call error() to check error code from last operation
  - Evaluating as bool (via SafeBool) checks whether last operation was successful by calling ! operator!()\n
@@ -203,8 +203,19 @@ public:
 
     bool readline(String& str, ulong maxlen=0) {
         error_ = bufrd_.readline(str, device_, maxlen);
-        if (error_ != ENone && error_ != EEnd) {
-            EVO_THROW_ERR_CHECK(ExceptionInT, "Stream text line read failed", error_, excep_);
+        if (error_ != ENone) {
+            EVO_THROW_ERR_CHECK(ExceptionInT, "Stream text line read failed", error_, (excep_ && error_ != EEnd));
+            return false;
+        }
+        return true;
+    }
+
+    using StreamBase::readlines;
+
+    bool readlines(LineBatch& batch, ulong maxlen=0) {
+        error_ = bufrd_.readlines(batch, device_, maxlen);
+        if (error_ != ENone) {
+            EVO_THROW_ERR_CHECK(ExceptionInT, "Stream text lines read failed", error_, (excep_ && error_ != EEnd));
             return false;
         }
         return true;
@@ -751,7 +762,7 @@ public:
     template<class U>
     This& operator<<(const FloatT<U>& num) {
         if (!num.null())
-            writenumf(num);
+            writenumf(num.value());
         return *this;
     }
 
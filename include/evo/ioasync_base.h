@@ -13,6 +13,7 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 #include "thread.h"
 #include "string.h"
 #include "substring.h"
+#include "sharedstring.h"
 #include "atomic_buffer_queue.h"
 #include "logger.h"
 
@@ -273,6 +274,15 @@ public:
     size_t read_size()
         { return ::evbuffer_get_length(input_); }
 
+    /** Peek at first byte in read buffer without consuming it.
+     - This is useful for detecting protocol before reading
+     .
+     \param  ch  %Set to first byte on success  [out]
+     \return     Whether successful, false if read buffer is empty
+    */
+    bool read_peek(char& ch)
+        { return (::evbuffer_copyout(input_, &ch, 1) == 1); }
+
     /** Read fixed size data from read buffer.
     - This references buffered data directly (no copy)
     - If not enough data available, call again on next read event -- see AsyncServer
@@ -355,6 +365,7 @@ public:
             read_flush();
             if (fixed_size <= 0)
                 break;
+            size = fixed_size;
         }
         return true;
     }
@@ -432,7 +443,50 @@ public:
     void write(const char* data, size_t size)
         { ::evbuffer_add(output_, data, size); }
 
+    /** Write string data by reference (no copy), if possible.
+     - If data is large enough (see WRITE_REF_MIN) and has an allocated buffer, this adds a reference to the buffer to the output (no copy)
+       - This holds a shared reference to the string buffer until written to the socket, then releases it
+       - The string may be modified or freed after this call, modifying will make an unshared copy -- see \ref Sharing "Sharing"
+     - Otherwise data is copied, same as write()
+     - \b Caution: %String buffer reference counts aren't thread safe, so the string buffer must not be shared with other threads
+     .
+     \param  data  %String data to write
+    */
+    void write_ref(const String& data) {
+        if (data.size() >= WRITE_REF_MIN && data.buffered()) {
+            String* ref = new String(data);
+            if (::evbuffer_add_reference(output_, ref->data(), ref->size(), on_write_ref_cleanup, ref) == 0)
+                return;
+            delete ref;
+        }
+        ::evbuffer_add(output_, data.data(), data.size());
+    }
+
+    /** Write shared string data by reference (no copy), if possible.
+     - This is the same as write_ref(const String&), but holds a SharedString reference, which has an atomic reference count
+     - Use this for data shared with other threads, like values in a store used by all server threads
+     .
+     \param  data  Shared string data to write
+    */
+    void write_ref(const SharedString& data) {
+        if (data.size() >= WRITE_REF_MIN) {
+            SharedString* ref = new SharedString(data);
+            if (::evbuffer_add_reference(output_, ref->data(), ref->size(), on_write_shared_ref_cleanup, ref) == 0)
+                return;
+            delete ref;
+        }
+        ::evbuffer_add(output_, data.data(), data.size());
+    }
+
+    static const SizeT WRITE_REF_MIN = 4096;    ///< Minimum data size to write by reference with write_ref(), smaller data is copied
+
 private:
+    static void on_write_ref_cleanup(const void*, size_t, void* arg)
+        { delete (String*)arg; }
+
+    static void on_write_shared_ref_cleanup(const void*, size_t, void* arg)
+        { delete (SharedString*)arg; }
+
     struct bufferevent* bev_;
     struct evbuffer* input_;
     struct evbuffer* output_;
@@ -213,6 +213,15 @@ protected:
 
     AtomicBufferQueue<QueueItem> queue_;    ///< Queue where each item represents an expected response from server
 
+    /** Check whether any client requests are active.
+     - A protocol handler with responses that continue after the queue item is popped (like multi-line responses) should override this to also check for that
+     .
+     \return  Whether any requests are active, true if a response is queued or a write is pending
+    */
+    bool check_client_active() {
+        return (!queue_.empty() || bufs_.write_size() > 0);
+    }
+
 private:
     // Disable copy constructor
     AsyncClient(const This&) EVO_ONCPP11(= delete);
@@ -228,10 +237,6 @@ private:
     SizeT read_fixed_size_;
     SizeT max_read_size_;
 
-    bool check_client_active() {
-        return (!queue_.empty() || bufs_.write_size() > 0);
-    }
-
     bool connect_new(struct sockaddr* addr, int addr_len) {
         init();
         bev_ = ::bufferevent_socket_new(evloop_->handle(), -1, BEV_OPT_CLOSE_ON_FREE);
@@ -276,14 +281,14 @@ private:
                 if (!self.on_read_fixed(self.read_fixed_size_, data, NULL)) {
                     if (self.logger.check(LOG_LEVEL_DEBUG_LOW))
                         self.logger.log_direct(LOG_LEVEL_DEBUG_LOW, logstr.set().reserve(64) << "AsyncClient " << self.id_ << " on_read_fixed() returned false to close");
-                    self.close();
+                    close_error(self, aeCLIENT);
                     return;
                 }
                 bufs.read_flush();
                 if (self.read_fixed_size_ <= 0)
                     break;
             }
-            bufs.read_reset(ProtocolHandler::MIN_INITIAL_READ, self.max_read_size_);
+            bufs.read_reset(self.max_read_size_, ProtocolHandler::MIN_INITIAL_READ);
             if (bufs.read_size() == 0)
                 return;
         }
@@ -292,7 +297,7 @@ private:
         if (!self.on_read(self.read_fixed_size_, bufs, NULL)) {
             if (self.logger.check(LOG_LEVEL_DEBUG_LOW))
                 self.logger.log_direct(LOG_LEVEL_DEBUG_LOW, logstr.set().reserve(64) << "AsyncClient " << self.id_ << " on_read() returned false to close");
-            self.close();
+            close_error(self, aeCLIENT);
             return;
         }
     }
@@ -327,13 +332,18 @@ private:
                 self.logger.log_direct(LOG_LEVEL_ERROR, logstr.set().reserve(42 + errmsg.size()) << "AsyncClient " << self.id_ << " error: " << errmsg << " (code: " << (int)err << ')');
             }
 
-            self.close();
-            ((ProtocolHandler&)self).on_error(err);
-            if (self.on_error_ != NULL)
-                self.on_error_->on_error(err);
+            close_error(self, err);
         }
     }
 
+    // Close connection and notify error handlers, so pending requests aren't left waiting
+    static void close_error(This& self, AsyncError err) {
+        self.close();
+        ((ProtocolHandler&)self).on_error(err);
+        if (self.on_error_ != NULL)
+            self.on_error_->on_error(err);
+    }
+
     static ulong get_next_id() {
         static AtomicULong id;
         return ++id;
@@ -53,40 +53,11 @@ public:
                             - wfNONE for non-deferred
         */
         Writer(This& parent, ulong id, SizeT buf_size, WriterFlags flags=wfNONE) {
-            if (int(flags) & wfDEFERRED) {
-                // Deferred
-                parent.send_end();
-                if (id == parent.next_id_) {
-                    // This is the current reply
-                    init(parent.buf_, buf_size);
-                    if (flags == wfDEFERRED_LAST)
-                        ++parent.next_id_;
-                } else {
-                    // Either append to existing reply in queue, or insert new reply -- keep queue ordered by ID
-                    ReplyItem* rsp;
-                    parent.deferred_get_queue_item(rsp, id);
-                    init(rsp->data, buf_size);
-                }
-            } else if (id == parent.prev_id_) {
-                // Append to previous send
-                if (parent.prev_ == NULL)
-                    init(parent.buf_, buf_size);
-                else
-                    init(parent.prev_->data, buf_size);
-            } else {
-                // New send
-                parent.send_end();
-                if (id == parent.next_id_) {
-                    init(parent.buf_, buf_size);
-                    ++parent.next_id_;
-                    parent.prev_ = NULL;
-                } else {
-                    parent.prev_ = parent.queue_.addnew().advLast();
-                    parent.prev_->id = id;
-                    init(parent.prev_->data, buf_size);
-                }
-                parent.prev_id_ = id;
-            }
+            String* out = parent.get_writer_out(id, flags);
+            if (out == NULL)
+                init(parent.buf_, buf_size);
+            else
+                init(*out, buf_size);
         }
     };
 
@@ -197,6 +168,46 @@ public:
         }
     }
 
+    /** Send response data by reference (no copy) for given request ID, if possible.
+     - This is similar to using a Writer, but writes a string buffer by reference so large data isn't copied -- see AsyncBuffers::write_ref()
+     - Use with Writer to write header data (copy) and payload data (reference) as separate parts of a response
+     - If the response is out of order (queued) then data is copied to the queue
+     - \b Caution: Flags must be correct for deferred or non-deferred response, otherwise results are undefined -- see Writer
+     .
+     \param  id     Request ID for response
+     \param  data   Response data to send
+     \param  flags  Flags used for deferred response, same as with Writer
+     \return        This
+    */
+    This& send_ref(ulong id, const String& data, WriterFlags flags=wfNONE) {
+        String* out = get_writer_out(id, flags);
+        if (out == NULL)
+            buf_.write_ref(data);
+        else if (out->size() == 0)
+            *out = data;
+        else
+            out->add(data);
+        return *this;
+    }
+
+    /** Send shared string response data by reference (no copy) for given request ID, if possible.
+     - This is the same as send_ref(ulong,const String&,WriterFlags) but references a SharedString, which may also be referenced by other threads
+     - If the response is out of order (queued) then data is copied to the queue
+     .
+     \param  id     Request ID for response
+     \param  data   Response data to send
+     \param  flags  Flags used for deferred response, same as with Writer
+     \return        This
+    */
+    This& send_ref(ulong id, const SharedString& data, WriterFlags flags=wfNONE) {
+        String* out = get_writer_out(id, flags);
+        if (out == NULL)
+            buf_.write_ref(data);
+        else
+            out->add(data.data(), data.size());
+        return *this;
+    }
+
     /** End current response.
      - Call after last send() for current response
      - Not needed for deferred responses, deferred_end() calls this
@@ -249,6 +260,43 @@ private:
     ulong prev_id_;         // previously queued/sent request ID -- not used by deferred_send()
     ReplyItem* prev_;       // previously queued item, NULL if none -- not used by deferred_send()
 
+    // Get output string for Writer with given request ID and flags, NULL to write to buffer directly
+    String* get_writer_out(ulong id, WriterFlags flags) {
+        if (int(flags) & wfDEFERRED) {
+            // Deferred
+            send_end();
+            if (id == next_id_) {
+                // This is the current reply
+                if (flags == wfDEFERRED_LAST)
+                    ++next_id_;
+                return NULL;
+            } else {
+                // Either append to existing reply in queue, or insert new reply -- keep queue ordered by ID
+                ReplyItem* rsp;
+                deferred_get_queue_item(rsp, id);
+                return &rsp->data;
+            }
+        } else if (id == prev_id_) {
+            // Append to previous send
+            if (prev_ == NULL)
+                return NULL;
+            return &prev_->data;
+        } else {
+            // New send
+            send_end();
+            prev_id_ = id;
+            if (id == next_id_) {
+                ++next_id_;
+                prev_ = NULL;
+                return NULL;
+            } else {
+                prev_ = queue_.addnew().advLast();
+                prev_->id = id;
+                return &prev_->data;
+            }
+        }
+    }
+
     bool deferred_get_queue_item(ReplyItem*& rsp, ulong id) {
         SizeT i = 0, sz = queue_.size();
         if (sz > 0 && id > queue_[sz-1].id) {
@@ -598,17 +646,41 @@ public:
     };
 
     /** Constructor. */
-    AsyncServer() : last_id_(0) {
+    AsyncServer() : global_(new Global), last_id_(0), main_(NULL), workers_(NULL), workers_count_(0), listener_(IoSocket::INVALID), worker_result_(false) {
         init();
     }
 
+    /** Destructor. */
+    ~AsyncServer() {
+        assert( workers_ == NULL ); // failure here means server destroyed while run_threads() still running
+        if (main_ == NULL)
+            delete global_;
+    }
+
     /** Get reference to global data used by all requests and all threads in this server.
      - Use this to populate configuration data before running the server
      .
      \return  Reference to global data
     */
     Global& get_global() {
-        return global_;
+        return *global_;
+    }
+
+    /** Get server stats, aggregated from all server threads.
+     - When running with run_threads() the stats from each thread are summed together
+     - This is safe to call from any thread while the server is running
+       - Counters are atomic, but are read one at a time without stopping the server, so a snapshot may be slightly out of date or not consistent across counters
+     .
+     \param  stats  Stores stats  [out]
+     \return        Reference to `stats`
+    */
+    Stats& get_stats(Stats& stats) {
+        stats = Stats();
+        stats_.get(stats);
+        Mutex::Lock lock(workers_mutex_);
+        for (uint i = 0; i < workers_count_; ++i)
+            workers_[i]->stats_.get(stats);
+        return stats;
     }
 
     /** Run server event handling and handle connections until shutdown.
@@ -645,7 +717,7 @@ public:
             return false;
         }
 
-        if (!shared_.on_init(*this, global_)) {
+        if (!shared_.on_init(*this, *global_)) {
             logger.log(LOG_LEVEL_ALERT, "AsyncServer Shared on_init() returned an error, indicating a bad configuration");
             return false;
         } else
@@ -668,20 +740,197 @@ public:
         return run(listener.device().handle);
     }
 
+    /** Run server with multiple threads, each with a separate event-loop, and handle connections until shutdown.
+     - This starts `count - 1` additional server threads and then runs the first server thread in the current thread, so this blocks until shutdown
+     - Each server thread has its own event-loop, `Shared` instance (calls `Shared::on_init()` per thread), and connections -- `Global` is shared by all threads
+       - Each server thread accepts connections directly from the listener socket, so the system spreads new connections across threads
+       - A connection is always handled by the thread that accepted it
+     - This keeps running until the listener socket is closed or shutdown() is called, which stops all server threads
+     - If `count` is 1 (or 0) this is the same as run()
+     - Requires `EVO_ASYNC_MULTI_THREAD` enabled (see \ref Async), otherwise this returns false (unless `count` is 1)
+     .
+     \param  listener  Listener socket handle to accept connections on, shared by all server threads
+     \param  count     Number of server threads to run
+     \return           Whether successful, false if initialization failed in any server thread (`Shared::on_init()` or internal error)
+    */
+    bool run_threads(IoSocket::Handle listener, uint count) {
+        return run_threads_internal(&listener, 1, count);
+    }
+
+    /** Run server with multiple threads, each with a separate event-loop, and handle connections until shutdown.
+     - See run_threads(IoSocket::Handle,uint)
+     .
+     \param  listener  Listener socket to accept connections on, shared by all server threads
+     \param  count     Number of server threads to run
+     \return           Whether successful, false if initialization failed in any server thread (`Shared::on_init()` or internal error)
+    */
+    bool run_threads(Socket& listener, uint count) {
+        return run_threads(listener.device().handle, count);
+    }
+
+    /** Run server with multiple threads, each with a separate event-loop and listener socket, and handle connections until shutdown.
+     - This is the same as run_threads(IoSocket::Handle,uint) except each server thread accepts connections from its own listener socket
+     - Use this with listener sockets bound to the same address with `SO_REUSEPORT` (Linux 3.9+) so the system load balances new connections across listeners without waking every thread on each new connection
+     - Server thread count is the same as the listener count
+     .
+     \param  listeners  Array of listener socket handles to accept connections on, one per server thread
+     \param  count      Number of listener socket handles, and number of server threads to run
+     \return            Whether successful, false if initialization failed in any server thread (`Shared::on_init()` or internal error)
+    */
+    bool run_threads(const IoSocket::Handle* listeners, uint count) {
+        return run_threads_internal(listeners, count, count);
+    }
+
     /** Shut down server.
      - The server will stop accepting new requests and will finish handling current requests
+     - This stops all server threads when run_threads() was used
      - This doesn't block and can be called from any thread or event handler
     */
     void shutdown() {
-        evloop_->shutdown();
+        if (main_ != NULL) {
+            main_->shutdown();
+        } else {
+            evloop_->shutdown();
+            Mutex::Lock lock(workers_mutex_);
+            for (uint i = 0; i < workers_count_; ++i)
+                workers_[i]->evloop_->shutdown();
+        }
     }
 
 private:
-    Global global_;
+    // Stats counters for a server thread: only updated by that thread, but may be read by any thread
+    struct StatsCounters {
+        AtomicULong active_connections;
+        AtomicULong accept_ok;
+        AtomicULong accept_err;
+        AtomicULong event_err;
+        AtomicULong reads;
+
+        StatsCounters() {
+            active_connections.store(0, EVO_ATOMIC_RELAXED);
+            accept_ok.store(0, EVO_ATOMIC_RELAXED);
+            accept_err.store(0, EVO_ATOMIC_RELAXED);
+            event_err.store(0, EVO_ATOMIC_RELAXED);
+            reads.store(0, EVO_ATOMIC_RELAXED);
+        }
+
+        // Add counters to stats
+        void get(Stats& stats) const {
+            stats.active_connections += active_connections.load(EVO_ATOMIC_RELAXED);
+            stats.accept_ok  += accept_ok.load(EVO_ATOMIC_RELAXED);
+            stats.accept_err += accept_err.load(EVO_ATOMIC_RELAXED);
+            stats.event_err  += event_err.load(EVO_ATOMIC_RELAXED);
+            stats.reads      += reads.load(EVO_ATOMIC_RELAXED);
+        }
+
+        // Add counters from a finished server thread
+        void add(const StatsCounters& src) {
+            Stats stats;
+            src.get(stats);
+            add(active_connections, stats.active_connections);
+            add(accept_ok, stats.accept_ok);
+            add(accept_err, stats.accept_err);
+            add(event_err, stats.event_err);
+            add(reads, stats.reads);
+        }
+
+        // Update counter from owning thread -- no read-modify-write needed with a single writer
+        static void add(AtomicULong& counter, ulong count)
+            { counter.store(counter.load(EVO_ATOMIC_RELAXED) + count, EVO_ATOMIC_RELAXED); }
+        static void inc(AtomicULong& counter)
+            { counter.store(counter.load(EVO_ATOMIC_RELAXED) + 1, EVO_ATOMIC_RELAXED); }
+        static void dec(AtomicULong& counter)
+            { counter.store(counter.load(EVO_ATOMIC_RELAXED) - 1, EVO_ATOMIC_RELAXED); }
+    };
+
+    Global* global_;        // owned by main server, worker servers share the main server global
     Shared shared_;
-    Stats stats_;
+    StatsCounters stats_;
     ulong last_id_;
 
+    This*  main_;           // main server if this is a worker server (used by run_threads()), NULL if this is the main server
+    This** workers_;        // worker servers started by run_threads(), NULL if none
+    uint   workers_count_;  // worker server count
+    Mutex  workers_mutex_;  // locks workers_ and workers_count_ in main server
+
+    IoSocket::Handle listener_; // listener for worker server thread
+    bool worker_result_;        // worker server thread result
+
+    // Constructor for worker server used by run_threads(), sharing main server global
+    explicit AsyncServer(This* main) : global_(main->global_), last_id_(0), main_(main), workers_(NULL), workers_count_(0), listener_(IoSocket::INVALID), worker_result_(false) {
+        init();
+    }
+
+    static void worker_thread(void* arg) {
+        This& worker = *(This*)arg;
+        worker.worker_result_ = worker.run(worker.listener_);
+        if (!worker.worker_result_)
+            worker.main_->shutdown();
+    }
+
+    bool run_threads_internal(const IoSocket::Handle* listeners, uint listener_count, uint count) {
+        assert( listeners != NULL );
+        assert( listener_count > 0 );
+        if (count <= 1)
+            return run(listeners[0]);
+    #if EVO_ASYNC_MULTI_THREAD
+        const uint worker_count = count - 1;
+        Thread* threads = new Thread[worker_count];
+        {
+            Mutex::Lock lock(workers_mutex_);
+            workers_ = new This*[worker_count];
+            for (uint i = 0; i < worker_count; ++i) {
+                This* worker = new This(this);
+                worker->listener_   = (listener_count > 1 ? listeners[i + 1] : listeners[0]);
+                worker->logger.ptr  = logger.ptr;
+                worker->read_timeout_ms_  = read_timeout_ms_;
+                worker->write_timeout_ms_ = write_timeout_ms_;
+                if (!evloop_->active())
+                    worker->evloop_->shutdown();
+                workers_[i] = worker;
+                ++workers_count_;
+            }
+        }
+        for (uint i = 0; i < worker_count; ++i) {
+            threads[i].thread_init = Thread::Init(worker_thread, workers_[i]);
+            if (!threads[i].thread_start()) {
+                logger.log(LOG_LEVEL_ALERT, "AsyncServer run_threads() failed to start server thread");
+                shutdown();
+                break;
+            }
+        }
+        if (logger.check(LOG_LEVEL_DEBUG))
+            logger.log_direct(LOG_LEVEL_DEBUG, String().reserve(48) << "AsyncServer starting threads: " << count);
+
+        bool result = run(listeners[0]);
+        shutdown();
+        for (uint i = 0; i < worker_count; ++i) {
+            if (threads[i].thread_active()) {
+                threads[i].thread_join();
+                if (!workers_[i]->worker_result_)
+                    result = false;
+            } else
+                result = false;
+        }
+        delete [] threads;
+
+        {
+            Mutex::Lock lock(workers_mutex_);
+            for (uint i = 0; i < workers_count_; ++i) {
+                stats_.add(workers_[i]->stats_);
+                delete workers_[i];
+            }
+            delete [] workers_;
+            workers_       = NULL;
+            workers_count_ = 0;
+        }
+        return result;
+    #else
+        logger.log(LOG_LEVEL_ALERT, "AsyncServer run_threads() requires EVO_ASYNC_MULTI_THREAD enabled");
+        return false;
+    #endif
+    }
+
     using AsyncBase::runlocal;
 
     struct Connection {
@@ -693,7 +942,7 @@ private:
         ulong id;                           ///< Connection ID
 
         Connection(This& async_server, struct bufferevent* bev, ulong id) :
-                server(async_server), protocol_server(async_server.global_, async_server.shared_, async_server.logger.ptr), bev(bev), read_fixed_size_(0), id(id) {
+                server(async_server), protocol_server(*async_server.global_, async_server.shared_, async_server.logger.ptr), bev(bev), read_fixed_size_(0), id(id) {
             deferred_context = new DeferredContext(protocol_server.handler);
 
             ::bufferevent_setcb(bev, on_read, NULL, on_error, this);
@@ -711,7 +960,7 @@ private:
 
         ~Connection() {
             ::bufferevent_free(bev);
-            --server.stats_.active_connections;
+            StatsCounters::dec(server.stats_.active_connections);
             if (!deferred_context->detach())
                 server.logger.log(LOG_LEVEL_DEBUG_LOW, "AsyncServer cleanup, deferred pending");
         }
@@ -731,13 +980,18 @@ private:
         Error err;
         IoSocket listener_socket(listener), client_socket;
         if (!listener_socket.accept_nonblock(err, client_socket)) {
+            if (err == ENonBlock) {
+                // Another server thread accepted the connection first
+                listener_socket.detach();
+                return;
+            }
             if (self.logger.check(LOG_LEVEL_ALERT)) {
                 String msg;
                 msg = "AsyncServer socket accept failed: ";
                 IoSocket::errormsg_out(msg, err);
                 self.logger.log_direct(LOG_LEVEL_ALERT, msg);
             }
-            ++self.stats_.accept_err;
+            StatsCounters::inc(self.stats_.accept_err);
             return;
         }
         listener_socket.detach();
@@ -745,24 +999,24 @@ private:
         struct bufferevent* bev = ::bufferevent_socket_new(self.evloop_->handle(), client_socket.detach(), BEV_OPT_CLOSE_ON_FREE);
         if (bev == NULL) {
             self.logger.log(LOG_LEVEL_ALERT, "AsyncServer libevent bufferevent_socket_new() returned an error -- this shouldn't happen");
-            ++self.stats_.accept_err;
+            StatsCounters::inc(self.stats_.accept_err);
             return;
         }
 
         // Connection takes ownership of bev, and is freed by on_read() or on_error() (when connection is closed)
         Connection* conn = new Connection(self, bev, ++self.last_id_);
-        ++self.stats_.active_connections;
+        StatsCounters::inc(self.stats_.active_connections);
         if (!conn->enable()) {
             delete conn; // failed to enable connection event handling
-            ++self.stats_.accept_err;
+            StatsCounters::inc(self.stats_.accept_err);
         } else
-            ++self.stats_.accept_ok;
+            StatsCounters::inc(self.stats_.accept_ok);
     }
 
     static void on_read(struct bufferevent* bev, void* conn_ptr) {
         Connection* conn = (Connection*)conn_ptr;
         LoggerPtr<>& logger = conn->server.logger;
-        ++conn->server.stats_.reads;
+        StatsCounters::inc(conn->server.stats_.reads);
         conn->protocol_server.handler.buffers.attach(bev);
 
         String logstr;
@@ -785,7 +1039,7 @@ private:
                 if (conn->read_fixed_size_ <= 0)
                     break;
             }
-            bufs->read_reset(ProtocolServer::MIN_INITIAL_READ, ProtocolServer::Handler::MAX_INITIAL_READ);
+            bufs->read_reset(ProtocolServer::Handler::MAX_INITIAL_READ, ProtocolServer::MIN_INITIAL_READ);
             if (bufs->read_size() == 0)
                 return;
         }
@@ -813,7 +1067,7 @@ private:
             err = aeIO_WRITE;
         else
             err = aeIO;
-        ++conn->server.stats_.event_err;
+        StatsCounters::inc(conn->server.stats_.event_err);
         conn->protocol_server.on_error(err);
 
         const ulong conn_id = conn->id;
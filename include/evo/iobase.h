@@ -205,6 +205,58 @@ struct StreamBase : public IoBase {
         return false;
     }
 
+    /** Read next batch of text lines from stream.
+     - This reads a large block and returns all complete lines in it at once, with a bulk newline scan and without copying line data
+       - This is much faster than readline() when reading many lines, since readline() copies each line to a string
+       - Lines reference the stream read buffer and are only valid until the next read from this stream
+       - The read buffer is grown to `batch.blocksize` if smaller, and as needed for a line longer than the buffer
+     - Depending on the stream type, this may be a blocking call
+       - Each batch does at most 1 read when no complete line is buffered, so with pipes and sockets lines are returned as they arrive
+     - Call error() to check error code
+     - Error codes:
+       - EEnd if no more lines (end-of-file)
+       - EOutOfBounds if line exceeds maxlen -- the line is skipped, though the rest of a line that didn't fit in the buffer is returned as a line on the next call
+       - ELoss if previous readtext() call left a pending partial newline pair, see readline()
+       - Other codes for read errors
+     - This never throws any exception
+     .
+     \param  batch   Stores lines read, cleared first [in/out]
+     \param  maxlen  Maximum line length, 0 for no limit
+     \return         Whether successful, false if no more lines (end-of-file) or error
+    */
+    virtual bool readlines(LineBatch& batch, ulong maxlen=0) {
+        EVO_PARAM_UNUSED(maxlen);
+        batch.lines.clear();
+        error_ = ENone;
+        return false;
+    }
+
+    /** Read all remaining text lines from stream and call function for each line.
+     - This calls readlines(LineBatch&,ulong) to read lines in batches, then calls `func(line)` for each line, where line is a `const SubString&`
+       - \b Caution: A line is only valid during the call, copy it to keep it
+     - This stops at end-of-file or on error -- call error() to check for error, EEnd means all lines were read
+     .
+     \tparam  F  Function or functor type to call -- inferred from `func` argument
+
+     \param  func       Function or functor to call for each line, return value is ignored
+     \param  blocksize  Block size for reading lines, see LineBatch
+     \param  maxlen     Maximum line length, 0 for no limit
+     \return            Number of lines read
+    */
+    template<class F>
+    ulongl readlines(F func, ulong blocksize=LineBatch::DEFSIZE, ulong maxlen=0) {
+        LineBatch batch(blocksize);
+        ulongl count = 0;
+        while (readlines(batch, maxlen)) {
+            const SubString* lines = batch.lines.data();
+            const SizeT size = batch.lines.size();
+            for (SizeT i = 0; i < size; ++i)
+                func(lines[i]);
+            count += size;
+        }
+        return count;
+    }
+
     /** Write repeat character as text output to stream.
      - This does a text write, converting newlines as needed
        - Note that writing newline text characters 1 char at a time or by string will give the same end result either way -- the edge cases are covered
@@ -762,7 +814,7 @@ struct StreamFormatter {
  - This is not normally instantiated directly, see: File, Pipe, Console, Socket
  - This implements binary and text input/output with buffering
    - Binary I/O (no newline conversion): readbin(), writebin()
-   - Text I/O (automatic newline conversion): readtext(), readline(), writetext(), writeline()
+   - Text I/O (automatic newline conversion): readtext(), readline(), readlines(), writetext(), writeline()
    - Use flush() to flush write buffer (text and binary)
    .
  - This also implements formatted output using operator<<()\n
@@ -927,8 +979,21 @@ public:
         if (T::STREAM_SEEKABLE && rwlast_ != rwlREAD && !readprep())
             return false;
         error_ = bufrd_.readline(str, device_, maxlen);
-        if (error_ != ENone && error_ != EEnd) {
-            EVO_THROW_ERR_CHECK(ExceptionInT, "Stream text line read failed", error_, excep_);
+        if (error_ != ENone) {
+            EVO_THROW_ERR_CHECK(ExceptionInT, "Stream text line read failed", error_, (excep_ && error_ != EEnd));
+            return false;
+        }
+        return true;
+    }
+
+    using StreamBase::readlines;
+
+    bool readlines(LineBatch& batch, ulong maxlen=0) {
+        if (T::STREAM_SEEKABLE && rwlast_ != rwlREAD && !readprep())
+            { batch.lines.clear(); return false; }
+        error_ = bufrd_.readlines(batch, device_, maxlen);
+        if (error_ != ENone) {
+            EVO_THROW_ERR_CHECK(ExceptionInT, "Stream text lines read failed", error_, (excep_ && error_ != EEnd));
             return false;
         }
         return true;
@@ -676,7 +676,7 @@ struct SocketAddressUnix : public SocketAddressBase {
    - finish(), finish_in(), finish_out()
    - close()
  - Data:
-   - readline(), readtext(), readbin()
+   - readline(), readlines(), readtext(), readbin()
      - bufread()
    - writeline(), writetext(), writechar(), writebin()
      - flush()
@@ -280,13 +280,13 @@ public:
         /** Destructor, frees buffer if needed. */
         ~Edit() {
             if (header != NULL)
-                ::free(header);
+                Buf::memfree((Header*)header);
         }
 
         /** Clear data and free buffer. */
         void clear() {
             if (header != NULL) {
-                ::free(header);
+                Buf::memfree((Header*)header);
                 header = NULL;
             }
             ptr  = NULL;
@@ -827,11 +827,32 @@ public:
         { return (offset < size_ ? size_-1-offset : END); }
 
     /** Get data hash value.
+     - With EVO_LIST_OPT_HASHCACHE, the hash value is cached in the buffer header, but only while the buffer is shared
+       - Copies of a list share the buffer, so repeated lookups with copies of a map key only hash the data once
+       - An unshared list isn't cached and is rehashed on every call, so this doesn't help with keys that don't share a buffer (including most keys during a map resize)
+       - A shared buffer can't be modified (modifiers unshare first), and the cache is invalidated when a buffer becomes shared again
+       - One hash value is cached per buffer, for the last slice and seed hashed
+       - \b Caution: This writes to the shared buffer header from a const method, so calling hash() on lists sharing a buffer from multiple threads at the same time isn't safe -- this includes concurrent const lookups in a hash container
+       .
+     .
      \param  seed  Seed value for hashing multiple values, 0 if none
      \return       Hash value
     */
-    ulong hash(ulong seed=0) const
-        { return DataHash<T>::hash(data_, size_, seed); }
+    ulong hash(ulong seed=0) const {
+        #if EVO_LIST_OPT_HASHCACHE
+            if (buf_.ptr != NULL && buf_.header->refs > 1) {
+                Header& header = *buf_.header;
+                if (header.hash_data != data_ || header.hash_size != size_ || header.hash_seed != seed) {
+                    header.hash_value = DataHash<T>::hash(data_, size_, seed);
+                    header.hash_data  = data_;
+                    header.hash_size  = size_;
+                    header.hash_seed  = seed;
+                }
+                return header.hash_value;
+            }
+        #endif
+        return DataHash<T>::hash(data_, size_, seed);
+    }
 
     // COMPARE
 
@@ -1836,6 +1857,27 @@ public:
         return *this;
     }
 
+#if EVO_ALLOCATORS || defined(DOXYGEN)
+    /** %Set allocator to use for new buffers (modifier).
+     - Requires EVO_ALLOCATORS to be enabled
+     - The current buffer isn't moved, and is still freed with the allocator it was allocated with
+     - Buffers aren't shared with a list using a different allocator, a copy is made instead -- see \ref Sharing "Sharing"
+     .
+     \param  allocator  %Allocator to use, NULL for default
+     \return            This
+    */
+    ListType& set_allocator(Allocator* allocator)
+        { buf_.allocator = allocator; return *this; }
+
+    /** Get allocator used for new buffers.
+     - Requires EVO_ALLOCATORS to be enabled
+     .
+     \return  %Allocator pointer, NULL for default
+    */
+    Allocator* get_allocator() const
+        { return buf_.allocator; }
+#endif
+
     // RESIZE
 
     /** Resize while preserving existing data (modifier).
@@ -2503,11 +2545,18 @@ public:
 
     /** Swap with another list.
      - This swaps internal state directly so is faster than moving items
+     - With EVO_ALLOCATORS each list keeps its own allocator, buffers are still freed with the allocator they were allocated with
      .
      \param  list  %List to swap with
     */
-    void swap(ListType& list)
-        { EVO_IMPL_CONTAINER_SWAP(this, &list, ThisType); }
+    void swap(ListType& list) {
+        EVO_IMPL_CONTAINER_SWAP(this, &list, ThisType);
+        #if EVO_ALLOCATORS
+            Allocator* temp     = buf_.allocator;
+            buf_.allocator      = list.buf_.allocator;
+            list.buf_.allocator = temp;
+        #endif
+    }
 
     // ALGS
 
@@ -2878,6 +2927,8 @@ public:
     /** \cond impl */
     Size used() const
         { return (buf_.ptr == NULL ? size_ : buf_.header->used); }
+    bool buffered() const
+        { return (buf_.ptr != NULL); }
     /** \endcond */
 
     // Testing methods
@@ -3002,6 +3053,15 @@ protected:
         Size used;                  ///< Buffer size used/initialized as item count
         Size size;                  ///< Buffer size allocated as item count
         Size refs;                  ///< Buffer reference count
+        #if EVO_ALLOCATORS
+            Allocator* allocator;   ///< Allocator used for this buffer, NULL for default
+        #endif
+        #if EVO_LIST_OPT_HASHCACHE
+            const T* hash_data;     ///< Cached hash data pointer, NULL if no cached hash
+            Size     hash_size;     ///< Cached hash data size
+            ulong    hash_seed;     ///< Cached hash seed
+            ulong    hash_value;    ///< Cached hash value
+        #endif
     };
 
     /** List buffer data helper. */
@@ -3009,13 +3069,16 @@ protected:
         Header* header;             ///< Data header pointer, NULL if no buffer allocated
         T*      ptr;                ///< Data pointer, NULL if buffer not used
         #if EVO_ALLOCATORS
-            Allocator*  allocator;  ///< Allocator pointer (NULL for default or if not owner)
+            Allocator*  allocator;  ///< Allocator pointer to use for new buffers, NULL for default
         #endif
 
         /** Constructor. */
         Buf() {
             header = NULL;
             ptr    = NULL;
+            #if EVO_ALLOCATORS
+                allocator = NULL;
+            #endif
         }
 
         /** Destructor. */
@@ -3042,17 +3105,19 @@ protected:
             assert( size > 0 );
             const Size bytes = sizeof(Header) + (size*sizeof(T));
             #if EVO_ALLOCATORS
-                if (allocator == NULL)
-                    header = (Header*)::malloc(bytes);
-                else
-                    header = (Header*)allocator->alloc(bytes);
+                header = EVO_IMPL_CONTAINER_MEM_ALLOC_A(allocator, Header, bytes);
+                assert( header != NULL );
+                header->allocator = allocator;
             #else
                 header = (Header*)::malloc(bytes);
+                assert( header != NULL );
             #endif
-            assert( header != NULL );
             header->refs = 1;
             header->used = used;
             header->size = size;
+            #if EVO_LIST_OPT_HASHCACHE
+                header->hash_data = NULL;
+            #endif
             return (T*)(header + 1);
         }
 
@@ -3080,10 +3145,7 @@ protected:
             assert( size > 0 );
             const Size bytes = sizeof(Header) + (size*sizeof(T));
             #if EVO_ALLOCATORS
-                if (allocator == NULL)
-                    this->header = (Header*)::realloc(this->header, bytes);
-                else
-                    this->header = (Header*)allocator->realloc(this->header, bytes);
+                this->header = EVO_IMPL_CONTAINER_MEM_REALLOC_A(this->header->allocator, Header, this->header, bytes);
             #else
                 this->header = (Header*)::realloc(this->header, bytes);
             #endif
@@ -3096,13 +3158,18 @@ protected:
         /** Free buffer memory.
          - Assumes buffer is allocated
         */
-        void memfree() {
+        void memfree()
+            { memfree(header); }
+
+        /** Free buffer memory for given header.
+         - This uses the allocator the buffer was allocated with
+         .
+         \param  header  Buffer header to free, must not be NULL
+        */
+        static void memfree(Header* header) {
             assert( (size_t)header > sizeof(Header) );
             #if EVO_ALLOCATORS
-                if (this->allocator == NULL)
-                    ::free(header);
-                else
-                    this->allocator->free(header);
+                EVO_IMPL_CONTAINER_MEM_FREE_A(header->allocator, header);
             #else
                 ::free(header);
             #endif
@@ -3147,7 +3214,8 @@ protected:
         } else if (data.size_ == 0) {
             setempty();
         #if EVO_ALLOCATORS
-        } else if (buf_.allocator != NULL && data.buf_.ptr != NULL) {
+        } else if (data.buf_.ptr != NULL && data.buf_.header->allocator != buf_.allocator) {
+            // Don't share buffer from a different allocator
             copy(data);
         #endif
         } else if (data.buf_.ptr == NULL) {
@@ -3186,7 +3254,7 @@ protected:
             buf_.free();
             buf_.header = data.buf_.header;
             buf_.ptr    = data.buf_.ptr;
-            ++buf_.header->refs;
+            ref_header();
             data_ = data.data_;
             size_ = data.size_;
             #if EVO_LIST_OPT_REFTERM
@@ -3212,7 +3280,8 @@ protected:
             if (size == 0) {
                 setempty();
             #if EVO_ALLOCATORS
-            } else if (buf_.allocator != NULL && data.buf_.header != NULL) {
+            } else if (data.buf_.ptr != NULL && data.buf_.header->allocator != buf_.allocator) {
+                // Don't share buffer from a different allocator
                 copy(data.data_+index, size);
             #endif
             } else if (data.buf_.ptr == NULL) {
@@ -3255,7 +3324,7 @@ protected:
                 #if EVO_LIST_OPT_REFTERM
                     terminated_ = data.terminated_;
                 #endif
-                ++buf_.header->refs;
+                ref_header();
             }
         }
     }
@@ -4023,6 +4092,18 @@ private:
         #endif
     }
 
+    /** Add reference to buffer header from another list, sharing the buffer.
+     - With EVO_LIST_OPT_HASHCACHE this invalidates the cached hash when the buffer becomes shared, since it may have been modified while not shared
+    */
+    void ref_header() {
+        #if EVO_LIST_OPT_HASHCACHE
+            if (++buf_.header->refs == 2)
+                buf_.header->hash_data = NULL;
+        #else
+            ++buf_.header->refs;
+        #endif
+    }
+
     /** Initialize given memory.
      \param  ptr   Memory to initialize
      \param  data  Data to initialize, NULL to leave uninitialized, PDEFAULT to initialize with default constructor
@@ -4036,6 +4117,10 @@ private:
     }
 };
 
+/** \cond impl */
+template<class T, class TSize, class H> struct DataHash<List<T,TSize>,H,false> : public impl::DataHashList<List<T,TSize>,T,H> { };
+/** \endcond */
+
 ///////////////////////////////////////////////////////////////////////////////
 //@}
 }
@@ -11,7 +11,7 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 #include "io.h"
 #include "file.h"
 #include "substring.h"
-#include "atomic_buffer_queue.h"
+#include "atomic_mpmc_queue.h"
 #include "thread.h"
 #include "time.h"
 #include "enum.h"
@@ -242,7 +242,7 @@ namespace impl {
             // Copy main buffer up to size from src
             size = src.size;
             if (src.size > 0) {
-                ::memcpy(buf, src.buf, size);
+                ::memcpy(buf, src.buf, (size > BUF_SIZE ? BUF_SIZE : size)); // rest is in aux_buf
                 src_mutable.size = 0;
             }
 
@@ -439,6 +439,8 @@ struct LoggerPtr {
 /** High performance message logger.
  - Efficient lock-free and thread-safe logging
  - This uses a background thread that pulls messages from the logger queue and writes to the log file
+   - Messages are written in batches: each batch is formatted into one buffer and written with a single write call -- see set_batch_size()
+   - The formatted timestamp is cached and only updated once per second
  - Call set_level() to set logging level -- messages less severe than this level are ignored (not logged)
  - Call start() to open/create the log file and start the background thread
  - Call log() or log_direct() to log messages from any thread, or use the helper macros:
@@ -512,11 +514,12 @@ public:
 
     static const uint MESSAGE_BUFFER_SIZE = MSG_BUF_SIZE;   ///< Preallocated buffer size per message -- messages within this size don't allocate memory when queued
     static const SizeT DEFAULT_QUEUE_SIZE = 256;            ///< Default queue size, override with constructor
+    static const SizeT DEFAULT_BATCH_SIZE = 128;            ///< Default max messages written per batch, see set_batch_size()
 
     /** Constructor.
      \param  queue_size  Queue size to use
     */
-    Logger(SizeT queue_size=DEFAULT_QUEUE_SIZE) : queue_(queue_size), outfile_(NL_SYS, false), thread_(consumer, this), local_time_(false) {
+    Logger(SizeT queue_size=DEFAULT_QUEUE_SIZE) : queue_(queue_size), outfile_(NL_SYS, false), thread_(consumer, this), local_time_(false), batch_size_(DEFAULT_BATCH_SIZE) {
         level_.store(LOG_LEVEL_WARN);
     }
 
@@ -543,6 +546,17 @@ public:
         local_time_ = local_time;
     }
 
+    /** %Set max number of messages to write per batch.
+     - The logging thread pulls up to this many messages from the queue, formats them into one buffer, then writes them with a single write call
+     - A batch is also limited by buffer size (16 KB), a larger message is written in a batch by itself
+     - This must be called before start() or start_thread()
+     .
+     \param  batch_size  Max messages per batch, 1 to write each message separately -- 0 is treated as 1
+    */
+    void set_batch_size(SizeT batch_size=DEFAULT_BATCH_SIZE) {
+        batch_size_ = (batch_size == 0 ? 1 : batch_size);
+    }
+
     bool get_error(String& msg) {
         Condition::Lock lock(condmutex_);
         if (errmsg_.null())
@@ -665,7 +679,7 @@ public:
 private:
     typedef impl::LoggerMsg<MSG_BUF_SIZE> Msg;
 
-    AtomicBufferQueue<Msg> queue_;
+    AtomicMpmcQueue<Msg> queue_;
 
     String errmsg_;
     String filepath_;
@@ -675,53 +689,92 @@ private:
     AtomicInt shutdown_;
     AtomicInt rotate_;
     bool local_time_;
+    SizeT batch_size_;
+
+    // Formats messages for consumer(), caches the timestamp prefix so it's only converted and formatted once per second
+    struct MsgFormatter {
+        static const StrSizeT PREFIX_MAX_LEN = 32;  // max prefix length, with timestamp and level
+
+        const bool& local_time;
+        DateTime dt;
+        String   dt_prefix;
+        int64    dt_sec;
+
+        MsgFormatter(const bool& local_time) : local_time(local_time), dt_sec(-1) {
+        }
+
+        void format(String& out, Msg& msg, uint32 buf1_size, uint32 buf2_size) {
+            const char* LEVEL_STR[] = { "ALRT", "ERRR", "WARN", "INFO", "dbug", "dbgl" };
+            const StrSizeT LEVEL_LEN = 4;
+
+            const int64 sec = msg.timestamp.get_unix_timestamp();
+            if (sec != dt_sec) {
+                if (local_time)
+                    msg.timestamp.convert_local_dt_notz(dt);
+                else
+                    msg.timestamp.convert_utc_dt(dt);
+                dt.tz.set();
+                dt_prefix.set() << '[';
+                dt.format(dt_prefix, ':') << ' ';
+                dt_sec = sec;
+            }
+
+            out << dt_prefix;
+            if (msg.level > LOG_LEVEL_DISABLED && msg.level <= LOG_LEVEL_DEBUG_LOW)
+                out.add(LEVEL_STR[(int)msg.level - 1], LEVEL_LEN);
+            else
+                out << FmtInt(msg.level).width(LEVEL_LEN, ' ');
+            out.add("] ", 2);
+            if (buf1_size > 0)
+                out.add(msg.buf, buf1_size);
+            if (buf2_size > 0)
+                out.add(msg.aux_buf, buf2_size);
+            out << NL;
+        }
+    };
 
     static void consumer(void* arg) {
-        const char BEGIN_DELIM = '[';
-        const SubString MSG_DELIM("] ", 2);
-        const char* LEVEL_STR[] = { "ALRT", "ERRR", "WARN", "INFO", "dbug", "dbgl" };
-        const StrSizeT LEVEL_LEN = 4;
+        const ulong BATCH_BUF_SIZE = IoWriter::DEFSIZE;
 
         const ulong WAKE_TIMEOUT_MS = 500;
         Logger& logger = *(Logger*)arg;
         bool closed = false;
         ulong drop_count = 0;
 
-        DateTime dt;
+        // Batch is formatted in buf then written with a single write -- buf fits in file write buffer so each flush is 1 write call
+        String buf;
+        buf.reserve(BATCH_BUF_SIZE);
+        SizeT buf_count = 0;
+
+        MsgFormatter formatter(logger.local_time_);
+
         Msg msg;
         uint32 buf1_size, buf2_size;
         for (;;) {
-            // Consume all messages in queue
-            while (logger.queue_.pop(msg)) {
-                if (closed) {
-                    ++drop_count;
-                } else {
-                    if (logger.local_time_)
-                        msg.timestamp.convert_local_dt_notz(dt);
-                    else
-                        msg.timestamp.convert_utc_dt(dt);
-                    dt.tz.set();
-
-                    logger.outfile_ << BEGIN_DELIM;
-                    dt.format(logger.outfile_, ':') << ' ';
-                    if (msg.level > LOG_LEVEL_DISABLED && msg.level <= LOG_LEVEL_DEBUG_LOW)
-                        logger.outfile_ << SubString(LEVEL_STR[(int)msg.level - 1], LEVEL_LEN);
-                    else
-                        logger.outfile_ << FmtInt(msg.level).width(LEVEL_LEN, ' ');
-
-                    logger.outfile_ << MSG_DELIM;
-
-                    bool error = false;
+            // Consume all messages in queue, in batches
+            for (;;) {
+                const bool popped = (buf_count < logger.batch_size_ && logger.queue_.pop(msg));
+                if (popped) {
+                    if (closed) {
+                        ++drop_count;
+                        continue;
+                    }
                     msg.get_buf_sizes(buf1_size, buf2_size);
-                    if (buf1_size > 0 && logger.outfile_.writebin(msg.buf, buf1_size) < buf1_size)
-                        error = true;
-                    else if (buf2_size > 0 && logger.outfile_.writebin(msg.aux_buf, buf2_size) < buf2_size)
-                        error = true;
-                    else
-                        logger.outfile_ << NL;
-                    if (error || !logger.outfile_) {
+                    const ulong msg_size = MsgFormatter::PREFIX_MAX_LEN + buf1_size + buf2_size + 2;
+                    if (buf_count == 0 || buf.size() + msg_size <= BATCH_BUF_SIZE) {
+                        formatter.format(buf, msg, buf1_size, buf2_size);
+                        ++buf_count;
+                        continue;
+                    }
+                }
+
+                // Write batch
+                if (buf_count > 0) {
+                    if (logger.outfile_.writebin(buf.data(), buf.size()) < buf.size() || !logger.outfile_.flush() || !logger.outfile_) {
                         // Unable to write to file
-                        ++drop_count;
+                        drop_count += buf_count + (popped ? 1 : 0);
+                        buf.clear();
+                        buf_count = 0;
                         logger.outfile_.close();
                         closed = true;
 
@@ -730,7 +783,18 @@ private:
                         errormsg_out(logger.errmsg_, logger.outfile_.error());
                         break;
                     }
+                    buf.clear();
+                    buf_count = 0;
+                }
+                if (!popped) {
+                    if (logger.queue_.empty())
+                        break;
+                    continue;   // batch was full, next batch
                 }
+
+                // Message didn't fit in last batch, starts next batch
+                formatter.format(buf, msg, buf1_size, buf2_size);
+                ++buf_count;
             }
             if (logger.shutdown_.load())
                 break;
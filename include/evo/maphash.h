@@ -527,6 +527,27 @@ public:
     ThisType& unshare()
         { buckets_.unshare(); return *this; }
 
+#if EVO_ALLOCATORS || defined(DOXYGEN)
+    /** %Set allocator to use for new buckets (modifier).
+     - Requires EVO_ALLOCATORS to be enabled
+     - This is used for the bucket list and buckets -- see PtrList::set_allocator()
+     - Collision lists within buckets (when multiple keys hash to the same bucket) still use the default allocator
+     .
+     \param  allocator  %Allocator to use, NULL for default
+     \return            This
+    */
+    ThisType& set_allocator(Allocator* allocator)
+        { buckets_.set_allocator(allocator); return *this; }
+
+    /** Get allocator used for new buckets.
+     - Requires EVO_ALLOCATORS to be enabled
+     .
+     \return  %Allocator pointer, NULL for default
+    */
+    Allocator* get_allocator() const
+        { return buckets_.get_allocator(); }
+#endif
+
     /** %Set hash map size (capacity).
      - Use to suggest a new capacity before adding a batch of items
      - This will set hash size to nearest power of 2 that can fit both current items and given size
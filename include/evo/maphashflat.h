@@ -0,0 +1,834 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file maphashflat.h Evo MapHashFlat container. */
+#pragma once
+#ifndef INCL_evo_maphashflat_h
+#define INCL_evo_maphashflat_h
+
+#include "map.h"
+#include "impl/hash.h"
+#include "impl/hashflat.h"
+
+// Disable certain MSVC warnings for this file
+#if defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable:4457)
+#endif
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Map implemented as a flat hash table using open addressing.
+
+\tparam  TKey    %Map key type
+\tparam  TValue  %Map value type
+\tparam  THash   %Hash type to use -- default: CompareHash
+\tparam  TSize   %Size type to use for size values (must be unsigned integer) -- default: `SizeT`
+
+\par Features
+
+ - Similar to STL `unordered_map`, and a drop-in replacement for MapHash -- both implement the Map interface
+ - Values are always unique (no duplicate keys)
+ - Items are each stored as a Pair, directly in a single contiguous array (no separate allocation per item or bucket)
+   - Each item slot has a 1-byte control value holding 7 bits of the item hash, so most non-matching slots are skipped without comparing keys
+   - Lookups match a group of 16 control bytes at once (with SSE 2 when available, otherwise 8 at a time with integer ops), and only compare keys where the hash bits match
+   - This makes lookups with expensive key comparisons, like String keys, much faster than comparing keys one by one
+   - Removed items leave a marker that is reclaimed on the next rehash, so removing doesn't move other items
+ - No memory allocated by new empty map
+ - No sharing -- copying a map makes a full copy, use MapHash if \ref Sharing "Sharing" is needed
+ .
+
+C++11:
+ - Range-based for loop -- see \ref StlCompatibility
+   \code
+    MapHashFlat<int,int> map;
+    for (auto& item : map.asconst()) {
+        item.key();
+        item.value();
+    }
+   \endcode
+ - Initialization lists
+   \code
+    MapHashFlat<int,int> map = {{3, 300}, {1, 100}, {2, 200}};
+    MapHashFlat<String,String> strmap = {{"key1", "foo"}, {"key2", "bar"}};
+   \endcode
+ - Move semantics
+
+\par Comparison/Hash
+
+This type is used for both hashing and comparing keys. You can leave the default comparison/hash type (CompareHash) or specify an alternative.
+
+ - CompareHash
+ .
+
+See: \ref PrimitivesContainers "Primitives & Containers"
+
+\par Iterators
+
+ - Map::Iter -- Read-Only Iterator (IteratorBi)
+ - Map::IterM -- Mutable Iterator (IteratorBi)
+ .
+
+\b Caution: Adding to or resizing a map will invalidate existing iterators using it, removing an item only invalidates iterators on the removed item.
+
+\par Constructor
+
+ - MapHashFlat()
+ - MapHashFlat(const MapBaseType&)
+ - MapHashFlat(const ThisType&)
+ - MapHashFlat(const std::initializer_list<InitPair>&) [C++11]
+ - MapHashFlat(ThisType&&) [C++11]
+
+\par Read Access
+
+ - asconst()
+ - size()
+   - null(), empty()
+   - capacity()
+   - shared()
+   - ordered()
+ - contains(const Key&) const
+ - cbegin(), cend()
+   - begin() const, end() const
+ - find()
+   - iter()
+ - operator==()
+   - operator!=()
+ .
+
+\par Modifiers
+
+ - resize()
+   - reserve()
+   - capacity(Size)
+   - capacitymin()
+   - unshare()
+ - begin(), end()
+ - iterM()
+ - findM()
+   - getitem()
+   - get()
+   - operator[]()
+ - set()
+   - set(const MapBaseType&)
+   - set(const ThisType&)
+   - setempty()
+   - clear()
+   - operator=(const MapBaseType&)
+   - operator=(const ThisType&)
+   - operator=(ThisType&&) [C++11]
+ - add(const Key&,const Value&,bool)
+   - add(const Item&,bool)
+   - add(const MapBaseType&,bool)
+ - remove(const Key&)
+   - remove(typename MapBaseType::IterM&,IteratorDir)
+ .
+
+\par Helpers
+
+ - map_contains()
+ - lookupsub()
+ .
+
+\par Example
+
+\code
+#include <evo/string.h>
+#include <evo/maphashflat.h>
+#include <evo/io.h>
+using namespace evo;
+static Console& c = con();
+
+int main() {
+    typedef MapHashFlat<String,int> MyMap;
+
+    // Create map with string keys and numeric values
+    MyMap map;
+    map.add("foo", 1);
+    map["bar"] = 2;
+
+    // Find and modify value
+    int* value = map.findM("foo");
+    if (value != NULL)
+        *value = 100;
+
+    // Iterate and print keys and values
+    for (MyMap::Iter iter(map); iter; ++iter)
+        c.out << iter->key() << "=" << iter->value() << NL;
+
+    return 0;
+}
+\endcode
+
+Output:
+\code{.unparsed}
+foo=100
+bar=2
+\endcode
+
+<i>Note: Item ordering will vary</i>
+*/
+template<class TKey, class TValue, class THash=CompareHash<TKey>, class TSize=SizeT>
+class MapHashFlat : public Map<TKey,TValue,TSize> {
+protected:
+    using Map<TKey,TValue,TSize>::size_;
+
+public:
+    EVO_CONTAINER_TYPE;
+#if defined(_MSC_VER) || defined(EVO_OLDCC) // avoid errors with older compilers and MSVC
+    typedef Map<TKey,TValue,TSize> MapBaseType;                 ///< %Map base type
+    typedef typename MapBaseType::Size Size;
+    typedef typename MapBaseType::Key Key;
+    typedef typename MapBaseType::Value Value;
+    typedef typename MapBaseType::Item Item;
+    typedef typename MapBaseType::IterKey IterKey;
+    typedef typename MapBaseType::IterItem IterItem;
+#else
+    using typename Map<TKey,TValue,TSize>::MapBaseType;
+    using typename Map<TKey,TValue,TSize>::Size;
+    using typename Map<TKey,TValue,TSize>::Key;
+    using typename Map<TKey,TValue,TSize>::Value;
+    using typename Map<TKey,TValue,TSize>::Item;
+    using typename Map<TKey,TValue,TSize>::IterKey;
+    using typename Map<TKey,TValue,TSize>::IterItem;
+#endif
+    typedef MapHashFlat<TKey,TValue,THash,TSize> ThisType;      ///< This type
+    typedef THash Hash;                                         ///< Hashing type -- default: CompareHash
+
+    typedef typename IteratorBi<ThisType>::Const Iter;          ///< Iterator (const) - IteratorBi
+    typedef IteratorBi<ThisType>                 IterM;         ///< Iterator (mutable) - IteratorBi
+
+    /** Constructor. */
+    MapHashFlat() : Map<TKey,TValue,TSize>(false), items_(NULL), ctrl_(NULL)
+        { }
+
+    /** Copy constructor.
+     \param  src  Source to copy
+    */
+    MapHashFlat(const MapBaseType& src) : Map<TKey,TValue,TSize>(false), items_(NULL), ctrl_(NULL) {
+        if (!src.null()) {
+            items_ = EVO_PEMPTY;
+            reserve(src.size());
+            for (typename MapBaseType::Iter iter(src); iter; ++iter)
+                getitem(iter->first).second = iter->second;
+        }
+    }
+
+    /** Copy constructor.
+     \param  src  Source to copy
+    */
+    MapHashFlat(const ThisType& src) : Map<TKey,TValue,TSize>(false), items_(NULL), ctrl_(NULL), data_(src.data_) {
+        copy(src);
+    }
+
+    /** Destructor. */
+    ~MapHashFlat()
+        { free(); }
+
+#if defined(EVO_CPP11)
+    using typename MapBaseType::InitPair;   ///< Used with initializer_list constructor (C++11)
+
+    /** Sequence constructor (C++11).
+     \param  init  Initializer list, passed as comma-separated values in braces `{ }`
+    */
+    MapHashFlat(const std::initializer_list<InitPair>& init) : MapHashFlat() {
+        assert( init.size() < IntegerT<Size>::MAX );
+        capacitymin((Size)init.size());
+        for (const auto& item : init)
+            add(item.key, item.value);
+    }
+
+    /** Move constructor (C++11).
+     \param  src  Source to move
+    */
+    MapHashFlat(ThisType&& src) : Map<TKey,TValue,TSize>(false), items_(src.items_), ctrl_(src.ctrl_), data_(std::move(src.data_)) {
+        MapBaseType::size_ = src.MapBaseType::size_;
+        src.MapBaseType::size_ = 0;
+        src.items_ = NULL;
+        src.ctrl_  = NULL;
+    }
+
+    /** Move assignment operator (C++11).
+     \param  src  Source to move
+     \return      This
+    */
+    ThisType& operator=(ThisType&& src) {
+        free();
+        items_ = src.items_;
+        ctrl_  = src.ctrl_;
+        data_  = std::move(src.data_);
+        MapBaseType::size_ = src.MapBaseType::size_;
+        src.MapBaseType::size_ = 0;
+        src.items_ = NULL;
+        src.ctrl_  = NULL;
+        return *this;
+    }
+#endif
+
+    /** \copydoc List::asconst() */
+    const ThisType& asconst() const {
+        return *this;
+    }
+
+    // SET
+
+    /** \copydoc Map::operator=() */
+    ThisType& operator=(const MapBaseType& src)
+        { set(src); return *this; }
+
+    /** Assignment operator.
+     - This copies the hash and comparison objects as well
+     .
+     \param  src  Source to copy
+     \return      This
+    */
+    ThisType& operator=(const ThisType& src)
+        { set(src); return *this; }
+
+    ThisType& set()
+        { free(); return *this; }
+
+    ThisType& set(const MapBaseType& src) {
+        if (this != &src) {
+            if (src.null()) {
+                free();
+            } else {
+                clear();
+                reserve(src.size());
+                for (typename MapBaseType::Iter iter(src); iter; ++iter)
+                    getitem(iter->first).second = iter->second;
+            }
+        }
+        return *this;
+    }
+
+    ThisType& set(const ThisType& src) {
+        if (this != &src) {
+            free();
+            data_ = src.data_;
+            copy(src);
+        }
+        return *this;
+    }
+
+    ThisType& setempty() {
+        if (items_ == NULL)
+            items_ = EVO_PEMPTY;
+        else
+            clear();
+        return *this;
+    }
+
+    ThisType& clear() {
+        if (size_ > 0) {
+            const Size cap = data_.capacity;
+            for (Size i = 0; i < cap; ++i)
+                if (Group::full(ctrl_[i]))
+                    items_[i].~Item();
+            size_ = 0;
+        }
+        if (data_.capacity > 0) {
+            memset(ctrl_, Group::EMPTY, (size_t)data_.capacity + Group::SIZE);
+            data_.growth_left = growth_limit(data_.capacity);
+        }
+        return *this;
+    }
+
+    // INFO
+
+    bool null() const
+        { return (items_ == NULL); }
+
+    bool shared() const
+        { return false; }
+
+    Size capacity() const
+        { return data_.capacity; }
+
+    // COMPARE
+
+    using MapBaseType::operator==;
+    using MapBaseType::operator!=;
+
+    // FIND
+
+    /** \copydoc List::cbegin() */
+    Iter cbegin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::cend() */
+    Iter cend() const
+        { return Iter(); }
+
+    /** \copydoc List::begin() */
+    IterM begin()
+        { return IterM(*this); }
+
+    /** \copydoc List::begin() const */
+    Iter begin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::end() */
+    IterM end()
+        { return IterM(); }
+
+    /** \copydoc List::end() const */
+    Iter end() const
+        { return Iter(); }
+
+    bool contains(const Key& key) const
+        { return (find(key) != NULL); }
+
+    const Value* find(const Key& key) const {
+        if (size_ > 0) {
+            const Size index = find_index(key, data_.hash(key));
+            if (index != END)
+                return &items_[index].second;
+        }
+        return NULL;
+    }
+
+    Value* findM(const Key& key) {
+        if (size_ > 0) {
+            const Size index = find_index(key, data_.hash(key));
+            if (index != END)
+                return &items_[index].second;
+        }
+        return NULL;
+    }
+
+    /** \copydoc Map::iter() */
+    Iter iter(const Key& key) const {
+        IterKey iterkey;
+        const Item* item = getiter(iterkey, key);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** \copydoc Map::iterM() */
+    IterM iterM(const Key& key) {
+        IterKey iterkey;
+        Item* item = (Item*)getiter(iterkey, key);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    Item& getitem(const Key& key, bool* created=NULL) {
+        const ulong hash = data_.hash(key);
+        Size index;
+        if (size_ > 0 && (index=find_index(key, hash)) != END) {
+            if (created != NULL)
+                *created = false;
+            return items_[index];
+        }
+
+        // Add new item, grow or rehash first if needed
+        if (data_.capacity == 0)
+            rehash(MIN_SIZE);
+        index = find_insert(hash);
+        if (data_.growth_left == 0 && ctrl_[index] == Group::EMPTY) {
+            rehash_grow();
+            index = find_insert(hash);
+        }
+        if (ctrl_[index] == Group::EMPTY)
+            --data_.growth_left;
+        set_ctrl(index, Group::ctrl(hash));
+        ++size_;
+
+        Item* item = items_ + index;
+        DataInit<Item>::init_safe(item, 1);
+        item->first = key;
+        if (created != NULL)
+            *created = true;
+        return *item;
+    }
+
+    /** \copydoc Map::get() */
+    Value& get(const Key& key, bool* created=NULL)
+        { return getitem(key, created).second; }
+
+    // INFO_SET
+
+    /** \copydoc Map::operator[]() */
+    Value& operator[](const Key& key)
+        { return getitem(key, NULL).second; }
+
+    ThisType& unshare()
+        { return *this; }
+
+    /** %Set hash map size (capacity).
+     - Use to suggest a new capacity before adding a batch of items
+     - This will set hash size to nearest power of 2 that can fit both current items and given size without growing
+     - \b Caution: This will invalidate iterators on this map
+     .
+     \param  size  New suggested capacity
+     \return       This
+    */
+    ThisType& capacity(Size size) {
+        if (size < size_)
+            size = size_;
+        Size newsize = MIN_SIZE;
+        while (growth_limit(newsize) < size)
+            newsize <<= 1;
+        if (newsize != data_.capacity)
+            rehash(newsize);
+        return *this;
+    }
+
+    /** %Set map capacity to at least given minimum.
+     \param  min  Minimum capacity
+     \return      This
+    */
+    ThisType& capacitymin(Size min) {
+        if (min > growth_limit(data_.capacity))
+            capacity(min);
+        return *this;
+    }
+
+    /** \copydoc Map::reserve() */
+    ThisType& reserve(Size size)
+        { return capacitymin(size_ + size); }
+
+    // RESIZE
+
+    /** %Set hash map size (capacity) directly.
+     - This will force capacity to a given size (rounded up to next power of 2 if not a power of 2)
+     - All existing items are preserved and rehashed as needed
+     - If size is too small to fit current items under the load limit then the next power of 2 that fits is used
+     - \b Caution: This will invalidate iterators on this map
+     .
+     \param  size  New size/capacity, minimum size of 16 is used if lower
+     \return       This
+    */
+    void resize(Size size) {
+        Size newsize = MIN_SIZE;
+        while (newsize < size || growth_limit(newsize) < size_)
+            newsize <<= 1;
+        if (newsize != data_.capacity)
+            rehash(newsize);
+    }
+
+    // ADD
+
+    Item& add(const Key& key, const Value& value, bool update=true) {
+        bool created_val;
+        Item& upditem = getitem(key, &created_val);
+        if (created_val || update)
+            upditem.second = value;
+        return upditem;
+    }
+
+    Item& add(const Item& item, bool update=true)
+        { return add(item.first, item.second, update); }
+
+    ThisType& add(const MapBaseType& map, bool update=true) {
+        if (this != &map) {
+            reserve(map.size());
+            for (typename MapBaseType::Iter iter(map); iter; ++iter)
+                add(iter->first, iter->second, update);
+        }
+        return *this;
+    }
+
+    // REMOVE
+
+    bool remove(const Key& key) {
+        if (size_ > 0) {
+            const Size index = find_index(key, data_.hash(key));
+            if (index != END) {
+                remove_index(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool remove(typename MapBaseType::IterM& iter, IteratorDir dir=iterNONE)
+        { return remove((IterM&)iter, dir); }
+
+    bool remove(IterM& iter, IteratorDir dir=iterNONE) {
+        if (iter && this == &iter.getParent()) {
+            IterKey& iterkey = iter.getKey();
+            assert( iterkey.a < data_.capacity );
+            assert( Group::full(ctrl_[iterkey.a]) );
+            remove_index(iterkey.a);
+
+            // Update iterator -- removing leaves other items in place
+            if (size_ > 0 && dir != iterNONE) {
+                const IterItem* item = (dir == iterRV ? iterPrev(iterkey) : iterNext(iterkey));
+                if (item != NULL)
+                    iter.setData((IterItem*)item);
+                else
+                    iter = iterEND;
+            } else
+                iter = iterEND;
+            return true;
+        }
+        return false;
+    }
+
+    // INTERNAL
+
+    // Testing methods
+    /** \cond impl */
+#if EVO_UNIT_TEST_MODE
+    Size utCollisions() const {
+        Size count = 0;
+        for (Size i = 0; i < data_.capacity; ++i)
+            if (Group::full(ctrl_[i]) && probe_start(data_.hash(items_[i].first)) != i)
+                ++count;
+        return count;
+    }
+#endif
+    /** \endcond */
+
+    // Iterator support methods
+    /** \cond impl */
+    void iterInitMutable()
+        { }
+    const IterItem* iterFirst(IterKey& key) const {
+        key.b = 0;
+        if (size_ > 0) {
+            for (key.a = 0; key.a < data_.capacity; ++key.a)
+                if (Group::full(ctrl_[key.a]))
+                    return (IterItem*)(items_ + key.a);
+        }
+        key.a = END;
+        return NULL;
+    }
+    const IterItem* iterNext(IterKey& key) const {
+        if (key.a != END) {
+            while (++key.a < data_.capacity)
+                if (Group::full(ctrl_[key.a]))
+                    return (IterItem*)(items_ + key.a);
+            key.a = END;
+        }
+        return NULL;
+    }
+    const IterItem* iterLast(IterKey& key) const {
+        key.b = 0;
+        if (size_ > 0) {
+            for (key.a = data_.capacity; key.a > 0; )
+                if (Group::full(ctrl_[--key.a]))
+                    return (IterItem*)(items_ + key.a);
+        }
+        key.a = END;
+        return NULL;
+    }
+    const IterItem* iterPrev(IterKey& key) const {
+        if (key.a != END) {
+            while (key.a > 0)
+                if (Group::full(ctrl_[--key.a]))
+                    return (IterItem*)(items_ + key.a);
+            key.a = END;
+        }
+        return NULL;
+    }
+    /** \endcond */
+
+protected:
+    const Item* getiter(IterKey& iterkey, const Key& key) const {
+        iterkey.b = 0;
+        if (size_ > 0) {
+            iterkey.a = find_index(key, data_.hash(key));
+            if (iterkey.a != END)
+                return items_ + iterkey.a;
+        }
+        iterkey.a = END;
+        return NULL;
+    }
+
+private:
+    typedef impl::HashFlatGroup Group;
+
+    static const Size MIN_SIZE = 16;        // minimum hash size -- must be power of 2 and at least Group::SIZE
+
+    typedef Item T;     // used by EVO_PEMPTY
+
+    Item* items_;       // item slots, NULL if null, EVO_PEMPTY if empty and not allocated
+    char* ctrl_;        // control bytes, one per item slot followed by copy of first Group::SIZE bytes so a group can always be read contiguously
+
+    // Use inheritance to reduce size bloat with empty Hash
+    struct Data : public THash {
+        Size capacity;      // number of item slots, power of 2 or 0 if not allocated
+        Size growth_left;   // number of empty slots that may be used before a rehash is required
+
+        Data() : capacity(0), growth_left(0) {
+        }
+        Data(const Data& data) : THash(data), capacity(0), growth_left(0) {
+        }
+        Data& operator=(const Data& data) {
+            THash::operator=(data);
+            return *this;
+        }
+
+    #if defined(EVO_CPP11)
+        Data(Data&& data) : THash(std::move((THash&&)data)), capacity(data.capacity), growth_left(data.growth_left) {
+            data.capacity = 0;
+            data.growth_left = 0;
+        }
+        Data& operator=(Data&& data) {
+            THash::operator=(std::move((THash&&)data));
+            capacity = data.capacity;
+            growth_left = data.growth_left;
+            data.capacity = 0;
+            data.growth_left = 0;
+            return *this;
+        }
+    #endif
+    };
+
+    Data data_;
+
+    // Max items before growing -- keeps load factor at or below 7/8
+    static Size growth_limit(Size capacity)
+        { return capacity - (capacity >> 3); }
+
+    Size probe_start(ulong hash) const
+        { return (Size)(hash >> 7) & (data_.capacity - 1); }
+
+    void set_ctrl(Size index, char value) {
+        ctrl_[index] = value;
+        if (index < Group::SIZE)
+            ctrl_[data_.capacity + index] = value;
+    }
+
+    // Find key and return index, END if not found -- compares all control bytes in group at once, then only compares keys with matching hash bits
+    Size find_index(const Key& key, ulong hash) const {
+        const Size mask = data_.capacity - 1;
+        const char h2   = Group::ctrl(hash);
+        Size pos = probe_start(hash);
+        for (Size step = 0; step <= mask; ) {
+            const Group group(ctrl_ + pos);
+            for (uint match = group.match(h2); match != 0; ) {
+                const Size index = (pos + Group::next(match)) & mask;
+                if (data_(key, items_[index].first) == 0)
+                    return index;
+            }
+            if (group.match_empty() != 0)
+                break;
+            step += Group::SIZE;
+            pos = (pos + step) & mask;
+        }
+        return END;
+    }
+
+    // Find first empty or deleted slot for hash, must have at least 1 available
+    Size find_insert(ulong hash) const {
+        const Size mask = data_.capacity - 1;
+        Size pos = probe_start(hash);
+        for (Size step = 0; ; ) {
+            uint match = Group(ctrl_ + pos).match_avail();
+            if (match != 0)
+                return (pos + Group::next(match)) & mask;
+            step += Group::SIZE;
+            pos = (pos + step) & mask;
+            assert( step <= mask );
+        }
+    }
+
+    void remove_index(Size index) {
+        items_[index].~Item();
+        set_ctrl(index, Group::DELETED);
+        --size_;
+        if (size_ == 0) {
+            // Reclaim deleted slots when empty
+            memset(ctrl_, Group::EMPTY, (size_t)data_.capacity + Group::SIZE);
+            data_.growth_left = growth_limit(data_.capacity);
+        }
+    }
+
+    // Grow when no more room, or rehash in place when there are enough deleted slots to reclaim
+    void rehash_grow() {
+        if (data_.capacity == 0)
+            rehash(MIN_SIZE);
+        else if (size_ <= growth_limit(data_.capacity) / 2)
+            rehash(data_.capacity);
+        else
+            rehash(data_.capacity << 1);
+    }
+
+    // Allocate new table with given capacity and move items to it -- items are relocated by copying bytes, like other Evo containers
+    void rehash(Size newcap) {
+        assert( newcap >= MIN_SIZE );
+        assert( growth_limit(newcap) >= size_ );
+        Item* const old_items = items_;
+        char* const old_ctrl  = ctrl_;
+        const Size  old_cap   = data_.capacity;
+
+        alloc(newcap);
+        if (size_ > 0) {
+            for (Size i = 0; i < old_cap; ++i) {
+                if (Group::full(old_ctrl[i])) {
+                    const ulong hash = data_.hash(old_items[i].first);
+                    const Size index = find_insert(hash);
+                    set_ctrl(index, Group::ctrl(hash));
+                    memcpy((void*)(items_ + index), (const void*)(old_items + i), sizeof(Item));
+                }
+            }
+            data_.growth_left -= size_;
+        }
+        if (old_cap > 0)
+            ::free(old_items);
+    }
+
+    // Allocate table with all slots empty, doesn't free old table
+    void alloc(Size cap) {
+        const size_t items_bytes = (size_t)cap * sizeof(Item);
+        items_ = (Item*)::malloc(items_bytes + (size_t)cap + Group::SIZE);
+        ctrl_  = (char*)items_ + items_bytes;
+        memset(ctrl_, Group::EMPTY, (size_t)cap + Group::SIZE);
+        data_.capacity    = cap;
+        data_.growth_left = growth_limit(cap);
+    }
+
+    void copy(const ThisType& src) {
+        if (src.items_ == NULL) {
+            items_ = NULL;
+        } else if (src.size_ == 0) {
+            items_ = EVO_PEMPTY;
+        } else {
+            alloc(src.data_.capacity);
+            memcpy(ctrl_, src.ctrl_, (size_t)data_.capacity + Group::SIZE);
+            for (Size i = 0; i < data_.capacity; ++i)
+                if (Group::full(ctrl_[i]))
+                    DataInit<Item>::init(items_ + i, src.items_ + i, 1);
+            size_ = src.size_;
+            data_.growth_left = src.data_.growth_left;
+        }
+    }
+
+    void free() {
+        if (data_.capacity > 0) {
+            clear();
+            ::free(items_);
+            data_.capacity    = 0;
+            data_.growth_left = 0;
+        }
+        items_ = NULL;
+        ctrl_  = NULL;
+        size_  = 0;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(INCL_evo_string_h) || defined(DOXYGEN)
+/** MapHashFlat using String keys and values.
+ - This is an alias to MapHashFlat
+ - This is only defined if string.h is included before maphashflat.h
+*/
+typedef MapHashFlat<String,String> StrHashFlat;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#if defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+#endif
@@ -11,6 +11,7 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 #include "map.h"
 #include "list.h"
 #include "strtok.h"
+#include "impl/eytzinger.h"
 
 namespace evo {
 /** \addtogroup EvoContainers */
@@ -331,12 +332,14 @@ public:
     */
     ThisType& operator=(const ThisType& src) {
         data_.items = src.data_.items;
+        data_.index.clear();
         MapBaseType::size_ = src.size_;
         return *this;
     }
 
     ThisType& set() {
         data_.items.set();
+        data_.index.clear();
         MapBaseType::size_ = 0;
         return *this;
     }
@@ -357,18 +360,21 @@ public:
     ThisType& set(const ThisType& src) {
         ((Compare&)data_) = (const Compare&)src.data_;
         data_.items.set(src.data_.items);
+        data_.index.clear();
         MapBaseType::size_ = src.size_;
         return *this;
     }
 
     ThisType& setempty() {
         data_.items.setempty();
+        data_.index.clear();
         MapBaseType::size_ = 0;
         return *this;
     }
 
     ThisType& clear() {
         data_.items.clear();
+        data_.index.clear();
         MapBaseType::size_ = 0;
         return *this;
     }
@@ -453,6 +459,29 @@ public:
     Size findindex(const Key& key) const
         { Size pos; return (search(pos, key) == NULL ? END : pos); }
 
+    /** Find (lookup) indexes for multiple keys (const).
+     - This is faster than calling findindex() for each key when the map is frozen -- see freeze()
+     - When frozen, up to 16 searches are interleaved at a time so their memory accesses overlap, otherwise each key is searched in turn
+     - Use item() to get an item by index
+     .
+     \param  keys     Keys to find
+     \param  count    Number of keys to find
+     \param  indexes  Stores found index for each key, END if not found -- must have room for `count` indexes  [out]
+     \return          Number of keys found
+    */
+    Size find_many(const Key* keys, Size count, Size* indexes) const {
+        if (data_.index.active())
+            return data_.index.find_many(keys, count, indexes, (const Compare&)data_);
+        Size found = 0;
+        for (Size i = 0; i < count; ++i) {
+            if (search(indexes[i], keys[i]) != NULL)
+                ++found;
+            else
+                indexes[i] = END;
+        }
+        return found;
+    }
+
     /** \copydoc Map::iter() */
     Iter iter(const Key& key) const {
         IterKey iterkey;
@@ -471,6 +500,7 @@ public:
         Item* item;
         Size pos;
         if ( (item=(Item*)search(pos, key)) == NULL) {
+            data_.index.clear();
             item = &data_.items.itemM(data_.items.insertnew(pos));
             item->first = key;
             if (created != NULL)
@@ -497,6 +527,7 @@ public:
     /** Get item at position (mutable).
      - Results are undefined if index is out of bounds
      - Calls unshare()
+     - \b Caution: The item key must not be changed, otherwise results are undefined
      .
      \param  index  Item index
      \return        Item (mutable)
@@ -513,6 +544,26 @@ public:
     ThisType& unshare()
         { data_.items.unshare(); return *this; }
 
+#if EVO_ALLOCATORS || defined(DOXYGEN)
+    /** %Set allocator to use for new item buffers (modifier).
+     - Requires EVO_ALLOCATORS to be enabled
+     - See List::set_allocator()
+     .
+     \param  allocator  %Allocator to use, NULL for default
+     \return            This
+    */
+    ThisType& set_allocator(Allocator* allocator)
+        { data_.items.set_allocator(allocator); return *this; }
+
+    /** Get allocator used for new item buffers.
+     - Requires EVO_ALLOCATORS to be enabled
+     .
+     \return  %Allocator pointer, NULL for default
+    */
+    Allocator* get_allocator() const
+        { return data_.items.get_allocator(); }
+#endif
+
     ThisType& capacity(Size size)
         { data_.items.capacity(size); return *this; }
 
@@ -522,6 +573,35 @@ public:
     ThisType& compact()
         { data_.items.compact(); return *this; }
 
+    /** Freeze map for read-optimized lookups (modifier).
+     - This builds a search index with a copy of all keys in Eytzinger (BFS) order, where the top levels of the search tree share cache lines
+     - Frozen lookups are branchless and prefetch a few levels ahead -- useful with large maps that are built once then searched often
+     - Items are still stored in a sorted list so iterators and item() are unaffected, the index uses extra memory for a copy of each key and an index
+     - Any change to the map keys unfreezes it, as does advList() (mutable) -- call freeze() again after making changes
+     - Values may still be changed while frozen
+     - Copies of a frozen map are not frozen
+     .
+     \return  This
+    */
+    ThisType& freeze()
+        { data_.index.build(data_.items.data(), data_.items.size()); return *this; }
+
+    /** Unfreeze map and free search index (modifier).
+     - This isn't needed before making changes, since changes to keys unfreeze automatically
+     .
+     \return  This
+    */
+    ThisType& unfreeze()
+        { data_.index.clear(); return *this; }
+
+    /** Get whether map is frozen with a read-optimized search index.
+     - See freeze()
+     .
+     \return  Whether frozen
+    */
+    bool frozen() const
+        { return data_.index.active(); }
+
     /** \copydoc Map::reserve() */
     ThisType& reserve(Size size)
         { capacitymin(this->size_ + size); return *this; }
@@ -554,6 +634,7 @@ public:
         bool result = false;
         Size index;
         if (search(index, key) != NULL) {
+            data_.index.clear();
             data_.items.remove(index);
             --MapBaseType::size_;
             result = true;
@@ -567,6 +648,7 @@ public:
     bool remove(IterM& iter, IteratorDir dir=iterNONE) {
         if (iter && this == &iter.getParent()) {
             IterKey& iterkey = iter.getKey();
+            data_.index.clear();
             data_.items.remove(iterkey.a);
             bool nextitem = false;
             if (--MapBaseType::size_ > 0 && dir != iterNONE) {
@@ -593,6 +675,7 @@ public:
     */
     void removeat(Size index) {
         assert( index < data_.items.size() );
+        data_.index.clear();
         data_.items.remove(index);
         --MapBaseType::size_;
     }
@@ -609,11 +692,12 @@ public:
 
     /** Advanced: Get internal list.
      - \b Caution: The list must remain sorted, otherwise results are undefined
+     - This unfreezes the map, see freeze()
      .
      \return  Internal list
     */
     List<Item>& advList()
-        { return data_.items; }
+        { data_.index.clear(); return data_.items; }
 
     // INTERNAL
 
@@ -641,6 +725,7 @@ private:
     // Use inheritance to reduce size bloat with empty Compare
     struct Data : public Compare {
         Items items;
+        impl::EytzingerIndex<Key,Size> index;   // search index while frozen
 
         Data() {
         }
@@ -649,10 +734,13 @@ private:
 
     #if defined(EVO_CPP11)
         Data(Data&& data) : Compare(std::move((Compare&&)data)), items(std::move(data.items)) {
+            index.swap(data.index);
         }
         Data& operator=(Data&& data) {
             *((Compare*)this) = std::move((Compare&&)data);
             items = std::move(data.items);
+            index.clear();
+            index.swap(data.index);
             return *this;
         }
     #endif
@@ -661,6 +749,8 @@ private:
     Data data_;
 
     const Item* search(Size& index, const Key& key) const {
+        if (data_.index.active())
+            return (data_.index.find(index, key, (const Compare&)data_) ? &data_.items.item(index) : NULL);
         int cmp;
         Size left = 0, right = data_.items.size(), mid = 0;
         while (left < right) {
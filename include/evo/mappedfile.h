@@ -0,0 +1,419 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file mappedfile.h Evo MappedFile class for memory-mapped file input. */
+#pragma once
+#ifndef INCL_evo_mappedfile_h
+#define INCL_evo_mappedfile_h
+
+#include "substring.h"
+#include "impl/sysio.h"
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+// Namespace: evo
+namespace evo {
+
+/** \addtogroup EvoIO */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Read-only memory-mapped file.
+ - Use this to read a large file as one block of memory, without copying it into buffers
+ - Contents are accessed directly with data() and size(), or as a SubString with str()
+ - Use lines() to iterate file lines as SubString values pointing into the mapping, with no copies
+   - Use lines(uint,uint) to split lines into chunks (on line boundaries) for processing with multiple threads
+ - \b Caution: Data, strings, and line values reference the mapping and are invalid after close(), or after the file is truncated by another process
+ - The file is mapped with a sequential access hint by default (madvise() on Linux/Unix), so the OS reads ahead and drops pages already read
+ - Files that don't support mapping (pipes, sockets, character devices) fail to open with error ENotImpl -- use File for these
+ - Copying is disabled
+ .
+
+\par Example
+
+\code
+#include <evo/mappedfile.h>
+#include <evo/io.h>
+using namespace evo;
+
+int main() {
+    try {
+        MappedFile file("file.txt");
+        MappedFile::Lines lines(file.lines());
+        while (lines.next())
+            con().out << "> " << lines.value() << NL;
+    } EVO_CATCH(return 1);
+
+    return 0;
+}
+\endcode
+
+\par Example with threads
+
+Each thread processes a chunk of the same mapping, chunks are split on line boundaries so each line is in exactly 1 chunk:
+\code
+// In thread `index` of `count` threads, where file is a MappedFile shared by all threads
+MappedFile::Lines lines(file.lines(index, count));
+while (lines.next())
+    process(lines.value());
+\endcode
+*/
+class MappedFile : public SafeBool<MappedFile> {
+public:
+    /** Line tokenizer for a block of memory, used with MappedFile.
+     - This has the same interface as StrTokLine for getting lines: next(), value(), reset()
+     - This is used instead of StrTokLine since the block may be larger than a String can reference, each line must fit in a SubString
+     - This recognizes all the main newline types, see \ref Newline
+     - Unlike StrTokLine, a newline at the end doesn't produce an extra empty line -- same as File::readline()
+     - Line values reference the block -- results are undefined if it's modified or unmapped while referenced
+     .
+    */
+    class Lines {
+    public:
+        typedef Lines ThisType;     ///< This type
+
+        /** Default constructor creates empty tokenizer. */
+        Lines() : start_(NULL), end_(NULL), cur_(NULL)
+            { }
+
+        /** Copy constructor.
+         \param  src  Source to copy
+        */
+        Lines(const ThisType& src) : start_(src.start_), end_(src.end_), cur_(src.cur_), value_(src.value_)
+            { }
+
+        /** Constructor to start tokenizing block of memory.
+         \param  data  Data pointer, NULL for none
+         \param  size  Data size in bytes
+        */
+        Lines(const char* data, ulongl size) : start_(data), end_(data + size), cur_(data)
+            { }
+
+        /** Assignment operator.
+         \param  src  Source to copy
+         \return      This
+        */
+        ThisType& operator=(const ThisType& src) {
+            start_ = src.start_;
+            end_   = src.end_;
+            cur_   = src.cur_;
+            value_ = src.value_;
+            return *this;
+        }
+
+        /** Reset to start tokenizing from the beginning again.
+         \return  This
+        */
+        ThisType& reset() {
+            cur_ = start_;
+            value_.set();
+            return *this;
+        }
+
+        /** Get data pointer for block being tokenized.
+         \return  Data pointer, NULL if none
+        */
+        const char* data() const
+            { return start_; }
+
+        /** Get size of block being tokenized.
+         \return  Size in bytes
+        */
+        ulongl size() const
+            { return (ulongl)(end_ - start_); }
+
+        /** Get current offset in block where next line starts.
+         \return  Offset in bytes, size() if no more lines
+        */
+        ulongl pos() const
+            { return (ulongl)(cur_ - start_); }
+
+        /** Get current line value from last call to next().
+         \return  Current line, null if none
+        */
+        const SubString& value() const
+            { return value_; }
+
+        /** Find next line.
+         - Call value() to get line value
+         .
+         \return  Whether next line was found, false if no more
+        */
+        bool next() {
+            if (cur_ >= end_) {
+                value_.set();
+                return false;
+            }
+            const char* p = str_scan_delim(cur_, end_, '\r', '\n');
+            assert( (ulongl)(p - cur_) <= (ulongl)IntegerT<SubString::Size>::MAX );
+            value_.set(cur_, (SubString::Size)(p - cur_));
+            if (p < end_) {
+                ++p;
+                if (p < end_ && ((p[-1] == '\r' && *p == '\n') || (p[-1] == '\n' && *p == '\r')))
+                    ++p;
+            }
+            cur_ = p;
+            return true;
+        }
+
+    private:
+        const char* start_;
+        const char* end_;
+        const char* cur_;
+        SubString   value_;
+    };
+
+    /** Constructor.
+     - This initializes without opening a file, use open() to open a file
+     .
+     \param  excep  Whether to enable exceptions on error, default set by Evo config: EVO_EXCEPTIONS
+    */
+    MappedFile(bool excep=EVO_EXCEPTIONS) : data_(NULL), size_(0), error_(ENone), excep_(excep) {
+    }
+
+    /** Constructor to open and map file.
+     - This calls open()
+     .
+     \param  path        File path to open
+     \param  sequential  Whether to hint the OS that the file will be read sequentially, false for no hint
+     \param  excep       Whether to enable exceptions on error, default set by Evo config: EVO_EXCEPTIONS
+    */
+    MappedFile(const char* path, bool sequential=true, bool excep=EVO_EXCEPTIONS) : data_(NULL), size_(0), error_(ENone), excep_(excep) {
+        open(path, sequential);
+    }
+
+    /** Destructor, unmaps file. */
+    ~MappedFile() {
+        close();
+    }
+
+    /** Negation operator checks whether an error was set by a previous operation.
+     - Call error() to get last error code
+     - Alternatively, use SafeBool evaluation to check whether previous operations were successful
+     .
+     \return  Whether last operation set an error
+    */
+    bool operator!() const {
+        return (error_ != ENone);
+    }
+
+    /** Get whether exceptions are enabled.
+     \return  Whether exceptions enabled
+    */
+    bool excep() const {
+        return excep_;
+    }
+
+    /** %Set whether exceptions are enabled.
+     \param  val  Whether to enable exceptions
+    */
+    void excep(bool val) {
+        excep_ = val;
+    }
+
+    /** Get error code from last operation.
+     \return  Error code, ENone for success (no error)
+    */
+    Error error() const {
+        return error_;
+    }
+
+    /** Get whether file is open (mapped).
+     \return  Whether open
+    */
+    bool isopen() const {
+        return (data_ != NULL);
+    }
+
+    /** Open and map file for reading.
+     - Current file is closed first
+     - The file handle is closed after mapping, the mapping stays valid until close()
+     - Throws ExceptionFileOpen on error, if exceptions enabled
+     .
+     \param  path        File path to open
+     \param  sequential  Whether to hint the OS that the file will be read sequentially, false for no hint
+     \return             Whether successful, false on error -- call error() for error code
+    */
+    bool open(const char* path, bool sequential=true) {
+        close();
+        IoFile file;
+        if ((error_ = file.open(path, oREAD)) == ENone)
+            error_ = map(file.handle, sequential);
+        EVO_THROW_ERR_CHECK(evo::ExceptionFileOpen, "MappedFile::open() failed", error_, (excep_ && error_ != ENone));
+        return (error_ == ENone);
+    }
+
+    /** Close (unmap) file, if open.
+     - This invalidates all data, strings, and line values referencing the mapping
+    */
+    void close() {
+        if (size_ > 0) {
+        #if defined(_WIN32)
+            ::UnmapViewOfFile((void*)data_);
+        #else
+            ::munmap((void*)data_, (size_t)size_);
+        #endif
+        }
+        data_  = NULL;
+        size_  = 0;
+        error_ = ENone;
+    }
+
+    /** Get pointer to mapped file data.
+     \return  Data pointer, NULL if not open -- not terminated
+    */
+    const char* data() const {
+        return data_;
+    }
+
+    /** Get mapped file size.
+     \return  Size in bytes, 0 if not open or empty
+    */
+    ulongl size() const {
+        return size_;
+    }
+
+    /** Get mapped file data as a SubString.
+     - Use data() and size() or lines() with files larger than a SubString can reference
+     .
+     \return  %String referencing all file data, null if not open or file is too large for a SubString
+    */
+    SubString str() const {
+        if (data_ == NULL || size_ > (ulongl)IntegerT<SubString::Size>::MAX)
+            return SubString();
+        return SubString(data_, (SubString::Size)size_);
+    }
+
+    /** Get line tokenizer for whole file.
+     - Call Lines::next() to get each line
+     .
+     \return  Line tokenizer referencing mapped data
+    */
+    Lines lines() const {
+        return Lines(data_, size_);
+    }
+
+    /** Get line tokenizer for a chunk of file, split on line boundaries.
+     - This splits the file into `count` chunks of about the same size, each ending after a newline (or at end of file), and returns chunk at `index`
+     - Together the chunks contain each line exactly once, so they can be processed by separate threads
+     - A chunk is empty if no line starts in its part of the file, as with a very long line or very small file
+     - Chunks are split after a LF newline, so files with only CR newlines give all lines in the first chunk
+     .
+     \param  index  Chunk index, must be less than `count`
+     \param  count  Number of chunks, must be positive
+     \return        Line tokenizer referencing mapped data for chunk
+    */
+    Lines lines(uint index, uint count) const {
+        assert( count > 0 );
+        assert( index < count );
+        const ulongl start = line_start(chunk_offset(index, count));
+        const ulongl end   = (index + 1 >= count ? size_ : line_start(chunk_offset(index + 1, count)));
+        return Lines(data_ + start, end - start);
+    }
+
+private:
+    // Disable copying
+    MappedFile(const MappedFile&) EVO_ONCPP11(= delete);
+    MappedFile& operator=(const MappedFile&) EVO_ONCPP11(= delete);
+
+    const char* data_;      ///< Mapped data, NULL if not open
+    ulongl      size_;      ///< Mapped data size, 0 if empty
+    Error       error_;     ///< Last error code
+    bool        excep_;     ///< Whether to throw exceptions
+
+    Error map(IoFile::Handle handle, bool sequential) {
+    #if defined(_WIN32)
+        HANDLE filehandle = (HANDLE)::_get_osfhandle(handle);
+        LARGE_INTEGER filesize;
+        if (filehandle == INVALID_HANDLE_VALUE || ::GetFileType(filehandle) != FILE_TYPE_DISK)
+            return ENotImpl;
+        if (!::GetFileSizeEx(filehandle, &filesize))
+            return EFail;
+        if ((ulongl)filesize.QuadPart > (ulongl)std::numeric_limits<size_t>::max())
+            return ESize;
+        if (filesize.QuadPart == 0) {
+            data_ = "";
+            return ENone;
+        }
+        HANDLE maphandle = ::CreateFileMapping(filehandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (maphandle == NULL)
+            return EFail;
+        const void* ptr = ::MapViewOfFile(maphandle, FILE_MAP_READ, 0, 0, 0);
+        ::CloseHandle(maphandle);
+        if (ptr == NULL)
+            return (::GetLastError() == ERROR_NOT_ENOUGH_MEMORY ? ESpace : EFail);
+        (void)sequential;   // Windows: No hint for existing mappings
+        data_ = (const char*)ptr;
+        size_ = (ulongl)filesize.QuadPart;
+    #else
+        struct stat st;
+        if (::fstat(handle, &st) != 0)
+            return EFail;
+        if (!S_ISREG(st.st_mode))
+            return ENotImpl;
+        if ((ulongl)st.st_size > (ulongl)std::numeric_limits<size_t>::max())
+            return ESize;
+        if (st.st_size == 0) {
+            data_ = "";
+            return ENone;
+        }
+        void* ptr = ::mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+        if (ptr == MAP_FAILED) {
+            switch (errno) {
+                case EACCES: return EAccess;
+                case ENODEV: return ENotImpl;
+                case ENOMEM: // fallthrough
+                case EAGAIN: return ESpace;
+                default:     return EFail;
+            }
+        }
+    #if defined(MADV_SEQUENTIAL)
+        if (sequential)
+            ::madvise(ptr, (size_t)st.st_size, MADV_SEQUENTIAL);
+    #else
+        (void)sequential;
+    #endif
+        data_ = (const char*)ptr;
+        size_ = (ulongl)st.st_size;
+    #endif
+        return ENone;
+    }
+
+    // Get approximate offset for start of chunk, without overflow on large files
+    ulongl chunk_offset(uint index, uint count) const {
+        return (size_ / count) * index + (size_ % count) * index / count;
+    }
+
+    // Get offset of first line starting at or after offset, size_ if none
+    ulongl line_start(ulongl offset) const {
+        if (offset == 0 || offset >= size_)
+            return (offset == 0 ? 0 : size_);
+        const char* end = data_ + size_;
+        const char* lf = (const char*)::memchr(data_ + offset - 1, '\n', (size_t)(size_ - offset + 1));
+        if (lf == NULL)
+            return size_;
+
+        // Newline pairs (CRLF or LFCR) are matched left to right by Lines::next(), so pair from the start of this run of newline chars to find the newline ending with or after lf
+        const char* p = lf;
+        while (p > data_ && (p[-1] == '\r' || p[-1] == '\n'))
+            --p;
+        for (;;) {
+            const char* next = p + 1;
+            if (next < end && ((*p == '\r' && *next == '\n') || (*p == '\n' && *next == '\r')))
+                ++next;
+            if (next > lf)
+                return (ulongl)(next - data_);
+            p = next;
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
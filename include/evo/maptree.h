@@ -0,0 +1,711 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file maptree.h Evo MapTree container. */
+#pragma once
+#ifndef INCL_evo_maptree_h
+#define INCL_evo_maptree_h
+
+#include "map.h"
+#include "impl/btree.h"
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Map implemented as an ordered B+tree.
+
+\tparam  TKey      %Map key type
+\tparam  TValue    %Map value type
+\tparam  TCompare  Comparison type to use
+\tparam  TSize     %Size type to use for size values (must be unsigned integer) -- default: SizeT
+
+\par Features
+
+ - Similar to STL `map`, and a drop-in replacement for MapList -- both implement the Map interface
+ - Values are always unique (no duplicate keys)
+ - Items are stored as a Pair in leaf nodes, each a sorted array sized to fill a few cache lines, and leaves are linked in order
+   - Branch nodes hold only keys and child pointers, also sized to a few cache lines, so each search step touches few cache lines
+   - Lookups, inserts, and removes are `O(log n)` -- unlike MapList, inserts only shift items within one leaf
+   - Iterating walks the linked leaves, so is nearly as fast as iterating an array
+   - Inserting after the last item (as with time-ordered keys) fills leaves completely instead of splitting them in half
+ - Bulk load from sorted items with set_sorted(), which fills leaves and builds branches bottom-up without searching
+ - No memory allocated by new empty map
+ - No sharing -- copying a map makes a full copy, use MapList if \ref Sharing "Sharing" is needed
+ .
+
+C++11:
+ - Range-based for loop -- see \ref StlCompatibility
+   \code
+    MapTree<int,int> map;
+    for (auto& item : map.asconst()) {
+        item.key();
+        item.value();
+    }
+   \endcode
+ - Initialization lists
+   \code
+    MapTree<int,int> map = {{3, 300}, {1, 100}, {2, 200}};
+    MapTree<String,String> strmap = {{"key1", "foo"}, {"key2", "bar"}};
+   \endcode
+ - Move semantics
+
+\par Comparison
+
+You can leave the default comparison type (Compare) or specify an alternative.
+
+ - Compare, CompareR
+ - CompareI, CompareIR
+ .
+
+See: \ref PrimitivesContainers "Primitives & Containers"
+
+\par Iterators
+
+ - MapTree::Iter -- Read-Only Iterator (IteratorBi)
+ - MapTree::IterM -- Mutable Iterator (IteratorBi)
+ .
+
+\b Caution: Adding or removing items may move items within and between leaves, which invalidates existing iterators using this map.
+
+\par Constructors
+
+ - MapTree()
+ - MapTree(const MapBaseType&)
+ - MapTree(const ThisType&)
+ - MapTree(const std::initializer_list<InitPair>&) [C++11]
+ - MapTree(ThisType&&) [C++11]
+
+\par Read Access
+
+ - asconst()
+ - size()
+   - null(), empty()
+   - capacity()
+   - shared()
+   - ordered()
+   - get_compare() const
+ - contains(const Key&) const
+ - cbegin(), cend()
+   - begin() const, end() const
+ - find()
+   - iter()
+   - iter_lower(), iter_upper()
+ - operator==()
+   - operator!=()
+ .
+
+\par Modifiers
+
+ - reserve()
+   - capacity(Size)
+   - capacitymin()
+   - unshare()
+   - get_compare()
+ - begin(), end()
+ - iterM()
+   - iter_lowerM(), iter_upperM()
+ - findM()
+   - getitem()
+   - get()
+   - operator[]()
+ - set()
+   - set(const MapBaseType&)
+   - set(const ThisType&)
+   - set_sorted()
+   - setempty()
+   - clear()
+   - operator=(const MapBaseType&)
+   - operator=(const ThisType&)
+   - operator=(ThisType&&) [C++11]
+ - add(const Key&,const Value&,bool)
+   - add(const Item&,bool)
+   - add(const MapBaseType&,bool)
+ - remove(const Key&)
+   - remove(const Key&,Size)
+   - remove(typename MapBaseType::IterM&,IteratorDir)
+   - remove_range(IterM&,Size)
+   - remove_range(IterM&,IterM&)
+ .
+
+\par Helpers
+
+ - map_contains()
+ - lookupsub()
+ .
+
+\par Example
+
+\code
+#include <evo/maptree.h>
+#include <evo/io.h>
+using namespace evo;
+static Console& c = con();
+
+int main() {
+    typedef MapTree<ulong,int> MyMap;
+
+    // Create map with timestamp keys and numeric values
+    MyMap map;
+    map.add(1000, 1);
+    map.add(1500, 2);
+    map.add(2000, 3);
+    map[3000] = 4;
+
+    // Iterate and print items in range 1500 to 2999
+    MyMap::Iter end(map.iter_lower(3000));
+    for (MyMap::Iter iter(map.iter_lower(1500)); iter != end; ++iter)
+        c.out << iter->key() << "=" << iter->value() << NL;
+
+    // Remove items before 2000
+    MyMap::IterM start(map);
+    MyMap::IterM stop(map.iter_lowerM(2000));
+    map.remove_range(start, stop);
+
+    return 0;
+}
+\endcode
+
+Output:
+\code{.unparsed}
+1500=2
+2000=3
+\endcode
+*/
+template<class TKey, class TValue, class TCompare=Compare<TKey>, class TSize=SizeT>
+class MapTree : public Map<TKey,TValue,TSize> {
+protected:
+    using Map<TKey,TValue,TSize>::size_;
+
+public:
+    EVO_CONTAINER_TYPE;
+#if defined(_MSC_VER) || defined(EVO_OLDCC) // avoid errors with older compilers and MSVC
+    typedef Map<TKey,TValue,TSize> MapBaseType;                 ///< %Map base type
+    typedef typename MapBaseType::Size Size;
+    typedef typename MapBaseType::Key Key;
+    typedef typename MapBaseType::Value Value;
+    typedef typename MapBaseType::Item Item;
+    typedef typename MapBaseType::IterKey IterKey;
+    typedef typename MapBaseType::IterItem IterItem;
+#else
+    using typename Map<TKey,TValue,TSize>::MapBaseType;
+    using typename Map<TKey,TValue,TSize>::Size;
+    using typename Map<TKey,TValue,TSize>::Key;
+    using typename Map<TKey,TValue,TSize>::Value;
+    using typename Map<TKey,TValue,TSize>::Item;
+    using typename Map<TKey,TValue,TSize>::IterKey;
+    using typename Map<TKey,TValue,TSize>::IterItem;
+#endif
+    typedef MapTree<TKey,TValue,TCompare,TSize> ThisType;      ///< This type
+    typedef TCompare Compare;                                   ///< %Compare type to use
+
+    typedef typename IteratorBi<ThisType>::Const Iter;          ///< Iterator (const) - IteratorBi
+    typedef IteratorBi<ThisType>                 IterM;         ///< Iterator (mutable) - IteratorBi
+
+    /** Constructor. */
+    MapTree() : Map<TKey,TValue,TSize>(true), null_(true)
+        { }
+
+    /** Copy constructor.
+     - Uses default comparison object
+     - Results are undefined if TCompare is a function pointer since this will not initialize it
+     .
+     \param  src  Source to copy
+    */
+    MapTree(const MapBaseType& src) : Map<TKey,TValue,TSize>(true), null_(true)
+        { set(src); }
+
+    /** Copy constructor.
+     - This copies the comparison object as well
+     .
+     \param  src  Source to copy
+    */
+    MapTree(const ThisType& src) : Map<TKey,TValue,TSize>(true), null_(true), data_(src.data_)
+        { copy(src); }
+
+    /** Destructor. */
+    ~MapTree()
+        { }
+
+#if defined(EVO_CPP11)
+    using typename MapBaseType::InitPair;   ///< Used with initializer_list constructor (C++11)
+
+    /** Sequence constructor (C++11).
+     \param  init  Initializer list, passed as comma-separated values in braces `{ }`
+    */
+    MapTree(const std::initializer_list<InitPair>& init) : MapTree() {
+        assert( init.size() < IntegerT<Size>::MAX );
+        setempty();
+        for (const auto& item : init)
+            add(item.key, item.value);
+    }
+
+    /** Move constructor (C++11).
+     \param  src  Source to move
+    */
+    MapTree(ThisType&& src) : Map<TKey,TValue,TSize>(true), null_(src.null_), data_(std::move(src.data_)) {
+        size_ = src.size_;
+        src.size_ = 0;
+        src.null_ = true;
+    }
+
+    /** Move assignment operator (C++11).
+     \param  src  Source to move
+     \return      This
+    */
+    ThisType& operator=(ThisType&& src) {
+        data_ = std::move(src.data_);
+        null_ = src.null_;
+        size_ = src.size_;
+        src.size_ = 0;
+        src.null_ = true;
+        return *this;
+    }
+#endif
+
+    /** \copydoc List::asconst() */
+    const ThisType& asconst() const {
+        return *this;
+    }
+
+    // SET
+
+    /** \copydoc Map::operator=() */
+    ThisType& operator=(const MapBaseType& src)
+        { set(src); return *this; }
+
+    /** Assignment operator.
+     - This copies the comparison object as well
+     .
+     \param  src  Source to copy
+     \return      This
+    */
+    ThisType& operator=(const ThisType& src)
+        { set(src); return *this; }
+
+    ThisType& set() {
+        data_.reset();
+        size_ = 0;
+        null_ = true;
+        return *this;
+    }
+
+    ThisType& set(const MapBaseType& src) {
+        if (this != &src) {
+            if (src.null()) {
+                set();
+            } else {
+                clear();
+                impl::BTreeIterReader<Item,typename MapBaseType::Iter> reader(src);
+                size_ = data_.load(reader);
+            }
+        }
+        return *this;
+    }
+
+    ThisType& set(const ThisType& src) {
+        if (this != &src) {
+            set();
+            data_ = src.data_;
+            copy(src);
+        }
+        return *this;
+    }
+
+    /** %Set as copy of sorted items.
+     - This is much faster than adding items one at a time when items are already sorted by key with no duplicate keys:
+       - Leaves are filled in order without searching, then branches are built bottom-up
+       - Leaves are filled completely, so is best for data that is mostly read or appended to
+     - Items that aren't sorted are still added correctly, though more slowly: once an item is out of order, it and all remaining items are added one at a time
+     - Items with duplicate keys replace previous items with the same key
+     - \b Caution: This will invalidate iterators on this map
+     .
+     \param  items  Items to copy, should be sorted by key
+     \param  count  Number of items to copy
+     \return        This
+    */
+    ThisType& set_sorted(const Item* items, Size count) {
+        clear();
+        impl::BTreeArrayReader<Item> reader(items, count);
+        size_ = data_.load(reader);
+        return *this;
+    }
+
+    ThisType& setempty() {
+        clear();
+        null_ = false;
+        return *this;
+    }
+
+    ThisType& clear() {
+        data_.reset();
+        size_ = 0;
+        null_ = false;
+        return *this;
+    }
+
+    // INFO
+
+    bool null() const
+        { return null_; }
+
+    bool shared() const
+        { return false; }
+
+    /** \copydoc Map::capacity()
+     - This is the number of item slots in all leaves
+    */
+    Size capacity() const
+        { return data_.leaf_count() * Tree::LEAF_SIZE; }
+
+    // COMPARE
+
+    /** Get comparison object being used for comparisons (const).
+     \return  Comparison object reference
+    */
+    const Compare& get_compare() const
+        { return data_; }
+
+    /** Get comparison object being used for comparisons.
+     \return  Comparison object reference
+    */
+    Compare& get_compare()
+        { return data_; }
+
+    using MapBaseType::operator==;
+    using MapBaseType::operator!=;
+
+    // FIND
+
+    /** \copydoc List::cbegin() */
+    Iter cbegin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::cend() */
+    Iter cend() const
+        { return Iter(); }
+
+    /** \copydoc List::begin() */
+    IterM begin()
+        { return IterM(*this); }
+
+    /** \copydoc List::begin() const */
+    Iter begin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::end() */
+    IterM end()
+        { return IterM(); }
+
+    /** \copydoc List::end() const */
+    Iter end() const
+        { return Iter(); }
+
+    bool contains(const Key& key) const
+        { return (data_.find(key) != NULL); }
+
+    const Value* find(const Key& key) const {
+        const Item* item = data_.find(key);
+        return (item != NULL ? &item->second : NULL);
+    }
+
+    Value* findM(const Key& key) {
+        Item* item = (Item*)data_.find(key);
+        return (item != NULL ? &item->second : NULL);
+    }
+
+    /** \copydoc Map::iter() */
+    Iter iter(const Key& key) const {
+        IterKey iterkey;
+        const Item* item = getiter(iterkey, key);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** \copydoc Map::iterM() */
+    IterM iterM(const Key& key) {
+        IterKey iterkey;
+        Item* item = (Item*)getiter(iterkey, key);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    /** Find first item with key greater or equal to given key (lower bound) (const).
+     - This gives the lower-bound iterator for the given key according to the ordering of keys
+     - Use with iter_upper() or another iter_lower() to get iterators representing a range of items in map
+     .
+     \param  key  Key to look for
+     \return      Iterator, at end if key is greater than the last item key, or if map is empty
+     \see iter_lowerM(), iter_upper()
+    */
+    Iter iter_lower(const Key& key) const {
+        IterKey iterkey;
+        bool found;
+        const Item* item = data_.lower(iterkey.a, iterkey.b, key, found);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** Find first item with key greater or equal to given key (lower bound).
+     - This gives the lower-bound iterator for the given key according to the ordering of keys
+     - Use with iter_upperM() or another iter_lowerM() to get iterators representing a range of items in map
+     .
+     \param  key  Key to look for
+     \return      Iterator, at end if key is greater than the last item key, or if map is empty
+     \see iter_lower(), iter_upperM()
+    */
+    IterM iter_lowerM(const Key& key) {
+        IterKey iterkey;
+        bool found;
+        const Item* item = data_.lower(iterkey.a, iterkey.b, key, found);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    /** Find first item with key greater than given key (upper bound) (const).
+     - This gives the upper-bound iterator for the given key according to the ordering of keys
+     - Use with iter_lower() to get iterators representing a range of items in map
+     .
+     \param  key  Key to look for
+     \return      Iterator, at end if key is greater or equal to the last item key, or if map is empty
+     \see iter_upperM(), iter_lower()
+    */
+    Iter iter_upper(const Key& key) const {
+        IterKey iterkey;
+        const Item* item = data_.upper(iterkey.a, iterkey.b, key);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** Find first item with key greater than given key (upper bound).
+     - This gives the upper-bound iterator for the given key according to the ordering of keys
+     - Use with iter_lowerM() to get iterators representing a range of items in map
+     .
+     \param  key  Key to look for
+     \return      Iterator, at end if key is greater or equal to the last item key, or if map is empty
+     \see iter_upper(), iter_lowerM()
+    */
+    IterM iter_upperM(const Key& key) {
+        IterKey iterkey;
+        const Item* item = data_.upper(iterkey.a, iterkey.b, key);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    Item& getitem(const Key& key, bool* created=NULL) {
+        bool created_val;
+        Item* item = data_.insert(key, created_val);
+        if (created_val) {
+            ++size_;
+            null_ = false;
+        }
+        if (created != NULL)
+            *created = created_val;
+        return *item;
+    }
+
+    /** \copydoc Map::get() */
+    Value& get(const Key& key, bool* created=NULL)
+        { return getitem(key, created).second; }
+
+    // INFO_SET
+
+    /** \copydoc Map::operator[]() */
+    Value& operator[](const Key& key)
+        { return getitem(key, NULL).second; }
+
+    ThisType& unshare()
+        { return *this; }
+
+    /** %Set map capacity (no-op).
+     - Tree nodes are allocated as needed, so this does nothing but implement the Map interface
+     .
+     \return  This
+    */
+    ThisType& capacity(Size)
+        { return *this; }
+
+    /** %Set map capacity to at least given minimum (no-op).
+     - Tree nodes are allocated as needed, so this does nothing but implement the Map interface
+     .
+     \return  This
+    */
+    ThisType& capacitymin(Size)
+        { return *this; }
+
+    /** \copydoc Map::reserve() */
+    ThisType& reserve(Size)
+        { return *this; }
+
+    // ADD
+
+    Item& add(const Key& key, const Value& value, bool update=true) {
+        bool created_val;
+        Item& upditem = getitem(key, &created_val);
+        if (created_val || update)
+            upditem.second = value;
+        return upditem;
+    }
+
+    Item& add(const Item& item, bool update=true)
+        { return add(item.first, item.second, update); }
+
+    ThisType& add(const MapBaseType& map, bool update=true) {
+        if (this != &map) {
+            for (typename MapBaseType::Iter iter(map); iter; ++iter)
+                add(iter->first, iter->second, update);
+        }
+        return *this;
+    }
+
+    // REMOVE
+
+    bool remove(const Key& key) {
+        if (data_.remove(key)) {
+            --size_;
+            return true;
+        }
+        return false;
+    }
+
+    /** Find and remove item with given key and following items.
+     - \b Caution: This will invalidate iterators on this map
+     .
+     \param  key    Key to find and remove, along with following items
+     \param  count  Number of items to remove, ALL for all remaining items
+     \return        Number of items removed
+    */
+    Size remove(const Key& key, Size count) {
+        IterKey iterkey;
+        if (count > 0 && data_.find(iterkey.a, iterkey.b, key) != NULL) {
+            count = data_.remove_range(iterkey.a, iterkey.b, count);
+            size_ -= count;
+            return count;
+        }
+        return 0;
+    }
+
+    bool remove(typename MapBaseType::IterM& iter, IteratorDir dir=iterNONE)
+        { return remove((IterM&)iter, dir); }
+
+    /** \copydoc Map::remove(IterM&,IteratorDir) */
+    bool remove(IterM& iter, IteratorDir dir=iterNONE) {
+        if (iter && this == &iter.getParent()) {
+            IterKey& iterkey = iter.getKey();
+            data_.remove_range(iterkey.a, iterkey.b, 1);
+            --size_;
+
+            // Update iterator -- position is now at next item
+            if (dir != iterNONE) {
+                if (dir == iterRV)
+                    data_.prev_pos(iterkey.a, iterkey.b);
+                const IterItem* item = (IterItem*)data_.item_at(iterkey.a, iterkey.b);
+                if (item != NULL)
+                    iter.setData((IterItem*)item);
+                else
+                    iter = iterEND;
+            } else
+                iter = iterEND;
+            return true;
+        }
+        return false;
+    }
+
+    /** Remove range of items using iterator.
+     - This removes `count` items starting from (and including) `start`
+     - This is more efficient than removing items 1 by 1, since items are removed from each leaf at once
+     - No items are removed if start is at end, or count is 0
+     .
+     \param  start  Iterator to first item to remove, updated to next remaining item (or end if no more)
+     \param  count  Count of items to remove, ALL for all
+     \return        Number of items removed, which may be less than count
+    */
+    Size remove_range(IterM& start, Size count) {
+        if (count > 0 && start && this == &start.getParent()) {
+            IterKey& iterkey = start.getKey();
+            count = data_.remove_range(iterkey.a, iterkey.b, count);
+            size_ -= count;
+            const IterItem* item = (IterItem*)data_.item_at(iterkey.a, iterkey.b);
+            if (item != NULL)
+                start.setData((IterItem*)item);
+            else
+                start = iterEND;
+            return count;
+        }
+        return 0;
+    }
+
+    /** Remove range of items using iterators.
+     - This removes items starting from (and including) `start`, ending at (but not including) `end`
+     - This is more efficient than removing items 1 by 1, since items are removed from each leaf at once
+     - No items are removed if start is at end, or if start >= end
+     .
+     \param  start  Iterator to first item to remove, updated to next remaining item (or end if no more)
+     \param  end    Iterator to remove to, updated to end
+     \return        Number of items removed
+    */
+    Size remove_range(IterM& start, IterM& end) {
+        if (start && this == &start.getParent()) {
+            if (end) {
+                if (this == &end.getParent()) {
+                    const IterKey& endkey = end.getKey();
+                    const IterKey& iterkey = start.getKey();
+                    const Size count = data_.count_range(iterkey.a, iterkey.b, endkey.a, endkey.b);
+                    if (count != END && count > 0) {
+                        end = iterEND;
+                        return remove_range(start, count);
+                    }
+                }
+            } else
+                return remove_range(start, ALL);
+        }
+        return 0;
+    }
+
+    // INTERNAL
+
+    // Iterator support methods
+    /** \cond impl */
+    void iterInitMutable()
+        { }
+    const IterItem* iterFirst(IterKey& key) const
+        { return (IterItem*)data_.first_item(key.a, key.b); }
+    const IterItem* iterNext(IterKey& key) const
+        { return (IterItem*)data_.next_item(key.a, key.b); }
+    const IterItem* iterLast(IterKey& key) const
+        { return (IterItem*)data_.last_item(key.a, key.b); }
+    const IterItem* iterPrev(IterKey& key) const
+        { return (IterItem*)data_.prev_item(key.a, key.b); }
+    /** \endcond */
+
+protected:
+    const Item* getiter(IterKey& iterkey, const Key& key) const
+        { return data_.find(iterkey.a, iterkey.b, key); }
+
+private:
+    typedef impl::BTree<Key,Item,TCompare,Size> Tree;
+
+    bool null_;     // whether map is null
+    Tree data_;
+
+    void copy(const ThisType& src) {
+        null_ = src.null_;
+        if (src.size_ > 0) {
+            impl::BTreeIterReader<Item,Iter> reader(src);
+            size_ = data_.load(reader);
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(INCL_evo_string_h) || defined(DOXYGEN)
+/** MapTree using String keys and values.
+ - This is an alias to MapTree
+ - This is only defined if string.h is included before maptree.h
+*/
+typedef MapTree<String,String> StrMapTree;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
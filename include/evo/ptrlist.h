@@ -25,6 +25,18 @@ namespace evo {
 
 // Internal implementation macros -- only used in this file
 /** \cond impl */
+// Alloc/Free item -- items use same allocator as buffer header
+#if EVO_ALLOCATORS
+    #define EVO_IMPL_PTRLIST_ITEM_ALLOC(HDR) \
+        EVO_IMPL_CONTAINER_MEM_ALLOC_A(HDR->allocator, Value, sizeof(Value))
+    #define EVO_IMPL_PTRLIST_ITEM_FREE(HDR, PTR) \
+        EVO_IMPL_CONTAINER_MEM_FREE_A(HDR->allocator, PTR)
+#else
+    #define EVO_IMPL_PTRLIST_ITEM_ALLOC(HDR) \
+        EVO_IMPL_CONTAINER_MEM_ALLOC1(Value)
+    #define EVO_IMPL_PTRLIST_ITEM_FREE(HDR, PTR) \
+        EVO_IMPL_CONTAINER_MEM_FREE(PTR)
+#endif
 // Alloc+Copy items
 #define EVO_IMPL_PTRLIST_ITEMS_ALLOC_COPY(DEST, SRC, FIRST, LAST) { \
     Item item; \
@@ -32,7 +44,7 @@ namespace evo {
         if (SRC[i] == NULL) { \
             DEST[i] = NULL; \
         } else { \
-            DEST[i] = item = EVO_IMPL_CONTAINER_MEM_ALLOC1(Value); \
+            DEST[i] = item = EVO_IMPL_PTRLIST_ITEM_ALLOC(header_); \
             new(item) T(*SRC[i]); \
         } \
     } \
@@ -48,10 +60,21 @@ namespace evo {
 
 // Alloc/Realloc/Free buffer
 //  Assumes buffer is already freed/null
+#if EVO_ALLOCATORS
+    #define EVO_IMPL_PTRLIST_ALLOC_MEM(HDR, SIZE) { \
+        HDR = EVO_IMPL_CONTAINER_MEM_ALLOC_A(allocator_, Header, sizeof(Header) + (SIZE*sizeof(T*))); \
+        assert( HDR != NULL ); \
+        HDR->allocator = allocator_; \
+    }
+#else
+    #define EVO_IMPL_PTRLIST_ALLOC_MEM(HDR, SIZE) { \
+        HDR = (Header*)::malloc( sizeof(Header) + (SIZE*sizeof(T*)) ); \
+        assert( HDR != NULL ); \
+    }
+#endif
 #define EVO_IMPL_PTRLIST_ALLOC(HDR, DATA, SIZE) { \
     assert( SIZE > 0 ); \
-    HDR = (Header*)::malloc( sizeof(Header) + (SIZE*sizeof(T*)) ); \
-    assert( HDR != NULL ); \
+    EVO_IMPL_PTRLIST_ALLOC_MEM(HDR, SIZE); \
     HDR->size = SIZE; \
     HDR->refs = 1; \
     DATA = (Item*)(HDR + 1); \
@@ -70,11 +93,18 @@ namespace evo {
         memset(data_, 0, sizeof(Item*)*size_); \
 }
 //  Assumes buffer is already allocated
+#if EVO_ALLOCATORS
+    #define EVO_IMPL_PTRLIST_REALLOC_MEM(HDR, SIZE) \
+        HDR = EVO_IMPL_CONTAINER_MEM_REALLOC_A(HDR->allocator, Header, HDR, sizeof(Header) + (SIZE*sizeof(T*)))
+#else
+    #define EVO_IMPL_PTRLIST_REALLOC_MEM(HDR, SIZE) \
+        HDR = (Header*)::realloc( HDR, sizeof(Header) + (SIZE*sizeof(T*)) )
+#endif
 #define EVO_IMPL_PTRLIST_REALLOC(HDR, DATA, SIZE) { \
     assert( (size_t)HDR > sizeof(Header) ); \
     assert( DATA != NULL ); \
     assert( SIZE > 0 ); \
-    HDR = (Header*)::realloc( HDR, sizeof(Header) + (SIZE*sizeof(T*)) ); \
+    EVO_IMPL_PTRLIST_REALLOC_MEM(HDR, SIZE); \
     assert( HDR != NULL ); \
     HDR->size = SIZE; \
     DATA = (Item*)(HDR+1); \
@@ -88,15 +118,22 @@ namespace evo {
         for (data += HDR->first; data <= end; ++data) \
             if (*data != NULL) { \
                 (**data).~T(); \
-                EVO_IMPL_CONTAINER_MEM_FREE(*data); \
+                EVO_IMPL_PTRLIST_ITEM_FREE(HDR, *data); \
             } \
     } \
 }
 //  Assumes buffer is already allocated
-#define EVO_IMPL_PTRLIST_FREEMEM(HDR) { \
-    assert( (size_t)HDR > sizeof(Header) ); \
-    ::free(HDR); \
-}
+#if EVO_ALLOCATORS
+    #define EVO_IMPL_PTRLIST_FREEMEM(HDR) { \
+        assert( (size_t)HDR > sizeof(Header) ); \
+        EVO_IMPL_CONTAINER_MEM_FREE_A(HDR->allocator, HDR); \
+    }
+#else
+    #define EVO_IMPL_PTRLIST_FREEMEM(HDR) { \
+        assert( (size_t)HDR > sizeof(Header) ); \
+        ::free(HDR); \
+    }
+#endif
 //  Assumes buffer is already allocated
 #define EVO_IMPL_PTRLIST_FREE(HDR) { \
     if (HDR != NULL && --HDR->refs == 0) { \
@@ -221,6 +258,9 @@ public:
         header_ = NULL;
         data_   = NULL;
         size_   = 0;
+        #if EVO_ALLOCATORS
+            allocator_ = NULL;
+        #endif
     }
 
     /** Copy constructor.
@@ -229,6 +269,17 @@ public:
      \param  data  Data to copy
     */
     PtrList(const ThisType& data) {
+        #if EVO_ALLOCATORS
+            allocator_ = NULL;
+            if (data.size_ > 0 && data.header_->allocator != NULL) {
+                // Don't share buffer from a different allocator
+                header_ = NULL;
+                data_   = NULL;
+                size_   = 0;
+                copy(data);
+                return;
+            }
+        #endif
         if (data.size_ > 0) {
             header_ = data.header_;
             data_   = data.data_;
@@ -266,6 +317,10 @@ public:
         src.header_ = NULL;
         src.data_ = NULL;
         src.size_ = 0;
+        #if EVO_ALLOCATORS
+            allocator_ = src.allocator_;
+            src.allocator_ = NULL;
+        #endif
     }
 
     /** Move assignment operator (C++11).
@@ -280,6 +335,10 @@ public:
         src.header_ = NULL;
         src.data_ = NULL;
         src.size_ = 0;
+        #if EVO_ALLOCATORS
+            allocator_ = src.allocator_;
+            src.allocator_ = NULL;
+        #endif
         return *this;
     }
 #endif
@@ -364,6 +423,11 @@ public:
     */
     ThisType& set(const ThisType& data) {
         if (data_ != data.data_) {
+            #if EVO_ALLOCATORS
+                if (data.size_ > 0 && data.header_->allocator != allocator_)
+                    // Don't share buffer from a different allocator
+                    return copy(data);
+            #endif
             if (size_ > 0)
                 EVO_IMPL_PTRLIST_FREE(header_);
             if (data.size_ > 0) {
@@ -726,7 +790,7 @@ public:
         if (result == NULL) {
             // Create new item
             newitem: // used to skip NULL check
-            data_[key] = result = EVO_IMPL_CONTAINER_MEM_ALLOC1(Value);
+            data_[key] = result = EVO_IMPL_PTRLIST_ITEM_ALLOC(header_);
             DataInit<T>::init_safe(result);
             if (++header_->used == 1)
                 header_->first = header_->last = key;
@@ -800,6 +864,27 @@ public:
         return *this;
     }
 
+#if EVO_ALLOCATORS || defined(DOXYGEN)
+    /** %Set allocator to use for new buffers and items (modifier).
+     - Requires EVO_ALLOCATORS to be enabled
+     - The current buffer isn't moved, and it and its items are still freed with the allocator they were allocated with
+     - Buffers aren't shared with a list using a different allocator, a copy is made instead -- see \ref Sharing "Sharing"
+     .
+     \param  allocator  %Allocator to use, NULL for default
+     \return            This
+    */
+    ThisType& set_allocator(Allocator* allocator)
+        { allocator_ = allocator; return *this; }
+
+    /** Get allocator used for new buffers and items.
+     - Requires EVO_ALLOCATORS to be enabled
+     .
+     \return  %Allocator pointer, NULL for default
+    */
+    Allocator* get_allocator() const
+        { return allocator_; }
+#endif
+
     // RESIZE
 
     /** Resize while preserving existing data (modifier).
@@ -894,7 +979,7 @@ public:
                                 for (Item* end=data_+last; data <= end; ++data)
                                     if (*data != NULL) {
                                         (**data).~T();
-                                        EVO_IMPL_CONTAINER_MEM_FREE(*data);
+                                        EVO_IMPL_PTRLIST_ITEM_FREE(header_, *data);
                                         --used;
                                     }
                             }
@@ -1022,7 +1107,7 @@ public:
                                     while (++i <= last)
                                         if (olddata[i] != NULL) {
                                             header_->first = i;
-                                            data_[i] = item = EVO_IMPL_CONTAINER_MEM_ALLOC1(Value);
+                                            data_[i] = item = EVO_IMPL_PTRLIST_ITEM_ALLOC(header_);
                                             new(item) T(*olddata[i]);
                                             break; // no need to set last_copy since not removing last item
                                         } else
@@ -1036,7 +1121,7 @@ public:
                             } else if (olddata[i] == NULL) {
                                 data_[i] = NULL;
                             } else {
-                                data_[i] = item = EVO_IMPL_CONTAINER_MEM_ALLOC1(Value);
+                                data_[i] = item = EVO_IMPL_PTRLIST_ITEM_ALLOC(header_);
                                 new(item) T(*olddata[i]);
                                 last_copy = i;
                             }
@@ -1049,7 +1134,7 @@ public:
                 Item& item = data_[key];
                 if (item != NULL) {
                     (*item).~T();
-                    EVO_IMPL_CONTAINER_MEM_FREE(item);
+                    EVO_IMPL_PTRLIST_ITEM_FREE(header_, item);
                     item = NULL;
                     if (--header_->used == 0)
                         // Empty
@@ -1079,11 +1164,18 @@ public:
 
     /** Swap with another list.
      - This swaps internal state directly for best performance
+     - With EVO_ALLOCATORS each list keeps its own allocator, buffers are still freed with the allocator they were allocated with
      .
      \param  list  %List to swap with
     */
-    void swap(ThisType& list)
-        { EVO_IMPL_CONTAINER_SWAP(this, &list, ThisType); }
+    void swap(ThisType& list) {
+        EVO_IMPL_CONTAINER_SWAP(this, &list, ThisType);
+        #if EVO_ALLOCATORS
+            Allocator* temp = allocator_;
+            allocator_      = list.allocator_;
+            list.allocator_ = temp;
+        #endif
+    }
 
     // INTERNAL
 
@@ -1207,6 +1299,9 @@ protected:
         Size first;             ///< Index of first used item, 0 if used=0
         Size last;              ///< Index of last used item, 0 if used=0
         Size refs;              ///< Buffer reference count
+        #if EVO_ALLOCATORS
+            Allocator* allocator;   ///< Allocator used for this buffer and its items, NULL for default
+        #endif
     };
 
     // States:
@@ -1216,15 +1311,22 @@ protected:
     Header* header_;            ///< Data header pointer, NULL if no buffer allocated
     Item*   data_;              ///< Data pointer, NULL if null, can be 1 if empty (size_=0)
     Size    size_;              ///< Data size (same as header.size), 0 if empty
+    #if EVO_ALLOCATORS
+        Allocator* allocator_;  ///< Allocator to use for new buffers, NULL for default
+    #endif
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 // Remove implementation macros
+#undef EVO_IMPL_PTRLIST_ITEM_ALLOC
+#undef EVO_IMPL_PTRLIST_ITEM_FREE
 #undef EVO_IMPL_PTRLIST_ITEMS_ALLOC_COPY
 #undef EVO_IMPL_PTRLIST_ITEMS_ALLOC_COPY_ZERO_NEW
+#undef EVO_IMPL_PTRLIST_ALLOC_MEM
 #undef EVO_IMPL_PTRLIST_ALLOC
 #undef EVO_IMPL_PTRLIST_ALLOC_COPY
+#undef EVO_IMPL_PTRLIST_REALLOC_MEM
 #undef EVO_IMPL_PTRLIST_REALLOC
 #undef EVO_IMPL_PTRLIST_CLEAR
 #undef EVO_IMPL_PTRLIST_FREEMEM
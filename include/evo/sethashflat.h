@@ -0,0 +1,750 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file sethashflat.h Evo SetHashFlat container. */
+#pragma once
+#ifndef INCL_evo_sethashflat_h
+#define INCL_evo_sethashflat_h
+
+#include "set.h"
+#include "impl/hash.h"
+#include "impl/hashflat.h"
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Set implemented as a flat hash table using open addressing.
+
+\tparam  TKey   %Set key type
+\tparam  THash  Hash and comparison type to use
+\tparam  TSize  %Size type to use for size values (must be unsigned integer) -- default: SizeT
+
+\par Features
+
+ - Similar to STL unordered_set, and a drop-in replacement for SetHash -- both implement the Set interface
+ - Values are always unique (no duplicates)
+ - Values are stored directly in a single contiguous array (no separate allocation per value or bucket)
+   - Each slot has a 1-byte control value holding 7 bits of the value hash
+   - Lookups match a group of 16 control bytes at once (with SSE 2 when available, otherwise 8 at a time with integer ops), and only compare values where the hash bits match
+   - This makes lookups with expensive comparisons, like String values, much faster than comparing values one by one
+ - No memory allocated by new empty set
+ - No sharing -- copying a set makes a full copy, use SetHash if \ref Sharing "Sharing" is needed
+ .
+
+ C++11:
+ - Range-based for loop -- see \ref StlCompatibility
+   \code
+    SetHashFlat<int> hash;
+    for (auto num : hash.asconst()) {
+    }
+   \endcode
+ - Initialization lists
+   \code
+    SetHashFlat<int> hash = {3, 1, 2};
+    SetHashFlat<String> strhash = {"foo", "bar"};
+   \endcode
+ - Move semantics
+
+\par Hashing and Comparison
+
+You can leave the default hashing and comparison type (CompareHash) or specify an alternative.
+
+ - CompareHash
+ .
+
+See: \ref PrimitivesContainers "Primitives & Containers"
+
+\par Iterators
+
+ - SetHashFlat::Iter -- Read-Only Iterator (IteratorBi)
+ - SetHashFlat::IterM -- Mutable Iterator (IteratorBi)
+ .
+
+\b Caution: Adding to or resizing a set will invalidate existing iterators (and pointers) using it, removing a value only invalidates iterators on the removed value.
+
+\par Constructors
+
+ - SetHashFlat()
+ - SetHashFlat(const SetBaseType&)
+ - SetHashFlat(const ThisType&)
+ - SetHashFlat(std::initializer_list<Value>) [C++11]
+ - SetHashFlat(ThisType&&) [C++11]
+
+\par Read Access
+
+ - asconst()
+ - size()
+   - null(), empty()
+   - capacity()
+   - shared()
+   - ordered()
+   - get_compare() const
+ - contains()
+ - cbegin(), cend()
+   - begin() const, end() const
+ - iter()
+ - operator==()
+   - operator!=()
+ .
+
+\par Modifiers
+
+ - reserve()
+   - capacity(Size)
+   - capacitymin()
+   - unshare()
+   - compact()
+   - get_compare()
+ - begin(), end()
+ - iterM()
+ - set()
+   - set(const ThisType&)
+   - setempty()
+   - clear()
+   - operator=(const SetBaseType&)
+   - operator=(const ThisType&)
+   - operator=(ThisType&&) [C++11]
+ - get()
+ - add(const Value&,bool)
+   - addfrom()
+   - addsplit()
+ - remove(const Value&)
+   - remove(IterM&,IteratorDir)
+ .
+
+\par Examples
+
+Example using a set of strings
+
+\code
+#include <evo/string.h>
+#include <evo/sethashflat.h>
+#include <evo/io.h>
+using namespace evo;
+static Console& c = con();
+
+int main() {
+    // Create set with string values
+    StrSetHashFlat set;
+    set.add("foo");
+    set.addsplit("bar,baz");
+
+    // Check if set contains value
+    bool has_foo = set.contains("foo");     // true
+    bool has_abc = set.contains("abc");     // false
+
+    // Iterate and print values
+    for (StrSetHashFlat::Iter iter(set); iter; ++iter)
+        c.out << *iter << NL;
+
+    return 0;
+}
+\endcode
+
+Output:
+\code{.unparsed}
+baz
+foo
+bar
+\endcode
+
+<i>Note: Item ordering will vary</i>
+*/
+template<class TKey, class THash=CompareHash<TKey>, class TSize=SizeT>
+class SetHashFlat : public Set<TKey,TSize> {
+protected:
+    using Set<TKey,TSize>::size_;
+
+public:
+    EVO_CONTAINER_TYPE;
+#if defined(_MSC_VER) || defined(EVO_OLDCC) // avoid errors with older compilers and MSVC
+    typedef Set<TKey,TSize> SetBaseType;                        ///< %Set base type
+    typedef typename SetBaseType::Size Size;
+    typedef typename SetBaseType::Key Key;
+    typedef typename SetBaseType::Value Value;
+    typedef typename SetBaseType::Item Item;
+    typedef typename SetBaseType::IterKey IterKey;
+    typedef typename SetBaseType::IterItem IterItem;
+#else
+    using typename Set<TKey,TSize>::SetBaseType;
+    using typename Set<TKey,TSize>::Size;
+    using typename Set<TKey,TSize>::Key;
+    using typename Set<TKey,TSize>::Value;
+    using typename Set<TKey,TSize>::Item;
+    using typename Set<TKey,TSize>::IterKey;
+    using typename Set<TKey,TSize>::IterItem;
+#endif
+    typedef SetHashFlat<TKey,THash,TSize> ThisType;             ///< This type
+    typedef THash Hash;                                         ///< Hashing type -- default: CompareHash
+
+    typedef typename IteratorBi<ThisType>::Const Iter;          ///< Iterator (const) - IteratorBi
+    typedef IteratorBi<ThisType>                 IterM;         ///< Iterator (mutable) - IteratorBi
+
+    /** Constructor. */
+    SetHashFlat() : items_(NULL), ctrl_(NULL)
+        { }
+
+    /** Copy constructor.
+     \param  src  Source to copy
+    */
+    SetHashFlat(const SetBaseType& src) : items_(NULL), ctrl_(NULL) {
+        if (!src.null()) {
+            items_ = EVO_PEMPTY;
+            reserve(src.size());
+            for (typename SetBaseType::Iter iter(src); iter; ++iter)
+                get(*iter);
+        }
+    }
+
+    /** Copy constructor.
+     \param  src  Source to copy
+    */
+    SetHashFlat(const ThisType& src) : items_(NULL), ctrl_(NULL), data_(src.data_)
+        { copy(src); }
+
+    /** Destructor. */
+    ~SetHashFlat()
+        { free(); }
+
+#if defined(EVO_CPP11)
+    /** Sequence constructor (C++11).
+     \param  init  Initializer list, passed as comma-separated values in braces `{ }`
+    */
+    SetHashFlat(std::initializer_list<Value> init) : SetHashFlat() {
+        assert( init.size() < IntegerT<Size>::MAX );
+        capacitymin((Size)init.size());
+        for (const auto& val : init)
+            add(val);
+    }
+
+    /** Move constructor (C++11).
+     \param  src  Source to move
+    */
+    SetHashFlat(ThisType&& src) : items_(src.items_), ctrl_(src.ctrl_), data_(std::move(src.data_)) {
+        SetBaseType::size_ = src.SetBaseType::size_;
+        src.SetBaseType::size_ = 0;
+        src.items_ = NULL;
+        src.ctrl_  = NULL;
+    }
+
+    /** Move assignment operator (C++11).
+     \param  src  Source to move
+     \return      This
+    */
+    ThisType& operator=(ThisType&& src) {
+        free();
+        items_ = src.items_;
+        ctrl_  = src.ctrl_;
+        data_  = std::move(src.data_);
+        SetBaseType::size_ = src.SetBaseType::size_;
+        src.SetBaseType::size_ = 0;
+        src.items_ = NULL;
+        src.ctrl_  = NULL;
+        return *this;
+    }
+#endif
+
+    /** \copydoc List::asconst() */
+    const ThisType& asconst() const {
+        return *this;
+    }
+
+    // SET
+
+    /** \copydoc Set::operator=() */
+    ThisType& operator=(const SetBaseType& src)
+        { set(src); return *this; }
+
+    /** \copydoc Set::operator=(const SetBaseType& src) */
+    ThisType& operator=(const ThisType& src)
+        { set(src); return *this; }
+
+    ThisType& set()
+        { free(); return *this; }
+
+    /** \copydoc Set::set(const SetBaseType& src) */
+    ThisType& set(const SetBaseType& src) {
+        if (this != &src) {
+            if (src.null()) {
+                free();
+            } else {
+                setempty();
+                reserve(src.size());
+                for (typename SetBaseType::Iter iter(src); iter; ++iter)
+                    get(*iter);
+            }
+        }
+        return *this;
+    }
+
+    /** \copydoc Set::set(const SetBaseType& src) */
+    ThisType& set(const ThisType& src) {
+        if (this != &src) {
+            free();
+            data_ = src.data_;
+            copy(src);
+        }
+        return *this;
+    }
+
+    ThisType& setempty() {
+        if (items_ == NULL)
+            items_ = EVO_PEMPTY;
+        else
+            clear();
+        return *this;
+    }
+
+    ThisType& clear() {
+        if (size_ > 0) {
+            const Size cap = data_.capacity;
+            for (Size i = 0; i < cap; ++i)
+                if (Group::full(ctrl_[i]))
+                    items_[i].~Item();
+            size_ = 0;
+        }
+        if (data_.capacity > 0) {
+            memset(ctrl_, Group::EMPTY, (size_t)data_.capacity + Group::SIZE);
+            data_.growth_left = growth_limit(data_.capacity);
+        }
+        return *this;
+    }
+
+    // INFO
+
+    bool null() const
+        { return (items_ == NULL); }
+
+    bool shared() const
+        { return false; }
+
+    Size capacity() const
+        { return data_.capacity; }
+
+    bool ordered() const
+        { return false; }
+
+    // COMPARE
+
+    /** Get hash & comparison object being used for hashing and comparisons (const).
+     \return  %Hash & comparison object reference
+    */
+    const Hash& get_compare() const
+        { return data_; }
+
+    /** Get hash & comparison object being used for hashing and comparisons.
+     \return  %Hash & comparison object reference
+    */
+    Hash& get_compare()
+        { return data_; }
+
+    using SetBaseType::operator==;
+    using SetBaseType::operator!=;
+
+    // FIND
+
+    /** \copydoc List::cbegin() */
+    Iter cbegin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::cend() */
+    Iter cend() const
+        { return Iter(); }
+
+    /** \copydoc List::begin() */
+    IterM begin()
+        { return IterM(*this); }
+
+    /** \copydoc List::begin() const */
+    Iter begin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::end() */
+    IterM end()
+        { return IterM(); }
+
+    /** \copydoc List::end() const */
+    Iter end() const
+        { return Iter(); }
+
+    bool contains(const Value& value) const
+        { return (size_ > 0 && find_index(value, data_.hash(value)) != END); }
+
+    /** \copydoc Set::iter() */
+    Iter iter(const Value& value) const {
+        IterKey iterkey;
+        const Value* item = getiter(iterkey, value);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** \copydoc Set::iterM() */
+    IterM iterM(const Value& value) {
+        IterKey iterkey;
+        Value* item = (Value*)getiter(iterkey, value);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    Value& get(const Value& value, bool* created=NULL) {
+        const ulong hash = data_.hash(value);
+        Size index;
+        if (size_ > 0 && (index=find_index(value, hash)) != END) {
+            if (created != NULL)
+                *created = false;
+            return items_[index];
+        }
+
+        // Add new value, grow or rehash first if needed
+        if (data_.capacity == 0)
+            rehash(MIN_SIZE);
+        index = find_insert(hash);
+        if (data_.growth_left == 0 && ctrl_[index] == Group::EMPTY) {
+            rehash_grow();
+            index = find_insert(hash);
+        }
+        if (ctrl_[index] == Group::EMPTY)
+            --data_.growth_left;
+        set_ctrl(index, Group::ctrl(hash));
+        ++size_;
+
+        Value* item = items_ + index;
+        DataInit<Value>::init(item, &value, 1);
+        if (created != NULL)
+            *created = true;
+        return *item;
+    }
+
+    // INFO_SET
+
+    ThisType& unshare()
+        { return *this; }
+
+    /** %Set hash set capacity (capacity).
+     - Use to suggest a new capacity before adding a batch of items
+     - This will set hash size to nearest power of 2 that can fit both current items and given size without growing
+     - \b Caution: This will invalidate iterators and pointers to values on this set
+     .
+     \param  size  New suggested capacity
+     \return       This
+    */
+    ThisType& capacity(Size size) {
+        if (size < size_)
+            size = size_;
+        Size newsize = MIN_SIZE;
+        while (growth_limit(newsize) < size)
+            newsize <<= 1;
+        if (newsize != data_.capacity)
+            rehash(newsize);
+        return *this;
+    }
+
+    /** %Set set capacity to at least given minimum.
+     \param  min  Minimum capacity
+     \return      This
+    */
+    ThisType& capacitymin(Size min) {
+        if (min > growth_limit(data_.capacity))
+            capacity(min);
+        return *this;
+    }
+
+    /** \copydoc Set::reserve() */
+    ThisType& reserve(Size size)
+        { return capacitymin(size_ + size); }
+
+    // ADD
+
+    Value& add(const Value& value, bool update=false) {
+        bool created_val;
+        Value& upditem = get(value, &created_val);
+        if (!created_val && update)
+            upditem = value;
+        return upditem;
+    }
+
+    // REMOVE
+
+    bool remove(const Value& value) {
+        if (size_ > 0) {
+            const Size index = find_index(value, data_.hash(value));
+            if (index != END) {
+                remove_index(index);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool remove(typename SetBaseType::IterM& iter, IteratorDir dir=iterNONE)
+        { return remove((IterM&)iter, dir); }
+
+    bool remove(IterM& iter, IteratorDir dir=iterNONE) {
+        if (iter && this == &iter.getParent()) {
+            IterKey& iterkey = iter.getKey();
+            assert( iterkey.a < data_.capacity );
+            assert( Group::full(ctrl_[iterkey.a]) );
+            remove_index(iterkey.a);
+
+            // Update iterator -- removing leaves other values in place
+            if (size_ > 0 && dir != iterNONE) {
+                const IterItem* item = (dir == iterRV ? iterPrev(iterkey) : iterNext(iterkey));
+                if (item != NULL)
+                    iter.setData((IterItem*)item);
+                else
+                    iter = iterEND;
+            } else
+                iter = iterEND;
+            return true;
+        }
+        return false;
+    }
+
+    // INTERNAL
+
+    // Iterator support methods
+    /** \cond impl */
+    void iterInitMutable()
+        { }
+    const IterItem* iterFirst(IterKey& key) const {
+        key.b = 0;
+        if (size_ > 0) {
+            for (key.a = 0; key.a < data_.capacity; ++key.a)
+                if (Group::full(ctrl_[key.a]))
+                    return items_ + key.a;
+        }
+        key.a = END;
+        return NULL;
+    }
+    const IterItem* iterNext(IterKey& key) const {
+        if (key.a != END) {
+            while (++key.a < data_.capacity)
+                if (Group::full(ctrl_[key.a]))
+                    return items_ + key.a;
+            key.a = END;
+        }
+        return NULL;
+    }
+    const IterItem* iterLast(IterKey& key) const {
+        key.b = 0;
+        if (size_ > 0) {
+            for (key.a = data_.capacity; key.a > 0; )
+                if (Group::full(ctrl_[--key.a]))
+                    return items_ + key.a;
+        }
+        key.a = END;
+        return NULL;
+    }
+    const IterItem* iterPrev(IterKey& key) const {
+        if (key.a != END) {
+            while (key.a > 0)
+                if (Group::full(ctrl_[--key.a]))
+                    return items_ + key.a;
+            key.a = END;
+        }
+        return NULL;
+    }
+    /** \endcond */
+
+protected:
+    const Value* getiter(IterKey& iterkey, const Value& value) const {
+        iterkey.b = 0;
+        if (size_ > 0) {
+            iterkey.a = find_index(value, data_.hash(value));
+            if (iterkey.a != END)
+                return items_ + iterkey.a;
+        }
+        iterkey.a = END;
+        return NULL;
+    }
+
+private:
+    typedef impl::HashFlatGroup Group;
+
+    static const Size MIN_SIZE = 16;        // minimum hash size -- must be power of 2 and at least Group::SIZE
+
+    typedef Item T;     // used by EVO_PEMPTY
+
+    Item* items_;       // value slots, NULL if null, EVO_PEMPTY if empty and not allocated
+    char* ctrl_;        // control bytes, one per value slot followed by copy of first Group::SIZE bytes so a group can always be read contiguously
+
+    // Use inheritance to reduce size bloat with empty Hash
+    struct Data : public THash {
+        Size capacity;      // number of value slots, power of 2 or 0 if not allocated
+        Size growth_left;   // number of empty slots that may be used before a rehash is required
+
+        Data() : capacity(0), growth_left(0) {
+        }
+        Data(const Data& data) : THash(data), capacity(0), growth_left(0) {
+        }
+        Data& operator=(const Data& data) {
+            THash::operator=(data);
+            return *this;
+        }
+
+    #if defined(EVO_CPP11)
+        Data(Data&& data) : THash(std::move((THash&&)data)), capacity(data.capacity), growth_left(data.growth_left) {
+            data.capacity = 0;
+            data.growth_left = 0;
+        }
+        Data& operator=(Data&& data) {
+            THash::operator=(std::move((THash&&)data));
+            capacity = data.capacity;
+            growth_left = data.growth_left;
+            data.capacity = 0;
+            data.growth_left = 0;
+            return *this;
+        }
+    #endif
+    };
+
+    Data data_;
+
+    // Max values before growing -- keeps load factor at or below 7/8
+    static Size growth_limit(Size capacity)
+        { return capacity - (capacity >> 3); }
+
+    Size probe_start(ulong hash) const
+        { return (Size)(hash >> 7) & (data_.capacity - 1); }
+
+    void set_ctrl(Size index, char value) {
+        ctrl_[index] = value;
+        if (index < Group::SIZE)
+            ctrl_[data_.capacity + index] = value;
+    }
+
+    // Find value and return index, END if not found -- compares all control bytes in group at once, then only compares values with matching hash bits
+    Size find_index(const Value& value, ulong hash) const {
+        const Size mask = data_.capacity - 1;
+        const char h2   = Group::ctrl(hash);
+        Size pos = probe_start(hash);
+        for (Size step = 0; step <= mask; ) {
+            const Group group(ctrl_ + pos);
+            for (uint match = group.match(h2); match != 0; ) {
+                const Size index = (pos + Group::next(match)) & mask;
+                if (data_(value, items_[index]) == 0)
+                    return index;
+            }
+            if (group.match_empty() != 0)
+                break;
+            step += Group::SIZE;
+            pos = (pos + step) & mask;
+        }
+        return END;
+    }
+
+    // Find first empty or deleted slot for hash, must have at least 1 available
+    Size find_insert(ulong hash) const {
+        const Size mask = data_.capacity - 1;
+        Size pos = probe_start(hash);
+        for (Size step = 0; ; ) {
+            uint match = Group(ctrl_ + pos).match_avail();
+            if (match != 0)
+                return (pos + Group::next(match)) & mask;
+            step += Group::SIZE;
+            pos = (pos + step) & mask;
+            assert( step <= mask );
+        }
+    }
+
+    void remove_index(Size index) {
+        items_[index].~Item();
+        set_ctrl(index, Group::DELETED);
+        --size_;
+        if (size_ == 0) {
+            // Reclaim deleted slots when empty
+            memset(ctrl_, Group::EMPTY, (size_t)data_.capacity + Group::SIZE);
+            data_.growth_left = growth_limit(data_.capacity);
+        }
+    }
+
+    // Grow when no more room, or rehash in place when there are enough deleted slots to reclaim
+    void rehash_grow() {
+        if (data_.capacity == 0)
+            rehash(MIN_SIZE);
+        else if (size_ <= growth_limit(data_.capacity) / 2)
+            rehash(data_.capacity);
+        else
+            rehash(data_.capacity << 1);
+    }
+
+    // Allocate new table with given capacity and move values to it -- values are relocated by copying bytes, like other Evo containers
+    void rehash(Size newcap) {
+        assert( newcap >= MIN_SIZE );
+        assert( growth_limit(newcap) >= size_ );
+        Item* const old_items = items_;
+        char* const old_ctrl  = ctrl_;
+        const Size  old_cap   = data_.capacity;
+
+        alloc(newcap);
+        if (size_ > 0) {
+            for (Size i = 0; i < old_cap; ++i) {
+                if (Group::full(old_ctrl[i])) {
+                    const ulong hash = data_.hash(old_items[i]);
+                    const Size index = find_insert(hash);
+                    set_ctrl(index, Group::ctrl(hash));
+                    memcpy((void*)(items_ + index), (const void*)(old_items + i), sizeof(Item));
+                }
+            }
+            data_.growth_left -= size_;
+        }
+        if (old_cap > 0)
+            ::free(old_items);
+    }
+
+    // Allocate table with all slots empty, doesn't free old table
+    void alloc(Size cap) {
+        const size_t items_bytes = (size_t)cap * sizeof(Item);
+        items_ = (Item*)::malloc(items_bytes + (size_t)cap + Group::SIZE);
+        ctrl_  = (char*)items_ + items_bytes;
+        memset(ctrl_, Group::EMPTY, (size_t)cap + Group::SIZE);
+        data_.capacity    = cap;
+        data_.growth_left = growth_limit(cap);
+    }
+
+    void copy(const ThisType& src) {
+        if (src.items_ == NULL) {
+            items_ = NULL;
+        } else if (src.size_ == 0) {
+            items_ = EVO_PEMPTY;
+        } else {
+            alloc(src.data_.capacity);
+            memcpy(ctrl_, src.ctrl_, (size_t)data_.capacity + Group::SIZE);
+            for (Size i = 0; i < data_.capacity; ++i)
+                if (Group::full(ctrl_[i]))
+                    DataInit<Item>::init(items_ + i, src.items_ + i, 1);
+            size_ = src.size_;
+            data_.growth_left = src.data_.growth_left;
+        }
+    }
+
+    void free() {
+        if (data_.capacity > 0) {
+            clear();
+            ::free(items_);
+            data_.capacity    = 0;
+            data_.growth_left = 0;
+        }
+        items_ = NULL;
+        ctrl_  = NULL;
+        size_  = 0;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(INCL_evo_string_h) || defined(DOXYGEN)
+/** SetHashFlat using String values.
+ - This is an alias to SetHashFlat
+ - This is only defined if string.h is included before sethashflat.h
+*/
+typedef SetHashFlat<String> StrSetHashFlat;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
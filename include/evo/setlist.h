@@ -10,6 +10,7 @@ Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for
 
 #include "set.h"
 #include "list.h"
+#include "impl/eytzinger.h"
 
 namespace evo {
 /** \addtogroup EvoContainers */
@@ -346,6 +347,7 @@ public:
 
     ThisType& set() {
         data_.items.set();
+        data_.index.clear();
         SetBaseType::size_ = 0;
         return *this;
     }
@@ -362,18 +364,21 @@ public:
     ThisType& set(const ThisType& src) {
         ((Compare&)data_) = (const Compare&)src.data_;
         data_.items.set(src.data_.items);
+        data_.index.clear();
         SetBaseType::size_ = src.size_;
         return *this;
     }
 
     ThisType& setempty() {
         data_.items.setempty();
+        data_.index.clear();
         SetBaseType::size_ = 0;
         return *this;
     }
 
     ThisType& clear() {
         data_.items.clear();
+        data_.index.clear();
         SetBaseType::size_ = 0;
         return *this;
     }
@@ -538,6 +543,7 @@ public:
         Item* item;
         Size pos;
         if ( (item=(Item*)search(pos, value)) == NULL) {
+            data_.index.clear();
             item = &(data_.items.itemM(data_.items.insert(pos, &value, 1)));
             if (created != NULL)
                 *created = true;
@@ -556,6 +562,29 @@ public:
     const Value& item(Size index) const
         { return data_.items.item(index); }
 
+    /** Find multiple values and get their indexes (const).
+     - This is faster than calling contains() or iter() for each value when the set is frozen -- see freeze()
+     - When frozen, up to 16 searches are interleaved at a time so their memory accesses overlap, otherwise each value is searched in turn
+     - Use item() to get a value by index
+     .
+     \param  values   Values to find
+     \param  count    Number of values to find
+     \param  indexes  Stores found index for each value, END if not found -- must have room for `count` indexes  [out]
+     \return          Number of values found
+    */
+    Size find_many(const Value* values, Size count, Size* indexes) const {
+        if (data_.index.active())
+            return data_.index.find_many(values, count, indexes, (const TCompare&)data_);
+        Size found = 0;
+        for (Size i = 0; i < count; ++i) {
+            if (search(indexes[i], values[i]) != NULL)
+                ++found;
+            else
+                indexes[i] = END;
+        }
+        return found;
+    }
+
     // INFO_SET
 
     ThisType& unshare()
@@ -574,6 +603,34 @@ public:
     ThisType& compact()
         { data_.items.compact(); return *this; }
 
+    /** Freeze set for read-optimized searches (modifier).
+     - This builds a search index with a copy of all values in Eytzinger (BFS) order, where the top levels of the search tree share cache lines
+     - Frozen searches are branchless and prefetch a few levels ahead -- useful with large sets that are built once then searched often
+     - Values are still stored in a sorted list so iterators and item() are unaffected, the index uses extra memory for a copy of each value and an index
+     - Any change to the set unfreezes it, including getting a mutable iterator -- call freeze() again after making changes
+     - Copies of a frozen set are not frozen
+     .
+     \return  This
+    */
+    ThisType& freeze()
+        { data_.index.build(data_.items.data(), data_.items.size()); return *this; }
+
+    /** Unfreeze set and free search index (modifier).
+     - This isn't needed before making changes, since changes unfreeze automatically
+     .
+     \return  This
+    */
+    ThisType& unfreeze()
+        { data_.index.clear(); return *this; }
+
+    /** Get whether set is frozen with a read-optimized search index.
+     - See freeze()
+     .
+     \return  Whether frozen
+    */
+    bool frozen() const
+        { return data_.index.active(); }
+
     // ADD
 
     Value& add(const Value& item, bool update=false) {
@@ -589,6 +646,7 @@ public:
     bool remove(const Value& value) {
         Size index;
         if (search(index, value) != NULL) {
+            data_.index.clear();
             data_.items.remove(index);
             --SetBaseType::size_;
             return true;
@@ -606,6 +664,7 @@ public:
     Size remove(const Value& value, Size count) {
         Size index;
         if (count > 0 && search(index, value) != NULL) {
+            data_.index.clear();
             count = data_.items.remove(index, count);
             SetBaseType::size_ -= count;
             return count;
@@ -620,6 +679,7 @@ public:
     bool remove(IterM& iter, IteratorDir dir=iterNONE) {
         if (iter && this == &iter.getParent()) {
             IterKey& iterkey = iter.getKey();
+            data_.index.clear();
             data_.items.remove(iterkey.a);
             bool nextitem = false;
             if (--SetBaseType::size_ > 0 && dir != iterNONE) {
@@ -648,6 +708,7 @@ public:
     */
     Size removeat(Size index, Size count=1) {
         assert( index < data_.items.size() );
+        data_.index.clear();
         count = data_.items.remove(index, count);
         SetBaseType::size_ -= count;
         return count;
@@ -664,6 +725,7 @@ public:
     */
     Size remove_range(IterM& start, Size count) {
         if (count > 0 && start && this == &start.getParent()) {
+            data_.index.clear();
             count = data_.items.remove(start.index().a, count);
             SetBaseType::size_ -= count;
             if (start.index().a >= SetBaseType::size_)
@@ -689,6 +751,7 @@ public:
                 if (this == &end.getParent()) {
                     const Size end_index = end.index().a;
                     if (end_index > index) {
+                        data_.index.clear();
                         const Size count = data_.items.remove(index, end_index - index);
                         SetBaseType::size_ -= count;
                         end = iterEND;
@@ -696,6 +759,7 @@ public:
                     }
                 }
             } else {
+                data_.index.clear();
                 const Size count = data_.items.remove(index, ALL);
                 SetBaseType::size_ -= count;
                 start = iterEND;
@@ -710,7 +774,7 @@ public:
     // Iterator support methods
     /** \cond impl */
     void iterInitMutable()
-        { data_.items.iterInitMutable(); }
+        { data_.index.clear(); data_.items.iterInitMutable(); }
     const IterItem* iterFirst(IterKey& key) const
         { return (IterItem*)data_.items.iterFirst(key.a); }
     const IterItem* iterNext(IterKey& key) const
@@ -733,6 +797,7 @@ private:
         using TCompare::operator();
 
         List<Item> items;
+        impl::EytzingerIndex<Value,Size> index;     // search index while frozen
 
         Data()
             { }
@@ -740,11 +805,13 @@ private:
             { }
     #if defined(EVO_CPP11)
         Data(Data&& data) : TCompare(std::move(data)), items(std::move(data.items))
-            { }
+            { index.swap(data.index); }
 
         Data& operator=(Data&& data) {
             ((TCompare&)*this) = std::move((TCompare&)data);
             items = std::move(data.items);
+            index.clear();
+            index.swap(data.index);
             return *this;
         }
     #endif
@@ -753,6 +820,8 @@ private:
     Data data_;
 
     const Value* search(Size& index, const Value& value) const {
+        if (data_.index.active())
+            return (data_.index.find(index, value, (const TCompare&)data_) ? &data_.items.item(index) : NULL);
         int cmp;
         Size left = 0, right = data_.items.size(), mid = 0;
         while (left < right) {
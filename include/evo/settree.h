@@ -0,0 +1,628 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file settree.h Evo SetTree container. */
+#pragma once
+#ifndef INCL_evo_settree_h
+#define INCL_evo_settree_h
+
+#include "set.h"
+#include "impl/btree.h"
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Set implemented as an ordered B+tree.
+
+\tparam  TKey      %Set key type
+\tparam  TCompare  Comparison type to use
+\tparam  TSize     %Size type to use for size values (must be unsigned integer) -- default: SizeT
+
+\par Features
+
+ - Similar to STL set, and a drop-in replacement for SetList -- both implement the Set interface
+ - Values are always unique (no duplicates)
+ - Values are stored in leaf nodes, each a sorted array sized to fill a few cache lines, and leaves are linked in order
+   - Branch nodes hold only values and child pointers, also sized to a few cache lines, so each search step touches few cache lines
+   - Lookups, inserts, and removes are `O(log n)` -- unlike SetList, inserts only shift values within one leaf
+   - Iterating walks the linked leaves, so is nearly as fast as iterating an array
+   - Inserting after the last value (as with time-ordered values) fills leaves completely instead of splitting them in half
+ - Bulk load from sorted values with set_sorted(), which fills leaves and builds branches bottom-up without searching
+ - No memory allocated by new empty set
+ - No sharing -- copying a set makes a full copy, use SetList if \ref Sharing "Sharing" is needed
+ .
+
+C++11:
+ - Range-based for loop -- see \ref StlCompatibility
+   \code
+    SetTree<int> set;
+    for (auto num : set.asconst()) {
+    }
+   \endcode
+ - Initialization lists
+   \code
+    SetTree<int> set = {3, 1, 2};
+    SetTree<String> strset = {"foo", "bar"};
+   \endcode
+ - Move semantics
+
+\par Comparison
+
+You can leave the default comparison type (Compare) or specify an alternative.
+
+ - Compare, CompareR
+ - CompareI, CompareIR
+ .
+
+See: \ref PrimitivesContainers "Primitives & Containers"
+
+\par Iterators
+
+ - SetTree::Iter -- Read-Only Iterator (IteratorBi)
+ - SetTree::IterM -- Mutable Iterator (IteratorBi)
+ .
+
+\b Caution: Adding or removing values may move values within and between leaves, which invalidates existing iterators using this set.
+
+\par Constructors
+
+ - SetTree()
+ - SetTree(const SetBaseType&)
+ - SetTree(const ThisType&)
+ - SetTree(std::initializer_list<Value>) [C++11]
+ - SetTree(ThisType&&) [C++11]
+
+\par Read Access
+
+ - asconst()
+ - size()
+   - null(), empty()
+   - capacity()
+   - shared()
+   - ordered()
+   - get_compare() const
+ - contains()
+ - cbegin(), cend()
+   - begin() const, end() const
+ - iter()
+   - iter_lower(), iter_upper()
+ - operator==()
+   - operator!=()
+ .
+
+\par Modifiers
+
+ - reserve()
+   - capacity(Size)
+   - capacitymin()
+   - unshare()
+   - get_compare()
+ - begin(), end()
+ - iterM()
+   - iter_lowerM(), iter_upperM()
+ - set()
+   - set(const SetBaseType&)
+   - set(const ThisType&)
+   - set_sorted()
+   - setempty()
+   - clear()
+   - operator=(const SetBaseType&)
+   - operator=(const ThisType&)
+   - operator=(ThisType&&) [C++11]
+ - get()
+ - add()
+   - addfrom()
+   - addsplit()
+ - remove(const Value&)
+   - remove(const Value&,Size)
+   - remove(IterM&,IteratorDir)
+   - remove_range(IterM&,Size)
+   - remove_range(IterM&,IterM&)
+ .
+
+\par Example
+
+\code
+#include <evo/settree.h>
+#include <evo/io.h>
+using namespace evo;
+static Console& c = con();
+
+int main() {
+    // Create set with numeric values
+    SetTree<int> set;
+    set.add(20);
+    set.add(10);
+    set.add(40);
+    set.add(30);
+
+    // Iterate and print values from 15 to 30
+    SetTree<int>::Iter end(set.iter_upper(30));
+    for (SetTree<int>::Iter iter(set.iter_lower(15)); iter != end; ++iter)
+        c.out << *iter << NL;
+
+    return 0;
+}
+\endcode
+
+Output:
+\code{.unparsed}
+20
+30
+\endcode
+*/
+template<class TKey, class TCompare=Compare<TKey>, class TSize=SizeT>
+class SetTree : public Set<TKey,TSize> {
+public:
+    EVO_CONTAINER_TYPE;
+#if defined(_MSC_VER) || defined(EVO_OLDCC) // avoid errors with older compilers and MSVC
+    typedef Set<TKey,TSize> SetBaseType;                ///< %Set base type
+    typedef typename SetBaseType::Size Size;
+    typedef typename SetBaseType::Key Key;
+    typedef typename SetBaseType::Value Value;
+    typedef typename SetBaseType::Item Item;
+    typedef typename SetBaseType::IterKey IterKey;
+    typedef typename SetBaseType::IterItem IterItem;
+#else
+    using typename Set<TKey,TSize>::SetBaseType;
+    using typename Set<TKey,TSize>::Size;
+    using typename Set<TKey,TSize>::Key;
+    using typename Set<TKey,TSize>::Value;
+    using typename Set<TKey,TSize>::Item;
+    using typename Set<TKey,TSize>::IterKey;
+    using typename Set<TKey,TSize>::IterItem;
+#endif
+    typedef SetTree<TKey,TCompare,TSize> ThisType;      ///< This type
+    typedef TCompare Compare;                           ///< %Compare type to use
+
+    typedef typename IteratorBi<ThisType>::Const Iter;  ///< Iterator (const) - IteratorBi
+    typedef IteratorBi<ThisType>                 IterM; ///< Iterator (mutable) - IteratorBi
+
+    /** Default constructor. */
+    SetTree() : null_(true)
+        { }
+
+    /** Copy constructor.
+     - Uses default comparison object
+     - Results are undefined if TCompare is a function pointer since this will not initialize it
+     .
+     \param  src  Source to copy
+    */
+    SetTree(const SetBaseType& src) : null_(true)
+        { set(src); }
+
+    /** Copy constructor.
+     - This copies the comparison object as well
+     .
+     \param  src  Source to copy
+    */
+    SetTree(const ThisType& src) : Set<TKey,TSize>(), null_(true), data_(src.data_)
+        { copy(src); }
+
+    /** Destructor. */
+    ~SetTree()
+        { }
+
+#if defined(EVO_CPP11)
+    /** Sequence constructor (C++11).
+     \param  init  Initializer list, passed as comma-separated values in braces `{ }`
+    */
+    SetTree(std::initializer_list<Value> init) : SetTree() {
+        assert( init.size() < IntegerT<Size>::MAX );
+        setempty();
+        for (const auto& val : init)
+            add(val);
+    }
+
+    /** Move constructor (C++11).
+     \param  src  Source to move
+    */
+    SetTree(ThisType&& src) : null_(src.null_), data_(std::move(src.data_)) {
+        SetBaseType::size_ = src.SetBaseType::size_;
+        src.SetBaseType::size_ = 0;
+        src.null_ = true;
+    }
+
+    /** Move assignment operator (C++11).
+     \param  src  Source to move
+     \return      This
+    */
+    ThisType& operator=(ThisType&& src) {
+        data_ = std::move(src.data_);
+        null_ = src.null_;
+        SetBaseType::size_ = src.SetBaseType::size_;
+        src.SetBaseType::size_ = 0;
+        src.null_ = true;
+        return *this;
+    }
+#endif
+
+    /** \copydoc List::asconst() */
+    const ThisType& asconst() const {
+        return *this;
+    }
+
+    // SET
+
+    /** \copydoc Set::operator=(const SetBaseType& src) */
+    ThisType& operator=(const SetBaseType& src)
+        { set(src); return *this; }
+
+    /** \copydoc Set::operator=(const SetBaseType& src) */
+    ThisType& operator=(const ThisType& src)
+        { set(src); return *this; }
+
+    ThisType& set() {
+        data_.reset();
+        SetBaseType::size_ = 0;
+        null_ = true;
+        return *this;
+    }
+
+    /** \copydoc Set::set(const SetBaseType& src) */
+    ThisType& set(const SetBaseType& src) {
+        if (this != &src) {
+            if (src.null()) {
+                set();
+            } else {
+                clear();
+                impl::BTreeIterReader<Item,typename SetBaseType::Iter> reader(src);
+                SetBaseType::size_ = data_.load(reader);
+            }
+        }
+        return *this;
+    }
+
+    /** \copydoc Set::set(const SetBaseType& src) */
+    ThisType& set(const ThisType& src) {
+        if (this != &src) {
+            set();
+            data_ = src.data_;
+            copy(src);
+        }
+        return *this;
+    }
+
+    /** %Set as copy of sorted values.
+     - This is much faster than adding values one at a time when values are already sorted with no duplicates:
+       - Leaves are filled in order without searching, then branches are built bottom-up
+       - Leaves are filled completely, so is best for data that is mostly read or appended to
+     - Values that aren't sorted are still added correctly, though more slowly: once a value is out of order, it and all remaining values are added one at a time
+     - \b Caution: This will invalidate iterators on this set
+     .
+     \param  values  Values to copy, should be sorted
+     \param  count   Number of values to copy
+     \return         This
+    */
+    ThisType& set_sorted(const Value* values, Size count) {
+        clear();
+        impl::BTreeArrayReader<Item> reader(values, count);
+        SetBaseType::size_ = data_.load(reader);
+        return *this;
+    }
+
+    ThisType& setempty() {
+        clear();
+        null_ = false;
+        return *this;
+    }
+
+    ThisType& clear() {
+        data_.reset();
+        SetBaseType::size_ = 0;
+        null_ = false;
+        return *this;
+    }
+
+    // INFO
+
+    bool null() const
+        { return null_; }
+
+    bool shared() const
+        { return false; }
+
+    /** \copydoc Set::capacity()
+     - This is the number of value slots in all leaves
+    */
+    Size capacity() const
+        { return data_.leaf_count() * Tree::LEAF_SIZE; }
+
+    bool ordered() const
+        { return true; }
+
+    // COMPARE
+
+    /** Get comparison object being used for comparisons (const).
+     \return  Comparison object reference
+    */
+    const Compare& get_compare() const
+        { return data_; }
+
+    /** Get comparison object being used for comparisons.
+     \return  Comparison object reference
+    */
+    Compare& get_compare()
+        { return data_; }
+
+    using SetBaseType::operator==;
+    using SetBaseType::operator!=;
+
+    // FIND
+
+    /** \copydoc List::cbegin() */
+    Iter cbegin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::cend() */
+    Iter cend() const
+        { return Iter(); }
+
+    /** \copydoc List::begin() */
+    IterM begin()
+        { return IterM(*this); }
+
+    /** \copydoc List::begin() const */
+    Iter begin() const
+        { return Iter(*this); }
+
+    /** \copydoc List::end() */
+    IterM end()
+        { return IterM(); }
+
+    /** \copydoc List::end() const */
+    Iter end() const
+        { return Iter(); }
+
+    bool contains(const Value& value) const
+        { return (data_.find(value) != NULL); }
+
+    /** \copydoc Set::iter() */
+    Iter iter(const Value& value) const {
+        IterKey iterkey;
+        const Item* item = getiter(iterkey, value);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** \copydoc SetList::iter_lower() */
+    Iter iter_lower(const Value& value) const {
+        IterKey iterkey;
+        bool found;
+        const Item* item = data_.lower(iterkey.a, iterkey.b, value, found);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** \copydoc SetList::iter_lowerM() */
+    IterM iter_lowerM(const Value& value) {
+        IterKey iterkey;
+        bool found;
+        const Item* item = data_.lower(iterkey.a, iterkey.b, value, found);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    /** \copydoc SetList::iter_upper() */
+    Iter iter_upper(const Value& value) const {
+        IterKey iterkey;
+        const Item* item = data_.upper(iterkey.a, iterkey.b, value);
+        return (item != NULL ? Iter(*this, iterkey, (IterItem*)item) : Iter(*this, iterEND));
+    }
+
+    /** \copydoc SetList::iter_upperM() */
+    IterM iter_upperM(const Value& value) {
+        IterKey iterkey;
+        const Item* item = data_.upper(iterkey.a, iterkey.b, value);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    /** \copydoc Set::iterM() */
+    IterM iterM(const Value& value) {
+        IterKey iterkey;
+        Item* item = (Item*)getiter(iterkey, value);
+        return (item != NULL ? IterM(*this, iterkey, (IterItem*)item) : IterM(*this, iterEND));
+    }
+
+    Value& get(const Value& value, bool* created=NULL) {
+        bool created_val;
+        Item* item = data_.insert(value, created_val);
+        if (created_val) {
+            ++SetBaseType::size_;
+            null_ = false;
+        }
+        if (created != NULL)
+            *created = created_val;
+        return *item;
+    }
+
+    // INFO_SET
+
+    ThisType& unshare()
+        { return *this; }
+
+    /** %Set capacity (no-op).
+     - Tree nodes are allocated as needed, so this does nothing but implement the Set interface
+     .
+     \return  This
+    */
+    ThisType& capacity(Size)
+        { return *this; }
+
+    /** %Set capacity to at least given minimum (no-op).
+     - Tree nodes are allocated as needed, so this does nothing but implement the Set interface
+     .
+     \return  This
+    */
+    ThisType& capacitymin(Size)
+        { return *this; }
+
+    /** \copydoc Set::reserve() */
+    ThisType& reserve(Size)
+        { return *this; }
+
+    // ADD
+
+    Value& add(const Value& item, bool update=false) {
+        bool created_val;
+        Value& upditem = get(item, &created_val);
+        if (!created_val && update)
+            upditem = item;
+        return upditem;
+    }
+
+    // REMOVE
+
+    bool remove(const Value& value) {
+        if (data_.remove(value)) {
+            --SetBaseType::size_;
+            return true;
+        }
+        return false;
+    }
+
+    /** Find and remove value and following values.
+     - \b Caution: This will invalidate iterators on this set
+     .
+     \param  value  Value to to find and remove
+     \param  count  Number of values to remove, ALL for all remaining values
+     \return        Number of value removed
+    */
+    Size remove(const Value& value, Size count) {
+        IterKey iterkey;
+        if (count > 0 && data_.find(iterkey.a, iterkey.b, value) != NULL) {
+            count = data_.remove_range(iterkey.a, iterkey.b, count);
+            SetBaseType::size_ -= count;
+            return count;
+        }
+        return 0;
+    }
+
+    bool remove(typename SetBaseType::IterM& iter, IteratorDir dir=iterNONE)
+        { return remove((IterM&)iter, dir); }
+
+    /** \copydoc Set::remove(IterM&,IteratorDir) */
+    bool remove(IterM& iter, IteratorDir dir=iterNONE) {
+        if (iter && this == &iter.getParent()) {
+            IterKey& iterkey = iter.getKey();
+            data_.remove_range(iterkey.a, iterkey.b, 1);
+            --SetBaseType::size_;
+
+            // Update iterator -- position is now at next value
+            if (dir != iterNONE) {
+                if (dir == iterRV)
+                    data_.prev_pos(iterkey.a, iterkey.b);
+                const IterItem* item = (IterItem*)data_.item_at(iterkey.a, iterkey.b);
+                if (item != NULL)
+                    iter.setData((IterItem*)item);
+                else
+                    iter = iterEND;
+            } else
+                iter = iterEND;
+            return true;
+        }
+        return false;
+    }
+
+    /** Remove range of values using iterator (mutable).
+     - This removes `count` values starting from (and including) `start`
+     - This is more efficient than removing values 1 by 1, since values are removed from each leaf at once
+     - No values are removed if start is at end, or count is 0
+     .
+     \param  start  Iterator to first value to remove, updated to next remaining value (or end if no more)
+     \param  count  Count of values to remove, ALL for all
+     \return        Number of values removed, which may be less than count
+    */
+    Size remove_range(IterM& start, Size count) {
+        if (count > 0 && start && this == &start.getParent()) {
+            IterKey& iterkey = start.getKey();
+            count = data_.remove_range(iterkey.a, iterkey.b, count);
+            SetBaseType::size_ -= count;
+            const IterItem* item = (IterItem*)data_.item_at(iterkey.a, iterkey.b);
+            if (item != NULL)
+                start.setData((IterItem*)item);
+            else
+                start = iterEND;
+            return count;
+        }
+        return 0;
+    }
+
+    /** Remove range of values using iterators (mutable).
+     - This removes values starting from (and including) `start`, ending at (but not including) `end`
+     - This is more efficient than removing values 1 by 1, since values are removed from each leaf at once
+     - No values are removed if start is at end, or if start >= end
+     .
+     \param  start  Iterator to first value to remove, updated to next remaining value (or end if no more)
+     \param  end    Iterator to remove to, updated to end
+     \return        Number of values removed
+    */
+    Size remove_range(IterM& start, IterM& end) {
+        if (start && this == &start.getParent()) {
+            if (end) {
+                if (this == &end.getParent()) {
+                    const IterKey& endkey = end.getKey();
+                    const IterKey& iterkey = start.getKey();
+                    const Size count = data_.count_range(iterkey.a, iterkey.b, endkey.a, endkey.b);
+                    if (count != END && count > 0) {
+                        end = iterEND;
+                        return remove_range(start, count);
+                    }
+                }
+            } else
+                return remove_range(start, ALL);
+        }
+        return 0;
+    }
+
+    // INTERNAL
+
+    // Iterator support methods
+    /** \cond impl */
+    void iterInitMutable()
+        { }
+    const IterItem* iterFirst(IterKey& key) const
+        { return (IterItem*)data_.first_item(key.a, key.b); }
+    const IterItem* iterNext(IterKey& key) const
+        { return (IterItem*)data_.next_item(key.a, key.b); }
+    const IterItem* iterLast(IterKey& key) const
+        { return (IterItem*)data_.last_item(key.a, key.b); }
+    const IterItem* iterPrev(IterKey& key) const
+        { return (IterItem*)data_.prev_item(key.a, key.b); }
+    /** \endcond */
+
+protected:
+    const Value* getiter(IterKey& iterkey, const Value& value) const
+        { return data_.find(iterkey.a, iterkey.b, value); }
+
+private:
+    typedef impl::BTree<Key,Item,TCompare,Size> Tree;
+
+    bool null_;     // whether set is null
+    Tree data_;
+
+    void copy(const ThisType& src) {
+        null_ = src.null_;
+        if (src.SetBaseType::size_ > 0) {
+            impl::BTreeIterReader<Item,Iter> reader(src);
+            SetBaseType::size_ = data_.load(reader);
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+#if defined(INCL_evo_string_h) || defined(DOXYGEN)
+/** SetTree using String values.
+ - This is an alias to SetTree
+ - This is only defined if string.h is included before settree.h
+*/
+typedef SetTree<String> StrSetTree;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
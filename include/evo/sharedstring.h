@@ -0,0 +1,452 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file sharedstring.h Evo SharedList and SharedString, immutable buffers shareable between threads. */
+#pragma once
+#ifndef INCL_evo_sharedstring_h
+#define INCL_evo_sharedstring_h
+
+#include "substring.h"
+#include "atomic.h"
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Base class for SharedList and SharedString -- do not use directly.
+ - This holds a reference to an immutable list buffer with an atomic reference count
+ .
+ \tparam  TList  %List type held, List or String
+ \tparam  TSub   Non-owning type used to reference list data, SubList or SubString
+*/
+template<class TList,class TSub>
+class SharedListBase {
+public:
+    typedef TList                       ListType;       ///< %List type
+    typedef TSub                        SubType;        ///< Non-owning type referencing list data
+    typedef typename TList::Item        Item;           ///< Item type
+    typedef typename TList::Size        Size;           ///< Size type
+    typedef typename TList::Key         Key;            ///< Key type (item index)
+
+    /** Get whether null.
+     \return  Whether null
+    */
+    bool null() const
+        { return (shared_ == NULL); }
+
+    /** Get whether empty.
+     \return  Whether empty (or null)
+    */
+    bool empty() const
+        { return (shared_ == NULL || shared_->list.size() == 0); }
+
+    /** Get size as item count.
+     \return  Size, 0 if empty or null
+    */
+    Size size() const
+        { return (shared_ == NULL ? 0 : shared_->list.size()); }
+
+    /** Get whether data is shared with other instances.
+     - This may change at any time if other threads hold references
+     .
+     \return  Whether shared
+    */
+    bool shared() const
+        { return (shared_ != NULL && shared_->refs.load(EVO_ATOMIC_ACQUIRE) > 1); }
+
+    /** Get data pointer.
+     \return  Data pointer, NULL if null
+    */
+    const Item* data() const
+        { return (shared_ == NULL ? NULL : shared_->list.data()); }
+
+    /** Get item at position.
+     \param  index  Item index, must be less than size()
+     \return        Item at index
+    */
+    const Item& operator[](Key index) const {
+        assert( shared_ != NULL );
+        assert( index < shared_->list.size() );
+        return shared_->list.data()[index];
+    }
+
+    /** Get non-owning reference to data, for reading without copying.
+     - This doesn't add a reference, so don't keep the result after this instance is changed or destroyed
+     - Data is immutable while referenced, so different threads may read from their own results at the same time
+     - To keep the data, copy this instance instead -- copying the result to a List or String copies the data
+     .
+     \return  Data reference, null if null
+    */
+    SubType get() const
+        { return (shared_ == NULL ? SubType() : SubType(shared_->list.data(), shared_->list.size())); }
+
+    /** Release data to a list and set this as null.
+     - If this is the only reference then data is moved to `dest` without copying, otherwise data is copied to `dest`
+     .
+     \param  dest  %List to store data in
+     \return       Whether data was moved without copying
+    */
+    bool release(TList& dest) {
+        bool result = false;
+        if (shared_ == NULL) {
+            dest.set();
+        } else if (shared_->refs.load(EVO_ATOMIC_ACQUIRE) == 1) {
+            // Only reference, move data
+            dest.swap(shared_->list);
+            delete shared_;
+            shared_ = NULL;
+            result = true;
+        } else {
+            dest.set(shared_->list.data(), shared_->list.size());
+            free();
+        }
+        return result;
+    }
+
+protected:
+    /** Shared data with atomic reference count, list is never modified while shared. */
+    struct Shared {
+        AtomicULong refs;           ///< Reference count
+        TList       list;           ///< Data, has its own buffer not shared with any other list -- never exposed so it can't be shared with a non-atomic reference
+    };
+
+    Shared* shared_;                ///< Shared data, NULL if null
+
+    /** Constructor. */
+    SharedListBase() : shared_(NULL)
+        { }
+
+    /** Copy constructor, shares data from source.
+     \param  src  Source to share
+    */
+    SharedListBase(const SharedListBase& src) : shared_(src.shared_) {
+        if (shared_ != NULL)
+            shared_->refs.fetch_add(1, EVO_ATOMIC_RELAXED);
+    }
+
+    /** Destructor. */
+    ~SharedListBase()
+        { free(); }
+
+    /** %Set as shared reference to source.
+     \param  src  Source to share
+    */
+    void ref(const SharedListBase& src) {
+        if (shared_ != src.shared_) {
+            if (src.shared_ != NULL)
+                src.shared_->refs.fetch_add(1, EVO_ATOMIC_RELAXED);
+            free();
+            shared_ = src.shared_;
+        }
+    }
+
+    /** %Set as copy of data.
+     \param  data  Data to copy
+     \param  size  Data size as item count
+    */
+    void copy(const Item* data, Size size) {
+        free();
+        shared_ = new Shared;
+        shared_->refs.store(1, EVO_ATOMIC_RELAXED);
+        shared_->list.set(data, size);
+        shared_->list.unshare();
+    }
+
+    /** %Set by taking data from list, without copying if list buffer isn't already shared.
+     - List data is copied if it references external data or a buffer shared with another list
+     - This leaves `src` as null
+     .
+     \param  src  Source list to take from
+     \return      Taken list, used for additional setup by derived class
+    */
+    TList& take(TList& src) {
+        free();
+        shared_ = new Shared;
+        shared_->refs.store(1, EVO_ATOMIC_RELAXED);
+        if (src.null())
+            shared_->list.set(src);
+        else {
+            src.unshare();
+            shared_->list.swap(src);
+            src.set();
+        }
+        return shared_->list;
+    }
+
+    /** %Set as null, freeing data if this is the last reference. */
+    void free() {
+        if (shared_ != NULL) {
+            if (shared_->refs.fetch_sub(1, EVO_ATOMIC_ACQ_REL) == 1)
+                delete shared_;
+            shared_ = NULL;
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Immutable list that can be shared between threads without copying.
+ - This references a list buffer with an atomic (thread-safe) reference count, so copies can be passed to other threads
+   - Copying just increments the reference count, data is never copied
+   - Data is freed by whichever thread releases the last reference
+ - Data is immutable, use release() to get a modifiable List -- this moves without copying if this is the only reference
+ - List takes data from a List without copying when the list buffer isn't already shared -- see set(ListType&)
+ - Different instances referencing the same data can be used by different threads at the same time, but a single instance must not be modified by multiple threads at once
+ - \b Caution: When EVO_ALLOCATORS is enabled, don't share data allocated with an allocator that isn't thread safe (like ArenaAllocator or PoolAllocator) with other threads
+ .
+
+\tparam  T  Item type to use
+
+\par Example
+
+\code
+#include <evo/sharedstring.h>
+using namespace evo;
+
+int main() {
+    List<int> list;
+    list.add(1).add(2).add(3);
+
+    // Take buffer without copying, pass copies to other threads
+    SharedList<int> shared(list);
+    SharedList<int> shared2(shared);
+
+    // Release to modifiable list
+    List<int> list2;
+    shared.set();
+    shared2.release(list2);     // only reference left, so moves without copying
+    list2.add(4);
+
+    return 0;
+}
+\endcode
+*/
+template<class T>
+class SharedList : public SharedListBase< List<T>, SubList<T> > {
+public:
+    typedef SharedList<T>                           ThisType;   ///< This type
+    typedef SharedListBase< List<T>, SubList<T> >   BaseType;   ///< Base type
+    typedef List<T>                                 ListType;   ///< %List type
+    typedef typename ListType::Size                 Size;       ///< Size type
+
+    /** Default constructor sets as null. */
+    SharedList()
+        { }
+
+    /** Copy constructor, shares data from source without copying.
+     \param  src  Source to share
+    */
+    SharedList(const ThisType& src) : BaseType(src)
+        { }
+
+    /** Constructor taking data from list, without copying if list buffer isn't already shared.
+     - See set(ListType&)
+     .
+     \param  src  Source list to take from, set to null
+    */
+    explicit SharedList(ListType& src)
+        { this->take(src); }
+
+    /** Assignment operator, shares data from source without copying.
+     \param  src  Source to share
+     \return      This
+    */
+    ThisType& operator=(const ThisType& src)
+        { this->ref(src); return *this; }
+
+#if defined(EVO_CPP11)
+    /** Move constructor taking data from list (C++11), without copying if list buffer isn't already shared.
+     \param  src  Source list to take from, set to null
+    */
+    SharedList(ListType&& src)
+        { this->take(src); }
+
+    /** Move assignment operator taking data from list (C++11), without copying if list buffer isn't already shared.
+     \param  src  Source list to take from, set to null
+     \return      This
+    */
+    ThisType& operator=(ListType&& src)
+        { this->take(src); return *this; }
+#endif
+
+    /** %Set as null.
+     \return  This
+    */
+    ThisType& set()
+        { this->free(); return *this; }
+
+    /** %Set by taking data from list, without copying if list buffer isn't already shared.
+     - List data is copied if it references external data or a buffer shared with another list
+     - This leaves `src` as null
+     .
+     \param  src  Source list to take from, set to null
+     \return      This
+    */
+    ThisType& set(ListType& src)
+        { this->take(src); return *this; }
+
+    /** %Set as copy of data.
+     \param  data  Data to copy
+     \param  size  Data size as item count
+     \return       This
+    */
+    ThisType& set(const T* data, Size size)
+        { this->copy(data, size); return *this; }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Immutable string that can be shared between threads without copying.
+ - This references a string buffer with an atomic (thread-safe) reference count, so copies can be passed to other threads
+   - Copying just increments the reference count, data is never copied
+   - Data is freed by whichever thread releases the last reference
+ - Data is immutable and always terminated, so cstr() is const
+ - Use get() to read as a SubString without copying, or release() to get a modifiable String -- this moves without copying if this is the only reference
+ - This takes data from a String without copying when the string buffer isn't already shared -- see set(String&)
+ - Different instances referencing the same data can be used by different threads at the same time, but a single instance must not be modified by multiple threads at once
+ - \b Caution: When EVO_ALLOCATORS is enabled, don't share data allocated with an allocator that isn't thread safe (like ArenaAllocator or PoolAllocator) with other threads
+ .
+
+\par Example
+
+\code
+#include <evo/sharedstring.h>
+#include <evo/io.h>
+using namespace evo;
+static Console& c = con();
+
+int main() {
+    String str;
+    str << "payload " << 123;
+
+    // Take buffer without copying, copies can be passed to other threads
+    SharedString shared(str);
+    SharedString shared2(shared);
+    c.out << shared2.get() << NL;
+
+    // Release to modifiable string
+    String str2;
+    shared.set();
+    shared2.release(str2);      // only reference left, so moves without copying
+    str2 << '!';
+
+    return 0;
+}
+\endcode
+*/
+class SharedString : public SharedListBase<String,SubString> {
+public:
+    typedef SharedString                        ThisType;   ///< This type
+    typedef SharedListBase<String,SubString>    BaseType;   ///< Base type
+
+    /** Default constructor sets as null. */
+    SharedString()
+        { }
+
+    /** Copy constructor, shares data from source without copying.
+     \param  src  Source to share
+    */
+    SharedString(const ThisType& src) : BaseType(src)
+        { }
+
+    /** Constructor taking data from string, without copying if string buffer isn't already shared.
+     - See set(String&)
+     .
+     \param  src  Source string to take from, set to null
+    */
+    explicit SharedString(String& src)
+        { take(src).cstr(); }
+
+    /** Constructor copying string data.
+     \param  str  %String to copy, may be a terminated string
+    */
+    SharedString(const char* str)
+        { set(str); }
+
+    /** Assignment operator, shares data from source without copying.
+     \param  src  Source to share
+     \return      This
+    */
+    ThisType& operator=(const ThisType& src)
+        { ref(src); return *this; }
+
+#if defined(EVO_CPP11)
+    /** Move constructor taking data from string (C++11), without copying if string buffer isn't already shared.
+     \param  src  Source string to take from, set to null
+    */
+    SharedString(String&& src)
+        { take(src).cstr(); }
+
+    /** Move assignment operator taking data from string (C++11), without copying if string buffer isn't already shared.
+     \param  src  Source string to take from, set to null
+     \return      This
+    */
+    ThisType& operator=(String&& src)
+        { take(src).cstr(); return *this; }
+#endif
+
+    /** %Set as null.
+     \return  This
+    */
+    ThisType& set()
+        { free(); return *this; }
+
+    /** %Set by taking data from string, without copying if string buffer isn't already shared.
+     - String data is copied if it references external data or a buffer shared with another string
+     - This leaves `src` as null
+     .
+     \param  src  Source string to take from, set to null
+     \return      This
+    */
+    ThisType& set(String& src)
+        { take(src).cstr(); return *this; }
+
+    /** %Set as copy of string data.
+     \param  data  Data to copy
+     \param  size  Data size
+     \return       This
+    */
+    ThisType& set(const char* data, StrSizeT size)
+        { copy(data, size); shared_->list.cstr(); return *this; }
+
+    /** %Set as copy of string data.
+     \param  str  %String to copy
+     \return      This
+    */
+    ThisType& set(const StringBase& str) {
+        if (str.data_ == NULL)
+            free();
+        else
+            set(str.data_, str.size_);
+        return *this;
+    }
+
+    /** %Set as copy of terminated string.
+     \param  str  %String to copy, NULL to set as null
+     \return      This
+    */
+    ThisType& set(const char* str) {
+        if (str == NULL)
+            free();
+        else
+            set(str, (StrSizeT)strlen(str));
+        return *this;
+    }
+
+    /** Get terminated string pointer.
+     - This is always terminated so doesn't modify anything
+     .
+     \return  Terminated string pointer, empty string if null
+    */
+    const char* cstr() const
+        { return (shared_ == NULL || shared_->list.size() == 0 ? "" : shared_->list.data()); }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
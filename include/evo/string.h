@@ -217,8 +217,8 @@ struct StringFlt : public ListBase<char,StrSizeT> {
     */
     struct NumInfo {
         Size size;          ///< Buffer size required to format number (including PADDING), modified by format() to formatted size (excluding PADDING)
-        T    number;        ///< Normalized floating point number to format
-        int  exponent;      ///< Exponent for normalized floating point number to format
+        T    number;        ///< Floating point number to format (normalized if needed)
+        int  exponent;      ///< Exponent for normalized floating point number to format, if used
         int  precision;     ///< Precision to format
         bool terminated;    ///< Whether to add terminator
 
@@ -233,7 +233,7 @@ struct StringFlt : public ListBase<char,StrSizeT> {
          \return      Formatted data pointer (`ptr`)
         */
         char* format(char* ptr) {
-            const ulong len = impl::fnumf(ptr, number, exponent, precision);
+            const ulong len = impl::FloatFmt<T>::format(ptr, number, exponent, precision);
             if (terminated)
                 ptr[len] = '\0';
             assert( len < IntegerT<Size>::MAX );
@@ -302,16 +302,15 @@ struct StringFlt : public ListBase<char,StrSizeT> {
     char* set(T num, int precision=fPREC_AUTO, bool terminated=true, NumInfo* info=NULL) {
         ulong len;
         int exp = 0;
+        const int maxlen = impl::FloatFmt<T>::prepare(num, exp, precision);
         if (precision < 0) {
             // fPREC_AUTO
             data_ = buffer;
-            num = FloatT<T>::fexp10(exp, num);
-            len = impl::fnumfe(data_, num, exp, false);
+            len = impl::FloatFmt<T>::format(data_, num, exp, precision);
             assert( len <= (ulong)BUF_SIZE );
         } else {
             // Explicit precision may require allocating memory
-            num = FloatT<T>::fexp10(exp, impl::fnumf_weight(num, precision));
-            ulong maxsize = (ulong)FloatT<T>::maxdigits_prec(exp, precision) + PADDING;
+            ulong maxsize = (ulong)maxlen + PADDING;
             assert( maxsize > 0 );
             assert( maxsize < IntegerT<Size>::MAX );
             if (maxsize > (ulong)BUF_SIZE) {
@@ -333,7 +332,7 @@ struct StringFlt : public ListBase<char,StrSizeT> {
                 data_ = dbuffer_;
             } else
                 data_ = buffer;
-            len = impl::fnumf(data_, num, exp, precision);
+            len = impl::FloatFmt<T>::format(data_, num, exp, precision);
         }
         if (terminated) {
             assert( PADDING > 0 );    // Terminator requires padding > 0
@@ -2006,6 +2005,7 @@ public:
      - This searches for any one of the given characters
      - Search stops before reaching end index or end of string
      - Character at end index is not checked
+     - This uses SSE optimization when enabled -- see \ref CppCompilers
      .
      \param  chars  Characters to search for, must not contain multi-byte chars
      \param  count  Character count to search for
@@ -2024,10 +2024,9 @@ public:
                     return (Key)(ptr - data_);
             } else {
                 const char* pend = data_ + end;
-                const char* ptr  = data_ + start;
-                for (; ptr < pend; ++ptr)
-                    if (memchr(chars, *ptr, count) != NULL)
-                        return (Key)(ptr - data_);
+                const char* ptr  = impl::str_scan_any(data_ + start, pend, chars, count);
+                if (ptr < pend)
+                    return (Key)(ptr - data_);
             }
         }
         return NONE;
@@ -2050,6 +2049,7 @@ public:
      - This searches for any one of the given characters
      - This does a reverse search starting right before end index
      - Character at end index is not checked
+     - This uses SSE optimization when enabled -- see \ref CppCompilers
      .
      \param  chars  Characters to search for, must not contain multi-byte chars
      \param  count  Character count to search for
@@ -2064,10 +2064,9 @@ public:
             if (end > size_)
                 end = size_;
             const char* pstart = data_ + start;
-            const char* ptr    = data_ + end;
-            while (ptr > pstart)
-                if (memchr(chars, *--ptr, count) != NULL)
-                    return (Key)(ptr - data_);
+            const char* ptr    = impl::str_scan_any_r(pstart, data_ + end, chars, count);
+            if (ptr > pstart)
+                return (Key)(ptr - data_) - 1;
         }
         return NONE;
     }
@@ -2089,6 +2088,7 @@ public:
      - This searches for any character not in `chars`
      - Search stops before reaching end index or end of string
      - Character at end index is not checked
+     - This uses SSE optimization when enabled -- see \ref CppCompilers
      .
      \param  chars  Excluded characters, must not contain multi-byte chars
      \param  count  Excluded character count
@@ -2103,10 +2103,9 @@ public:
             if (end > size_)
                 end = size_;
             const char* pend = data_ + end;
-            const char* ptr  = data_ + start;
-            for (; ptr < pend; ++ptr)
-                if (memchr(chars, *ptr, count) == NULL)
-                    return (Key)(ptr - data_);
+            const char* ptr  = impl::str_scan_anybut(data_ + start, pend, chars, count);
+            if (ptr < pend)
+                return (Key)(ptr - data_);
         }
         return NONE;
     }
@@ -2128,6 +2127,7 @@ public:
      - This searches for any character not in `chars`
      - This does a reverse search starting right before end index
      - Character at end index is not checked
+     - This uses SSE optimization when enabled -- see \ref CppCompilers
      .
      \param  chars  Excluded characters, must not contain multi-byte chars
      \param  count  Excluded character count
@@ -2142,10 +2142,9 @@ public:
             if (count == 0)
                 return end - 1;
             const char* pstart = data_ + start;
-            const char* ptr    = data_ + end;
-            while (ptr > pstart)
-                if (memchr(chars, *--ptr, count) == NULL)
-                    return (Key)(ptr - data_);
+            const char* ptr    = impl::str_scan_anybut_r(pstart, data_ + end, chars, count);
+            if (ptr > pstart)
+                return (Key)(ptr - data_) - 1;
         }
         return NONE;
     }
@@ -4457,15 +4456,8 @@ public:
         }
     #else
         int exp = 0;
-        if (precision < 0) {
-            num = FloatT<TNum>::fexp10(exp, num);
-            reserve(FloatT<TNum>::MAXDIGITS_AUTO + 1);
-            len = impl::fnumfe(data_ + size_, num, exp, false);
-        } else {
-            num = FloatT<TNum>::fexp10(exp, impl::fnumf_weight(num, precision));
-            reserve(FloatT<TNum>::maxdigits_prec(exp, precision) + 1);
-            len = impl::fnumf(data_ + size_, num, exp, precision);
-        }
+        reserve(impl::FloatFmt<TNum>::prepare(num, exp, precision) + 1);
+        len = impl::FloatFmt<TNum>::format(data_ + size_, num, exp, precision);
     #endif
         buf_.header->used += len;
         size_             += len;
@@ -5031,6 +5023,12 @@ public:
     String& unshare()
         { ListType::unshare(); return *this; }
 
+#if EVO_ALLOCATORS || defined(DOXYGEN)
+    /** \copydoc ListType::set_allocator() */
+    String& set_allocator(Allocator* allocator)
+        { ListType::set_allocator(allocator); return *this; }
+#endif
+
     /** \copydoc ListType::resize(Size) */
     String& resize(Size size)
         { ListType::resize(size); return *this; }
@@ -5147,15 +5145,8 @@ private:
         }
     #else
         int exp = 0;
-        if (precision < 0) {
-            num = FloatT<T>::fexp10(exp, num);
-            clear().capacitymin(FloatT<T>::MAXDIGITS_AUTO).unshare();
-            len = impl::fnumfe(data_, num, exp, false);
-        } else {
-            num = FloatT<T>::fexp10(exp, impl::fnumf_weight(num, precision));
-            clear().capacitymin(FloatT<T>::maxdigits_prec(exp, precision)).unshare();
-            len = impl::fnumf(data_, num, exp, precision);
-        }
+        clear().capacitymin(impl::FloatFmt<T>::prepare(num, exp, precision)).unshare();
+        len = impl::FloatFmt<T>::format(data_, num, exp, precision);
     #endif
         buf_.header->used += len;
         size_             += len;
@@ -5371,6 +5362,10 @@ template<> struct Convert<String,FloatL> : public Convert_StringToCFltBase<Float
 */
 typedef String::ListBaseType StringBase;
 
+/** \cond impl */
+template<class H> struct DataHash<String,H,false> : public impl::DataHashList<String,char,H> { };
+/** \endcond */
+
 ///////////////////////////////////////////////////////////////////////////////
 //@}
 }
@@ -0,0 +1,422 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file stringpool.h Evo StringPool and InternedString, for interning strings. */
+#pragma once
+#ifndef INCL_evo_stringpool_h
+#define INCL_evo_stringpool_h
+
+#include "string.h"
+#include "thread.h"
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** \cond impl */
+namespace impl {
+    // Interned string, allocated with string data following, never modified or freed until pool is destroyed
+    struct StringPoolEntry {
+        String str;         // References string data following this, copying doesn't use a reference count
+        ulong  hash;        // String hash, from String::hash()
+        uint   id;          // Entry id, index in pool
+    };
+}
+/** \endcond */
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** Interned string from a StringPool.
+ - This is a lightweight handle (pointer) to a string in a StringPool, copying is very fast
+ - Interned strings are compared by id, which is constant time (O(1)) -- see StringPool for details
+   - Ordering by compare() is by id (interning order) and not alphabetical
+   - Only compare interned strings from the same pool
+ - hash() returns the string hash computed when interned, so hashing is also constant time
+ - This works as a key in hash containers like MapHash and SetHash
+ - This is only valid while the StringPool it came from exists
+ .
+*/
+class InternedString {
+public:
+    typedef InternedString ThisType;    ///< This type
+    typedef uint Id;                    ///< Interned string id type
+
+    /** Default constructor sets as null. */
+    InternedString() : entry_(NULL)
+        { }
+
+    /** Copy constructor.
+     \param  src  Source to copy
+    */
+    InternedString(const ThisType& src) : entry_(src.entry_)
+        { }
+
+    /** Assignment operator.
+     \param  src  Source to copy
+     \return      This
+    */
+    ThisType& operator=(const ThisType& src)
+        { entry_ = src.entry_; return *this; }
+
+    /** %Set as null.
+     \return  This
+    */
+    ThisType& set()
+        { entry_ = NULL; return *this; }
+
+    /** Get whether null.
+     \return  Whether null
+    */
+    bool null() const
+        { return (entry_ == NULL); }
+
+    /** Get interned string id.
+     - Ids are assigned in interning order, starting from 0
+     .
+     \return  Interned string id, NONE if null
+    */
+    Id id() const
+        { return (entry_ == NULL ? (Id)NONE : entry_->id); }
+
+    /** Get interned string.
+     - The returned string references pool memory, so copying it doesn't allocate or use a reference count and is safe from multiple threads
+     - A copy is valid while the pool exists, modifying a copy makes a new unshared buffer
+     .
+     \return  Interned string, null if this is null
+    */
+    const String& str() const
+        { return (entry_ == NULL ? null_str() : entry_->str); }
+
+    /** Get interned string as terminated string pointer.
+     \return  Terminated string pointer, empty string if null or empty
+    */
+    const char* cstr() const
+        { return (entry_ == NULL || entry_->str.size() == 0 ? "" : entry_->str.data()); }
+
+    /** Get string hash value.
+     - This uses the hash computed when the string was interned, with seed 0 this is the same as String::hash()
+     .
+     \param  seed  Seed value for hashing multiple values, 0 if none
+     \return       Hash value
+    */
+    ulong hash(ulong seed=0) const {
+        const ulong hashval = (entry_ == NULL ? 0 : entry_->hash);
+        return (seed == 0 ? hashval : DataHash<ulong>::hash(hashval, seed));
+    }
+
+    /** Comparison by id.
+     - Null is less than non-null
+     .
+     \param  src  Interned string to compare to, must be from the same pool
+     \return      Result (<0 if this is less, 0 if equal, >0 if this is greater)
+    */
+    int compare(const ThisType& src) const {
+        if (entry_ == src.entry_)
+            return 0;
+        else if (entry_ == NULL)
+            return -1;
+        else if (src.entry_ == NULL)
+            return 1;
+        return (entry_->id < src.entry_->id ? -1 : 1);
+    }
+
+    /** Equality operator.
+     \param  src  Interned string to compare to
+     \return      Whether equal
+    */
+    bool operator==(const ThisType& src) const
+        { return (entry_ == src.entry_); }
+
+    /** Inequality operator.
+     \param  src  Interned string to compare to
+     \return      Whether not equal
+    */
+    bool operator!=(const ThisType& src) const
+        { return (entry_ != src.entry_); }
+
+    /** Less-than operator, compares by id.
+     \param  src  Interned string to compare to, must be from the same pool
+     \return      Whether this is less than src
+    */
+    bool operator<(const ThisType& src) const
+        { return (compare(src) < 0); }
+
+private:
+    friend class StringPool;
+
+    const impl::StringPoolEntry* entry_;
+
+    InternedString(const impl::StringPoolEntry* entry) : entry_(entry)
+        { }
+
+    static const String& null_str() {
+        static const String NULL_STR;
+        return NULL_STR;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** %String interning pool, maps strings to stable ids and shared interned strings.
+ - Interning a string returns an InternedString with a stable id and a copy of the string owned by the pool
+   - Interning the same string again returns the same InternedString
+   - Ids are assigned in interning order, starting from 0
+   - Interned strings are never removed, they are freed when the pool is destroyed
+ - Strings are hashed once with SpookyHash (via String::hash()) and looked up in an open addressing hash table with linear probing
+ - Thread safe:
+   - Lookups are lock free: find(), get(), and intern() when the string is already interned
+   - Adding a new string with intern() uses a mutex, concurrent lookups are not blocked
+   - When the hash table grows the old table is kept until the pool is destroyed, since concurrent lookups may still be using it -- this uses at most the same memory as the current table
+ - Useful for a small set of frequently used strings, like keys, command names, and categories -- this isn't meant for an unbounded set of strings
+ .
+
+\par Example
+
+\code
+#include <evo/stringpool.h>
+#include <evo/maphash.h>
+using namespace evo;
+
+int main() {
+    StringPool pool;
+
+    // Intern strings
+    InternedString get = pool.intern("get");
+    InternedString set = pool.intern("set");
+    InternedString get2 = pool.intern(SubString("get_key", 3));  // same as get
+
+    // Compare by id
+    bool same = (get == get2);  // true
+
+    // Use as map key, compared by id
+    MapHash<InternedString,int> map;
+    map[get] = 1;
+    map[set] = 2;
+
+    // Lookup without adding
+    InternedString found = pool.find("set");
+    int value = map[found];     // 2
+
+    return 0;
+}
+\endcode
+*/
+class StringPool {
+public:
+    typedef InternedString::Id Id;      ///< Interned string id type
+    typedef SizeT Size;                 ///< Size type
+
+    static const Size DEFAULT_CAPACITY = 64;    ///< Default initial capacity
+
+    /** Constructor.
+     \param  capacity  Initial capacity as string count, rounded up to a power of 2
+    */
+    StringPool(Size capacity=DEFAULT_CAPACITY) : retired_(NULL) {
+        count_.store(0, EVO_ATOMIC_RELAXED);
+        table_.store(impl_table_new(capacity < 2 ? 2 : size_pow2(capacity)), EVO_ATOMIC_RELEASE);
+    }
+
+    /** Destructor, frees all interned strings. */
+    ~StringPool() {
+        Table* table = table_.load(EVO_ATOMIC_ACQUIRE);
+        const Size count = count_.load(EVO_ATOMIC_ACQUIRE);
+        for (Size i = 0; i < count; ++i)
+            impl_entry_free(table->ids[i]);
+        impl_table_free(table);
+        while (retired_ != NULL) {
+            table = retired_;
+            retired_ = table->prev;
+            impl_table_free(table);
+        }
+    }
+
+    /** Get number of interned strings.
+     \return  Interned string count
+    */
+    Size size() const
+        { return count_.load(EVO_ATOMIC_ACQUIRE); }
+
+    /** Get whether pool is empty.
+     \return  Whether empty
+    */
+    bool empty() const
+        { return (count_.load(EVO_ATOMIC_ACQUIRE) == 0); }
+
+    /** Find interned string, lock free.
+     \param  str  %String to find
+     \return      Interned string, null if not found
+    */
+    InternedString find(const StringBase& str) const
+        { return InternedString(impl_find(table_.load(EVO_ATOMIC_ACQUIRE), str.data_, str.size_, DataHash<char>::hash(str.data_, str.size_))); }
+
+    /** Find interned string, lock free.
+     \param  str   %String pointer to find
+     \param  size  %String size as character count
+     \return       Interned string, null if not found
+    */
+    InternedString find(const char* str, StrSizeT size) const
+        { return InternedString(impl_find(table_.load(EVO_ATOMIC_ACQUIRE), str, size, DataHash<char>::hash(str, size))); }
+
+    /** Find interned string, lock free.
+     \param  str  %String to find, must be terminated
+     \return      Interned string, null if not found
+    */
+    InternedString find(const char* str) const
+        { return find(str, (str == NULL ? 0 : (StrSizeT)strlen(str))); }
+
+    /** Get interned string by id, lock free.
+     \param  id  Interned string id
+     \return     Interned string, null if not found
+    */
+    InternedString get(Id id) const {
+        // Load count before table, ids below count are always in the table loaded after it
+        if ((Size)id >= count_.load(EVO_ATOMIC_ACQUIRE))
+            return InternedString();
+        return InternedString(table_.load(EVO_ATOMIC_ACQUIRE)->ids[id]);
+    }
+
+    /** Intern string, adding if needed.
+     - This is lock free if the string is already interned, otherwise this locks a mutex to add it
+     .
+     \param  str  %String to intern
+     \return      Interned string
+    */
+    InternedString intern(const StringBase& str)
+        { return intern(str.data_, str.size_); }
+
+    /** Intern string, adding if needed.
+     - This is lock free if the string is already interned, otherwise this locks a mutex to add it
+     .
+     \param  str   %String pointer to intern, may be NULL if size is 0
+     \param  size  %String size as character count
+     \return       Interned string
+    */
+    InternedString intern(const char* str, StrSizeT size) {
+        const ulong hash = DataHash<char>::hash(str, size);
+        const Entry* entry = impl_find(table_.load(EVO_ATOMIC_ACQUIRE), str, size, hash);
+        if (entry == NULL) {
+            Mutex::Lock lock(mutex_);
+            Table* table = table_.load(EVO_ATOMIC_ACQUIRE);
+            entry = impl_find(table, str, size, hash);
+            if (entry == NULL) {
+                const Size count = count_.load(EVO_ATOMIC_RELAXED);
+                if (count >= table->capacity)
+                    table = impl_grow(table, count);
+
+                Entry* new_entry = impl_entry_new(str, size, hash, (Id)count);
+                table->ids[count] = new_entry;
+                count_.store(count + 1, EVO_ATOMIC_RELEASE);
+
+                Size i = (Size)hash & table->mask;
+                while (table->slots[i].load(EVO_ATOMIC_RELAXED) != NULL)
+                    i = (i + 1) & table->mask;
+                table->slots[i].store(new_entry, EVO_ATOMIC_RELEASE);
+                entry = new_entry;
+            }
+        }
+        return InternedString(entry);
+    }
+
+    /** Intern string, adding if needed.
+     - This is lock free if the string is already interned, otherwise this locks a mutex to add it
+     .
+     \param  str  %String to intern, must be terminated
+     \return      Interned string
+    */
+    InternedString intern(const char* str)
+        { return intern(str, (str == NULL ? 0 : (StrSizeT)strlen(str))); }
+
+private:
+    typedef impl::StringPoolEntry Entry;
+
+    // Hash table with 2 slots per capacity, and ids array -- replaced (not modified) when growing
+    struct Table {
+        Size           capacity;    // Max entries, ids array size
+        Size           mask;        // Mask for slot index, slot count is capacity * 2
+        Atomic<Entry*>* slots;      // Slots for open addressing hash table, NULL for empty slot
+        Entry**        ids;         // Entries by id
+        Table*         prev;        // Next retired table
+    };
+
+    Atomic<Table*> table_;      // Current table
+    AtomicULong    count_;      // Entry count, next id
+    Table*         retired_;    // Retired tables, freed by destructor
+    Mutex          mutex_;      // Locked to add entries
+
+    // Disable copying
+    StringPool(const StringPool&);
+    StringPool& operator=(const StringPool&);
+
+    static const Entry* impl_find(const Table* table, const char* str, StrSizeT size, ulong hash) {
+        for (Size i = (Size)hash & table->mask;; i = (i + 1) & table->mask) {
+            const Entry* entry = table->slots[i].load(EVO_ATOMIC_ACQUIRE);
+            if (entry == NULL)
+                return NULL;
+            if (entry->hash == hash && entry->str.size() == size && (size == 0 || memcmp(entry->str.data(), str, size) == 0))
+                return entry;
+        }
+    }
+
+    Table* impl_grow(Table* table, Size count) {
+        Table* new_table = impl_table_new(table->capacity * 2);
+        for (Size i = 0; i < count; ++i) {
+            Entry* entry = table->ids[i];
+            new_table->ids[i] = entry;
+            Size j = (Size)entry->hash & new_table->mask;
+            while (new_table->slots[j].load(EVO_ATOMIC_RELAXED) != NULL)
+                j = (j + 1) & new_table->mask;
+            new_table->slots[j].store(entry, EVO_ATOMIC_RELAXED);
+        }
+        table_.store(new_table, EVO_ATOMIC_RELEASE);
+        table->prev = retired_;
+        retired_ = table;
+        return new_table;
+    }
+
+    static Table* impl_table_new(Size capacity) {
+        const Size slot_count = capacity * 2;
+        Table* table = new Table;
+        table->capacity = capacity;
+        table->mask     = slot_count - 1;
+        table->slots    = new Atomic<Entry*>[slot_count];
+        table->ids      = new Entry*[capacity];
+        table->prev     = NULL;
+        for (Size i = 0; i < slot_count; ++i)
+            table->slots[i].store(NULL, EVO_ATOMIC_RELAXED);
+        return table;
+    }
+
+    static void impl_table_free(Table* table) {
+        delete [] table->slots;
+        delete [] table->ids;
+        delete table;
+    }
+
+    static Entry* impl_entry_new(const char* str, StrSizeT size, ulong hash, Id id) {
+        char* buf = new char[sizeof(Entry) + size + 1];
+        char* data = buf + sizeof(Entry);
+        if (size > 0)
+            memcpy(data, str, size);
+        data[size] = '\0';
+
+        Entry* entry = new(buf) Entry;
+        entry->str.set(data, size);
+        entry->hash = hash;
+        entry->id   = id;
+        return entry;
+    }
+
+    static void impl_entry_free(Entry* entry) {
+        entry->~Entry();
+        delete [] (char*)entry;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
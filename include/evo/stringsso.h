@@ -0,0 +1,621 @@
+// Evo C++ Library
+/* Copyright 2019 Justin Crowell
+Distributed under the BSD 2-Clause License -- see included file LICENSE.txt for details.
+*/
+///////////////////////////////////////////////////////////////////////////////
+/** \file stringsso.h Evo StringSSO, string with inline storage for short strings. */
+#pragma once
+#ifndef INCL_evo_stringsso_h
+#define INCL_evo_stringsso_h
+
+#include "string.h"
+#include "substring.h"
+
+namespace evo {
+/** \addtogroup EvoContainers */
+//@{
+
+///////////////////////////////////////////////////////////////////////////////
+
+/** %String container with Short String Optimization (SSO).
+ - Strings up to INLINE_SIZE characters are stored inline in this object, with no memory allocation
+ - Larger strings are stored in a String buffer, which is shared (copy-on-write) like String -- see \ref Sharing "Sharing"
+   - Copying a large StringSSO, or setting from a large String, makes a shared copy
+   - A string that shrinks to fit inline stays in the String buffer until set again
+ - Data is always owned, set(const char*,Size) and similar always copy (unlike String, which references the pointer)
+ - This converts to SubString so it works anywhere a `const StringBase&` is accepted -- including StrTok and String::set()
+   - The SubString references this string data, and is invalidated when this is modified or destroyed
+ - This doesn't store a pointer to its own inline data, so it's relocatable and may be used as an item in Evo containers
+ - Use get(String&) const to set a String without copying a large string
+ - Inline data is always terminated, use cstr() to terminate a large string
+ .
+
+\tparam  N  Minimum inline capacity as character count, actual capacity (INLINE_SIZE) may be larger to use all available space for the String buffer
+
+C++11:
+ - Move semantics
+
+\par Example
+
+\code
+#include <evo/stringsso.h>
+using namespace evo;
+
+int main() {
+    // Short strings are stored inline, no memory allocation
+    StringSSO<> key, val;
+    SubString("key=value").split('=', key, val);
+
+    // Large strings are shared with String
+    StringSSO<> str;
+    str << "A string that is too long to store inline";
+    String str2;
+    str.get(str2);
+
+    return 0;
+}
+\endcode
+*/
+template<StrSizeT N=23>
+class StringSSO {
+public:
+    typedef StringSSO<N>    ThisType;       ///< This type
+    typedef StrSizeT        Size;           ///< Size type
+    typedef StrSizeT        Key;            ///< Key type (item index)
+    typedef char            Item;           ///< Item type
+
+    /** Inline capacity as character count, not including terminator. */
+    static const Size INLINE_SIZE = (N >= sizeof(String) ? N : (Size)sizeof(String) - 1);
+
+    /** Default constructor sets as null. */
+    StringSSO() : size_(0), state_(sNULL)
+        { }
+
+    /** Copy constructor.
+     - Makes shared copy if data isn't inline
+     .
+     \param  src  Source to copy
+    */
+    StringSSO(const ThisType& src) : size_(0), state_(sNULL)
+        { set(src); }
+
+    /** Constructor to copy from a String.
+     - Makes shared copy if too large to store inline
+     .
+     \param  str  %String to copy
+    */
+    StringSSO(const String& str) : size_(0), state_(sNULL)
+        { set(str); }
+
+    /** Constructor to copy substring data.
+     \param  str  %String to copy
+    */
+    StringSSO(const StringBase& str) : size_(0), state_(sNULL)
+        { set(str); }
+
+    /** Constructor to copy string data.
+     \param  str   %String pointer to copy from, NULL to set as null
+     \param  size  %String size as character count
+    */
+    StringSSO(const char* str, Size size) : size_(0), state_(sNULL)
+        { set(str, size); }
+
+    /** Constructor to copy terminated string.
+     \param  str  %String to copy, must be terminated, NULL to set as null
+    */
+    StringSSO(const char* str) : size_(0), state_(sNULL)
+        { set(str); }
+
+    /** Destructor. */
+    ~StringSSO()
+        { impl_free_heap(); }
+
+#if defined(EVO_CPP11)
+    /** Move constructor (C++11).
+     \param  src  Source to move, set as null
+    */
+    StringSSO(ThisType&& src) : size_(0), state_(sNULL)
+        { impl_move(src); }
+
+    /** Move constructor from String (C++11).
+     - Takes the String buffer if too large to store inline
+     .
+     \param  str  %String to move, set as null
+    */
+    StringSSO(String&& str) : size_(0), state_(sNULL)
+        { impl_move(str); }
+
+    /** Move assignment operator (C++11).
+     \param  src  Source to move, set as null
+     \return      This
+    */
+    ThisType& operator=(ThisType&& src) {
+        if (this != &src) {
+            impl_clear();
+            impl_move(src);
+        }
+        return *this;
+    }
+
+    /** Move assignment operator from String (C++11).
+     - Takes the String buffer if too large to store inline
+     .
+     \param  str  %String to move, set as null
+     \return      This
+    */
+    ThisType& operator=(String&& str)
+        { impl_clear(); impl_move(str); return *this; }
+#endif
+
+    /** Assignment operator.
+     - Makes shared copy if data isn't inline
+     .
+     \param  src  Source to copy
+     \return      This
+    */
+    ThisType& operator=(const ThisType& src)
+        { return set(src); }
+
+    /** Assignment operator to copy from a String.
+     - Makes shared copy if too large to store inline
+     .
+     \param  str  %String to copy
+     \return      This
+    */
+    ThisType& operator=(const String& str)
+        { return set(str); }
+
+    /** Assignment operator to copy substring data.
+     \param  str  %String to copy
+     \return      This
+    */
+    ThisType& operator=(const StringBase& str)
+        { return set(str); }
+
+    /** Assignment operator to copy terminated string.
+     \param  str  %String to copy, must be terminated, NULL to set as null
+     \return      This
+    */
+    ThisType& operator=(const char* str)
+        { return set(str); }
+
+    // SET
+
+    /** %Set as null.
+     \return  This
+    */
+    ThisType& set()
+        { impl_clear(); return *this; }
+
+    /** %Set from another string.
+     - Makes shared copy if data isn't inline
+     .
+     \param  src  Source to copy
+     \return      This
+    */
+    ThisType& set(const ThisType& src) {
+        if (this != &src) {
+            if (src.state_ == sHEAP)
+                set(src.impl_heap());
+            else
+                set(src.impl_data(), src.size_);
+        }
+        return *this;
+    }
+
+    /** %Set from a String.
+     - Makes shared copy if too large to store inline
+     .
+     \param  str  %String to copy
+     \return      This
+    */
+    ThisType& set(const String& str) {
+        if (str.size() > INLINE_SIZE) {
+            if (state_ == sHEAP)
+                impl_heap().set(str);
+            else {
+                new(storage_.heap) String(str);
+                state_ = sHEAP;
+            }
+        } else
+            set(str.data(), str.size());
+        return *this;
+    }
+
+    /** %Set as copy of substring data.
+     \param  str  %String to copy
+     \return      This
+    */
+    ThisType& set(const StringBase& str)
+        { return set(str.data_, str.size_); }
+
+    /** %Set as copy of substring data.
+     - This is used by SubString::split() and similar methods
+     .
+     \param  str    %String to copy
+     \param  index  Start index of substring data, END to set as empty
+     \param  size   Data size as item count, ALL for all from index
+     \return        This
+    */
+    ThisType& set(const StringBase& str, Key index, Key size=ALL) {
+        if (str.data_ == NULL)
+            impl_clear();
+        else if (index >= str.size_)
+            set(str.data_, 0);
+        else {
+            const Size max_size = str.size_ - index;
+            set(str.data_ + index, (size > max_size ? max_size : size));
+        }
+        return *this;
+    }
+
+    /** %Set as copy of string data.
+     \param  str   %String pointer to copy from, NULL to set as null
+     \param  size  %String size as character count
+     \return       This
+    */
+    ThisType& set(const char* str, Size size) {
+        if (str == NULL) {
+            impl_clear();
+        } else if (size <= INLINE_SIZE) {
+            if (state_ == sHEAP) {
+                // Copy first in case str references heap data
+                char buf[INLINE_SIZE];
+                memcpy(buf, str, size);
+                impl_free_heap();
+                memcpy(storage_.buf, buf, size);
+            } else
+                memmove(storage_.buf, str, size);
+            storage_.buf[size] = '\0';
+            size_  = size;
+            state_ = sINLINE;
+        } else {
+            if (state_ == sHEAP) {
+                String& heap = impl_heap();
+                if (str >= heap.data() && str < heap.data() + heap.size()) {
+                    // Copy from own heap data
+                    String tmp;
+                    tmp.copy(str, size);
+                    heap.swap(tmp);
+                } else
+                    heap.copy(str, size);
+            } else {
+                (new(storage_.heap) String)->copy(str, size);
+                state_ = sHEAP;
+            }
+        }
+        return *this;
+    }
+
+    /** %Set as copy of terminated string.
+     \param  str  %String to copy, must be terminated, NULL to set as null
+     \return      This
+    */
+    ThisType& set(const char* str)
+        { return (str == NULL ? set() : set(str, (Size)strlen(str))); }
+
+    /** Clear by removing all characters.
+     - String will be empty (not null) after this
+     .
+     \return  This
+    */
+    ThisType& clear() {
+        if (state_ == sHEAP)
+            impl_heap().clear();
+        else {
+            storage_.buf[0] = '\0';
+            size_  = 0;
+            state_ = sINLINE;
+        }
+        return *this;
+    }
+
+    // INFO
+
+    /** Get whether null.
+     \return  Whether null
+    */
+    bool null() const
+        { return (state_ == sNULL); }
+
+    /** Get whether empty.
+     \return  Whether empty (or null)
+    */
+    bool empty() const
+        { return (size() == 0); }
+
+    /** Get size.
+     \return  Size as character count
+    */
+    Size size() const
+        { return (state_ == sHEAP ? impl_heap().size() : size_); }
+
+    /** Get whether data is stored inline.
+     \return  Whether inline, false if null or using a String buffer
+    */
+    bool inlined() const
+        { return (state_ == sINLINE); }
+
+    /** Get data pointer (const).
+     - \b Caution: Large string data may not be terminated, use cstr() to get terminated string
+     .
+     \return  Data pointer, NULL if null
+    */
+    const char* data() const
+        { return impl_data(); }
+
+    /** Get terminated string pointer.
+     - This terminates a large string, inline data is always terminated
+     .
+     \return  Terminated string pointer, empty string if null
+    */
+    const char* cstr() {
+        switch (state_) {
+            case sINLINE: return storage_.buf;
+            case sHEAP:   return impl_heap().cstr();
+            default:      break;
+        }
+        return "";
+    }
+
+    /** Get character at position (const).
+     \param  index  Character index, must be less than size()
+     \return        Character at index
+    */
+    const char& operator[](Key index) const {
+        assert( index < size() );
+        return impl_data()[index];
+    }
+
+    /** Get data as String.
+     - This makes a shared copy if data isn't inline, otherwise a new buffer is allocated
+     .
+     \param  str  %String to set [out]
+     \return      str
+    */
+    String& get(String& str) const {
+        switch (state_) {
+            case sINLINE: str.copy(storage_.buf, size_); break;
+            case sHEAP:   str.set(impl_heap());          break;
+            default:      str.set();                     break;
+        }
+        return str;
+    }
+
+    /** Get data as SubString.
+     - This is also used to implicitly convert to `const StringBase&`
+     - The result references this string data, and is invalidated when this is modified or destroyed
+     .
+     \return  %SubString referencing this data, null if this is null
+    */
+    SubString sub() const
+        { return SubString(impl_data(), size()); }
+
+    /** Conversion to SubString.
+     - This allows passing to any `const StringBase&` parameter -- see sub()
+     .
+     \return  %SubString referencing this data, null if this is null
+    */
+    operator SubString() const
+        { return sub(); }
+
+    /** Get data hash value.
+     \param  seed  Seed value for hashing multiple values, 0 if none
+     \return       Hash value
+    */
+    ulong hash(ulong seed=0) const
+        { return DataHash<char>::hash(impl_data(), size(), seed); }
+
+    // COMPARE
+
+    /** Comparison.
+     \param  str  %String to compare to
+     \return      Result (<0 if this is less, 0 if equal, >0 if this is greater)
+    */
+    int compare(const StringBase& str) const {
+        const char* data = impl_data();
+        int result;
+        if (data == NULL)
+            result = (str.data_ == NULL ? 0 : -1);
+        else if (str.data_ == NULL)
+            result = 1;
+        else
+            result = DataCompare<char>::compare(data, size(), str.data_, str.size_);
+        return result;
+    }
+
+    /** Equality operator.
+     \param  str  %String to compare to
+     \return      Whether equal
+    */
+    bool operator==(const StringBase& str) const {
+        const char* data = impl_data();
+        if (data == NULL || str.data_ == NULL)
+            return (data == str.data_);
+        const Size size = this->size();
+        return (size == str.size_ && (data == str.data_ || memcmp(data, str.data_, size) == 0));
+    }
+
+    /** Equality operator.
+     \param  str  %String to compare to, must be terminated
+     \return      Whether equal
+    */
+    bool operator==(const char* str) const {
+        const char* data = impl_data();
+        if (data == NULL || str == NULL)
+            return (data == str);
+        const size_t len = strlen(str);
+        return (size() == len && memcmp(data, str, len) == 0);
+    }
+
+    /** Inequality operator.
+     \param  str  %String to compare to
+     \return      Whether not equal
+    */
+    bool operator!=(const StringBase& str) const
+        { return !(*this == str); }
+
+    /** Inequality operator.
+     \param  str  %String to compare to, must be terminated
+     \return      Whether not equal
+    */
+    bool operator!=(const char* str) const
+        { return !(*this == str); }
+
+    /** Less-than operator.
+     \param  str  %String to compare to
+     \return      Whether this is less than str
+    */
+    bool operator<(const StringBase& str) const
+        { return (compare(str) < 0); }
+
+    // ADD
+
+    /** Append character.
+     \param  ch  Character to append
+     \return     This
+    */
+    ThisType& add(char ch)
+        { return add(&ch, 1); }
+
+    /** Append string data.
+     - This moves to a String buffer if the result is too large to store inline
+     .
+     \param  str   %String pointer to append, must not be NULL if size is non-zero
+     \param  size  %String size as character count
+     \return       This
+    */
+    ThisType& add(const char* str, Size size) {
+        if (state_ == sHEAP)
+            impl_heap().add(str, size);
+        else {
+            const Size new_size = size_ + size;
+            if (new_size <= INLINE_SIZE) {
+                if (size > 0)
+                    memmove(storage_.buf + size_, str, size);
+                storage_.buf[new_size] = '\0';
+                size_  = new_size;
+                state_ = sINLINE;
+            } else {
+                // Move to String buffer, str may reference inline data so copy before constructing in its place
+                String tmp;
+                tmp.reserve(new_size);
+                tmp.add(storage_.buf, size_);
+                tmp.add(str, size);
+                new(storage_.heap) String;
+                impl_heap().swap(tmp);
+                state_ = sHEAP;
+            }
+        }
+        return *this;
+    }
+
+    /** Append substring data.
+     \param  str  %String to append
+     \return      This
+    */
+    ThisType& add(const StringBase& str)
+        { return add(str.data_, str.size_); }
+
+    /** Append terminated string.
+     \param  str  %String to append, must be terminated, ignored if NULL
+     \return      This
+    */
+    ThisType& add(const char* str)
+        { return (str == NULL ? *this : add(str, (Size)strlen(str))); }
+
+    /** Append operator.
+     \param  ch  Character to append
+     \return     This
+    */
+    ThisType& operator<<(char ch)
+        { return add(&ch, 1); }
+
+    /** Append operator.
+     \param  str  %String to append
+     \return      This
+    */
+    ThisType& operator<<(const StringBase& str)
+        { return add(str.data_, str.size_); }
+
+    /** Append operator.
+     \param  str  %String to append, must be terminated, ignored if NULL
+     \return      This
+    */
+    ThisType& operator<<(const char* str)
+        { return add(str); }
+
+private:
+    union Storage {
+        char   buf[INLINE_SIZE + 1];    // Inline data, always terminated
+        char   heap[sizeof(String)];    // String buffer constructed with placement new
+        void*  align_ptr;
+        ulongl align_num;
+    };
+
+    // State: null, inline (data in storage_.buf), or heap (String constructed in storage_.heap)
+    // -- the data pointer is derived from this on each access, so there's no pointer to this instance and it stays relocatable
+    enum State {
+        sNULL = 0,
+        sINLINE,
+        sHEAP
+    };
+
+    Storage storage_;
+    Size    size_;      // Inline data size, 0 if null and not used with heap
+    uchar   state_;     // State value
+
+    const char* impl_data() const {
+        switch (state_) {
+            case sINLINE: return storage_.buf;
+            case sHEAP:   return impl_heap().data();
+            default:      break;
+        }
+        return NULL;
+    }
+
+    String& impl_heap()
+        { return *(String*)storage_.heap; }
+
+    const String& impl_heap() const
+        { return *(const String*)storage_.heap; }
+
+    void impl_free_heap() {
+        if (state_ == sHEAP) {
+            impl_heap().~String();
+            state_ = sNULL;
+        }
+    }
+
+    void impl_clear() {
+        impl_free_heap();
+        size_  = 0;
+        state_ = sNULL;
+    }
+
+#if defined(EVO_CPP11)
+    void impl_move(ThisType& src) {
+        if (src.state_ == sHEAP) {
+            new(storage_.heap) String(std::move(src.impl_heap()));
+            state_ = sHEAP;
+        } else
+            set(src.impl_data(), src.size_);
+        src.impl_clear();
+    }
+
+    void impl_move(String& str) {
+        if (str.size() > INLINE_SIZE) {
+            new(storage_.heap) String(std::move(str));
+            state_ = sHEAP;
+        } else {
+            set(str.data(), str.size());
+            str.set();
+        }
+    }
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+//@}
+}
+#endif
@@ -88,23 +88,13 @@ namespace impl {
         return end;
     }
 
-    // Scan to next delim
-    inline const char* str_scan_delim_default(const char* str, const char* end, const char* delims, uint delim_count) {
-        for (; str < end; ++str)
-            if (::memchr(delims, *str, delim_count) != NULL)
-                break;
-        return str;
-    }
+    // Scan to next delim, uses character set lookup table (see StrCharSet)
+    inline const char* str_scan_delim_default(const char* str, const char* end, const char* delims, uint delim_count)
+        { return str_scan_any(str, end, delims, delim_count); }
 
-    // Scan to next delim in reverse, return new end
-    inline const char* str_scan_delim_default_r(const char* str, const char* end, const char* delims, uint delim_count) {
-        while (str < end) {
-            --end;
-            if (::memchr(delims, *end, delim_count) != NULL)
-                return end + 1;
-        }
-        return end;
-    }
+    // Scan to next delim in reverse, return new end, uses character set lookup table (see StrCharSet)
+    inline const char* str_scan_delim_default_r(const char* str, const char* end, const char* delims, uint delim_count)
+        { return str_scan_any_r(str, end, delims, delim_count); }
 
 #if defined(EVO_CPU)
     static const size_t SSE_BATCH_SIZE = 16;
@@ -338,90 +328,6 @@ namespace impl {
         return end;
     }
 
-    // Scan to next delim -- min 1 delim, max 16 delims
-    inline const char* str_scan_delim_cpu(const char* str, const char* end, const char* delims, uint delim_count) {
-        assert( delim_count > 1 );
-        assert( delim_count <= SSE_BATCH_SIZE );
-        if (str < end) {
-            // Scan up to alignment boundary
-            const char* align16 = (char*)( ((size_t)str + SSE_ALIGN16) & SSE_ALIGN16_MASK );
-            while (str < align16)
-                if (::memchr(delims, *str, delim_count) != NULL || ++str == end)
-                    return str;
-
-            // Scan in chunks of batch size using SSE 4.2 instruction: pcmpistri
-            align16 = (char*)((size_t)end & SSE_ALIGN16_MASK);
-            if (str < align16) {
-                __m128i delims_in;
-                {
-                    char buf[SSE_BATCH_SIZE];
-                    ::memcpy(buf, delims, delim_count);
-                    if (delim_count < SSE_BATCH_SIZE)
-                        ::memset(buf + delim_count, delims[0], SSE_BATCH_SIZE - delim_count);
-                    delims_in = _mm_loadu_si128((__m128i*)buf);
-                }
-
-                const int FLAGS = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
-                do {
-                    const int i = _mm_cmpistri(delims_in, _mm_load_si128((__m128i*)str), FLAGS);
-                    if (i != (int)SSE_BATCH_SIZE)
-                        return str + i;
-                    str += SSE_BATCH_SIZE;
-                } while (str < align16);
-            }
-
-            // Scan remaining chars
-            for (; str < end; ++str)
-                if (::memchr(delims, *str, delim_count) != NULL)
-                    break;
-        }
-        return str;
-    }
-
-    // Scan to next delim in reverse, return new end -- min 1 delim, max 16 delims
-    inline const char* str_scan_delim_cpu_r(const char* str, const char* end, const char* delims, uint delim_count) {
-        if (str < end) {
-            const char* align16 = (char*)((size_t)end & SSE_ALIGN16_MASK);
-            if (align16 > str) {
-                // Scan up to alignment boundary
-                while (end > align16) {
-                    --end;
-                    if (::memchr(delims, *end, delim_count) != NULL)
-                        return end + 1;
-                }
-
-                // Scan in chunks of batch size using SSE 4.2 instruction: pcmpistri
-                align16 = (char*)( ((size_t)str + SSE_ALIGN16) & SSE_ALIGN16_MASK );
-                if (end > align16) {
-                    __m128i delims_in;
-                    {
-                        char buf[SSE_BATCH_SIZE];
-                        ::memcpy(buf, delims, delim_count);
-                        if (delim_count < SSE_BATCH_SIZE)
-                            ::memset(buf + delim_count, delims[0], SSE_BATCH_SIZE - delim_count);
-                        delims_in = _mm_loadu_si128((__m128i*)buf);
-                    }
-
-                    const int FLAGS = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_MOST_SIGNIFICANT;
-                    do {
-                        end -= SSE_BATCH_SIZE;
-                        const int i = _mm_cmpistri(delims_in, _mm_load_si128((__m128i*)end), FLAGS);
-                        if (i != (int)SSE_BATCH_SIZE)
-                            return end + i + 1;
-                    } while (end > align16);
-                }
-            }
-
-            // Scan remaining chars
-            while (str < end) {
-                --end;
-                if (::memchr(delims, *end, delim_count) != NULL)
-                    return end + 1;
-            }
-        }
-        return end;
-    }
-
 #elif defined(EVO_IMPL_SSE2)
     // Scan to next non-whitespace char
     inline const char* str_scan_nws_cpu(const char* str, const char* end) {
@@ -1068,7 +974,7 @@ inline const char* str_scan_delim_r(const char* str, const char* end, char delim
 /** Scan string pointer for next delimiter and return stop pointer.
  - \#include <evo/strscan.h>
  - This uses SSE optimization when enabled -- see \ref CppCompilers
- - Note: SSE optimizations don't apply with `delim_count > 16`
+ - Note: With SSE 2 (and not SSE 4.2), SSE optimizations don't apply with `delim_count > 16`
  .
  \param  str          %String pointer to scan, must not be NULL
  \param  end          Pointer to stop scanning, must be >= `str`
@@ -1089,8 +995,11 @@ inline const char* str_scan_delim(const char* str, const char* end, const char*
         case 2:
             return impl::str_scan_delim_cpu(str, end, delims[0], delims[1]);
         default:
+        #if !defined(EVO_IMPL_SSE42)
+            // SSE 2 compares each delim, SSE 4.2 uses character set lookup table instead
             if (delim_count <= impl::SSE_BATCH_SIZE)
                 return impl::str_scan_delim_cpu(str, end, delims, delim_count);
+        #endif
             break;
     }
 #endif
@@ -1101,7 +1010,7 @@ inline const char* str_scan_delim(const char* str, const char* end, const char*
  - \#include <evo/strscan.h>
  - This returns a new `end` pointer, which points to the character _after_ a delimiter
  - This uses SSE optimization when enabled -- see \ref CppCompilers
- - Note: SSE optimizations don't apply with `delim_count > 16`
+ - Note: With SSE 2 (and not SSE 4.2), SSE optimizations don't apply with `delim_count > 16`
  .
  \param  str          %String pointer to scan, must not be NULL
  \param  end          End pointer to stop scanning, must be >= `str`
@@ -1122,8 +1031,11 @@ inline const char* str_scan_delim_r(const char* str, const char* end, const char
         case 2:
             return impl::str_scan_delim_cpu_r(str, end, delims[0], delims[1]);
         default:
+        #if !defined(EVO_IMPL_SSE42)
+            // SSE 2 compares each delim, SSE 4.2 uses character set lookup table instead
             if (delim_count <= impl::SSE_BATCH_SIZE)
                 return impl::str_scan_delim_cpu_r(str, end, delims, delim_count);
+        #endif
             break;
     }
 #endif
@@ -1555,7 +1467,7 @@ inline const char* str_scan_endq(const char*& startq, const char*& endq, const c
  - The quoted value ends with an end-quote, followed by optional whitespace (space, tab, newlines), followed by either a delim or end of input
  - This supports all the Evo quoting types -- see \ref SmartQuoting
  - This uses SSE optimization when enabled -- see \ref CppCompilers
- - Note: SSE optimizations don't apply with `delim_count > 16`
+ - Note: With SSE 2 (and not SSE 4.2), SSE optimizations don't apply with `delim_count > 16`
  - See String::writequoted(), StrQuoting::get(bool&,const char*,ulong,char,char)
  .
  \param  startq       %Set to start of quoted text (without quote chars)  [out]
@@ -1664,7 +1576,7 @@ inline const char* str_scan_endq(const char*& startq, const char*& endq, const c
    - This returns a new `end` pointer, which points to the character _after_ a delimiter
  - This supports all the Evo quoting types -- see \ref SmartQuoting
  - This uses SSE optimization when enabled -- see \ref CppCompilers
- - Note: SSE optimizations don't apply with `delim_count > 16`
+ - Note: With SSE 2 (and not SSE 4.2), SSE optimizations don't apply with `delim_count > 16`
  - See String::writequoted(), StrQuoting::get(bool&,const char*,ulong,char)
  .
  \param  startq       %Set to start of quoted text (without quote chars)  [out]
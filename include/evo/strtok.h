@@ -1786,6 +1786,251 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+/** %String bulk tokenizer for delimited fields and lines in large buffers.
+ - This tokenizes fields separated by a delimiter and lines separated by newlines in a single pass -- ideal for large CSV/TSV data and log files
+ - This scans ahead in blocks of 64 chars to get a bitmask of delimiter and newline positions, then iterates tokens from the bitmask without rescanning
+   - This uses SSE optimization when enabled -- see \ref CppCompilers
+ - After each token, delim() gives the delimiter that ended it:
+   - Field delimiter: Next token is on the same line
+   - Newline (`'\n'`): Token is the last one in the line -- all main newline types are recognized and reported as `'\n'`, see \ref Newline
+   - Null: Token is the last one in the string
+ - A newline at the end of the string does not start another line
+ - This skips whitespace (spaces, tabs) around tokens like StrTok, except when the field delimiter is a whitespace char
+ - This references target string data -- results are undefined if target string is modified while referenced
+ .
+
+\par Example
+
+\code
+#include <evo/strtok.h>
+#include <evo/io.h>
+using namespace evo;
+Console& c = con();
+
+int main() {
+    SubString str = "id,name\n1,foo\r\n2,\"bar, baz\"\n";
+
+    // Lines:
+    //  id name
+    //  1 foo
+    //  2 bar, baz
+    StrTokBulk tok(str, ',');
+    while (tok.nextq()) {
+        c.out << tok.value();
+        c.out << (tok.delim() == ',' ? ' ' : '\n');
+    }
+
+    return 0;
+}
+\endcode
+*/
+class StrTokBulk : public StrTokBase {
+public:
+    typedef StrTokBulk      ThisType;    ///< This type
+    typedef StrTokBase      BaseType;    ///< Base type
+    typedef SubString::Size Size;        ///< %String size type
+
+    /** Constructor to start tokenizing given string.
+     - Call next() or nextq() for each token
+     .
+     \param  str    %String to tokenize
+     \param  delim  Field delimiter to use -- must not be a newline char
+    */
+    StrTokBulk(const StringBase& str, char delim=',') : StrTokBase(str), scan_(delim)
+        { impl_reset(); }
+
+    /** Copy constructor.
+     \param  src  Data to copy
+    */
+    StrTokBulk(const ThisType& src) : StrTokBase((const BaseType&)src), scan_(src.scan_), block_(src.block_), mask_(src.mask_)
+        { }
+
+    /** Assignment/Copy operator.
+     \param  src  Data to copy
+     \return      This
+    */
+    ThisType& operator=(const ThisType& src) {
+        this->copy(src);
+        scan_  = src.scan_;
+        block_ = src.block_;
+        mask_  = src.mask_;
+        return *this;
+    }
+
+    /** Assignment operator to start tokenizing given string from beginning, using the same field delimiter. Call next() or nextq() for each token.
+     \param  str  %String to tokenize
+     \return      This
+    */
+    ThisType& operator=(const StringBase& str) {
+        this->string_ = str;
+        this->value_.set();
+        this->delim_.set();
+        impl_reset();
+        return *this;
+    }
+
+    /** \copydoc StrTok::reset() */
+    ThisType& reset() {
+        this->delim_.set();
+        this->value_.set();
+        impl_reset();
+        return *this;
+    }
+
+    /** Find next token. Call value() to get token value, and delim() to get the delimiter that ended it.
+     - This will skip leading whitespace (spaces, tabs) before and after next token
+     .
+     \return  Whether next token was found, false if no more
+    */
+    bool next() {
+        const char* data = this->string_.data_;
+        Size ind;
+        if (!impl_start(ind))
+            return false;
+        const Size pos = impl_find(data, ind);
+        this->value_.set(data + ind, pos - ind).stripr();
+        impl_end(pos);
+        return true;
+    }
+
+    /** Find next token with quoting support. Call value() to get token value, and delim() to get the delimiter that ended it.
+     - This will skip leading whitespace (spaces, tabs) before and after next token
+     - Token may be single-quoted ( ' ), double-quoted ( " ), backtick-quoted ( ` ), or triple-quoted ( ''' or """ or ``` )
+       - This also supports backtick-DEL quoting -- backtick followed by the DEL char (7F) -- used when no other quoting is possible
+     - Token is only considered quoted if it begins and ends with given quotes, after excluding whitespace -- so an unquoted token can contain quote chars
+     - Quoted tokens may contain delimiters and newlines, and are scanned with str_scan_endq() -- unquoted tokens use the bitmask as with next()
+     - The field delimiter must not be a whitespace char to use this
+     - See \ref SmartQuoting
+     .
+     \return  Whether next token was found, false if no more
+    */
+    bool nextq() {
+        const char* data = this->string_.data_;
+        Size ind;
+        if (!impl_start(ind))
+            return false;
+        switch (data[ind]) {
+            case '\'':
+            case '"':
+            case '`': {
+                const char delims[3] = { scan_.delim, '\n', '\r' };
+                const char* start = data + ind;
+                const char* startq;
+                const char* endq;
+                const char* p = str_scan_endq(startq, endq, start, data + this->string_.size_, delims, 3, '\n');
+                this->value_.set(startq, (Size)(endq - startq));
+                if (startq == start)
+                    this->value_.stripr();
+                impl_end((Size)(p - data));
+                impl_sync(this->index_);
+                return true;
+            }
+            default:
+                break;
+        }
+        const Size pos = impl_find(data, ind);
+        this->value_.set(data + ind, pos - ind).stripr();
+        impl_end(pos);
+        return true;
+    }
+
+private:
+    impl::StrDelimMask scan_;   // Delimiter bitmask scanner
+    Size               block_;  // Start index of current block in mask_, END for none
+    uint64             mask_;   // Delimiter bitmask for current block
+
+    void impl_reset() {
+        const char* data = this->string_.data_;
+        const Size  size = this->string_.size_;
+        Size&       ind  = this->index_;
+        ind = 0;
+        impl_skipws(data, ind, size);
+        if (ind >= size)
+            ind = END;
+        block_ = END;
+        mask_  = 0;
+    }
+
+    void impl_skipws(const char* data, Size& ind, Size size) const {
+        for (char ch; ind < size && ((ch=data[ind]) == ' ' || ch == '\t') && ch != scan_.delim; )
+            ++ind;
+    }
+
+    // Skip whitespace to start next token, return false if no more
+    bool impl_start(Size& ind) {
+        const Size size = this->string_.size_;
+        ind = this->index_;
+        if (ind > size) {
+            this->value_.set();
+            this->delim_.set();
+            return false;
+        }
+        impl_skipws(this->string_.data_, ind, size);
+        if (ind == size) {
+            const bool more = !(this->delim_ == '\n');  // newline at end doesn't start another line
+            if (more)
+                this->value_.setempty();
+            else
+                this->value_.set();
+            this->delim_.set();
+            this->index_ = END;
+            return more;
+        }
+        return true;
+    }
+
+    // Find next delimiter or newline from index, return size if not found -- mask_ only has bits for positions from index
+    Size impl_find(const char* data, Size ind) {
+        const Size BLOCK_SIZE = impl::StrDelimMask::BLOCK_SIZE;
+        const Size size = this->string_.size_;
+        for (;;) {
+            if (mask_ != 0) {
+                const Size pos = block_ + impl::str_bitscan64(mask_);
+                mask_ &= mask_ - 1;
+                return pos;
+            }
+            block_ = (block_ == END || ind >= block_ + BLOCK_SIZE ? ind : block_ + BLOCK_SIZE);
+            if (block_ >= size)
+                return size;
+            const Size remain = size - block_;
+            mask_ = (remain >= BLOCK_SIZE ? scan_.get(data + block_) : scan_.get(data + block_, remain));
+            if (ind > block_)
+                mask_ &= (~(uint64)0 << (ind - block_));
+        }
+    }
+
+    // Clear mask bits for positions before index, used after skipping ahead
+    void impl_sync(Size ind) {
+        if (block_ != END && ind > block_) {
+            if (ind - block_ < impl::StrDelimMask::BLOCK_SIZE)
+                mask_ &= (~(uint64)0 << (ind - block_));
+            else
+                mask_ = 0;
+        }
+    }
+
+    // Set delimiter and index after token ending at pos
+    void impl_end(Size pos) {
+        const char* data = this->string_.data_;
+        const Size  size = this->string_.size_;
+        if (pos >= size) {
+            this->delim_.set();
+            this->index_ = END;
+        } else {
+            const char ch = data[pos];
+            if (ch == '\n' || ch == '\r') {
+                if (pos + 1 < size && data[pos + 1] == (ch == '\n' ? '\r' : '\n'))
+                    impl_sync(++pos + 1);
+                this->delim_ = '\n';
+            } else
+                this->delim_ = ch;
+            this->index_ = pos + 1;
+        }
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 /** Helper for tokenizing using a break-loop.
  - A break-loop is a loop that always breaks at the end so doesn't actually loop, but also allows an early break to skip remaining code in the loop
  - This calls `TOK.next()` and if it fails this does a `break` to stop current loop
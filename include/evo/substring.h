@@ -836,10 +836,9 @@ struct SubString : public SubList<char,StrSizeT> {
                     return (Key)(ptr - data_);
             } else {
                 const char* pend = data_ + end;
-                const char* ptr  = data_ + start;
-                for (; ptr < pend; ++ptr)
-                    if (memchr(chars, *ptr, count) != NULL)
-                        return (Key)(ptr - data_);
+                const char* ptr  = impl::str_scan_any(data_ + start, pend, chars, count);
+                if (ptr < pend)
+                    return (Key)(ptr - data_);
             }
         }
         return NONE;
@@ -857,10 +856,9 @@ struct SubString : public SubList<char,StrSizeT> {
             if (end > size_)
                 end = size_;
             const char* pstart = data_ + start;
-            const char* ptr    = data_ + end;
-            while (ptr > pstart)
-                if (memchr(chars, *--ptr, count) != NULL)
-                    return (Key)(ptr - data_);
+            const char* ptr    = impl::str_scan_any_r(pstart, data_ + end, chars, count);
+            if (ptr > pstart)
+                return (Key)(ptr - data_) - 1;
         }
         return NONE;
     }
@@ -877,10 +875,9 @@ struct SubString : public SubList<char,StrSizeT> {
             if (end > size_)
                 end = size_;
             const char* pend = data_ + end;
-            const char* ptr  = data_ + start;
-            for (; ptr < pend; ++ptr)
-                if (memchr(chars, *ptr, count) == NULL)
-                    return (Key)(ptr - data_);
+            const char* ptr  = impl::str_scan_anybut(data_ + start, pend, chars, count);
+            if (ptr < pend)
+                return (Key)(ptr - data_);
         }
         return NONE;
     }
@@ -897,10 +894,9 @@ struct SubString : public SubList<char,StrSizeT> {
             if (count == 0)
                 return end - 1;
             const char* pstart = data_ + start;
-            const char* ptr    = data_ + end;
-            while (ptr > pstart)
-                if (memchr(chars, *--ptr, count) == NULL)
-                    return (Key)(ptr - data_);
+            const char* ptr    = impl::str_scan_anybut_r(pstart, data_ + end, chars, count);
+            if (ptr > pstart)
+                return (Key)(ptr - data_) - 1;
         }
         return NONE;
     }
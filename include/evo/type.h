@@ -1030,6 +1030,29 @@ struct IntegerT : public Nullable<T> {
             base -= 100;
         assert( base > 1 );
         assert( base < 100 );
+        if (base == 10) {
+            // Compare instead of dividing for each digit, only 1 division (by constant) per 4 digits
+            typedef typename ToUnsigned<T>::Type UT;
+            UT unum;
+            int result = 1;
+            if (num < 0) {
+                unum = (UT)0 - (UT)num;
+                ++result;
+            } else
+                unum = (UT)num;
+            for (;;) {
+                if (unum < 10)
+                    return result;
+                if (unum < 100)
+                    return result + 1;
+                if (unum < 1000)
+                    return result + 2;
+                if (unum < 10000)
+                    return result + 3;
+                unum /= (UT)10000;
+                result += 4;
+            }
+        }
         int result = 0;
         if (num == 0)
             result = 1;